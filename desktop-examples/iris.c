@@ -49,48 +49,55 @@ u64 class_to_index(char label[64]) {
 }
 
 typedef struct {
-  Csv* csv;
-  size_t rows;   // csv_num_rows (includes header)
-  u64 N, D, C;
-  size_t cursor; // current csv row (data starts at 1)
+  Matf32 X_all;  // every sample (S×D)
+  u32* y_all;    // every class index (S)
+  u64 N;
+  u64 cursor;    // first sample of the next batch
 } IrisBatchCtx;
 
-static ML_Status iris_next_batch(void* ctxp, Matf32* X, Matf32* Y) {
-  IrisBatchCtx* ctx = (IrisBatchCtx*)ctxp;
-
+// Decode the whole CSV once into dataset matrices so batches can be views
+static ML_Status iris_load(const Csv* csv, size_t rows, u64 D, u64 C,
+                           Matf32* X_all, u32* y_all) {
   const size_t first_data_row = 1;
-  if (ctx->cursor < first_data_row) ctx->cursor = first_data_row;
-
-  if (ctx->cursor + (size_t)ctx->N > ctx->rows) {
-    ctx->cursor = first_data_row;
-    return ML_DONE;
-  }
-
-  ML_Status status = MatFillScalar(Y, 0.0f);
-  if (status != ML_OK) return status;
+  ML_Status status = ML_OK;
 
-  for (u64 i = 0; i < ctx->N; ++i) {
-    size_t csv_row = ctx->cursor + (size_t)i;
+  for (u64 i = 0; i + first_data_row < rows && i < X_all->rows; ++i) {
+    size_t csv_row = first_data_row + (size_t)i;
 
-    for (u64 j = 0; j < ctx->D; ++j) {
+    for (u64 j = 0; j < D; ++j) {
       size_t csv_col = (size_t)j + 1;
       f32 v = 0.0f;
-      if (!csv_get_f32(ctx->csv, csv_row, csv_col, &v)) return ML_INVALID_ARGUMENT;
-      status = MatSet(X, i, j, v);
+      if (!csv_get_f32(csv, csv_row, csv_col, &v)) return ML_INVALID_ARGUMENT;
+      status = MatSet(X_all, i, j, v);
       if (status != ML_OK) return status;
     }
 
     char label[64];
-    if (!csv_get_string(ctx->csv, csv_row, 5, label, sizeof(label))) return ML_INVALID_ARGUMENT;
+    if (!csv_get_string(csv, csv_row, 5, label, sizeof(label))) return ML_INVALID_ARGUMENT;
 
     int cls = class_to_index(label);
-    if (cls < 0 || (u64)cls >= ctx->C) return ML_INVALID_ARGUMENT;
+    if (cls < 0 || (u64)cls >= C) return ML_INVALID_ARGUMENT;
 
-    status = MatSet(Y, i, (u64)cls, 1.0f);
-    if (status != ML_OK) return status;
+    y_all[i] = (u32)cls;
   }
 
-  ctx->cursor += (size_t)ctx->N;
+  return ML_OK;
+}
+
+static ML_Status iris_next_batch(void* ctxp, Matf32* X, u32** labels) {
+  IrisBatchCtx* ctx = (IrisBatchCtx*)ctxp;
+
+  if (ctx->cursor + ctx->N > ctx->X_all.rows) {
+    ctx->cursor = 0;
+    return ML_DONE;
+  }
+
+  // Zero-copy: the batch is a window of N rows into the dataset
+  ML_Status status = Mat_view_rows(X, ctx->X_all, ctx->cursor, ctx->N);
+  if (status != ML_OK) return status;
+  *labels = ctx->y_all + ctx->cursor;
+
+  ctx->cursor += ctx->N;
   return ML_OK;
 }
 
@@ -119,16 +126,17 @@ int main() {
   // Virginica (2)
   const u64 C = 3;
 
-  // Dataset Matrices for training.
+  // Dataset buffers for training.
   // X is the feature matrix
-  // Y is the one-hot matrix
-  Matf32 X,Y;
+  // y holds the class index of each sample
+  Matf32 X;
   status = create_Mat(&arena,&X,N,D);
   if (status != ML_OK)
     printf("Error at creating dataset X: %d\n",status);
-  status = create_Mat(&arena,&Y,N,C);
+  u32* y = NULL;
+  status = push_ml_arena((void**)&y,&arena,N * sizeof(u32));
   if (status != ML_OK)
-    printf("Error at creating dataset Y: %d\n",status);
+    printf("Error at creating dataset y: %d\n",status);
 
   //Fill from dataset
   printf("Opening dataset...\n");
@@ -139,8 +147,22 @@ int main() {
     printf("Error loading dataset\n");
 
   size_t rows = csv_num_rows(&iris_dataset);
+  // rows includes the header line
+  const u64 S = rows > 1 ? (u64)rows - 1 : 0;
+
+  Matf32 X_all;
+  status = create_Mat(&arena,&X_all,S,D);
+  if (status != ML_OK)
+    printf("Error at creating dataset X_all: %d\n",status);
+  u32* y_all = NULL;
+  status = push_ml_arena((void**)&y_all,&arena,S * sizeof(u32));
+  if (status != ML_OK)
+    printf("Error at creating dataset y_all: %d\n",status);
+  status = iris_load(&iris_dataset,rows,D,C,&X_all,y_all);
+  if (status != ML_OK)
+    printf("Error decoding dataset: %d\n",status);
+
   print_matrix("X_train",X);
-  print_matrix("Y_train",Y);
 
   //Create classification model
   ML_Rng rng = {.ctx = NULL, .next01 = getrandom_next01};
@@ -161,27 +183,25 @@ int main() {
   ML_TrainConfig tconf = {.epochs = 200, .lr = 0.05f};
 
   IrisBatchCtx bctx = {
-    .csv = &iris_dataset,
-    .rows = rows,
+    .X_all = X_all,
+    .y_all = y_all,
     .N = N,
-    .D = D,
-    .C = C,
-    .cursor = 1,
+    .cursor = 0,
   };
   ML_BatchProvider provider = {
-  .next_batch = iris_next_batch,
+  .next_batch_labels = iris_next_batch,
   .ctx = &bctx,
   };
 
   // train
   f32 last_loss = 0.0f;
   printf("Starting to train...");
-  status = train_SoftmaxRegression(&model,
-				   provider,
-                                   tconf,
-                                   &X,
-                                   &Y,
-                                   &last_loss);
+  status = train_SoftmaxRegression_labels(&model,
+					  provider,
+                                          tconf,
+                                          &X,
+                                          y,
+                                          &last_loss);
   if (status != ML_OK) { printf("train error: %d\n", status); return 1; }
 
   printf("...Done training,loss=%.6f\n", (double)last_loss);
@@ -15,6 +15,21 @@
  * - never frees individual allocations (bump allocator)
  * - performs aligned allocations (alignment is pointer-size)
  * - is O(1) per allocation
+ * - is double-ended: push_ml_arena() grows up from the start of the buffer,
+ *   push_top_ml_arena() grows down from the end, and the two meet in the
+ *   middle
+ * - can be rolled back in LIFO order with mark_ml_arena() /
+ *   rewind_ml_arena(), or scratch scopes on the top end
+ *
+ * Keeping long-lived data (models, weights) at the bottom and temporaries
+ * at the top lets a long-running program reuse the top end forever while
+ * the bottom only ever grows.
+ *
+ * On desktop hosts create_mapped_ml_arena() backs an arena with a large
+ * reserved address range instead of a caller buffer. Pages are committed in
+ * chunks as either end reaches them, optionally as huge pages, so a training
+ * run can size its arena generously and pay only for what it touches. All
+ * push / mark / scratch functions work on it unchanged.
  *
  * Typical usage:
  * @code
@@ -23,6 +38,18 @@
  * ML_Status st = create_ml_arena(&arena, mem, sizeof(mem));
  * void* p = NULL;
  * st = push_ml_arena(&p, &arena, 128);
+ *
+ * // Temporaries that die at the end of a request
+ * ml_scratch scratch;
+ * begin_ml_scratch(&scratch, &arena);
+ * void* tmp = NULL;
+ * st = push_ml_scratch(&tmp, &scratch, 256);
+ * end_ml_scratch(&scratch);                // tmp is gone, p is not
+ *
+ * // Allocating APIs use the bottom end; roll them back with a mark
+ * ml_arena_mark m = mark_ml_arena(&arena);
+ * Mat_rowmax(&max, &arena, Z);
+ * rewind_ml_arena(&arena, m);
  * @endcode
  */
 
@@ -39,6 +66,15 @@
  * for storing pointers and most scalar types on typical targets.
  */
 #define ARENA_ALIGN (sizeof(void*))
+/**
+ * @brief Cache line size in bytes, for push_aligned_ml_arena().
+ *
+ * 64 covers x86, most ARM cores and the ESP32 family; it is also the
+ * widest vector (AVX-512) any kernel loads.
+ */
+#ifndef ARENA_CACHE_LINE
+#define ARENA_CACHE_LINE 64
+#endif
 /**
  * @brief Align @p n upward to the next multiple of @p p, where @p p is a power of two.
  *
@@ -48,6 +84,99 @@
  */
 #define ALIGN_UP_POW2(n, p) (((u64)(n) + ((u64)(p) - 1)) & (~((u64)(p) - 1)))
 
+/** @brief Most distinct tags an ml_arena_stats keeps separate totals for. */
+#ifndef ML_ARENA_MAX_TAGS
+#define ML_ARENA_MAX_TAGS 32
+#endif
+
+/** @brief Kind of an arena event passed to an ML_ArenaTraceFn. */
+typedef enum {
+  /** Bottom-end allocation (push_ml_arena(), push_aligned_ml_arena()). */
+  ML_ARENA_EV_PUSH,
+  /** Top-end allocation (push_top_ml_arena(), push_ml_scratch()). */
+  ML_ARENA_EV_PUSH_TOP,
+  /** An allocation that failed with ML_OUT_OF_MEMORY. */
+  ML_ARENA_EV_FAIL,
+  /** rewind_ml_arena() or end_ml_scratch(). */
+  ML_ARENA_EV_REWIND,
+} ML_ArenaEvent;
+
+/** @brief One traced arena event. */
+typedef struct {
+  ML_ArenaEvent kind;
+  /** Tag active at the time (NULL if none). */
+  const char* tag;
+  /** Offset of the block from the arena base (new top for a rewind). */
+  u64 offset;
+  /** Requested size in bytes (new bottom position for a rewind). */
+  u64 size;
+  /** Bytes skipped or padded for alignment. */
+  u64 waste;
+} ml_arena_event;
+
+/** @brief Trace callback, called after every event. */
+typedef void (*ML_ArenaTraceFn)(void* ctx, const ml_arena_event* ev);
+
+/** @brief Totals for one allocation tag. */
+typedef struct {
+  /** Tag string (not copied; must outlive the stats). */
+  const char* tag;
+  /** Bytes requested under this tag. */
+  u64 bytes;
+  /** Allocations made under this tag. */
+  u64 count;
+} ml_arena_tag_stats;
+
+/**
+ * @brief Optional instrumentation for an arena, see attach_stats_ml_arena().
+ *
+ * Byte and allocation counts are cumulative: memory released by a rewind
+ * is not subtracted. The peaks are the figures to size an arena from.
+ */
+typedef struct {
+  /** Highest bottom-end position reached. */
+  u64 peak_pos;
+  /** Highest bytes in use at once, both ends together. */
+  u64 peak_used;
+  /** Successful allocations. */
+  u64 allocs;
+  /** Allocations that failed with ML_OUT_OF_MEMORY. */
+  u64 failed;
+  /** Bytes requested by successful allocations. */
+  u64 bytes;
+  /** Bytes lost to alignment padding. */
+  u64 waste;
+  /** Per-tag totals; allocations without a tag go under "untagged". */
+  ml_arena_tag_stats tags[ML_ARENA_MAX_TAGS];
+  /** Entries used in @ref tags. */
+  u64 n_tags;
+  /** Allocations whose tag did not fit in @ref tags. */
+  u64 tags_dropped;
+  /** Optional trace callback (NULL for none). */
+  ML_ArenaTraceFn trace;
+  /** Passed to @ref trace. */
+  void* trace_ctx;
+} ml_arena_stats;
+
+/** @brief Line sink for dump_ml_arena_stats(); @p line has no newline. */
+typedef void (*ML_ArenaDumpFn)(void* ctx, const char* line);
+
+/** @brief Huge page policy for create_mapped_ml_arena(). */
+typedef enum {
+  /** Normal pages. */
+  ML_HUGEPAGES_NONE,
+  /** Ask for transparent huge pages (madvise(MADV_HUGEPAGE)); a hint only. */
+  ML_HUGEPAGES_THP,
+  /**
+   * Commit chunks from the explicit huge page pool (MAP_HUGETLB), falling
+   * back to normal pages with the THP hint when the pool runs dry.
+   */
+  ML_HUGEPAGES_HUGETLB,
+} ML_HugePages;
+
+/** @brief Backing state of a mapped arena (opaque). */
+typedef struct ml_arena_map ml_arena_map;
+
 /**
  * @brief Bump-pointer arena allocator.
  *
@@ -60,8 +189,43 @@ typedef struct {
   u64 capacity;
   /** Current bump position (offset in bytes from @ref base). */
   u64  pos; 
+  /** Start of the top-end allocations (offset from @ref base); @ref capacity when empty. */
+  u64  top;
+  /** Instrumentation, or NULL (the default) for none. */
+  ml_arena_stats* stats;
+  /** Tag recorded with each allocation, see set_tag_ml_arena(). */
+  const char* tag;
+  /** Nonzero for a counting arena, see create_counting_ml_arena(). */
+  u8 counting;
+  /** Commit state of a mapped arena, see create_mapped_ml_arena(); NULL otherwise. */
+  ml_arena_map* map;
 } ml_arena;
 
+/**
+ * @brief Saved arena state, see mark_ml_arena().
+ */
+typedef struct {
+  /** Bottom-end position at the time of the mark. */
+  u64 pos;
+  /** Top-end position at the time of the mark. */
+  u64 top;
+} ml_arena_mark;
+
+/**
+ * @brief Scratch scope on the top end of an arena.
+ *
+ * Everything pushed with push_ml_scratch() (or push_top_ml_arena()) after
+ * begin_ml_scratch() is released by end_ml_scratch(). Scopes nest and must
+ * end in reverse order of beginning. Bottom-end allocations made inside a
+ * scope are not affected.
+ */
+typedef struct {
+  /** Arena the scope allocates from. */
+  ml_arena* arena;
+  /** Top-end position to restore on end_ml_scratch(). */
+  u64 top;
+} ml_scratch;
+
 /**
  * @brief Initialize an arena with caller-provided backing memory.
  *
@@ -74,6 +238,73 @@ typedef struct {
  */
 ML_Status create_ml_arena(ml_arena* target,void* mem,u64 capacity);
 
+/**
+ * @brief Initialize a counting arena: no memory, unlimited capacity.
+ *
+ * Every push succeeds, hands out a NULL pointer and advances the arena
+ * exactly as a real one would, so after a dry run of some allocating code
+ * get_used_ml_arena_bytes() is the space that code needs. Aligned pushes
+ * book their worst-case padding, since a counting arena has no address
+ * to align.
+ *
+ * Only code that allocates without touching the memory can run on it;
+ * the create_model_* / create_op_* functions recognise a counting arena
+ * and skip initialising what they allocate.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p target is NULL.
+ */
+ML_Status create_counting_ml_arena(ml_arena* target);
+
+/**
+ * @brief Initialize an arena over a reserved, lazily committed address range.
+ *
+ * Reserves @p reserve bytes of address space without backing them, then
+ * commits @p chunk bytes at a time as push_ml_arena() / push_top_ml_arena()
+ * reach uncommitted space: the bottom end grows upwards from the start and
+ * the top end downwards from the end, exactly as in a fixed arena. The
+ * range never moves, so every pointer handed out stays valid until the
+ * arena is destroyed, and capacity is the whole reservation.
+ *
+ * Committed chunks are kept across rewinds and reused; only
+ * destroy_mapped_ml_arena() returns them.
+ *
+ * Only available where mmap() is (Linux, macOS and other POSIX hosts);
+ * elsewhere, including ESP-IDF, it returns ML_UNIMPLEMENTED.
+ *
+ * @code
+ * ml_arena arena;
+ * create_mapped_ml_arena(&arena, GiB(16), MiB(2), ML_HUGEPAGES_THP);
+ * create_model_SoftmaxRegression(&arena, &model, conf);  // commits ~model size
+ * ...
+ * destroy_mapped_ml_arena(&arena);
+ * @endcode
+ *
+ * @param target Output arena to initialize.
+ * @param reserve Address space to reserve in bytes (the arena capacity),
+ *        rounded up to a whole number of chunks.
+ * @param chunk Commit granularity in bytes; 0 picks 2 MiB. Rounded up to
+ *        the page size (the huge page size for ML_HUGEPAGES_HUGETLB).
+ * @param huge Huge page policy.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p target is NULL or @p reserve is 0.
+ * @return ML_OUT_OF_MEMORY if the address space cannot be reserved.
+ * @return ML_UNIMPLEMENTED if the platform has no mmap().
+ */
+ML_Status create_mapped_ml_arena(ml_arena* target, u64 reserve, u64 chunk, ML_HugePages huge);
+
+/**
+ * @brief Release the reservation of a mapped arena.
+ *
+ * Every pointer handed out by the arena becomes invalid; @p target is
+ * cleared.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p target is NULL or not a mapped arena.
+ */
+ML_Status destroy_mapped_ml_arena(ml_arena* target);
+
 /**
  * @brief Allocate @p size bytes from the arena (bump allocation).
  *
@@ -82,7 +313,9 @@ ML_Status create_ml_arena(ml_arena* target,void* mem,u64 capacity);
  * Behavior:
  * - On success, *@p ptr receives the allocated pointer and the arena position advances.
  * - If @p size == 0, *@p ptr is set to NULL and the function returns ML_OK.
- * - If there is not enough space, returns ML_OUT_OF_MEMORY and does not modify the arena.
+ * - If there is not enough space below the top-end allocations, returns
+ *   ML_OUT_OF_MEMORY and does not modify the arena. On a mapped arena this
+ *   also happens when the pages cannot be committed.
  *
  * @param ptr Output pointer to receive the allocated address.
  * @param arena Arena to allocate from.
@@ -94,15 +327,146 @@ ML_Status create_ml_arena(ml_arena* target,void* mem,u64 capacity);
  */
 ML_Status push_ml_arena(void** ptr,ml_arena* arena, u64 size);
 
+/**
+ * @brief Allocate @p size bytes aligned to @p align from the bottom end.
+ *
+ * The returned address is a multiple of @p align (as an address, not just
+ * as an offset from the arena base), and the block is padded to a whole
+ * number of @p align units, so with @p align = ARENA_CACHE_LINE the
+ * allocation shares no cache line with its neighbours. The padding bytes
+ * are lost to the arena.
+ *
+ * Same size == 0 and failure behaviour as push_ml_arena().
+ *
+ * @param ptr Output pointer to receive the allocated address.
+ * @param arena Arena to allocate from.
+ * @param size Number of bytes to allocate.
+ * @param align Alignment in bytes, a power of two; values below
+ *        ARENA_ALIGN are raised to it.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p ptr or @p arena is NULL, @p arena->base
+ *         is NULL, or @p align is not a power of two.
+ * @return ML_OUT_OF_MEMORY if the arena does not have sufficient remaining capacity.
+ */
+ML_Status push_aligned_ml_arena(void** ptr, ml_arena* arena, u64 size, u64 align);
+
+/**
+ * @brief Allocate @p size bytes from the top end of the arena.
+ *
+ * Same contract as push_ml_arena() (alignment, size == 0, failure leaves
+ * the arena unchanged), but the block is carved downwards from the end of
+ * the buffer. Meant for temporaries; see ml_scratch.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p ptr is NULL, or @p arena is NULL, or @p arena->base is NULL.
+ * @return ML_OUT_OF_MEMORY if the free space between the two ends is too small.
+ */
+ML_Status push_top_ml_arena(void** ptr, ml_arena* arena, u64 size);
+
+/**
+ * @brief Save the current state of both ends of the arena.
+ *
+ * @param arena Arena to query (NULL gives an all-zero mark).
+ * @return Mark to pass to rewind_ml_arena().
+ */
+ml_arena_mark mark_ml_arena(const ml_arena* arena);
+
+/**
+ * @brief Release everything allocated (on either end) since @p mark.
+ *
+ * Marks are LIFO: rewinding to a mark invalidates every later mark and
+ * every pointer handed out after it.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p arena is NULL or @p mark is not an
+ *         earlier state of @p arena (e.g. it was already rewound past).
+ */
+ML_Status rewind_ml_arena(ml_arena* arena, ml_arena_mark mark);
+
+/**
+ * @brief Open a scratch scope on the top end of @p arena.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p scratch or @p arena is NULL.
+ */
+ML_Status begin_ml_scratch(ml_scratch* scratch, ml_arena* arena);
+
+/**
+ * @brief Allocate @p size bytes that live until end_ml_scratch().
+ *
+ * Equivalent to push_top_ml_arena(ptr, scratch->arena, size).
+ */
+ML_Status push_ml_scratch(void** ptr, ml_scratch* scratch, u64 size);
+
+/**
+ * @brief Close a scratch scope, releasing its top-end allocations.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p scratch is NULL or not open, or an
+ *         enclosing scope was already ended (scopes ended out of order).
+ */
+ML_Status end_ml_scratch(ml_scratch* scratch);
+
+/**
+ * @brief Bytes in use at both ends of the arena, alignment padding included.
+ *
+ * @param arena Arena to query.
+ * @return pos + (capacity - top), or 0 if @p arena is NULL.
+ */
+u64 get_used_ml_arena_bytes(const ml_arena* arena);
+
 /**
  * @brief Get the number of free bytes remaining in the arena.
  *
- * This is a simple capacity - pos calculation (no alignment padding is considered
- * for a *future* allocation).
+ * This is a simple top - pos calculation, the gap between the two ends (no
+ * alignment padding is considered for a *future* allocation).
  *
  * @param arena Arena to query.
  * @return Remaining free bytes, or 0 if @p arena is NULL or exhausted.
  */
 u64 get_freemem_ml_arena_bytes(const ml_arena* arena);
 
+/**
+ * @brief Start collecting statistics for @p arena into @p stats.
+ *
+ * @p stats is cleared (its @ref ml_arena_stats::trace callback and context
+ * are kept) and its peaks start from the arena's current state. Pass NULL
+ * to detach. Without stats attached every push costs one extra branch.
+ *
+ * @code
+ * static ml_arena_stats st;
+ * attach_stats_ml_arena(&arena, &st);
+ * create_model_SoftmaxRegression(&arena, &model, conf);
+ * dump_ml_arena_stats(&arena, print_line, NULL);  // peak, waste, per-op bytes
+ * @endcode
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p arena is NULL.
+ */
+ML_Status attach_stats_ml_arena(ml_arena* arena, ml_arena_stats* stats);
+
+/**
+ * @brief Set the tag recorded with subsequent allocations.
+ *
+ * Operators tag their buffers ("Linear.W", "Softmax.P", ...) while they
+ * allocate them. Tags are compared as strings and are not copied.
+ *
+ * @param arena Arena to tag (NULL is ignored).
+ * @param tag New tag, or NULL for none.
+ * @return The previous tag, so callers can restore it.
+ */
+const char* set_tag_ml_arena(ml_arena* arena, const char* tag);
+
+/**
+ * @brief Write a human-readable summary of the arena's statistics.
+ *
+ * Emits one line for the totals, one for alignment waste and one per tag
+ * through @p fn. Does nothing without attached stats.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p arena or @p fn is NULL.
+ */
+ML_Status dump_ml_arena_stats(const ml_arena* arena, ML_ArenaDumpFn fn, void* ctx);
+
 #endif //ML_ALLOC_H
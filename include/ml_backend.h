@@ -0,0 +1,120 @@
+#ifndef ML_BACKEND_H
+#define ML_BACKEND_H
+
+#include "ml_error.h"
+
+/**
+ * @file ml_backend.h
+ * @brief Selection of the SIMD kernel backend used by the primitives.
+ *
+ * Every dense primitive (fill, copy, scale, SGD, row/column reductions,
+ * broadcasts, exp and the GEMM micro-kernel) is routed through a kernel
+ * table. On first use the CPU is probed once and the widest backend it
+ * supports is installed; the portable scalar backend is always available
+ * and is the only one compiled into ESP-IDF builds.
+ *
+ * The backend can be overridden, e.g. to compare results against the
+ * scalar reference:
+ * @code
+ * set_ml_backend(ML_BACKEND_SCALAR);
+ * // ...
+ * set_ml_backend(ML_BACKEND_AUTO);
+ * @endcode
+ *
+ * @note Switching backends is not synchronised with kernels running on
+ *       other threads; do it while the library is idle.
+ */
+
+/** @brief Kernel backends known to the library. */
+typedef enum {
+  /** Pick the widest backend supported by the running CPU. */
+  ML_BACKEND_AUTO,
+  /** Portable C loops (always available). */
+  ML_BACKEND_SCALAR,
+  /** x86 SSE2 (128-bit). */
+  ML_BACKEND_SSE2,
+  /** x86 AVX2 + FMA + F16C (256-bit). */
+  ML_BACKEND_AVX2,
+  /** x86 AVX-512F (512-bit). */
+  ML_BACKEND_AVX512,
+  /** ARM NEON (128-bit). */
+  ML_BACKEND_NEON,
+} ML_Backend;
+
+/**
+ * @brief Get the backend currently used by the primitives.
+ *
+ * Triggers CPU detection if no backend has been installed yet.
+ *
+ * @return The active backend (never ML_BACKEND_AUTO).
+ */
+ML_Backend get_ml_backend(void);
+
+/**
+ * @brief Install a kernel backend.
+ *
+ * @param backend Backend to use, or ML_BACKEND_AUTO for the widest supported one.
+ *
+ * @return ML_OK on success.
+ * @return ML_UNIMPLEMENTED if @p backend is not compiled in or not supported by this CPU.
+ * @return ML_INVALID_ARGUMENT if @p backend is not a known value.
+ */
+ML_Status set_ml_backend(ML_Backend backend);
+
+/**
+ * @brief Check whether a backend is compiled in and supported by this CPU.
+ *
+ * @param backend Backend to query.
+ * @return Non-zero if @p backend can be installed with set_ml_backend().
+ */
+int has_ml_backend(ML_Backend backend);
+
+/**
+ * @brief Human readable backend name ("scalar", "avx2", ...).
+ *
+ * @param backend Backend to name.
+ * @return Static string, "unknown" for invalid values.
+ */
+const char* get_name_ml_backend(ML_Backend backend);
+
+/**
+ * @brief Accuracy tiers for the exp/log kernels.
+ *
+ * Used by Mat_exp_inplace(), softmax and cross-entropy. Errors are in ULP
+ * of the exact result, measured over every f32 input. The fast tiers run the same algorithm on every backend
+ * (results may differ in the last bit where FMA is available). Subnormal,
+ * zero, infinite and NaN inputs and outputs are handled as libm does.
+ *
+ * The default is ML_MATH_DEFAULT_ACCURACY, ML_MATH_FAST unless overridden
+ * at build time (-DML_MATH_DEFAULT_ACCURACY=ML_MATH_EXACT, or the CMake
+ * cache variable ESP_ML_MATH_ACCURACY=EXACT).
+ */
+typedef enum {
+  /** libm expf/logf, one element at a time. */
+  ML_MATH_EXACT,
+  /** Vectorised polynomial; max error exp 1.01 ULP, log 0.83 ULP. */
+  ML_MATH_FAST,
+  /** Shorter polynomial; max error exp 70 ULP, log 208 ULP (relative < 2^-16). */
+  ML_MATH_FASTEST,
+} ML_MathAccuracy;
+
+#ifndef ML_MATH_DEFAULT_ACCURACY
+#define ML_MATH_DEFAULT_ACCURACY ML_MATH_FAST
+#endif
+
+/**
+ * @brief Get the accuracy tier used by the exp/log kernels.
+ */
+ML_MathAccuracy get_ml_math_accuracy(void);
+
+/**
+ * @brief Select the accuracy tier used by the exp/log kernels.
+ *
+ * @param acc Tier to use.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p acc is not a known value.
+ */
+ML_Status set_ml_math_accuracy(ML_MathAccuracy acc);
+
+#endif // ML_BACKEND_H
@@ -0,0 +1,160 @@
+#ifndef ML_FIXED_H
+#define ML_FIXED_H
+
+#include "ml_error.h"
+#include "ml_alloc.h"
+#include "ml_primitives.h"
+
+/**
+ * @file ml_fixed.h
+ * @brief Fixed-point (Q15 / Q7) matrices and integer-only kernels.
+ *
+ * For targets without an FPU, where every f32 operation is a soft-float
+ * library call. A Matq15 holds 16-bit and a Matq7 8-bit signed integers
+ * with @ref Matq15::frac fractional bits, i.e. x = q / 2^frac (Q15 proper
+ * is frac = 15; smaller values trade precision for range). The product,
+ * softmax and argmax kernels below use only integer arithmetic:
+ * products accumulate exactly in 32/64-bit integers and are rounded back
+ * to 16 bits with a single shift, and softmax computes exp from a 257
+ * entry table of 2^(-j/256).
+ *
+ * Only the conversions from/to f32 (used once, by the model converter or
+ * to feed inputs on a host) touch floating point.
+ */
+
+/** @brief Storage width of a fixed-point tensor. */
+typedef enum {
+  /** 8-bit, values in [-128, 127] / 2^frac. */
+  ML_FIXED_Q7,
+  /** 16-bit, values in [-32768, 32767] / 2^frac. */
+  ML_FIXED_Q15,
+} ML_FixedType;
+
+/** @brief Largest number of fractional bits a fixed-point matrix may use. */
+#define ML_FIXED_MAX_FRAC 30
+
+/** @brief Fractional bits of softmax probabilities (1.0 saturates to 32767). */
+#define ML_FIXED_PROB_FRAC 15
+
+/**
+ * @brief Row-major 16-bit fixed-point matrix; x = data / 2^frac.
+ *
+ * Same layout rules as Matf32 (@ref stride 0 means cols).
+ */
+typedef struct {
+  u64 rows;
+  u64 cols;
+  i16* data;
+  u64 stride;
+  u8 frac;
+} Matq15;
+
+/** @brief Row-major 8-bit fixed-point matrix; x = data / 2^frac. */
+typedef struct {
+  u64 rows;
+  u64 cols;
+  i8* data;
+  u64 stride;
+  u8 frac;
+} Matq7;
+
+/**
+ * @brief Allocate a Q15 matrix with @p frac fractional bits (data uninitialized).
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p arena or @p dest is NULL or
+ *         @p frac exceeds ML_FIXED_MAX_FRAC.
+ * @return ML_OUT_OF_MEMORY if the arena cannot satisfy the allocation.
+ */
+ML_Status create_Matq15(ml_arena* arena, Matq15* dest, u64 rows, u64 cols, u8 frac);
+
+/** @brief Allocate a Q7 matrix; see create_Matq15(). */
+ML_Status create_Matq7(ml_arena* arena, Matq7* dest, u64 rows, u64 cols, u8 frac);
+
+/**
+ * @brief Most fractional bits that still represent +-@p absmax.
+ *
+ * @param absmax Largest magnitude the tensor must hold.
+ * @param type Storage width.
+ * @return frac in [0, ML_FIXED_MAX_FRAC]. Magnitudes too large even for
+ *         frac = 0 will saturate.
+ */
+u8 ml_fixed_frac_for(f32 absmax, ML_FixedType type);
+
+/**
+ * @brief Convert to fixed point: dest = sat(round(op(src) * 2^dest->frac)).
+ *
+ * @param dest Preallocated output, shape of op(src); its frac is used.
+ * @param src Matrix to convert.
+ * @param src_t ML_TRANS to convert the transpose of @p src.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes mismatch.
+ */
+ML_Status Mat_to_Matq15(Matq15* dest, const Matf32 src, ML_Transpose src_t);
+
+/** @brief Q7 counterpart of Mat_to_Matq15(). */
+ML_Status Mat_to_Matq7(Matq7* dest, const Matf32 src, ML_Transpose src_t);
+
+/**
+ * @brief Convert back to f32: dest = src.data / 2^src.frac.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes mismatch.
+ */
+ML_Status Matq15_to_Mat(Matf32* dest, const Matq15 src);
+
+/**
+ * @brief Integer GEMM with Q7 weights: out = lhs * rhs_t^T (+ bias).
+ *
+ * @p lhs is (M x K) and @p rhs_t is (N x K), so both are read along K
+ * with unit stride. Products accumulate exactly; the sum is rounded once
+ * from (lhs.frac + rhs_t.frac) fractional bits to out->frac, the bias is
+ * added and the result saturated to 16 bits.
+ *
+ * @param out Preallocated (M x N) output; its frac selects the format.
+ * @param lhs (M x K) activations.
+ * @param rhs_t (N x K) weights, stored transposed.
+ * @param bias Optional (1 x N) bias with frac equal to out->frac, or NULL.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL, shapes mismatch or
+ *         @p bias has a different frac than @p out.
+ */
+ML_Status Matq15_Mul_Matq7_trans_into(Matq15* out, const Matq15 lhs,
+                                      const Matq7 rhs_t, const Matq15* bias);
+
+/** @brief Q15-weight counterpart of Matq15_Mul_Matq7_trans_into(). */
+ML_Status Matq15_Mul_Matq15_trans_into(Matq15* out, const Matq15 lhs,
+                                       const Matq15 rhs_t, const Matq15* bias);
+
+/**
+ * @brief Row-wise softmax in integer arithmetic.
+ *
+ * exp is evaluated as 2^(x * log2 e) with a table of 2^(-j/256) and
+ * linear interpolation between entries; the normalisation is one integer
+ * division per element. Output has ML_FIXED_PROB_FRAC fractional bits
+ * (out->frac is set); the row sum is 1 to within a few units in the last
+ * place.
+ *
+ * @param out Preallocated output, same shape as @p in; may be @p in.
+ * @param in Logits.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL, shapes mismatch or
+ *         rows are empty.
+ */
+ML_Status Matq15_softmax_into(Matq15* out, const Matq15 in);
+
+/**
+ * @brief Index of the largest element of every row (first one on ties).
+ *
+ * @param in Matrix with at least one column.
+ * @param out_idx Array of in.rows indices.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or rows are empty.
+ */
+ML_Status Matq15_argmax_rows(const Matq15 in, u64* out_idx);
+
+#endif // ML_FIXED_H
@@ -0,0 +1,106 @@
+#ifndef ML_FUSE_H
+#define ML_FUSE_H
+
+#include "ml_error.h"
+#include "ml_half.h"
+#include "ml_primitives.h"
+
+/**
+ * @file ml_fuse.h
+ * @brief Fused elementwise / broadcast expression pipeline.
+ *
+ * A chain of elementwise and broadcast operations is described as an
+ * array of ML_FuseOp and executed one row at a time: the input row is
+ * loaded once, every op is applied to it while it is hot in cache, and it
+ * is written back once. Compared to calling the corresponding
+ * Mat_*_inplace primitives back to back this turns k sweeps over an N x C
+ * buffer into one.
+ *
+ * Softmax, for example, is:
+ * @code
+ * ML_FuseOp ops[] = {
+ *   { .kind = ML_FUSE_SUB_ROWMAX },
+ *   { .kind = ML_FUSE_EXP },
+ *   { .kind = ML_FUSE_DIV_ROWSUM },
+ * };
+ * Mat_fused_into(&P, Z, ops, 3);
+ * @endcode
+ */
+
+/** @brief Operation applied to the current row x of the pipeline. */
+typedef enum {
+  /** x[c] += operand[0,c]; operand is a (1 x C) row vector. */
+  ML_FUSE_ADD_ROWVEC,
+  /** x[c] -= operand[r,0]; operand is an (N x 1) column vector. */
+  ML_FUSE_SUB_COLVEC,
+  /** x[c] /= operand[r,0]; operand is an (N x 1) column vector, non-zero. */
+  ML_FUSE_DIV_COLVEC,
+  /** x[c] += operand[r,c]; operand is an (N x C) matrix. */
+  ML_FUSE_ADD_MAT,
+  /** x[c] -= operand[r,c]; operand is an (N x C) matrix. */
+  ML_FUSE_SUB_MAT,
+  /** x[c] *= scalar. */
+  ML_FUSE_SCALE,
+  /** x[c] += scalar. */
+  ML_FUSE_ADD_SCALAR,
+  /** x[c] = exp(x[c]). */
+  ML_FUSE_EXP,
+  /**
+   * m = max_c x[c]; x[c] -= m.
+   * If operand.data is set, m is also stored in operand[r,0] (N x 1).
+   */
+  ML_FUSE_SUB_ROWMAX,
+  /**
+   * s = sum_c x[c]; x[c] /= s (s must be non-zero).
+   * If operand.data is set, s is also stored in operand[r,0] (N x 1).
+   */
+  ML_FUSE_DIV_ROWSUM,
+} ML_FuseOpKind;
+
+/** @brief One step of a fused pipeline. */
+typedef struct {
+  ML_FuseOpKind kind;
+  /** Broadcast operand or optional per-row output, depending on @ref kind. */
+  Matf32 operand;
+  /** Scalar for ML_FUSE_SCALE / ML_FUSE_ADD_SCALAR. */
+  f32 scalar;
+} ML_FuseOp;
+
+/**
+ * @brief Run a fused pipeline: out = ops(in), one pass per row.
+ *
+ * All operand shapes are validated before any row is touched.
+ * @p out may be the same matrix as @p in (in-place), but must not
+ * otherwise overlap it, and operands must not overlap @p out.
+ *
+ * @param out Preallocated output, same shape as @p in.
+ * @param in Input matrix.
+ * @param ops Operations, applied in order.
+ * @param n_ops Number of operations (0 makes this a copy).
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL, shapes mismatch,
+ *         buffers overlap, an op kind is unknown, or a divisor is zero.
+ *         In the last case rows are processed in parallel, so any rows of
+ *         @p out may already have been written.
+ */
+ML_Status Mat_fused_into(Matf32* out, const Matf32 in,
+                         const ML_FuseOp* ops, u64 n_ops);
+
+/**
+ * @brief In-place form of Mat_fused_into(): target = ops(target).
+ */
+ML_Status Mat_fused_inplace(Matf32* target, const ML_FuseOp* ops, u64 n_ops);
+
+/**
+ * @brief Mat_fused_into() over a 16-bit input: out = ops(f32(in)).
+ *
+ * Each row is widened straight into @p out and the ops run on it there,
+ * so loading a half-precision batch (and, e.g., normalising it) is a
+ * single pass with no intermediate f32 copy. With n_ops == 0 this is
+ * Mat16_to_Mat().
+ */
+ML_Status Mat16_fused_into(Matf32* out, const Mat16 in,
+                           const ML_FuseOp* ops, u64 n_ops);
+
+#endif // ML_FUSE_H
@@ -0,0 +1,136 @@
+#ifndef ML_HALF_H
+#define ML_HALF_H
+
+#include "ml_error.h"
+#include "ml_alloc.h"
+#include "ml_primitives.h"
+
+/**
+ * @file ml_half.h
+ * @brief 16-bit float storage (IEEE f16 and bfloat16) with f32 compute.
+ *
+ * A Mat16 halves the memory of a Matf32 for data that does not need full
+ * precision at rest: trained weights, datasets and input batches. Values
+ * are widened to f32 inside the kernels that read them (GEMM packing, the
+ * fused row pipeline), so every product and sum still accumulates in f32
+ * and no f32 copy of the whole operand is ever materialised.
+ *
+ * f16 keeps 11 significant bits over a +-65504 range; bf16 keeps 8 bits
+ * over the full f32 range. Conversions from f32 round to nearest even.
+ *
+ * @code
+ * Mat16 Wh;
+ * create_Mat16(&arena, &Wh, D, C, ML_HALF_BF16);
+ * Mat_to_Mat16(&Wh, W);              // Wh = bf16(W)
+ * Mat_Mul_Mat16_into(&Z, X, Wh);     // Z = X * f32(Wh)
+ * @endcode
+ */
+
+/** @brief 16-bit float encodings. */
+typedef enum {
+  /** IEEE 754 binary16: 5 exponent bits, 10 mantissa bits. */
+  ML_HALF_F16,
+  /** bfloat16: the top half of an f32 (8 exponent bits, 7 mantissa bits). */
+  ML_HALF_BF16,
+} ML_HalfFormat;
+
+/**
+ * @brief Row-major matrix of 16-bit floats with a leading dimension.
+ *
+ * Same layout rules as Matf32: @ref stride is the distance between rows in
+ * elements (0 means cols).
+ */
+typedef struct {
+  u64 rows;
+  u64 cols;
+  u16* data;
+  u64 stride;
+  ML_HalfFormat format;
+} Mat16;
+
+/**
+ * @brief Leading dimension of @p m in elements.
+ */
+static inline u64 Mat16_ld(const Mat16 m) {
+  return m.stride ? m.stride : m.cols;
+}
+
+/**
+ * @brief Allocate a 16-bit matrix of shape (rows x cols).
+ *
+ * Data is uninitialized.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p arena or @p dest is NULL or
+ *         @p format is unknown.
+ * @return ML_OUT_OF_MEMORY if the arena cannot satisfy the allocation.
+ */
+ML_Status create_Mat16(ml_arena* arena, Mat16* dest, u64 rows, u64 cols,
+                       ML_HalfFormat format);
+
+/**
+ * @brief Narrow an f32 matrix: dest = half(src), round to nearest even.
+ *
+ * Values beyond the format's range become infinity.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes mismatch.
+ */
+ML_Status Mat_to_Mat16(Mat16* dest, const Matf32 src);
+
+/**
+ * @brief Widen to f32: dest = f32(src) (exact).
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes mismatch.
+ */
+ML_Status Mat16_to_Mat(Matf32* dest, const Mat16 src);
+
+/**
+ * @brief out = lhs * f32(rhs), f32 activations times 16-bit weights.
+ *
+ * @param out Preallocated (M x N) output; must not alias the operands.
+ * @param lhs (M x K) f32 operand.
+ * @param rhs (K x N) 16-bit operand.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes mismatch.
+ */
+ML_Status Mat_Mul_Mat16_into(Matf32* out, const Matf32 lhs, const Mat16 rhs);
+
+/**
+ * @brief out = f32(lhs) * rhs, 16-bit batch times f32 weights.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes mismatch.
+ */
+ML_Status Mat16_Mul_Mat_into(Matf32* out, const Mat16 lhs, const Matf32 rhs);
+
+/**
+ * @brief out = f32(lhs) * f32(rhs), both operands 16-bit (formats may differ).
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes mismatch.
+ */
+ML_Status Mat16_Mul_Mat16_into(Matf32* out, const Mat16 lhs, const Mat16 rhs);
+
+/**
+ * @brief Mat_Mul_Mat16_into() with a fused epilogue (see ML_Epilogue):
+ *        out = act(scale * lhs * f32(rhs) + bias).
+ *
+ * @param ep Epilogue, or NULL for a plain product.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT as for Mat_Mul_Mat16_into(), or if the
+ *         epilogue is invalid (see Mat_Mul_Mat_fused_into()).
+ */
+ML_Status Mat_Mul_Mat16_fused_into(Matf32* out, const Matf32 lhs, const Mat16 rhs,
+                                   const ML_Epilogue* ep);
+
+/**
+ * @brief Mat16_Mul_Mat16_into() with a fused epilogue (see ML_Epilogue).
+ */
+ML_Status Mat16_Mul_Mat16_fused_into(Matf32* out, const Mat16 lhs, const Mat16 rhs,
+                                     const ML_Epilogue* ep);
+
+#endif // ML_HALF_H
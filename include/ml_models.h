@@ -5,11 +5,17 @@
 #include "ml_rng.h"
 typedef struct {
   // Fills X (N×D) and Y (N×C) for the next batch.
+  // Instead of copying, a provider may repoint X and Y at views of a
+  // larger dataset (e.g. Mat_view_rows); the shapes must stay N×D / N×C.
   // Return ML_OK if a batch was produced.
   // Return ML_DONE (or similar) when the epoch is finished.
   // Return other errors on failure.
   ML_Status (*next_batch)(void* ctx, Matf32* X, Matf32* Y);
   void* ctx;
+  // Sparse-label form used by train_*_labels: fills X and N class
+  // indices in (*labels)[0..N), or repoints *labels at the dataset's own
+  // label array. Same return codes as next_batch.
+  ML_Status (*next_batch_labels)(void* ctx, Matf32* X, u32** labels);
 } ML_BatchProvider;
 
 typedef struct {
@@ -26,6 +32,15 @@ typedef struct {
   FillStrategy w_init;
   FillStrategy b_init;
   ML_Rng* rng;
+  // Pack the operator workspaces (Z, softmax buffers, dZ, dW, db) into
+  // one pool by liveness (see ml_plan.h); buffers that are never live at
+  // the same time share memory. Intermediates are then only valid while
+  // in use: after train_step, Z/P/dZ may hold another buffer's data.
+  // create_config_SoftmaxRegression sets 0.
+  u8 plan_workspace;
+  // Forward only: no gradient buffers and no SoftmaxCrossEntropy
+  // workspace, so train_step_* fails. create_config_SoftmaxRegression sets 0.
+  u8 inference_only;
 } SoftmaxRegressionConfig;
 
 ML_Status create_config_SoftmaxRegression(SoftmaxRegressionConfig* conf,
@@ -37,25 +52,44 @@ ML_Status create_config_SoftmaxRegression(SoftmaxRegressionConfig* conf,
 typedef struct {
   SoftmaxRegressionConfig conf;
   Linear lin;
-  Softmax sm;
-  CrossEntropy ce;
+  Softmax sm;             // inference
+  SoftmaxCrossEntropy ce; // training: loss and dZ from the logits
 } SoftmaxRegression;
 
 ML_Status create_model_SoftmaxRegression(ml_arena* arena,
                                         SoftmaxRegression* m,
                                         SoftmaxRegressionConfig conf);
 
+// Arena bytes create_model_SoftmaxRegression needs for conf, alignment
+// padding included, from a dry run on a counting arena (nothing is
+// allocated or initialised). Honours plan_workspace and inference_only.
+ML_Status footprint_SoftmaxRegression(SoftmaxRegressionConfig conf, u64* out_bytes);
+
+// Largest batch size N (keeping conf's D, C and flags) whose footprint
+// fits in bytes, e.g. get_freemem_ml_arena_bytes(&arena). Returns
+// ML_OUT_OF_MEMORY if not even N = 1 fits.
+ML_Status max_batch_SoftmaxRegression(SoftmaxRegressionConfig conf, u64 bytes, u64* out_N);
+
 ML_Status infer_SoftmaxRegression(SoftmaxRegression* m,
                                  const Matf32 X,
                                  Matf32* outP);
 
-// One SGD step: Y must be (N×C) one-hot, returns loss
+// One SGD step: Y must be (N×C) one-hot (or soft labels), returns loss.
+// Softmax probabilities are not kept: m->sm is only written by infer.
 ML_Status train_step_SoftmaxRegression(SoftmaxRegression* m,
                                       const Matf32 X,
                                       const Matf32 Y,
                                       f32 lr,
                                       f32* out_loss);
 
+// One SGD step with N class indices in [0, C) instead of a one-hot Y:
+// the loss costs O(N) and the gradient is a scatter into dZ
+ML_Status train_step_SoftmaxRegression_labels(SoftmaxRegression* m,
+                                             const Matf32 X,
+                                             const u32* labels,
+                                             f32 lr,
+                                             f32* out_loss);
+
 // Runs a standard loop over epochs, consuming batches from provider.
 // Xbuf and Ybuf must be preallocated (N×D) and (N×C).
 ML_Status train_SoftmaxRegression(SoftmaxRegression* m,
@@ -64,5 +98,161 @@ ML_Status train_SoftmaxRegression(SoftmaxRegression* m,
                                  Matf32* Xbuf,
                                  Matf32* Ybuf,
                                  f32* out_last_loss);
+
+// Same loop over provider.next_batch_labels; label_buf must hold N entries
+ML_Status train_SoftmaxRegression_labels(SoftmaxRegression* m,
+                                        ML_BatchProvider provider,
+                                        ML_TrainConfig tconf,
+                                        Matf32* Xbuf,
+                                        u32* label_buf,
+                                        f32* out_last_loss);
+
+// ---- Multi-layer perceptron ----
+
+// Most hidden layers an MLP can have
+#ifndef ML_MLP_MAX_HIDDEN
+#define ML_MLP_MAX_HIDDEN 4
+#endif
+
+typedef struct {
+  u64 N; //Batch size (fixed)
+  u64 D; //input dim (fixed)
+  u64 C; //number of classes (fixed)
+  u64 n_hidden;                   // hidden layers, 1..ML_MLP_MAX_HIDDEN
+  u64 hidden[ML_MLP_MAX_HIDDEN];  // width of each hidden layer
+  ML_Activation act;              // hidden activation
+  // Leaky ReLU slope, >= 0. create_config_MLP sets 0.01.
+  f32 alpha;
+  FillStrategy w_init;
+  FillStrategy b_init;
+  ML_Rng* rng;
+  // As for SoftmaxRegressionConfig: hidden activations, gradients and
+  // operator workspaces are packed into one pool by liveness, so layers
+  // share buffers wherever their lifetimes allow. create_config_MLP sets 1.
+  u8 plan_workspace;
+  // Forward only: no gradient buffers, train_step_* fails.
+  // create_config_MLP sets 0.
+  u8 inference_only;
+} MLPConfig;
+
+// hidden holds n_hidden layer widths
+ML_Status create_config_MLP(MLPConfig* conf,
+                            u64 N, u64 D, u64 C,
+                            const u64* hidden, u64 n_hidden,
+                            ML_Activation act,
+                            ML_Rng* rng,
+                            FillStrategy w_init,
+                            FillStrategy b_init);
+
+// Linear layers with the bias and activation fused into their GEMMs, then
+// softmax (inference) or fused softmax + cross-entropy (training).
+// GELU's derivative needs the pre-activation, so when training with GELU
+// the hidden Linears keep it in Z and a separate Activation follows.
+typedef struct {
+  MLPConfig conf;
+  Linear lin[ML_MLP_MAX_HIDDEN + 1];  // hidden layers, then the output layer
+  Activation act[ML_MLP_MAX_HIDDEN];  // only used when the activation is not fused
+  u8 fused;
+  // Gradient wrt each hidden layer's output, turned in place into the
+  // gradient wrt its pre-activation
+  Matf32 dH[ML_MLP_MAX_HIDDEN];
+  Softmax sm;             // inference
+  SoftmaxCrossEntropy ce; // training: loss and dZ from the logits
+} MLP;
+
+ML_Status create_model_MLP(ml_arena* arena, MLP* m, MLPConfig conf);
+
+// Arena bytes create_model_MLP needs for conf, as footprint_SoftmaxRegression
+ML_Status footprint_MLP(MLPConfig conf, u64* out_bytes);
+
+// X: (N×D), outP: (N×C)
+ML_Status infer_MLP(MLP* m, const Matf32 X, Matf32* outP);
+
+// One SGD step over all layers, same contracts as the SoftmaxRegression
+// forms. Each layer is updated as soon as the gradient for the layer
+// below has been taken from its old weights.
+ML_Status train_step_MLP(MLP* m, const Matf32 X, const Matf32 Y, f32 lr, f32* out_loss);
+ML_Status train_step_MLP_labels(MLP* m, const Matf32 X, const u32* labels,
+                                f32 lr, f32* out_loss);
+
+ML_Status train_MLP(MLP* m,
+                    ML_BatchProvider provider,
+                    ML_TrainConfig tconf,
+                    Matf32* Xbuf,
+                    Matf32* Ybuf,
+                    f32* out_last_loss);
+ML_Status train_MLP_labels(MLP* m,
+                           ML_BatchProvider provider,
+                           ML_TrainConfig tconf,
+                           Matf32* Xbuf,
+                           u32* label_buf,
+                           f32* out_last_loss);
+
+// ---- Int8 inference ----
+
+typedef struct {
+  ML_QuantGranularity w_gran; // per tensor or per output channel
+  // Optional calibration inputs (any number of rows, D cols). When given,
+  // the input scale is fixed from their range; otherwise every batch is
+  // quantized with its own range.
+  const Matf32* calib_X;
+} SoftmaxRegressionI8Config;
+
+ML_Status create_config_SoftmaxRegressionI8(SoftmaxRegressionI8Config* conf,
+                                           ML_QuantGranularity w_gran,
+                                           const Matf32* calib_X);
+
+typedef struct {
+  SoftmaxRegressionConfig conf; // shapes of the source model
+  LinearI8 lin;
+  Softmax sm;
+} SoftmaxRegressionI8;
+
+// Converts a trained model; src is only read during the call
+ML_Status create_model_SoftmaxRegressionI8(ml_arena* arena,
+                                          SoftmaxRegressionI8* q,
+                                          const SoftmaxRegression* src,
+                                          SoftmaxRegressionI8Config conf);
+
+// Same contract as infer_SoftmaxRegression
+ML_Status infer_SoftmaxRegressionI8(SoftmaxRegressionI8* q,
+                                   const Matf32 X,
+                                   Matf32* outP);
+
+// ---- Fixed-point inference ----
+
+typedef struct {
+  ML_FixedType w_type; // Q7 or Q15 weights
+  // Calibration inputs (any number of rows, D cols). Their range picks
+  // the input format and, through a float forward pass, the logit format.
+  const Matf32* calib_X;
+} SoftmaxRegressionQConfig;
+
+ML_Status create_config_SoftmaxRegressionQ(SoftmaxRegressionQConfig* conf,
+                                          ML_FixedType w_type,
+                                          const Matf32* calib_X);
+
+typedef struct {
+  SoftmaxRegressionConfig conf; // shapes of the source model
+  LinearQ lin;  // softmax writes straight into the caller's outP
+} SoftmaxRegressionQ;
+
+// Converts a trained model (uses floats once); src is only read during
+// the call. Inputs must then be given with q->lin.x_frac fractional bits.
+ML_Status create_model_SoftmaxRegressionQ(ml_arena* arena,
+                                         SoftmaxRegressionQ* q,
+                                         const SoftmaxRegression* src,
+                                         SoftmaxRegressionQConfig conf);
+
+// Integer-only. X: (N×D) with frac == q->lin.x_frac, outP: (N×C), Q15
+ML_Status infer_SoftmaxRegressionQ(SoftmaxRegressionQ* q,
+                                  const Matq15 X,
+                                  Matq15* outP);
+
+// Integer-only class prediction (argmax of the logits, softmax skipped).
+// out_class must hold N entries.
+ML_Status predict_SoftmaxRegressionQ(SoftmaxRegressionQ* q,
+                                    const Matq15 X,
+                                    u64* out_class);
 #endif //ML_MODELS_H
 
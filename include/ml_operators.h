@@ -2,7 +2,11 @@
 #define ML_OPERATORS_H
 
 #include "ml_error.h"
+#include "ml_fixed.h"
+#include "ml_half.h"
 #include "ml_primitives.h"
+#include "ml_quant.h"
+#include "ml_sparse.h"
 #include "ml_rng.h"
 
 typedef enum {
@@ -18,6 +22,25 @@ typedef struct {
   FillStrategy fillW_strat;
   FillStrategy fillb_strat;
   ML_Rng* rng;
+  // Inputs only ever come as CSR batches: skip the dense (N×D) X buffer.
+  // create_config_Linear sets 0; set it afterwards to opt in.
+  u8 sparse_input;
+  // Only allocate W and b; X, Z, dW and db get their shapes but no storage
+  // so the caller can bind them (see ml_plan.h). create_config_Linear sets 0.
+  u8 external_workspace;
+  // Forward only: dW and db are never allocated and backward fails.
+  // create_config_Linear sets 0.
+  u8 inference_only;
+  // Never copy dense inputs: skip the (N×D) X buffer and have
+  // execute_op_Linear_forward borrow the caller's matrix (see
+  // execute_op_Linear_forward_borrow). create_config_Linear sets 0.
+  u8 borrow_input;
+  // Activation fused into the forward GEMM's write-back, so Z holds
+  // act(X*W + b). Backward still takes the gradient wrt X*W + b; for all
+  // but GELU it can be formed in place from Z (Mat_act_grad_into).
+  // create_config_Linear sets ML_ACT_NONE with alpha 0.01.
+  ML_Activation act;
+  f32 alpha;
 } LinearConfig;
 
 ML_Status create_config_Linear(LinearConfig* conf,u64 inrows, u64 incols,
@@ -29,21 +52,93 @@ typedef struct {
   Matf32 X;
   Matf32 b;
 
+  // Sparse input bound by the last forward_sparse (not owned: the CSR
+  // must stay alive until backward). Empty after a dense forward.
+  MatCSR Xs;
+  // Dense input borrowed by the last forward_borrow, same rules as Xs.
+  // Empty after any other forward.
+  Matf32 Xb;
+
   Matf32 dW;
   Matf32 db;
-  Matf32 X_T;
 
   Matf32 Z;
+
+  ML_Activation act;  // fused into the forward, see LinearConfig
+  f32 alpha;
 } Linear;
 
 ML_Status create_op_Linear(ml_arena* arena,Linear* lin,LinearConfig conf);
+// Copies in into X for backward; borrows it instead (as below) when X
+// has no storage, e.g. with borrow_input
 ML_Status execute_op_Linear_forward(Linear* lin,const Matf32 in);
+// Zero-copy forward: Z = in*W + b straight from the caller's matrix, which
+// is only referenced (lin->Xb) and must stay alive and unchanged until
+// backward. Strided views are fine.
+ML_Status execute_op_Linear_forward_borrow(Linear* lin, const Matf32 in);
+// dW = X^T*dZ and db = colsum(dZ), dZ being the gradient wrt X*W + b
 ML_Status execute_op_Linear_backward(Linear* lin, const Matf32 dZ);
+// Gradient wrt the input for the layer below: dX = dZ*W^T (N×D), into a
+// caller-owned matrix. Reads W, so it must run before the SGD step.
+ML_Status execute_op_Linear_backward_input(Linear* lin, const Matf32 dZ, Matf32* dX);
+// Forward from a 16-bit batch: widened straight into X, then as above
+ML_Status execute_op_Linear_forward_half(Linear* lin, const Mat16 in);
+// Forward from a CSR batch (N×D): Z = in*W + b in O(nnz*C). Backward then
+// computes dW = in^T*dZ from the same CSR, also in O(nnz*C).
+ML_Status execute_op_Linear_forward_sparse(Linear* lin, const MatCSR in);
 ML_Status execute_op_Linear_sgd_step(Linear* lin, f32 lr);
 
+// Int8 inference-only copy of a trained Linear.
+// Weights are quantized once (per tensor or per output channel); the input
+// is quantized per call, with a fixed scale if one was calibrated or from
+// the batch's own range otherwise. Bias and output stay f32.
+typedef struct {
+  const Linear* src;           // trained layer to convert (read once)
+  ML_QuantGranularity w_gran;
+  f32 x_scale;                 // fixed input scale, 0 = per batch
+} LinearI8Config;
+
+ML_Status create_config_LinearI8(LinearI8Config* conf, const Linear* src,
+                                 ML_QuantGranularity w_gran, f32 x_scale);
+
+typedef struct {
+  Mati8 WT;   // (C x D) quantized W^T: one row per output channel
+  Matf32 b;   // (1 x C)
+  Mati8 Xq;   // (N x D) quantized input
+  Matf32 Z;   // (N x C)
+  f32 x_scale;
+} LinearI8;
+
+// Only reads conf.src; the f32 layer (and its arena) may be dropped after
+ML_Status create_op_LinearI8(ml_arena* arena, LinearI8* qlin, LinearI8Config conf);
+ML_Status execute_op_LinearI8_forward(LinearI8* qlin, const Matf32 in);
+
+// Inference-only copy of a trained Linear with W stored as f16 or bf16.
+// W is widened inside the GEMM, so compute and the bias stay f32.
+typedef struct {
+  const Linear* src;     // trained layer to convert (read once)
+  ML_HalfFormat format;
+} Linear16Config;
+
+ML_Status create_config_Linear16(Linear16Config* conf, const Linear* src,
+                                 ML_HalfFormat format);
+
+typedef struct {
+  Mat16 W;    // (D x C)
+  Matf32 b;   // (1 x C)
+  Matf32 Z;   // (N x C)
+} Linear16;
+
+// Only reads conf.src; the f32 layer (and its arena) may be dropped after
+ML_Status create_op_Linear16(ml_arena* arena, Linear16* hlin, Linear16Config conf);
+ML_Status execute_op_Linear16_forward(Linear16* hlin, const Matf32 in);
+ML_Status execute_op_Linear16_forward_half(Linear16* hlin, const Mat16 in);
+
 typedef struct { 
   u64 in_rows;
   u64 in_cols;
+  // Leave rowmax, rowsum and P unallocated for the caller to bind
+  u8 external_workspace;
 } SoftmaxConfig;
 
 ML_Status create_config_Softmax(SoftmaxConfig* conf,u64 inrows,u64 incols);
@@ -61,6 +156,8 @@ ML_Status execute_op_Softmax_forward(Softmax* sm, const Matf32 Z);
 typedef struct {
   u64 in_rows;  // N
   u64 in_cols;  // C
+  // Leave dZ unallocated for the caller to bind
+  u8 external_workspace;
 } CEConfig;
 
 ML_Status create_config_CrossEntropy(CEConfig *conf, u64 inrows, u64 incols);
@@ -82,4 +179,273 @@ ML_Status execute_op_CrossEntropy_forward(CrossEntropy *ce, const Matf32 P,
 ML_Status execute_op_CrossEntropy_backward(CrossEntropy *ce, const Matf32 P,
                                            const Matf32 Y);
 
+// Sparse-label forms: labels holds N class indices in [0, C) in place of a
+// one-hot Y. Forward reads one probability per row, O(N); backward writes
+// dZ = P/N and subtracts 1/N at each label.
+ML_Status execute_op_CrossEntropy_forward_labels(CrossEntropy* ce, const Matf32 P,
+                                                 const u32* labels);
+ML_Status execute_op_CrossEntropy_backward_labels(CrossEntropy* ce, const Matf32 P,
+                                                  const u32* labels);
+
+// Softmax and cross-entropy fused for training: from the logits Z, the
+// loss and dZ = (softmax(Z) - Y)/N in one row-local sweep, with the loss
+// taken as log-sum-exp(z) - z rather than -log(max(p, eps)). P, rowmax
+// and rowsum are never materialised.
+typedef struct {
+  u64 in_rows;  // N
+  u64 in_cols;  // C
+  // Leave rowloss and dZ unallocated for the caller to bind
+  u8 external_workspace;
+} SoftmaxCEConfig;
+
+ML_Status create_config_SoftmaxCrossEntropy(SoftmaxCEConfig* conf, u64 inrows, u64 incols);
+
+typedef struct {
+  f32 loss;        // last loss (mean)
+
+  Matf32 rowloss;  // (N x 1) per-sample loss, summed in order for the mean
+  Matf32 dZ;       // (N x C) gradient wrt logits: (softmax(Z) - Y)/N
+} SoftmaxCrossEntropy;
+
+ML_Status create_op_SoftmaxCrossEntropy(ml_arena* arena, SoftmaxCrossEntropy* sce,
+                                        SoftmaxCEConfig conf);
+
+// Computes sce->loss and sce->dZ from logits Z and labels Y (rows summing
+// to 1, one-hot or soft). dZ and rowloss may not overlap Z or Y.
+ML_Status execute_op_SoftmaxCrossEntropy(SoftmaxCrossEntropy* sce, const Matf32 Z,
+                                         const Matf32 Y);
+// Same with N class indices in [0, C) for labels; Y is never formed
+ML_Status execute_op_SoftmaxCrossEntropy_labels(SoftmaxCrossEntropy* sce, const Matf32 Z,
+                                                const u32* labels);
+
+// Elementwise activation (ReLU, leaky ReLU, sigmoid, tanh, GELU).
+// Forward A = act(X); backward dX = dA * act'(X), with the derivative read
+// from A, or for GELU from the input X, which is then only referenced
+// (op->Xb) and must stay alive and unchanged until backward.
+typedef struct {
+  u64 in_rows;  // N
+  u64 in_cols;  // D
+  ML_Activation act;
+  // Negative slope for ML_ACT_LEAKY_RELU, >= 0. create_config_Activation
+  // sets 0.01.
+  f32 alpha;
+  // Leave A and dX unallocated for the caller to bind
+  u8 external_workspace;
+  // Backward only ever runs in place on the incoming gradient (see
+  // execute_op_Activation_backward_inplace): skip dX.
+  // create_config_Activation sets 0.
+  u8 inplace_backward;
+} ActivationConfig;
+
+ML_Status create_config_Activation(ActivationConfig* conf, u64 inrows, u64 incols,
+                                   ML_Activation act);
+
+typedef struct {
+  ML_Activation act;
+  f32 alpha;
+
+  Matf32 Xb;  // input of the last forward (not owned)
+  Matf32 A;   // (N x D) act(X)
+  Matf32 dX;  // (N x D) gradient wrt X
+} Activation;
+
+ML_Status create_op_Activation(ml_arena* arena, Activation* op, ActivationConfig conf);
+
+// A = act(X). A may be bound to X's own storage to run in place, except
+// for GELU when backward follows, since that needs X itself.
+ML_Status execute_op_Activation_forward(Activation* op, const Matf32 X);
+// op->dX = dA * act'(X)
+ML_Status execute_op_Activation_backward(Activation* op, const Matf32 dA);
+// dA *= act'(X) in the caller's buffer, which then holds the gradient wrt
+// X; no dX storage is needed
+ML_Status execute_op_Activation_backward_inplace(Activation* op, Matf32* dA);
+
+// ---- 1-D convolution and pooling ----
+//
+// Windows of T steps of C channels are stored channels-last, one sample
+// per row: a batch is (N x T*C) with element (t, c) at column t*C + c.
+
+// Conv1D with "valid" padding: T_out = (T - dilation*(K-1) - 1)/stride + 1
+// and Y[o, co] = act(b[co] + sum_{k,ci} X[o*stride + k*dilation, ci] *
+// W[k*Cin + ci, co]). Kernels of up to 8 taps run a direct register-blocked
+// loop; longer ones an im2col + GEMM (im2col is a strided view of X when
+// dilation is 1).
+typedef struct {
+  u64 in_rows;   // N
+  u64 in_steps;  // T
+  u64 in_ch;     // Cin
+  u64 out_ch;    // Cout
+  u64 kernel;    // K, in taps
+  // create_config_Conv1D sets stride and dilation to 1
+  u64 stride;
+  u64 dilation;
+  FillStrategy fillW_strat;
+  FillStrategy fillb_strat;
+  ML_Rng* rng;
+  // Fused into the forward like LinearConfig::act. create_config_Conv1D
+  // sets ML_ACT_NONE with alpha 0.01.
+  ML_Activation act;
+  f32 alpha;
+  // Only allocate W and b; Y, dW, db, dX and the cols / dWn scratch get
+  // their shapes but no storage. create_config_Conv1D sets 0.
+  u8 external_workspace;
+  // Forward only: no gradients or backward scratch. create_config_Conv1D
+  // sets 0.
+  u8 inference_only;
+  // First layer of a network: backward skips dX. create_config_Conv1D
+  // sets 0.
+  u8 no_input_grad;
+} Conv1DConfig;
+
+ML_Status create_config_Conv1D(Conv1DConfig* conf, u64 inrows, u64 insteps,
+                               u64 inch, u64 outch, u64 kernel, ML_Rng* rng,
+                               FillStrategy w_strat, FillStrategy b_strat);
+
+typedef struct {
+  u64 in_steps;
+  u64 in_ch;
+  u64 out_steps;
+  u64 out_ch;
+  u64 kernel;
+  u64 stride;
+  u64 dilation;
+  ML_Activation act;
+  f32 alpha;
+
+  Matf32 W;   // (K*Cin x Cout), row k*Cin + ci is tap k of channel ci
+  Matf32 b;   // (1 x Cout)
+  Matf32 Xb;  // input of the last forward (not owned)
+  Matf32 Y;   // (N x T_out*Cout)
+
+  Matf32 dW;
+  Matf32 db;
+  Matf32 dX;  // (N x T*Cin); no storage with no_input_grad
+
+  // GEMM-path scratch: cols (T_out x K*Cin) holds unfolded patches and
+  // their gradients, dWn (K*Cin x Cout) one sample's dW. Empty when the
+  // configuration never needs them.
+  Matf32 cols;
+  Matf32 dWn;
+} Conv1D;
+
+ML_Status create_op_Conv1D(ml_arena* arena, Conv1D* conv, Conv1DConfig conf);
+// Y = act(conv(X, W) + b). X is only referenced (conv->Xb) and must stay
+// alive and unchanged until backward; strided views are fine, as long as
+// they do not overlap Y.
+ML_Status execute_op_Conv1D_forward(Conv1D* conv, const Matf32 X);
+// dW, db and (unless no_input_grad) dX from dY, the gradient wrt the
+// pre-activation output. dX may not overlap dY.
+ML_Status execute_op_Conv1D_backward(Conv1D* conv, const Matf32 dY);
+ML_Status execute_op_Conv1D_sgd_step(Conv1D* conv, f32 lr);
+
+// Max over windows of `pool` steps, per channel. The winning step of each
+// output is kept for backward, which routes dY back to it.
+typedef struct {
+  u64 in_rows;   // N
+  u64 in_steps;  // T
+  u64 channels;  // C
+  u64 pool;
+  // create_config_MaxPool1D sets stride = pool (disjoint windows)
+  u64 stride;
+  // Leave Y and dX unallocated for the caller to bind; idx is always
+  // allocated here. create_config_MaxPool1D sets 0.
+  u8 external_workspace;
+  // Forward only: no idx or dX. create_config_MaxPool1D sets 0.
+  u8 inference_only;
+} MaxPool1DConfig;
+
+ML_Status create_config_MaxPool1D(MaxPool1DConfig* conf, u64 inrows, u64 insteps,
+                                  u64 channels, u64 pool);
+
+typedef struct {
+  u64 in_steps;
+  u64 channels;
+  u64 out_steps;  // (T - pool)/stride + 1
+  u64 pool;
+  u64 stride;
+
+  u32* idx;   // (N x T_out*C) winning input step of each output
+  Matf32 Y;   // (N x T_out*C)
+  Matf32 dX;  // (N x T*C)
+} MaxPool1D;
+
+ML_Status create_op_MaxPool1D(ml_arena* arena, MaxPool1D* mp, MaxPool1DConfig conf);
+// The output (Y forward, dX backward) may not overlap the input
+ML_Status execute_op_MaxPool1D_forward(MaxPool1D* mp, const Matf32 X);
+ML_Status execute_op_MaxPool1D_backward(MaxPool1D* mp, const Matf32 dY);
+
+// Mean over all T steps per channel: (N x T*C) -> (N x C), the usual
+// bridge from a convolutional stack to a Linear classifier.
+typedef struct {
+  u64 in_rows;   // N
+  u64 in_steps;  // T
+  u64 channels;  // C
+  // Leave Y and dX unallocated for the caller to bind.
+  // create_config_GlobalAvgPool sets 0.
+  u8 external_workspace;
+  // Forward only: no dX. create_config_GlobalAvgPool sets 0.
+  u8 inference_only;
+} GlobalAvgPoolConfig;
+
+ML_Status create_config_GlobalAvgPool(GlobalAvgPoolConfig* conf, u64 inrows,
+                                      u64 insteps, u64 channels);
+
+typedef struct {
+  u64 in_steps;
+  u64 channels;
+
+  Matf32 Y;   // (N x C)
+  Matf32 dX;  // (N x T*C)
+} GlobalAvgPool;
+
+ML_Status create_op_GlobalAvgPool(ml_arena* arena, GlobalAvgPool* gap,
+                                  GlobalAvgPoolConfig conf);
+// The output (Y forward, dX backward) may not overlap the input
+ML_Status execute_op_GlobalAvgPool_forward(GlobalAvgPool* gap, const Matf32 X);
+// dX[t, c] = dY[c] / T
+ML_Status execute_op_GlobalAvgPool_backward(GlobalAvgPool* gap, const Matf32 dY);
+
+// ---- Fixed point (integer-only inference) ----
+
+// Fixed-point copy of a trained Linear: Q15 activations, Q7 or Q15
+// weights. W's format is picked from its range; x_frac / z_frac are the
+// input and output formats (see ml_fixed_frac_for).
+typedef struct {
+  const Linear* src;     // trained layer to convert (read once)
+  ML_FixedType w_type;
+  u8 x_frac;
+  u8 z_frac;
+} LinearQConfig;
+
+ML_Status create_config_LinearQ(LinearQConfig* conf, const Linear* src,
+                                ML_FixedType w_type, u8 x_frac, u8 z_frac);
+
+typedef struct {
+  ML_FixedType w_type;
+  Matq7 WT7;    // (C x D) W^T, when w_type == ML_FIXED_Q7
+  Matq15 WT15;  // (C x D) W^T, when w_type == ML_FIXED_Q15
+  Matq15 b;     // (1 x C), z_frac
+  Matq15 Z;     // (N x C), z_frac
+  u8 x_frac;
+} LinearQ;
+
+// Only reads conf.src; the f32 layer (and its arena) may be dropped after
+ML_Status create_op_LinearQ(ml_arena* arena, LinearQ* qlin, LinearQConfig conf);
+// in must be (N x D) with in.frac == x_frac
+ML_Status execute_op_LinearQ_forward(LinearQ* qlin, const Matq15 in);
+
+typedef struct {
+  u64 in_rows;
+  u64 in_cols;
+} SoftmaxQConfig;
+
+ML_Status create_config_SoftmaxQ(SoftmaxQConfig* conf, u64 inrows, u64 incols);
+
+typedef struct {
+  Matq15 P;   // (N x C), ML_FIXED_PROB_FRAC
+} SoftmaxQ;
+
+ML_Status create_op_SoftmaxQ(ml_arena* arena, SoftmaxQ* sm, SoftmaxQConfig conf);
+ML_Status execute_op_SoftmaxQ_forward(SoftmaxQ* sm, const Matq15 Z);
+
 #endif //MK_OPERATORS_H
@@ -0,0 +1,97 @@
+#ifndef ML_PLAN_H
+#define ML_PLAN_H
+
+#include "ml_error.h"
+#include "ml_alloc.h"
+#include "ml_primitives.h"
+
+/**
+ * @file ml_plan.h
+ * @brief Static liveness planning for operator workspaces.
+ *
+ * A model runs its operators in a fixed order (its schedule). Each
+ * workspace matrix is written at some step and last read at a later one;
+ * outside that range its storage is dead. The planner takes those live
+ * ranges and packs the buffers into one pool so that buffers that are
+ * never live at the same step share bytes. The pool is then allocated
+ * once from the arena and every descriptor is pointed into it.
+ *
+ * Live ranges are inclusive and measured in schedule steps. Two buffers
+ * whose ranges touch at a step (one read, one written by the same
+ * operator) are kept apart, so no operator sees its input and output
+ * alias.
+ *
+ * @code
+ * ML_PlanBuffer bufs[] = {
+ *   { .mat = &lin.Z, .first = 0, .last = 1 },
+ *   { .mat = &ce.dZ, .first = 3, .last = 4 },
+ * };
+ * u64 bytes = 0;
+ * plan_buffers(bufs, 2, &bytes);               // Z and dZ share offset 0
+ * bind_plan_buffers(&arena, bufs, 2, bytes);
+ * @endcode
+ */
+
+/**
+ * @brief Alignment of every planned buffer and of the pool, in bytes.
+ */
+#ifndef ML_PLAN_ALIGN
+#define ML_PLAN_ALIGN ARENA_CACHE_LINE
+#endif
+
+/** @brief Most buffers one plan_buffers() call accepts. */
+#ifndef ML_PLAN_MAX_BUFFERS
+#define ML_PLAN_MAX_BUFFERS 64
+#endif
+
+/**
+ * @brief One workspace buffer to place.
+ *
+ * @ref mat must have its rows and cols set; its data pointer and stride
+ * are filled in by bind_plan_buffers().
+ */
+typedef struct {
+  /** Descriptor to bind into the pool. */
+  Matf32* mat;
+  /** First schedule step at which the buffer is live (written). */
+  u32 first;
+  /** Last schedule step at which the buffer is live (read). */
+  u32 last;
+  /** Byte offset in the pool, set by plan_buffers(). */
+  u64 offset;
+} ML_PlanBuffer;
+
+/**
+ * @brief Assign pool offsets so that buffers with overlapping live ranges
+ *        never overlap in memory.
+ *
+ * Buffers are placed largest first, each at the lowest aligned offset
+ * that clears every already placed buffer it is live together with.
+ *
+ * @param bufs Buffers to place; their @ref ML_PlanBuffer::offset is written.
+ * @param n Number of buffers.
+ * @param out_bytes Receives the pool size needed.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p out_bytes is NULL, @p bufs is NULL with
+ *         @p n > 0, @p n exceeds ML_PLAN_MAX_BUFFERS, a descriptor is NULL
+ *         or a range has first > last.
+ */
+ML_Status plan_buffers(ML_PlanBuffer* bufs, u64 n, u64* out_bytes);
+
+/**
+ * @brief Allocate a pool of @p bytes and point every buffer into it.
+ *
+ * @param arena Arena to allocate the pool from (tagged "plan").
+ * @param bufs Buffers placed by plan_buffers().
+ * @param n Number of buffers.
+ * @param bytes Pool size returned by plan_buffers().
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if a pointer is NULL or a buffer does not
+ *         fit in @p bytes.
+ * @return ML_OUT_OF_MEMORY if the arena cannot hold the pool.
+ */
+ML_Status bind_plan_buffers(ml_arena* arena, ML_PlanBuffer* bufs, u64 n, u64 bytes);
+
+#endif // ML_PLAN_H
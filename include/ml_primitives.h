@@ -4,11 +4,15 @@
 #include "ml_error.h"
 #include "ml_alloc.h"
 
+#include <assert.h>
+
 /**
  * @file ml_primitives.h
  * @brief Dense f32 matrix primitives used by the ML operators.
  *
- * Matrices are dense, row-major, contiguous buffers of 32-bit floats.
+ * Matrices are dense, row-major buffers of 32-bit floats. Rows may be
+ * spaced further apart than their length (see Matf32::stride), which lets
+ * a Matf32 be a zero-copy view of a sub-block of a larger matrix.
  *
  * Naming conventions used in this API:
  * - *_inplace: modifies the first matrix argument in-place.
@@ -19,10 +23,16 @@
  */
 
 /**
- * @brief Dense matrix of 32-bit floats.
+ * @brief Dense matrix of 32-bit floats, or a strided view into one.
  *
  * Storage is row-major:
- * element (r,c) is stored at data[r*cols + c].
+ * element (r,c) is stored at data[r*ld + c], where ld = Mat_ld() is the
+ * leading dimension (@ref stride, or cols when stride is 0).
+ *
+ * A view produced by Mat_view() and friends shares its parent's storage:
+ * @ref data already points at the view's first element (the offset is
+ * folded in) and @ref stride is the parent's leading dimension. Every
+ * primitive and operator accepts views wherever it accepts a matrix.
  *
  * @note This type does not own memory; it points into an arena allocation.
  */
@@ -31,10 +41,56 @@ typedef struct {
   u64 rows;
   /** Number of columns. */
   u64 cols;
-  /** Row-major contiguous storage (rows*cols elements). */
+  /** Row-major storage; row r starts at data + r*Mat_ld(). */
   f32* data;
+  /** Elements between the starts of consecutive rows (0 means cols). */
+  u64 stride;
 } Matf32;
 
+/**
+ * @brief Leading dimension of @p m (elements between row starts).
+ */
+static inline u64 Mat_ld(const Matf32 m) {
+  return m.stride ? m.stride : m.cols;
+}
+
+/**
+ * @brief Whether the rows of @p m are packed back to back in memory.
+ */
+static inline int Mat_is_contiguous(const Matf32 m) {
+  return m.rows <= 1 || Mat_ld(m) == m.cols;
+}
+
+/**
+ * @name Unchecked element access
+ *
+ * Inline accessors for hot loops. Unlike MatGet() / MatSet() they return no
+ * status: the pointer and bounds are only checked with assert(), so the
+ * checks disappear when NDEBUG is defined (release builds). Validate shapes
+ * once before the loop, then use these inside it.
+ * @{
+ */
+
+/** @brief Pointer to the first element of row @p row. */
+static inline f32* Mat_row_ptr(const Matf32 m, u64 row) {
+  assert(m.data && row < m.rows);
+  return m.data + row * Mat_ld(m);
+}
+
+/** @brief Read element (row, col). */
+static inline f32 Mat_at(const Matf32 m, u64 row, u64 col) {
+  assert(m.data && row < m.rows && col < m.cols);
+  return m.data[row * Mat_ld(m) + col];
+}
+
+/** @brief Write element (row, col). */
+static inline void Mat_put(Matf32* m, u64 row, u64 col, f32 val) {
+  assert(m && m->data && row < m->rows && col < m->cols);
+  m->data[row * Mat_ld(*m) + col] = val;
+}
+
+/** @} */
+
 /**
  * @brief Allocate a matrix of shape (rows x cols) in the given arena.
  *
@@ -52,6 +108,96 @@ typedef struct {
  */
 ML_Status create_Mat(ml_arena* arena, Matf32* dest, u64 rows, u64 cols);
 
+/**
+ * @brief Allocate a (rows x cols) matrix whose storage starts on an
+ *        @p align byte boundary.
+ *
+ * With @p pad_rows set the leading dimension is rounded up so that every
+ * row, not just the first, starts on an @p align boundary; the padding
+ * columns are never read or written by the primitives. Without it the
+ * matrix is packed exactly like create_Mat().
+ *
+ * @code
+ * Matf32 W;
+ * create_Mat_aligned(&arena, &W, 3, 10, ARENA_CACHE_LINE, 1);   // stride 16
+ * @endcode
+ *
+ * @param arena Arena used for allocation.
+ * @param dest Output matrix descriptor to initialize.
+ * @param rows Number of rows.
+ * @param cols Number of cols.
+ * @param align Alignment in bytes (power of two, see push_aligned_ml_arena()).
+ * @param pad_rows Nonzero to pad each row to a multiple of @p align bytes.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p arena or @p dest is NULL or @p align is
+ *         not a power of two.
+ * @return ML_OUT_OF_MEMORY if the arena cannot satisfy the allocation.
+ */
+ML_Status create_Mat_aligned(ml_arena* arena, Matf32* dest, u64 rows, u64 cols,
+                             u64 align, u8 pad_rows);
+
+/**
+ * @brief Create a zero-copy view of a sub-block of @p src.
+ *
+ * The view covers rows [row0, row0+rows) and columns [col0, col0+cols)
+ * of @p src and shares its storage; writes through the view are visible
+ * in @p src.
+ *
+ * @param view Output view descriptor.
+ * @param src Matrix (or view) to window into.
+ * @param row0 First row of the block.
+ * @param col0 First column of the block.
+ * @param rows Rows in the block.
+ * @param cols Columns in the block.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p view or src.data is NULL.
+ * @return ML_OUT_OF_BOUNDS if the block does not fit inside @p src.
+ */
+ML_Status Mat_view(Matf32* view, const Matf32 src,
+                   u64 row0, u64 col0, u64 rows, u64 cols);
+
+/**
+ * @brief View of @p rows consecutive rows of @p src starting at @p row0.
+ *
+ * Typical use is a mini-batch window into a dataset matrix:
+ * @code
+ * Matf32 Xb;
+ * Mat_view_rows(&Xb, dataset, batch * N, N);
+ * @endcode
+ *
+ * @return Same as Mat_view().
+ */
+ML_Status Mat_view_rows(Matf32* view, const Matf32 src, u64 row0, u64 rows);
+
+/**
+ * @brief View of @p cols consecutive columns of @p src starting at @p col0.
+ *
+ * @return Same as Mat_view().
+ */
+ML_Status Mat_view_cols(Matf32* view, const Matf32 src, u64 col0, u64 cols);
+
+/**
+ * @brief View a raw buffer as a (rows x cols) matrix.
+ *
+ * Element (r,c) is read from base[offset + r*stride + c]. This lets a
+ * model read rows of a large caller-owned buffer without copying.
+ *
+ * @param view Output view descriptor.
+ * @param base Start of the buffer.
+ * @param offset Offset, in elements, of the view's first element.
+ * @param rows Rows in the view.
+ * @param cols Columns in the view.
+ * @param stride Leading dimension in elements (0 means cols).
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p view or @p base is NULL, or
+ *         @p stride is non-zero and smaller than @p cols.
+ */
+ML_Status Mat_view_buffer(Matf32* view, f32* base, u64 offset,
+                          u64 rows, u64 cols, u64 stride);
+
 /**
  * @brief Fill an entire matrix with a scalar value.
  *
@@ -78,6 +224,8 @@ ML_Status MatFillRow(Matf32* target, u64 row, const f32* val);
 /**
  * @brief Read one element from a matrix.
  *
+ * Checked on every call; inside loops prefer Mat_at().
+ *
  * @param target Matrix to read from.
  * @param row Row index.
  * @param col Column index.
@@ -92,6 +240,8 @@ ML_Status MatGet(const Matf32 target, u64 row, u64 col, f32* val);
 /**
  * @brief Write one element to a matrix.
  *
+ * Checked on every call; inside loops prefer Mat_put().
+ *
  * @param target Matrix to write into.
  * @param row Row index.
  * @param col Column index.
@@ -158,15 +308,135 @@ ML_Status Mat_Mul_Mat(Matf32* out, ml_arena* arena, const Matf32 lhs, const Matf
  * - out is allocated with shape (lhs.rows x rhs.cols)
  * - lhs.cols == rhs.rows
  *
- * @param out Preallocated output matrix.
+ * Large products run through a cache-blocked GEMM engine (packed panels
+ * and a register-tiled micro-kernel); small ones use a direct
+ * row-streaming loop.
+ *
+ * @param out Preallocated output matrix (must not alias @p lhs or @p rhs).
  * @param lhs Left operand.
  * @param rhs Right operand.
  *
  * @return ML_OK on success.
- * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes are incompatible.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL, shapes are incompatible,
+ *         or @p out shares storage with an operand.
  */
 ML_Status Mat_Mul_Mat_into(Matf32* out, const Matf32 lhs, const Matf32 rhs);
 
+/**
+ * @brief Operand transposition flag for Mat_Mul_Mat_trans_into().
+ */
+typedef enum {
+  /** Use the operand as stored. */
+  ML_NO_TRANS,
+  /** Use the transpose of the stored operand. */
+  ML_TRANS,
+} ML_Transpose;
+
+/**
+ * @brief Elementwise activation function.
+ *
+ * GELU uses the tanh approximation
+ * 0.5 x (1 + tanh(sqrt(2/pi) (x + 0.044715 x^3))).
+ */
+typedef enum {
+  /** Identity. */
+  ML_ACT_NONE,
+  /** max(x, 0). */
+  ML_ACT_RELU,
+  /** x for x > 0, alpha * x otherwise. */
+  ML_ACT_LEAKY_RELU,
+  /** 1 / (1 + exp(-x)). */
+  ML_ACT_SIGMOID,
+  /** tanh(x). */
+  ML_ACT_TANH,
+  /** Gaussian error linear unit (tanh approximation). */
+  ML_ACT_GELU,
+} ML_Activation;
+
+/**
+ * @brief Work fused into the write-back of a matrix product, see
+ *        Mat_Mul_Mat_fused_into().
+ *
+ * Each output element becomes act(scale * sum + bias[c]) while its tile
+ * of the product is still in L1, instead of in extra passes over out.
+ * Initialise with create_Epilogue().
+ */
+typedef struct {
+  /** Multiplier applied to the product (1 for none). */
+  f32 scale;
+  /** (1 x cols) row vector added to every row; data == NULL for none. */
+  Matf32 bias;
+  /** Activation applied last. */
+  ML_Activation act;
+  /** Negative slope for ML_ACT_LEAKY_RELU. */
+  f32 alpha;
+} ML_Epilogue;
+
+/**
+ * @brief Initialise an epilogue that does nothing: scale 1, no bias, no
+ *        activation, leaky slope 0.01.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p ep is NULL.
+ */
+ML_Status create_Epilogue(ML_Epilogue* ep);
+
+/**
+ * @brief Matrix multiplication with transposed operands: out = op(lhs) * op(rhs).
+ *
+ * op(X) is X for ML_NO_TRANS and X^T for ML_TRANS. The transpose is folded
+ * into how the GEMM engine reads the operand, so no transposed copy is
+ * ever materialised. For example the weight gradient X^T * dZ is
+ * @code
+ * Mat_Mul_Mat_trans_into(&dW, X, ML_TRANS, dZ, ML_NO_TRANS);
+ * @endcode
+ *
+ * Requires:
+ * - inner dimensions of op(lhs) and op(rhs) agree
+ * - out is allocated with shape (rows of op(lhs) x cols of op(rhs))
+ *
+ * @param out Preallocated output matrix (must not alias @p lhs or @p rhs).
+ * @param lhs Left operand as stored.
+ * @param lhs_t Whether to transpose @p lhs.
+ * @param rhs Right operand as stored.
+ * @param rhs_t Whether to transpose @p rhs.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL, shapes are incompatible,
+ *         a flag is not a valid ML_Transpose, or @p out shares storage with
+ *         an operand.
+ */
+ML_Status Mat_Mul_Mat_trans_into(Matf32* out,
+                                 const Matf32 lhs, ML_Transpose lhs_t,
+                                 const Matf32 rhs, ML_Transpose rhs_t);
+
+/**
+ * @brief Matrix multiplication with a fused epilogue:
+ *        out = act(scale * op(lhs) * op(rhs) + bias).
+ *
+ * Same operands and requirements as Mat_Mul_Mat_trans_into(). The
+ * epilogue is applied to each block of out as the GEMM finishes it, so a
+ * Linear layer's bias and activation cost no extra pass over out:
+ * @code
+ * ML_Epilogue ep;
+ * create_Epilogue(&ep);
+ * ep.bias = b;
+ * ep.act = ML_ACT_RELU;
+ * Mat_Mul_Mat_fused_into(&Z, X, ML_NO_TRANS, W, ML_NO_TRANS, &ep);
+ * @endcode
+ *
+ * @param ep Epilogue, or NULL for a plain product.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT as for Mat_Mul_Mat_trans_into(), or if the
+ *         bias is not (1 x cols of out), overlaps @p out, or @p ep->act is
+ *         not a valid ML_Activation.
+ */
+ML_Status Mat_Mul_Mat_fused_into(Matf32* out,
+                                 const Matf32 lhs, ML_Transpose lhs_t,
+                                 const Matf32 rhs, ML_Transpose rhs_t,
+                                 const ML_Epilogue* ep);
+
 /**
  * @brief Transpose with allocation: out = target^T.
  *
@@ -364,6 +634,8 @@ ML_Status Mat_rowwise_div_ColVec_inplace(Matf32* lhs, Matf32 rhs);
 /**
  * @brief In-place elementwise exponential: target[i] = exp(target[i]).
  *
+ * Accuracy follows set_ml_math_accuracy() (see ml_backend.h).
+ *
  * @param target Matrix to modify in-place.
  *
  * @return ML_OK on success.
@@ -371,4 +643,43 @@ ML_Status Mat_rowwise_div_ColVec_inplace(Matf32* lhs, Matf32 rhs);
  */
 ML_Status Mat_exp_inplace(Matf32* target);
 
+/**
+ * @brief Elementwise activation: out = act(in).
+ *
+ * Sigmoid, tanh and GELU follow set_ml_math_accuracy(). @p out may be
+ * @p in itself for an in-place update.
+ *
+ * @param out Output matrix, same shape as @p in.
+ * @param in Input matrix.
+ * @param act Activation to apply.
+ * @param alpha Negative slope for ML_ACT_LEAKY_RELU, ignored otherwise.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL, shapes differ, @p act
+ *         is not a valid ML_Activation, or @p out partially overlaps @p in.
+ */
+ML_Status Mat_act_into(Matf32* out, const Matf32 in, ML_Activation act, f32 alpha);
+
+/**
+ * @brief Activation backward: dx = dy * act'(x).
+ *
+ * The derivative is read from @p v, the forward output act(x), for every
+ * activation but ML_ACT_GELU, which takes the forward input x instead.
+ * ReLU and leaky ReLU take the sign of the output, so @p alpha must be
+ * >= 0. @p dx may be @p dy itself, to overwrite the incoming gradient.
+ *
+ * @param dx Output gradient, same shape as @p dy.
+ * @param dy Incoming gradient.
+ * @param v Forward output (or input for GELU), same shape as @p dy.
+ * @param act Activation used in the forward pass.
+ * @param alpha Negative slope for ML_ACT_LEAKY_RELU, ignored otherwise.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL, shapes differ, @p act
+ *         is not a valid ML_Activation, @p alpha < 0 for leaky ReLU, or
+ *         @p dx partially overlaps @p dy or @p v.
+ */
+ML_Status Mat_act_grad_into(Matf32* dx, const Matf32 dy, const Matf32 v,
+                            ML_Activation act, f32 alpha);
+
 #endif // ML_PRIMITIVES_H
@@ -0,0 +1,129 @@
+#ifndef ML_QUANT_H
+#define ML_QUANT_H
+
+#include "ml_error.h"
+#include "ml_alloc.h"
+#include "ml_primitives.h"
+
+/**
+ * @file ml_quant.h
+ * @brief Symmetric int8 matrices and the int8 x int8 -> int32 GEMM.
+ *
+ * A Mati8 stores q in [-127, 127] and represents x = q * scale, with no
+ * zero point. The scale is either shared by the whole matrix or kept per
+ * row. For weights stored output channel per row this is the usual
+ * per-channel quantization.
+ *
+ * Typical use, quantizing a (D x C) f32 weight matrix per output channel:
+ * @code
+ * Mati8 WT;
+ * create_Mati8(&arena, &WT, C, D, ML_QUANT_PER_ROW);
+ * Mat_quantize_i8(&WT, W, ML_TRANS);          // WT = quant(W^T)
+ * Mat_Mul_Mati8_into(&Z, Xq, WT);             // Z = deq(Xq) * deq(WT)^T
+ * @endcode
+ */
+
+/** @brief How many scales a Mati8 carries. */
+typedef enum {
+  /** One scale for the whole matrix. */
+  ML_QUANT_PER_TENSOR,
+  /** One scale per row (per output channel for transposed weights). */
+  ML_QUANT_PER_ROW,
+} ML_QuantGranularity;
+
+/**
+ * @brief Symmetric int8 matrix, row-major with a leading dimension.
+ *
+ * Same layout rules as Matf32: @ref stride is the distance between rows in
+ * elements (0 means cols).
+ */
+typedef struct {
+  u64 rows;
+  u64 cols;
+  i8* data;
+  u64 stride;
+  /** 1 scale (ML_QUANT_PER_TENSOR) or @ref rows scales (ML_QUANT_PER_ROW). */
+  f32* scales;
+  ML_QuantGranularity granularity;
+} Mati8;
+
+/**
+ * @brief Scale that applies to row @p row of @p m.
+ */
+static inline f32 Mati8_scale(const Mati8 m, u64 row) {
+  return m.granularity == ML_QUANT_PER_ROW ? m.scales[row] : m.scales[0];
+}
+
+/**
+ * @brief Allocate an int8 matrix of shape (rows x cols) and its scales.
+ *
+ * Data and scales are uninitialized.
+ *
+ * @param arena Arena to allocate from.
+ * @param dest Output matrix descriptor.
+ * @param rows Number of rows.
+ * @param cols Number of columns.
+ * @param granularity Per-tensor or per-row scales.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p arena or @p dest is NULL or
+ *         @p granularity is unknown.
+ * @return ML_OUT_OF_MEMORY if the arena cannot satisfy the allocation.
+ */
+ML_Status create_Mati8(ml_arena* arena, Mati8* dest, u64 rows, u64 cols,
+                       ML_QuantGranularity granularity);
+
+/**
+ * @brief Quantize an f32 matrix: dest = quant(op(src)).
+ *
+ * Scales are chosen from the absolute maximum (per tensor or per row of
+ * op(src)) so that it maps to 127; values round to nearest.
+ *
+ * @param dest Preallocated output, shape of op(src).
+ * @param src Matrix to quantize.
+ * @param src_t ML_TRANS to quantize the transpose of @p src.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes mismatch.
+ */
+ML_Status Mat_quantize_i8(Mati8* dest, const Matf32 src, ML_Transpose src_t);
+
+/**
+ * @brief Quantize with a fixed per-tensor scale: dest = clamp(round(src / scale)).
+ *
+ * Used for activations whose range was calibrated ahead of time; values
+ * outside [-127 * scale, 127 * scale] saturate. @p dest must be
+ * ML_QUANT_PER_TENSOR; its scale is set to @p scale.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL, shapes mismatch,
+ *         @p dest is per-row or @p scale is not positive.
+ */
+ML_Status Mat_quantize_i8_scaled(Mati8* dest, const Matf32 src, f32 scale);
+
+/**
+ * @brief Convert back to f32: dest = src.data * scale.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes mismatch.
+ */
+ML_Status Mat_dequantize_i8(Matf32* dest, const Mati8 src);
+
+/**
+ * @brief Int8 GEMM: out = deq(lhs) * deq(rhs_t)^T.
+ *
+ * @p lhs is (M x K) and @p rhs_t is (N x K), so both operands are read
+ * along K with unit stride. Products are accumulated exactly in int32 and
+ * scaled to f32 once per output element:
+ * out[i, j] = scale_lhs(i) * scale_rhs(j) * sum_k lhs[i, k] * rhs_t[j, k].
+ *
+ * @param out Preallocated (M x N) output; must not alias the operands.
+ * @param lhs Left operand (M x K).
+ * @param rhs_t Right operand, stored transposed (N x K).
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes mismatch.
+ */
+ML_Status Mat_Mul_Mati8_into(Matf32* out, const Mati8 lhs, const Mati8 rhs_t);
+
+#endif // ML_QUANT_H
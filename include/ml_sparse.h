@@ -0,0 +1,147 @@
+#ifndef ML_SPARSE_H
+#define ML_SPARSE_H
+
+#include "ml_error.h"
+#include "ml_alloc.h"
+#include "ml_primitives.h"
+
+/**
+ * @file ml_sparse.h
+ * @brief Arena-allocated sparse matrices (COO and CSR) and sparse x dense products.
+ *
+ * COO is the assembly format: entries are appended in any order with
+ * MatCOO_push(). CSR is the compute format: rows are contiguous runs of
+ * (column, value) pairs, so products stream the non-zeros once and cost
+ * O(nnz * n) instead of O(rows * cols * n).
+ *
+ * Both are sized for a maximum number of non-zeros at creation and never
+ * grow; indices are 32-bit to halve their footprint. Duplicate entries
+ * are allowed and simply add up in every product.
+ *
+ * @code
+ * MatCOO coo;  MatCSR X;
+ * create_MatCOO(&arena, &coo, N, D, max_nnz);
+ * MatCOO_push(&coo, row, col, 1.0f);          // ... one per feature
+ * create_MatCSR(&arena, &X, N, D, max_nnz);
+ * MatCSR_from_COO(&X, coo);
+ * MatCSR_Mul_Mat_into(&Z, X, W);              // Z = X * W
+ * @endcode
+ */
+
+/** @brief Coordinate-list sparse matrix. */
+typedef struct {
+  u64 rows;
+  u64 cols;
+  /** Entries in use. */
+  u64 nnz;
+  /** Entries allocated. */
+  u64 cap;
+  u32* row_idx;
+  u32* col_idx;
+  f32* values;
+} MatCOO;
+
+/** @brief Compressed sparse row matrix. */
+typedef struct {
+  u64 rows;
+  u64 cols;
+  /** Entries in use (== row_ptr[rows]). */
+  u64 nnz;
+  /** Entries allocated. */
+  u64 cap;
+  /** rows + 1 offsets; row r is entries [row_ptr[r], row_ptr[r + 1]). */
+  u32* row_ptr;
+  u32* col_idx;
+  f32* values;
+} MatCSR;
+
+/**
+ * @brief Allocate an empty COO matrix with room for @p cap entries.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p arena or @p dest is NULL, or a
+ *         dimension or @p cap does not fit 32-bit indices.
+ * @return ML_OUT_OF_MEMORY if the arena cannot satisfy the allocation.
+ */
+ML_Status create_MatCOO(ml_arena* arena, MatCOO* dest, u64 rows, u64 cols, u64 cap);
+
+/**
+ * @brief Allocate an empty CSR matrix (all rows empty) with room for @p cap entries.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p arena or @p dest is NULL, or a
+ *         dimension or @p cap does not fit 32-bit indices.
+ * @return ML_OUT_OF_MEMORY if the arena cannot satisfy the allocation.
+ */
+ML_Status create_MatCSR(ml_arena* arena, MatCSR* dest, u64 rows, u64 cols, u64 cap);
+
+/**
+ * @brief Append the entry (row, col) = val.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if @p coo is NULL.
+ * @return ML_OUT_OF_BOUNDS if (row, col) is outside the matrix.
+ * @return ML_OUT_OF_MEMORY if all @ref MatCOO::cap entries are in use.
+ */
+ML_Status MatCOO_push(MatCOO* coo, u64 row, u64 col, f32 val);
+
+/**
+ * @brief Build a CSR matrix from COO entries (stable within each row).
+ *
+ * @param dest Preallocated CSR of the same shape with cap >= src.nnz.
+ * @param src COO entries.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes mismatch.
+ * @return ML_OUT_OF_MEMORY if @p dest cannot hold src.nnz entries.
+ */
+ML_Status MatCSR_from_COO(MatCSR* dest, const MatCOO src);
+
+/**
+ * @brief Build a CSR matrix from the non-zero entries of a dense one.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes mismatch.
+ * @return ML_OUT_OF_MEMORY if @p src has more than dest->cap non-zeros.
+ */
+ML_Status MatCSR_from_dense(MatCSR* dest, const Matf32 src);
+
+/**
+ * @brief Expand to a dense matrix (zeros filled in).
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes mismatch.
+ */
+ML_Status MatCSR_to_dense(Matf32* dest, const MatCSR src);
+
+/**
+ * @brief Sparse x dense: out = lhs * rhs.
+ *
+ * Each non-zero lhs[i, p] adds lhs[i, p] * rhs[p, :] to out[i, :].
+ *
+ * @param out Preallocated (M x N) output.
+ * @param lhs (M x K) sparse operand.
+ * @param rhs (K x N) dense operand; must not overlap @p out.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes mismatch.
+ */
+ML_Status MatCSR_Mul_Mat_into(Matf32* out, const MatCSR lhs, const Matf32 rhs);
+
+/**
+ * @brief Sparse-transpose x dense: out = lhs^T * rhs.
+ *
+ * Each non-zero lhs[i, p] adds lhs[i, p] * rhs[i, :] to out[p, :], so the
+ * transpose is never formed. This is the weight gradient X^T * dZ of a
+ * Linear layer with sparse input.
+ *
+ * @param out Preallocated (K x N) output.
+ * @param lhs (M x K) sparse operand.
+ * @param rhs (M x N) dense operand; must not overlap @p out.
+ *
+ * @return ML_OK on success.
+ * @return ML_INVALID_ARGUMENT if pointers are NULL or shapes mismatch.
+ */
+ML_Status MatCSR_trans_Mul_Mat_into(Matf32* out, const MatCSR lhs, const Matf32 rhs);
+
+#endif // ML_SPARSE_H
@@ -0,0 +1,112 @@
+#ifndef ML_THREAD_H
+#define ML_THREAD_H
+
+#include "ml_defs.h"
+#include "ml_error.h"
+
+/**
+ * @file ml_thread.h
+ * @brief Worker pool and parallel-for used by the dense kernels.
+ *
+ * GEMM, transpose, row/column reductions, the elementwise kernels and the
+ * fused row pipeline (softmax) split their work into row or tile blocks
+ * and hand them to ml_parallel_for(). Workers are pthreads on desktop
+ * targets and FreeRTOS tasks under ESP-IDF; other targets always run
+ * serially.
+ *
+ * The default is one thread: no pool exists and every kernel runs on the
+ * caller exactly as a serial build would. Work is split on the same
+ * boundaries the serial code uses, so results are bit-identical for any
+ * number of threads.
+ *
+ * @code
+ * set_ml_threads(0);   // one per online CPU
+ * // ...
+ * set_ml_threads(1);   // back to serial, pool torn down
+ * @endcode
+ *
+ * @note Like set_ml_backend(), change the thread count while the library
+ *       is idle. Several application threads may run kernels at once on
+ *       different data. Only one of them uses the pool at a time, and the
+ *       others run serially. The pool also owns the GEMM pack panels
+ *       (see ML_GEMM_PACKED in src/ml_gemm.h), which set_ml_threads()
+ *       sizes for the new thread count; a product that cannot take the
+ *       pool skips them.
+ */
+
+/** @brief Largest pool size (including the calling thread). */
+#ifndef ML_THREADS_MAX
+#ifdef ESP_PLATFORM
+#define ML_THREADS_MAX 2
+#else
+#define ML_THREADS_MAX 64
+#endif
+#endif
+
+/**
+ * @brief Minimum elements of work per parallel chunk.
+ *
+ * Below this the hand-off costs more than it saves, so small matrices
+ * never leave the calling thread.
+ */
+#ifndef ML_PARALLEL_MIN_WORK
+#define ML_PARALLEL_MIN_WORK (16u * 1024u)
+#endif
+
+/**
+ * @brief Body of a parallel loop: process items [begin, end).
+ *
+ * @param ctx User pointer passed to ml_parallel_for().
+ * @param begin First item.
+ * @param end One past the last item.
+ * @param tid Index of the executing thread in [0, get_ml_threads()),
+ *            0 being the caller; use it to pick per-thread scratch.
+ */
+typedef void (*ML_ParallelFn)(void* ctx, u64 begin, u64 end, u64 tid);
+
+/**
+ * @brief Set the number of threads used by the kernels.
+ *
+ * @param n Threads including the caller; 0 means one per online CPU.
+ *          Clamped to ML_THREADS_MAX. 1 disables the pool.
+ *
+ * @return ML_OK on success.
+ * @return ML_UNIMPLEMENTED if @p n > 1 and this target has no threads.
+ * @return ML_OUT_OF_MEMORY if a worker could not be started (the pool is
+ *         left serial).
+ */
+ML_Status set_ml_threads(u64 n);
+
+/**
+ * @brief Number of threads the kernels currently use (1 = serial).
+ */
+u64 get_ml_threads(void);
+
+/**
+ * @brief Run @p fn over [0, n) in chunks of @p grain items.
+ *
+ * Chunks start at multiples of @p grain and are handed out dynamically;
+ * the caller takes part and the call returns when every chunk is done.
+ * With one thread, a single chunk, or when called from inside another
+ * parallel loop, this is just fn(ctx, 0, n, 0).
+ *
+ * @param n Number of items.
+ * @param grain Items per chunk (0 is treated as 1).
+ * @param fn Loop body.
+ * @param ctx Passed to @p fn.
+ */
+void ml_parallel_for(u64 n, u64 grain, ML_ParallelFn fn, void* ctx);
+
+/**
+ * @brief Chunk size for items that cost @p work_per_item elements each.
+ *
+ * Large enough for ML_PARALLEL_MIN_WORK per chunk, and rounded up to a
+ * multiple of @p align (a power of two, or 1).
+ */
+static inline u64 ml_parallel_grain(u64 work_per_item, u64 align) {
+  u64 g = work_per_item ? (ML_PARALLEL_MIN_WORK + work_per_item - 1) / work_per_item : 1;
+  if (g == 0) g = 1;
+  return (g + align - 1) & ~(align - 1);
+}
+
+#endif // ML_THREAD_H
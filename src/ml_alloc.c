@@ -1,11 +1,245 @@
+#if !defined(ESP_PLATFORM) && (defined(__unix__) || defined(__APPLE__))
+#define ML_ARENA_MMAP 1
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE       // MAP_ANONYMOUS, madvise under strict -std=c11
+#endif
+#endif
+
 #include "ml_alloc.h"
 #include <stdint.h>   // uintptr_t
 #include <stddef.h>   // size_t
+#include <stdio.h>    // snprintf
+#include <string.h>   // strcmp
+
+#if ML_ARENA_MMAP
+#include <sys/mman.h> // mmap, mprotect, madvise
+#include <unistd.h>   // sysconf
+#endif
+
+/** Huge page size assumed for ML_HUGEPAGES_HUGETLB and THP base alignment. */
+#ifndef ML_ARENA_HUGE_PAGE
+#define ML_ARENA_HUGE_PAGE MiB(2)
+#endif
+
+/*
+ * A mapped arena reserves [mapping, mapping + mapping_size) with no access
+ * and keeps two committed regions: [0, lo) for the bottom end and
+ * [hi, capacity) for the top end, both offsets from the arena base and both
+ * whole chunks. The struct itself lives in the first page of the mapping,
+ * below the (aligned) base.
+ */
+struct ml_arena_map {
+  void* mapping;
+  u64 mapping_size;
+  u64 chunk;
+  u64 lo;
+  u64 hi;
+  ML_HugePages huge;
+};
 
 static inline u64 arena_align_up(u64 n) {
   return ALIGN_UP_POW2(n, (u64)ARENA_ALIGN);
 }
 
+static ml_arena_tag_stats* arena_tag_slot(ml_arena_stats* st, const char* tag) {
+  if (!tag) tag = "untagged";
+
+  for (u64 i = 0; i < st->n_tags; ++i)
+    if (st->tags[i].tag == tag || strcmp(st->tags[i].tag, tag) == 0) return &st->tags[i];
+
+  if (st->n_tags == ML_ARENA_MAX_TAGS) return NULL;
+
+  ml_arena_tag_stats* slot = &st->tags[st->n_tags++];
+  slot->tag = tag;
+  slot->bytes = 0;
+  slot->count = 0;
+  return slot;
+}
+
+// Record an event on an arena with stats attached. Call after the arena
+// state has been updated so the peaks see the new positions.
+static void arena_note(ml_arena* arena, ML_ArenaEvent kind, u64 offset, u64 size, u64 waste) {
+  ml_arena_stats* st = arena->stats;
+
+  switch (kind) {
+   case ML_ARENA_EV_PUSH:
+   case ML_ARENA_EV_PUSH_TOP: {
+     st->allocs += 1;
+     st->bytes += size;
+     st->waste += waste;
+
+     ml_arena_tag_stats* slot = arena_tag_slot(st, arena->tag);
+     if (slot) {
+       slot->bytes += size;
+       slot->count += 1;
+     } else {
+       st->tags_dropped += 1;
+     }
+     break;
+   }
+   case ML_ARENA_EV_FAIL:
+     st->failed += 1;
+     break;
+   default:
+     break;
+  }
+
+  const u64 used = arena->pos + (arena->capacity - arena->top);
+  if (arena->pos > st->peak_pos) st->peak_pos = arena->pos;
+  if (used > st->peak_used) st->peak_used = used;
+
+  if (st->trace) {
+    ml_arena_event ev = { kind, arena->tag, offset, size, waste };
+    st->trace(st->trace_ctx, &ev);
+  }
+}
+
+static ML_Status arena_fail(ml_arena* arena, u64 size) {
+  if (arena->stats) arena_note(arena, ML_ARENA_EV_FAIL, 0, size, 0);
+  return ML_OUT_OF_MEMORY;
+}
+
+#if ML_ARENA_MMAP
+
+static ML_Status map_commit_range(ml_arena_map* m, u8* addr, u64 len) {
+#ifdef MAP_HUGETLB
+  if (m->huge == ML_HUGEPAGES_HUGETLB) {
+    void* p = mmap(addr, (size_t)len, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) return ML_OK;
+
+    // Pool exhausted (or never configured): normal pages from here on. A
+    // failed MAP_FIXED may already have dropped the reservation, so map
+    // the range afresh rather than mprotect() it.
+    m->huge = ML_HUGEPAGES_THP;
+    p = mmap(addr, (size_t)len, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+    if (p == MAP_FAILED) return ML_OUT_OF_MEMORY;
+#ifdef MADV_HUGEPAGE
+    madvise(addr, (size_t)len, MADV_HUGEPAGE);
+#endif
+    return ML_OK;
+  }
+#endif
+  if (mprotect(addr, (size_t)len, PROT_READ | PROT_WRITE) != 0) return ML_OUT_OF_MEMORY;
+  return ML_OK;
+}
+
+// Make sure [0, lo) and [hi, capacity) of a mapped arena are committed.
+static ML_Status map_commit(ml_arena* arena, u64 lo, u64 hi) {
+  ml_arena_map* m = arena->map;
+  u8* base = (u8*)arena->base;
+
+  if (lo > m->lo) {
+    u64 new_lo = ALIGN_UP_POW2(lo, m->chunk);
+    if (new_lo > m->hi) new_lo = m->hi;
+    if (map_commit_range(m, base + m->lo, new_lo - m->lo) != ML_OK) return ML_OUT_OF_MEMORY;
+    m->lo = new_lo;
+  }
+
+  if (hi < m->hi) {
+    u64 new_hi = hi & ~(m->chunk - 1);
+    if (new_hi < m->lo) new_hi = m->lo;
+    if (map_commit_range(m, base + new_hi, m->hi - new_hi) != ML_OK) return ML_OUT_OF_MEMORY;
+    m->hi = new_hi;
+  }
+
+  return ML_OK;
+}
+
+ML_Status create_mapped_ml_arena(ml_arena* target, u64 reserve, u64 chunk, ML_HugePages huge) {
+  if (!target) return ML_INVALID_ARGUMENT;
+  if (reserve == 0) return ML_INVALID_ARGUMENT;
+
+  long sys_page = sysconf(_SC_PAGESIZE);
+  const u64 page = sys_page > 0 ? (u64)sys_page : KiB(4);
+#ifndef MAP_HUGETLB
+  if (huge == ML_HUGEPAGES_HUGETLB) huge = ML_HUGEPAGES_THP;
+#endif
+
+  // Chunks are whole pages (huge pages for hugetlb) and a power of two
+  const u64 unit = huge == ML_HUGEPAGES_HUGETLB ? ML_ARENA_HUGE_PAGE : page;
+  if (chunk == 0) chunk = MiB(2);
+  if (chunk < unit) chunk = unit;
+  u64 c = unit;
+  while (c < chunk && c <= (~(u64)0 >> 1)) c <<= 1;
+  chunk = c;
+
+  // Base aligned to a huge page whenever huge pages may back it
+  const u64 align = huge == ML_HUGEPAGES_NONE ? page : ML_ARENA_HUGE_PAGE;
+  if (reserve > ~(u64)0 - chunk) return ML_INVALID_ARGUMENT;
+  const u64 capacity = ALIGN_UP_POW2(reserve, chunk);
+  if (capacity > (u64)SIZE_MAX - align - page) return ML_OUT_OF_MEMORY;
+  const u64 mapping_size = capacity + align + page;
+
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+  flags |= MAP_NORESERVE;
+#endif
+  void* mapping = mmap(NULL, (size_t)mapping_size, PROT_NONE, flags, -1, 0);
+  if (mapping == MAP_FAILED) return ML_OUT_OF_MEMORY;
+
+  // First page holds the map struct
+  if (mprotect(mapping, (size_t)page, PROT_READ | PROT_WRITE) != 0) {
+    munmap(mapping, (size_t)mapping_size);
+    return ML_OUT_OF_MEMORY;
+  }
+
+  uintptr_t base = (uintptr_t)ALIGN_UP_POW2((uintptr_t)mapping + page, align);
+
+#ifdef MADV_HUGEPAGE
+  if (huge != ML_HUGEPAGES_NONE) madvise((void*)base, (size_t)capacity, MADV_HUGEPAGE);
+#endif
+
+  ml_arena_map* m = (ml_arena_map*)mapping;
+  m->mapping = mapping;
+  m->mapping_size = mapping_size;
+  m->chunk = chunk;
+  m->lo = 0;
+  m->hi = capacity;
+  m->huge = huge;
+
+  target->base = (void*)base;
+  target->capacity = capacity;
+  target->pos = 0;
+  target->top = capacity;
+  target->stats = NULL;
+  target->tag = NULL;
+  target->counting = 0;
+  target->map = m;
+  return ML_OK;
+}
+
+ML_Status destroy_mapped_ml_arena(ml_arena* target) {
+  if (!target || !target->map) return ML_INVALID_ARGUMENT;
+
+  ml_arena_map* m = target->map;
+  munmap(m->mapping, (size_t)m->mapping_size);
+  memset(target, 0, sizeof(*target));
+  return ML_OK;
+}
+
+#else // no mmap: mapped arenas cannot be created, so map is always NULL
+
+static ML_Status map_commit(ml_arena* arena, u64 lo, u64 hi) {
+  (void)arena; (void)lo; (void)hi;
+  return ML_OUT_OF_MEMORY;
+}
+
+ML_Status create_mapped_ml_arena(ml_arena* target, u64 reserve, u64 chunk, ML_HugePages huge) {
+  (void)chunk; (void)huge;
+  if (!target) return ML_INVALID_ARGUMENT;
+  if (reserve == 0) return ML_INVALID_ARGUMENT;
+  return ML_UNIMPLEMENTED;
+}
+
+ML_Status destroy_mapped_ml_arena(ml_arena* target) {
+  (void)target;
+  return ML_INVALID_ARGUMENT;
+}
+
+#endif
+
 ML_Status create_ml_arena(ml_arena* target, void* mem, u64 capacity) {
   if (!target) return ML_INVALID_ARGUMENT;
   if (!mem) return ML_INVALID_ARGUMENT;
@@ -14,12 +248,31 @@ ML_Status create_ml_arena(ml_arena* target, void* mem, u64 capacity) {
   target->base = mem;
   target->capacity = capacity;
   target->pos = 0;
+  target->top = capacity;
+  target->stats = NULL;
+  target->tag = NULL;
+  target->counting = 0;
+  target->map = NULL;
+  return ML_OK;
+}
+
+ML_Status create_counting_ml_arena(ml_arena* target) {
+  if (!target) return ML_INVALID_ARGUMENT;
+
+  target->base = NULL;
+  target->capacity = ~(u64)0;
+  target->pos = 0;
+  target->top = target->capacity;
+  target->stats = NULL;
+  target->tag = NULL;
+  target->counting = 1;
+  target->map = NULL;
   return ML_OK;
 }
 
 ML_Status push_ml_arena(void** ptr, ml_arena* arena, u64 size) {
   if (!ptr) return ML_INVALID_ARGUMENT;
-  if (!arena || !arena->base) return ML_INVALID_ARGUMENT;
+  if (!arena || (!arena->base && !arena->counting)) return ML_INVALID_ARGUMENT;
 
   if (size == 0) { // define: size==0 gives NULL and succeeds
     *ptr = NULL;
@@ -29,22 +282,198 @@ ML_Status push_ml_arena(void** ptr, ml_arena* arena, u64 size) {
   // Align current position to ARENA_ALIGN
   u64 aligned_pos = arena_align_up(arena->pos);
 
-  // Check overflow and capacity
-  if (aligned_pos > arena->capacity) return ML_OUT_OF_MEMORY;
-  if (size > arena->capacity - aligned_pos) return ML_OUT_OF_MEMORY;
+  // Check overflow and the space left below the top end
+  if (aligned_pos > arena->top) return arena_fail(arena, size);
+  if (size > arena->top - aligned_pos) return arena_fail(arena, size);
+  if (arena->map && map_commit(arena, aligned_pos + size, arena->top) != ML_OK)
+    return arena_fail(arena, size);
 
-  // Compute pointer
+  // Compute pointer (a counting arena hands out none)
   uintptr_t base = (uintptr_t)arena->base;
-  *ptr = (void*)(base + (uintptr_t)aligned_pos);
+  *ptr = arena->counting ? NULL : (void*)(base + (uintptr_t)aligned_pos);
 
   // Bump
+  const u64 waste = aligned_pos - arena->pos;
   arena->pos = aligned_pos + size;
+  if (arena->stats) arena_note(arena, ML_ARENA_EV_PUSH, aligned_pos, size, waste);
   return ML_OK;
 }
 
+ML_Status push_aligned_ml_arena(void** ptr, ml_arena* arena, u64 size, u64 align) {
+  if (!ptr) return ML_INVALID_ARGUMENT;
+  if (!arena || (!arena->base && !arena->counting)) return ML_INVALID_ARGUMENT;
+  if (align == 0 || (align & (align - 1)) != 0) return ML_INVALID_ARGUMENT;
+
+  if (size == 0) {
+    *ptr = NULL;
+    return ML_OK;
+  }
+
+  if (align < (u64)ARENA_ALIGN) align = (u64)ARENA_ALIGN;
+
+  // Align the address itself; the base need not be aligned to align. A
+  // counting arena has no address, so it books the worst-case padding.
+  uintptr_t base = (uintptr_t)arena->base;
+  uintptr_t addr = (uintptr_t)ALIGN_UP_POW2(base + (uintptr_t)arena->pos, align);
+  u64 aligned_pos = arena->counting ? arena_align_up(arena->pos) + (align - (u64)ARENA_ALIGN)
+                                    : (u64)(addr - base);
+  u64 padded = ALIGN_UP_POW2(size, align);
+
+  if (padded < size) return arena_fail(arena, size);
+  if (aligned_pos > arena->top) return arena_fail(arena, size);
+  if (padded > arena->top - aligned_pos) return arena_fail(arena, size);
+  if (arena->map && map_commit(arena, aligned_pos + padded, arena->top) != ML_OK)
+    return arena_fail(arena, size);
+
+  *ptr = arena->counting ? NULL : (void*)addr;
+  const u64 waste = (aligned_pos - arena->pos) + (padded - size);
+  arena->pos = aligned_pos + padded;
+  if (arena->stats) arena_note(arena, ML_ARENA_EV_PUSH, aligned_pos, size, waste);
+  return ML_OK;
+}
+
+ML_Status push_top_ml_arena(void** ptr, ml_arena* arena, u64 size) {
+  if (!ptr) return ML_INVALID_ARGUMENT;
+  if (!arena || (!arena->base && !arena->counting)) return ML_INVALID_ARGUMENT;
+
+  if (size == 0) {
+    *ptr = NULL;
+    return ML_OK;
+  }
+
+  // The block ends at top and starts at the aligned address below it
+  if (size > arena->top - arena->pos) return arena_fail(arena, size);
+
+  uintptr_t base = (uintptr_t)arena->base;
+  uintptr_t start = (base + (uintptr_t)(arena->top - size)) & ~((uintptr_t)ARENA_ALIGN - 1);
+  if (start < base + (uintptr_t)arena->pos) return arena_fail(arena, size);
+  if (arena->map && map_commit(arena, arena->pos, (u64)(start - base)) != ML_OK)
+    return arena_fail(arena, size);
+
+  *ptr = arena->counting ? NULL : (void*)start;
+  const u64 new_top = (u64)(start - base);
+  const u64 waste = arena->top - new_top - size;
+  arena->top = new_top;
+  if (arena->stats) arena_note(arena, ML_ARENA_EV_PUSH_TOP, new_top, size, waste);
+  return ML_OK;
+}
+
+ml_arena_mark mark_ml_arena(const ml_arena* arena) {
+  ml_arena_mark mark = { 0, 0 };
+  if (!arena) return mark;
+
+  mark.pos = arena->pos;
+  mark.top = arena->top;
+  return mark;
+}
+
+ML_Status rewind_ml_arena(ml_arena* arena, ml_arena_mark mark) {
+  if (!arena) return ML_INVALID_ARGUMENT;
+
+  // A mark can only move each end back towards its own side
+  if (mark.pos > arena->pos || mark.top < arena->top) return ML_INVALID_ARGUMENT;
+  if (mark.top > arena->capacity) return ML_INVALID_ARGUMENT;
+
+  arena->pos = mark.pos;
+  arena->top = mark.top;
+  if (arena->stats) arena_note(arena, ML_ARENA_EV_REWIND, arena->top, arena->pos, 0);
+  return ML_OK;
+}
+
+ML_Status begin_ml_scratch(ml_scratch* scratch, ml_arena* arena) {
+  if (!scratch || !arena) return ML_INVALID_ARGUMENT;
+
+  scratch->arena = arena;
+  scratch->top = arena->top;
+  return ML_OK;
+}
+
+ML_Status push_ml_scratch(void** ptr, ml_scratch* scratch, u64 size) {
+  if (!scratch) return ML_INVALID_ARGUMENT;
+  return push_top_ml_arena(ptr, scratch->arena, size);
+}
+
+ML_Status end_ml_scratch(ml_scratch* scratch) {
+  if (!scratch || !scratch->arena) return ML_INVALID_ARGUMENT;
+
+  ml_arena* arena = scratch->arena;
+  // An enclosing scope that already ended moved top above ours
+  if (scratch->top < arena->top || scratch->top > arena->capacity) return ML_INVALID_ARGUMENT;
+
+  arena->top = scratch->top;
+  scratch->arena = NULL;
+  if (arena->stats) arena_note(arena, ML_ARENA_EV_REWIND, arena->top, arena->pos, 0);
+  return ML_OK;
+}
+
+u64 get_used_ml_arena_bytes(const ml_arena* arena) {
+  if (!arena) return 0;
+  return arena->pos + (arena->capacity - arena->top);
+}
+
 u64 get_freemem_ml_arena_bytes(const ml_arena* arena) {
   if (!arena) return 0;
-  if (arena->pos >= arena->capacity) return 0;
-  return arena->capacity - arena->pos;
+  if (arena->pos >= arena->top) return 0;
+  return arena->top - arena->pos;
+}
+
+
+ML_Status attach_stats_ml_arena(ml_arena* arena, ml_arena_stats* stats) {
+  if (!arena) return ML_INVALID_ARGUMENT;
+
+  arena->stats = stats;
+  if (!stats) return ML_OK;
+
+  ML_ArenaTraceFn trace = stats->trace;
+  void* trace_ctx = stats->trace_ctx;
+
+  memset(stats, 0, sizeof(*stats));
+  stats->trace = trace;
+  stats->trace_ctx = trace_ctx;
+  stats->peak_pos = arena->pos;
+  stats->peak_used = arena->pos + (arena->capacity - arena->top);
+
+  return ML_OK;
 }
 
+const char* set_tag_ml_arena(ml_arena* arena, const char* tag) {
+  if (!arena) return NULL;
+
+  const char* prev = arena->tag;
+  arena->tag = tag;
+  return prev;
+}
+
+ML_Status dump_ml_arena_stats(const ml_arena* arena, ML_ArenaDumpFn fn, void* ctx) {
+  if (!arena || !fn) return ML_INVALID_ARGUMENT;
+
+  const ml_arena_stats* st = arena->stats;
+  if (!st) return ML_OK;
+
+  char line[128];
+
+  snprintf(line, sizeof(line), "arena: capacity %llu, in use %llu, peak %llu (bottom %llu)",
+           (unsigned long long)arena->capacity,
+           (unsigned long long)(arena->pos + (arena->capacity - arena->top)),
+           (unsigned long long)st->peak_used, (unsigned long long)st->peak_pos);
+  fn(ctx, line);
+
+  snprintf(line, sizeof(line), "arena: %llu allocs (%llu failed), %llu bytes, %llu alignment waste",
+           (unsigned long long)st->allocs, (unsigned long long)st->failed,
+           (unsigned long long)st->bytes, (unsigned long long)st->waste);
+  fn(ctx, line);
+
+  for (u64 i = 0; i < st->n_tags; ++i) {
+    snprintf(line, sizeof(line), "  %-24s %10llu bytes %6llu allocs", st->tags[i].tag,
+             (unsigned long long)st->tags[i].bytes, (unsigned long long)st->tags[i].count);
+    fn(ctx, line);
+  }
+
+  if (st->tags_dropped) {
+    snprintf(line, sizeof(line), "  (%llu allocs over ML_ARENA_MAX_TAGS tags not itemised)",
+             (unsigned long long)st->tags_dropped);
+    fn(ctx, line);
+  }
+
+  return ML_OK;
+}
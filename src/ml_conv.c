@@ -0,0 +1,451 @@
+#include "ml_conv.h"
+#include "ml_simd.h"
+#include "ml_thread.h"
+
+#include <stddef.h>
+
+// Output steps and output channels one direct-convolution block covers;
+// 4 x 16 accumulators fit the register file of every backend once the
+// compiler vectorises the channel loop
+#define CONV_TB 4
+#define CONV_CB 16
+
+static inline u64 conv_min(u64 a, u64 b) { return a < b ? a : b; }
+
+// Operands of one convolution call, shared by every chunk of a parallel loop
+typedef struct {
+  const ML_Conv1DShape* s;
+  const f32* X;
+  u64 ldx;
+  const f32* W;
+  const ML_GemmEpilogue* ep;
+  f32* Y;
+  u64 ldy;
+  u64 tblocks;
+  const ML_SimdKernels* K;
+} conv_job;
+
+/* -------------------------------------------------------------------------- */
+/* Direct forward                                                              */
+/* -------------------------------------------------------------------------- */
+
+// Accumulate a full CONV_TB x CONV_CB block. x points at the first input
+// step of the block, w at column c0 of W. Fixed trip counts let the
+// compiler keep acc in registers and vectorise the inner loop.
+static void conv_block_full(const ML_Conv1DShape* s, const f32* x, const f32* w,
+                            f32 acc[CONV_TB][CONV_CB]) {
+  const u64 xs = s->stride * s->in_ch;
+  const u64 xd = s->dilation * s->in_ch;
+
+  for (u64 k = 0; k < s->kernel; ++k) {
+    const f32* xk = x + k * xd;
+    const f32* wk = w + k * s->in_ch * s->out_ch;
+    for (u64 ci = 0; ci < s->in_ch; ++ci) {
+      const f32* wr = wk + ci * s->out_ch;
+      for (u64 t = 0; t < CONV_TB; ++t) {
+        const f32 xv = xk[t * xs + ci];
+        for (u64 j = 0; j < CONV_CB; ++j) acc[t][j] += xv * wr[j];
+      }
+    }
+  }
+}
+
+// Same for a partial tb x cb block at the edges
+static void conv_block_edge(const ML_Conv1DShape* s, const f32* x, const f32* w,
+                            u64 tb, u64 cb, f32 acc[CONV_TB][CONV_CB]) {
+  const u64 xs = s->stride * s->in_ch;
+  const u64 xd = s->dilation * s->in_ch;
+
+  for (u64 k = 0; k < s->kernel; ++k) {
+    const f32* xk = x + k * xd;
+    const f32* wk = w + k * s->in_ch * s->out_ch;
+    for (u64 ci = 0; ci < s->in_ch; ++ci) {
+      const f32* wr = wk + ci * s->out_ch;
+      for (u64 t = 0; t < tb; ++t) {
+        const f32 xv = xk[t * xs + ci];
+        for (u64 j = 0; j < cb; ++j) acc[t][j] += xv * wr[j];
+      }
+    }
+  }
+}
+
+// One item is CONV_TB output steps of one sample, all output channels
+static void conv_direct_items(void* p, u64 begin, u64 end, u64 tid) {
+  const conv_job* c = p;
+  const ML_Conv1DShape* s = c->s;
+  const ML_GemmEpilogue* ep = c->ep;
+  const f32 scale = ep ? ep->scale : 1.0f;
+  (void)tid;
+
+  for (u64 it = begin; it < end; ++it) {
+    const u64 i = it / c->tblocks;
+    const u64 o0 = (it % c->tblocks) * CONV_TB;
+    const u64 tb = conv_min(CONV_TB, s->out_steps - o0);
+    const f32* x = c->X + i * c->ldx + o0 * s->stride * s->in_ch;
+    f32* y = c->Y + i * c->ldy + o0 * s->out_ch;
+
+    for (u64 c0 = 0; c0 < s->out_ch; c0 += CONV_CB) {
+      const u64 cb = conv_min(CONV_CB, s->out_ch - c0);
+      f32 acc[CONV_TB][CONV_CB] = { { 0 } };
+
+      if (tb == CONV_TB && cb == CONV_CB) conv_block_full(s, x, c->W + c0, acc);
+      else conv_block_edge(s, x, c->W + c0, tb, cb, acc);
+
+      const f32* bias = ep && ep->bias ? ep->bias + c0 : NULL;
+      for (u64 t = 0; t < tb; ++t) {
+        f32* yr = y + t * s->out_ch + c0;
+        for (u64 j = 0; j < cb; ++j) yr[j] = acc[t][j] * scale + (bias ? bias[j] : 0.0f);
+      }
+    }
+
+    if (ep && ep->act != ML_ACT_NONE) {
+      for (u64 t = 0; t < tb; ++t) {
+        f32* yr = y + t * s->out_ch;
+        c->K->act(yr, yr, s->out_ch, ep->act, ep->alpha);
+      }
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* im2col                                                                      */
+/* -------------------------------------------------------------------------- */
+
+// Unfold one sample into cols (T_out x K*Cin): row o is the concatenation
+// of the K dilated taps of output step o
+static void conv_im2col(const ML_SimdKernels* K, const ML_Conv1DShape* s,
+                        const f32* x, f32* cols) {
+  const u64 kc = s->kernel * s->in_ch;
+
+  for (u64 o = 0; o < s->out_steps; ++o) {
+    const f32* xo = x + o * s->stride * s->in_ch;
+    f32* row = cols + o * kc;
+    for (u64 k = 0; k < s->kernel; ++k)
+      K->copy(row + k * s->in_ch, xo + k * s->dilation * s->in_ch, s->in_ch);
+  }
+}
+
+// Patch matrix of sample x as a GEMM operand: the input itself when the
+// taps are contiguous, otherwise the unfolded copy in cols
+static const f32* conv_patches(const ML_SimdKernels* K, const ML_Conv1DShape* s,
+                               const f32* x, f32* cols, u64* rs) {
+  if (s->dilation == 1) {
+    *rs = s->stride * s->in_ch;
+    return x;
+  }
+  conv_im2col(K, s, x, cols);
+  *rs = s->kernel * s->in_ch;
+  return cols;
+}
+
+void ml_conv1d_forward(const ML_Conv1DShape* s, u64 n,
+                       const f32* X, u64 ldx, const f32* W,
+                       const ML_GemmEpilogue* ep,
+                       f32* Y, u64 ldy, f32* cols) {
+  const ML_SimdKernels* K = ml_simd();
+  const u64 kc = s->kernel * s->in_ch;
+
+  if (n == 0 || s->out_steps == 0 || s->out_ch == 0) return;
+
+  if (!ml_conv1d_uses_gemm(s)) {
+    conv_job c = {
+      .s = s, .X = X, .ldx = ldx, .W = W, .ep = ep, .Y = Y, .ldy = ldy,
+      .tblocks = (s->out_steps + CONV_TB - 1) / CONV_TB, .K = K,
+    };
+    ml_parallel_for(n * c.tblocks,
+                    ml_parallel_grain(CONV_TB * kc * s->out_ch, 1),
+                    conv_direct_items, &c);
+    return;
+  }
+
+  // One GEMM per sample; each is threaded over its output steps
+  for (u64 i = 0; i < n; ++i) {
+    u64 rs = 0;
+    const f32* A = conv_patches(K, s, X + i * ldx, cols, &rs);
+    ml_gemm_f32_ep(s->out_steps, s->out_ch, kc, A, rs, 1,
+                   W, s->out_ch, 1, Y + i * ldy, s->out_ch, ep);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Backward                                                                    */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  const ML_Conv1DShape* s;
+  u64 n;
+  const f32* X;
+  u64 ldx;
+  const f32* dY;
+  u64 lddy;
+  const f32* W;
+  f32* out;
+  u64 ld_out;
+  const ML_SimdKernels* K;
+} conv_bwd_job;
+
+// One item is row k*Cin + ci of dW, summed over samples and output steps
+// in a fixed order
+static void conv_dw_rows(void* p, u64 begin, u64 end, u64 tid) {
+  const conv_bwd_job* c = p;
+  const ML_Conv1DShape* s = c->s;
+  (void)tid;
+
+  for (u64 r = begin; r < end; ++r) {
+    const u64 k = r / s->in_ch;
+    const u64 ci = r % s->in_ch;
+    f32* dw = c->out + r * s->out_ch;
+
+    c->K->fill(dw, s->out_ch, 0.0f);
+    for (u64 i = 0; i < c->n; ++i) {
+      const f32* x = c->X + i * c->ldx + k * s->dilation * s->in_ch + ci;
+      const f32* dy = c->dY + i * c->lddy;
+      for (u64 o = 0; o < s->out_steps; ++o)
+        c->K->axpy(dw, dy + o * s->out_ch, s->out_ch, x[o * s->stride * s->in_ch]);
+    }
+  }
+}
+
+void ml_conv1d_backward_weights(const ML_Conv1DShape* s, u64 n,
+                                const f32* X, u64 ldx,
+                                const f32* dY, u64 lddy,
+                                f32* dW, f32* db, f32* dWn, f32* cols) {
+  const ML_SimdKernels* K = ml_simd();
+  const u64 kc = s->kernel * s->in_ch;
+
+  if (db) {
+    K->fill(db, s->out_ch, 0.0f);
+    for (u64 i = 0; i < n; ++i)
+      for (u64 o = 0; o < s->out_steps; ++o)
+        K->add(db, dY + i * lddy + o * s->out_ch, s->out_ch);
+  }
+
+  if (n == 0 || s->out_steps == 0) {
+    K->fill(dW, kc * s->out_ch, 0.0f);
+    return;
+  }
+
+  if (!ml_conv1d_uses_gemm(s)) {
+    conv_bwd_job c = {
+      .s = s, .n = n, .X = X, .ldx = ldx, .dY = dY, .lddy = lddy,
+      .out = dW, .ld_out = s->out_ch, .K = K,
+    };
+    ml_parallel_for(kc, ml_parallel_grain(n * s->out_steps * s->out_ch, 1),
+                    conv_dw_rows, &c);
+    return;
+  }
+
+  // dW_i = P_i^T dY_i, with P_i^T read through swapped strides
+  for (u64 i = 0; i < n; ++i) {
+    u64 rs = 0;
+    const f32* A = conv_patches(K, s, X + i * ldx, cols, &rs);
+    f32* C = i == 0 ? dW : dWn;
+    ml_gemm_f32(kc, s->out_ch, s->out_steps, A, 1, rs,
+                dY + i * lddy, s->out_ch, 1, C, s->out_ch);
+    if (i > 0) K->add(dW, dWn, kc * s->out_ch);
+  }
+}
+
+// One item is input step t of one sample: gather every (o, k) with
+// o*stride + k*dilation == t, so each item owns its output row
+static void conv_dx_steps(void* p, u64 begin, u64 end, u64 tid) {
+  const conv_bwd_job* c = p;
+  const ML_Conv1DShape* s = c->s;
+  (void)tid;
+
+  for (u64 it = begin; it < end; ++it) {
+    const u64 i = it / s->steps;
+    const u64 t = it % s->steps;
+    const f32* dy = c->dY + i * c->lddy;
+    f32* dx = c->out + i * c->ld_out + t * s->in_ch;
+
+    c->K->fill(dx, s->in_ch, 0.0f);
+    for (u64 k = 0; k < s->kernel && k * s->dilation <= t; ++k) {
+      const u64 u = t - k * s->dilation;
+      if (u % s->stride) continue;
+      const u64 o = u / s->stride;
+      if (o >= s->out_steps) continue;
+
+      const f32* w = c->W + k * s->in_ch * s->out_ch;
+      const f32* dyo = dy + o * s->out_ch;
+      for (u64 ci = 0; ci < s->in_ch; ++ci)
+        dx[ci] += c->K->dot(w + ci * s->out_ch, dyo, s->out_ch);
+    }
+  }
+}
+
+void ml_conv1d_backward_input(const ML_Conv1DShape* s, u64 n,
+                              const f32* dY, u64 lddy, const f32* W,
+                              f32* dX, u64 lddx, f32* cols) {
+  const ML_SimdKernels* K = ml_simd();
+  const u64 kc = s->kernel * s->in_ch;
+
+  if (!ml_conv1d_uses_gemm(s)) {
+    conv_bwd_job c = {
+      .s = s, .n = n, .dY = dY, .lddy = lddy, .W = W,
+      .out = dX, .ld_out = lddx, .K = K,
+    };
+    ml_parallel_for(n * s->steps,
+                    ml_parallel_grain(s->kernel * s->in_ch * s->out_ch, 1),
+                    conv_dx_steps, &c);
+    return;
+  }
+
+  // dP_i = dY_i W^T, then col2im scatters each patch row back onto its taps
+  for (u64 i = 0; i < n; ++i) {
+    f32* dx = dX + i * lddx;
+
+    K->fill(dx, s->steps * s->in_ch, 0.0f);
+    if (s->out_steps == 0) continue;
+
+    ml_gemm_f32(s->out_steps, kc, s->out_ch, dY + i * lddy, s->out_ch, 1,
+                W, 1, s->out_ch, cols, kc);
+    for (u64 o = 0; o < s->out_steps; ++o) {
+      f32* xo = dx + o * s->stride * s->in_ch;
+      const f32* row = cols + o * kc;
+      for (u64 k = 0; k < s->kernel; ++k)
+        K->add(xo + k * s->dilation * s->in_ch, row + k * s->in_ch, s->in_ch);
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Pooling                                                                     */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+  u64 steps;
+  u64 ch;
+  u64 out_steps;
+  u64 pool;
+  u64 stride;
+  const f32* X;
+  u64 ldx;
+  f32* Y;
+  u64 ldy;
+  u32* idx;
+  const u32* cidx;
+  const ML_SimdKernels* K;
+} pool_job;
+
+// One item is one output step of one sample
+static void maxpool_items(void* p, u64 begin, u64 end, u64 tid) {
+  const pool_job* c = p;
+  (void)tid;
+
+  for (u64 it = begin; it < end; ++it) {
+    const u64 i = it / c->out_steps;
+    const u64 o = it % c->out_steps;
+    const u64 t0 = o * c->stride;
+    const f32* x = c->X + i * c->ldx + t0 * c->ch;
+    f32* y = c->Y + i * c->ldy + o * c->ch;
+    c->K->copy(y, x, c->ch);
+
+    // Inference: no indices to keep
+    if (!c->idx) {
+      for (u64 q = 1; q < c->pool; ++q) {
+        const f32* xq = x + q * c->ch;
+        for (u64 j = 0; j < c->ch; ++j) y[j] = xq[j] > y[j] ? xq[j] : y[j];
+      }
+      continue;
+    }
+
+    u32* id = c->idx + it * c->ch;
+    for (u64 j = 0; j < c->ch; ++j) id[j] = (u32)t0;
+    for (u64 q = 1; q < c->pool; ++q) {
+      const f32* xq = x + q * c->ch;
+      for (u64 j = 0; j < c->ch; ++j) {
+        if (xq[j] > y[j]) {
+          y[j] = xq[j];
+          id[j] = (u32)(t0 + q);
+        }
+      }
+    }
+  }
+}
+
+void ml_maxpool1d_forward(u64 steps, u64 ch, u64 out_steps, u64 pool, u64 stride,
+                          u64 n, const f32* X, u64 ldx,
+                          f32* Y, u64 ldy, u32* idx) {
+  pool_job c = {
+    .steps = steps, .ch = ch, .out_steps = out_steps, .pool = pool,
+    .stride = stride, .X = X, .ldx = ldx, .Y = Y, .ldy = ldy, .idx = idx,
+    .K = ml_simd(),
+  };
+  ml_parallel_for(n * out_steps, ml_parallel_grain(pool * ch, 1), maxpool_items, &c);
+}
+
+// Overlapping windows can route two outputs to one input, so the scatter
+// runs per sample
+static void maxpool_bwd_samples(void* p, u64 begin, u64 end, u64 tid) {
+  const pool_job* c = p;
+  (void)tid;
+
+  for (u64 i = begin; i < end; ++i) {
+    const f32* dy = c->X + i * c->ldx;
+    const u32* id = c->cidx + i * c->out_steps * c->ch;
+    f32* dx = c->Y + i * c->ldy;
+
+    c->K->fill(dx, c->steps * c->ch, 0.0f);
+    for (u64 o = 0; o < c->out_steps; ++o)
+      for (u64 j = 0; j < c->ch; ++j)
+        dx[(u64)id[o * c->ch + j] * c->ch + j] += dy[o * c->ch + j];
+  }
+}
+
+void ml_maxpool1d_backward(u64 steps, u64 ch, u64 out_steps,
+                           u64 n, const f32* dY, u64 lddy, const u32* idx,
+                           f32* dX, u64 lddx) {
+  pool_job c = {
+    .steps = steps, .ch = ch, .out_steps = out_steps,
+    .X = dY, .ldx = lddy, .Y = dX, .ldy = lddx, .cidx = idx, .K = ml_simd(),
+  };
+  ml_parallel_for(n, ml_parallel_grain(steps * ch, 1), maxpool_bwd_samples, &c);
+}
+
+static void gap_fwd_samples(void* p, u64 begin, u64 end, u64 tid) {
+  const pool_job* c = p;
+  (void)tid;
+
+  for (u64 i = begin; i < end; ++i) {
+    const f32* x = c->X + i * c->ldx;
+    f32* y = c->Y + i * c->ldy;
+
+    c->K->fill(y, c->ch, 0.0f);
+    for (u64 t = 0; t < c->steps; ++t) c->K->add(y, x + t * c->ch, c->ch);
+    if (c->steps) c->K->scale(y, c->ch, 1.0f / (f32)c->steps);
+  }
+}
+
+void ml_gap1d_forward(u64 steps, u64 ch, u64 n,
+                      const f32* X, u64 ldx, f32* Y, u64 ldy) {
+  pool_job c = {
+    .steps = steps, .ch = ch, .X = X, .ldx = ldx, .Y = Y, .ldy = ldy,
+    .K = ml_simd(),
+  };
+  ml_parallel_for(n, ml_parallel_grain(steps * ch, 1), gap_fwd_samples, &c);
+}
+
+static void gap_bwd_samples(void* p, u64 begin, u64 end, u64 tid) {
+  const pool_job* c = p;
+  (void)tid;
+
+  for (u64 i = begin; i < end; ++i) {
+    const f32* dy = c->X + i * c->ldx;
+    f32* dx = c->Y + i * c->ldy;
+
+    for (u64 t = 0; t < c->steps; ++t) {
+      c->K->copy(dx + t * c->ch, dy, c->ch);
+      c->K->scale(dx + t * c->ch, c->ch, 1.0f / (f32)c->steps);
+    }
+  }
+}
+
+void ml_gap1d_backward(u64 steps, u64 ch, u64 n,
+                       const f32* dY, u64 lddy, f32* dX, u64 lddx) {
+  pool_job c = {
+    .steps = steps, .ch = ch, .X = dY, .ldx = lddy, .Y = dX, .ldy = lddx,
+    .K = ml_simd(),
+  };
+  ml_parallel_for(n, ml_parallel_grain(steps * ch, 1), gap_bwd_samples, &c);
+}
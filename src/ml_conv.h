@@ -0,0 +1,107 @@
+#ifndef ML_CONV_H
+#define ML_CONV_H
+
+#include "ml_defs.h"
+#include "ml_gemm.h"
+
+/**
+ * @file ml_conv.h
+ * @brief Internal 1-D convolution and pooling kernels.
+ *
+ * Every sample is one row of a batch matrix, laid out channels-last: T
+ * steps of C channels, element (t, c) at column t*C + c. The convolution
+ * weight is a packed (K*Cin x Cout) matrix whose row k*Cin + ci holds tap
+ * k of input channel ci, so one output step is the product of a K*Cin
+ * patch of the input with W. Padding is "valid":
+ * T_out = (T - dilation*(K - 1) - 1) / stride + 1.
+ *
+ * Kernels of at most ML_CONV_DIRECT_MAX_K taps run a direct loop blocked
+ * over output steps and channels so the accumulators stay in registers.
+ * Longer kernels go through the GEMM engine: with dilation 1 a patch is
+ * a contiguous K*Cin run and consecutive patches are stride*Cin apart, so
+ * the im2col matrix is just a strided view of the input; with dilation
+ * > 1 each sample is unfolded into the @p cols workspace first.
+ *
+ * Nothing is validated here; the operators in ml_operators.c check shapes
+ * and pointers once. Results do not depend on the thread count.
+ */
+
+/** @brief Longest kernel (in taps) the direct convolution loop handles. */
+#ifndef ML_CONV_DIRECT_MAX_K
+#define ML_CONV_DIRECT_MAX_K 8
+#endif
+
+/** @brief Geometry of a 1-D convolution over one sample. */
+typedef struct {
+  u64 steps;      // T
+  u64 in_ch;      // Cin
+  u64 out_steps;  // T_out
+  u64 out_ch;     // Cout
+  u64 kernel;     // K
+  u64 stride;
+  u64 dilation;
+} ML_Conv1DShape;
+
+/** @brief Non-zero when @p s runs the im2col + GEMM path. */
+static inline int ml_conv1d_uses_gemm(const ML_Conv1DShape* s) {
+  return s->kernel > ML_CONV_DIRECT_MAX_K;
+}
+
+/**
+ * @brief Floats of the @p cols workspace @p s needs (T_out x K*Cin on the
+ * GEMM path, 0 on the direct one). Backward always needs it on the GEMM
+ * path; forward only with dilation > 1.
+ */
+static inline u64 ml_conv1d_cols_len(const ML_Conv1DShape* s) {
+  return ml_conv1d_uses_gemm(s) ? s->out_steps * s->kernel * s->in_ch : 0;
+}
+
+/**
+ * @brief Y = act(conv(X, W) * scale + bias) for @p n samples.
+ *
+ * X is (n x T*Cin) with leading dimension @p ldx, Y (n x T_out*Cout) with
+ * @p ldy. @p ep supplies the bias and activation (NULL for none).
+ */
+void ml_conv1d_forward(const ML_Conv1DShape* s, u64 n,
+                       const f32* X, u64 ldx, const f32* W,
+                       const ML_GemmEpilogue* ep,
+                       f32* Y, u64 ldy, f32* cols);
+
+/**
+ * @brief dW = sum_n patches(X_n)^T dY_n and db = column sums of dY.
+ *
+ * @p dWn is a second (K*Cin x Cout) buffer the GEMM path uses for the
+ * per-sample products when n > 1; unused on the direct path.
+ */
+void ml_conv1d_backward_weights(const ML_Conv1DShape* s, u64 n,
+                                const f32* X, u64 ldx,
+                                const f32* dY, u64 lddy,
+                                f32* dW, f32* db, f32* dWn, f32* cols);
+
+/** @brief dX = the transposed convolution of dY with W. */
+void ml_conv1d_backward_input(const ML_Conv1DShape* s, u64 n,
+                              const f32* dY, u64 lddy, const f32* W,
+                              f32* dX, u64 lddx, f32* cols);
+
+/**
+ * @brief Y[o, c] = max over p < pool of X[o*stride + p, c], with the step
+ * that won recorded in idx (n x T_out*C entries, packed; NULL to skip).
+ */
+void ml_maxpool1d_forward(u64 steps, u64 ch, u64 out_steps, u64 pool, u64 stride,
+                          u64 n, const f32* X, u64 ldx,
+                          f32* Y, u64 ldy, u32* idx);
+
+/** @brief dX = 0, then dX[idx[o, c], c] += dY[o, c]. */
+void ml_maxpool1d_backward(u64 steps, u64 ch, u64 out_steps,
+                           u64 n, const f32* dY, u64 lddy, const u32* idx,
+                           f32* dX, u64 lddx);
+
+/** @brief Y[c] = mean over t of X[t, c] for each sample; Y is (n x C). */
+void ml_gap1d_forward(u64 steps, u64 ch, u64 n,
+                      const f32* X, u64 ldx, f32* Y, u64 ldy);
+
+/** @brief dX[t, c] = dY[c] / T for each sample. */
+void ml_gap1d_backward(u64 steps, u64 ch, u64 n,
+                       const f32* dY, u64 lddy, f32* dX, u64 lddx);
+
+#endif // ML_CONV_H
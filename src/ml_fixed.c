@@ -0,0 +1,355 @@
+#include "ml_fixed.h"
+#include "ml_alloc.h"
+#include "ml_error.h"
+#include "ml_primitives.h"
+
+#include <stddef.h>
+
+#define ML_Q15_MIN (-32768)
+#define ML_Q15_MAX 32767
+#define ML_Q7_MIN (-128)
+#define ML_Q7_MAX 127
+
+// Q7 x Q15 products are at most 2^22, so 256 of them always fit an i32
+#define ML_FIXED_Q7_BLOCK 256
+
+// log2(e) with 15 fractional bits
+#define ML_FIXED_LOG2E_Q15 47274u
+
+// 2^(-j/256) for j = 0..256, scaled by 2^15
+static const u16 fixed_exp2_lut[257] = {
+  32768, 32679, 32591, 32503, 32415, 32327, 32240, 32153, 32066, 31979,
+  31893, 31806, 31720, 31635, 31549, 31464, 31379, 31294, 31209, 31125,
+  31041, 30957, 30873, 30790, 30706, 30623, 30541, 30458, 30376, 30293,
+  30212, 30130, 30048, 29967, 29886, 29805, 29725, 29644, 29564, 29484,
+  29405, 29325, 29246, 29167, 29088, 29009, 28931, 28852, 28774, 28697,
+  28619, 28542, 28464, 28388, 28311, 28234, 28158, 28082, 28006, 27930,
+  27855, 27779, 27704, 27629, 27554, 27480, 27406, 27332, 27258, 27184,
+  27110, 27037, 26964, 26891, 26818, 26746, 26674, 26601, 26530, 26458,
+  26386, 26315, 26244, 26173, 26102, 26031, 25961, 25891, 25821, 25751,
+  25681, 25612, 25543, 25474, 25405, 25336, 25268, 25199, 25131, 25063,
+  24995, 24928, 24860, 24793, 24726, 24659, 24593, 24526, 24460, 24394,
+  24328, 24262, 24196, 24131, 24066, 24001, 23936, 23871, 23806, 23742,
+  23678, 23614, 23550, 23486, 23423, 23359, 23296, 23233, 23170, 23108,
+  23045, 22983, 22921, 22859, 22797, 22735, 22674, 22613, 22552, 22491,
+  22430, 22369, 22309, 22248, 22188, 22128, 22068, 22009, 21949, 21890,
+  21831, 21772, 21713, 21654, 21595, 21537, 21479, 21421, 21363, 21305,
+  21247, 21190, 21133, 21076, 21019, 20962, 20905, 20849, 20792, 20736,
+  20680, 20624, 20568, 20513, 20457, 20402, 20347, 20292, 20237, 20182,
+  20127, 20073, 20019, 19965, 19911, 19857, 19803, 19750, 19696, 19643,
+  19590, 19537, 19484, 19431, 19379, 19326, 19274, 19222, 19170, 19118,
+  19066, 19015, 18963, 18912, 18861, 18810, 18759, 18708, 18658, 18607,
+  18557, 18507, 18457, 18407, 18357, 18308, 18258, 18209, 18160, 18110,
+  18061, 18013, 17964, 17915, 17867, 17819, 17770, 17722, 17674, 17627,
+  17579, 17531, 17484, 17437, 17390, 17343, 17296, 17249, 17202, 17156,
+  17109, 17063, 17017, 16971, 16925, 16879, 16834, 16788, 16743, 16697,
+  16652, 16607, 16562, 16518, 16473, 16428, 16384,
+};
+
+static inline u64 matq15_ld(const Matq15 m) {
+  return m.stride ? m.stride : m.cols;
+}
+
+static inline u64 matq7_ld(const Matq7 m) {
+  return m.stride ? m.stride : m.cols;
+}
+
+static inline i64 fixed_sat(i64 v, i64 lo, i64 hi) {
+  return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// Round half away from zero and saturate to [lo, hi]. NaN slips past both
+// clamps and converting it is undefined, so it maps to 0.
+static inline i32 fixed_round(f32 v, i32 lo, i32 hi) {
+  if (!(v == v)) return 0;
+  if (v > (f32)hi) return hi;
+  if (v < (f32)lo) return lo;
+  return (i32)(v + (v >= 0.0f ? 0.5f : -0.5f));
+}
+
+// Rescale an accumulator by 2^-shift (rounding), add the bias, saturate
+static inline i16 fixed_requant(i64 acc, i32 shift, i64 bias) {
+  if (shift > 0) {
+    acc = (acc + ((i64)1 << (shift - 1))) >> shift;
+  } else if (shift < 0) {
+    // Anything beyond 2^32 saturates anyway; clamp so the shift cannot overflow
+    acc = fixed_sat(acc, -((i64)1 << 32), (i64)1 << 32) * ((i64)1 << -shift);
+  }
+  return (i16)fixed_sat(acc + bias, ML_Q15_MIN, ML_Q15_MAX);
+}
+
+static ML_Status fixed_check_bias(const Matq15* out, const Matq15* bias, u64 n) {
+  if (!bias) return ML_OK;
+  if (!bias->data || bias->rows != 1 || bias->cols != n) return ML_INVALID_ARGUMENT;
+  if (bias->frac != out->frac) return ML_INVALID_ARGUMENT;
+  return ML_OK;
+}
+
+ML_Status create_Matq15(ml_arena* arena, Matq15* dest, u64 rows, u64 cols, u8 frac) {
+  if (!arena || !dest) return ML_INVALID_ARGUMENT;
+  if (frac > ML_FIXED_MAX_FRAC) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+  void* data_ptr = NULL;
+
+  status = push_ml_arena(&data_ptr, arena, rows * cols * sizeof(i16));
+  if (status != ML_OK) return status;
+
+  dest->rows = rows;
+  dest->cols = cols;
+  dest->data = data_ptr;
+  dest->stride = cols;
+  dest->frac = frac;
+
+  return ML_OK;
+}
+
+ML_Status create_Matq7(ml_arena* arena, Matq7* dest, u64 rows, u64 cols, u8 frac) {
+  if (!arena || !dest) return ML_INVALID_ARGUMENT;
+  if (frac > ML_FIXED_MAX_FRAC) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+  void* data_ptr = NULL;
+
+  status = push_ml_arena(&data_ptr, arena, rows * cols * sizeof(i8));
+  if (status != ML_OK) return status;
+
+  dest->rows = rows;
+  dest->cols = cols;
+  dest->data = data_ptr;
+  dest->stride = cols;
+  dest->frac = frac;
+
+  return ML_OK;
+}
+
+u8 ml_fixed_frac_for(f32 absmax, ML_FixedType type) {
+  const f32 max = type == ML_FIXED_Q7 ? (f32)ML_Q7_MAX : (f32)ML_Q15_MAX;
+
+  // An all-zero tensor is exact in any format
+  if (!(absmax > 0.0f)) return type == ML_FIXED_Q7 ? 7 : 15;
+
+  u8 frac = 0;
+  f32 scaled = absmax;
+  while (frac < ML_FIXED_MAX_FRAC && scaled * 2.0f + 0.5f <= max) {
+    scaled *= 2.0f;
+    ++frac;
+  }
+  return frac;
+}
+
+ML_Status Mat_to_Matq15(Matq15* dest, const Matf32 src, ML_Transpose src_t) {
+  if (!dest) return ML_INVALID_ARGUMENT;
+  if (!dest->data || !src.data) return ML_INVALID_ARGUMENT;
+  if (src_t != ML_NO_TRANS && src_t != ML_TRANS) return ML_INVALID_ARGUMENT;
+
+  // Logical source op(src) is (rows x cols) with strides (rs, cs)
+  const u64 rows = src_t == ML_TRANS ? src.cols : src.rows;
+  const u64 cols = src_t == ML_TRANS ? src.rows : src.cols;
+  const u64 rs = src_t == ML_TRANS ? 1 : Mat_ld(src);
+  const u64 cs = src_t == ML_TRANS ? Mat_ld(src) : 1;
+
+  if (dest->rows != rows || dest->cols != cols) return ML_INVALID_ARGUMENT;
+
+  const f32 scale = (f32)((u32)1 << dest->frac);
+  const u64 ld = matq15_ld(*dest);
+
+  for (u64 r = 0; r < rows; ++r) {
+    const f32* in = src.data + r * rs;
+    i16* q = dest->data + r * ld;
+    for (u64 c = 0; c < cols; ++c)
+      q[c] = (i16)fixed_round(in[c * cs] * scale, ML_Q15_MIN, ML_Q15_MAX);
+  }
+
+  return ML_OK;
+}
+
+ML_Status Mat_to_Matq7(Matq7* dest, const Matf32 src, ML_Transpose src_t) {
+  if (!dest) return ML_INVALID_ARGUMENT;
+  if (!dest->data || !src.data) return ML_INVALID_ARGUMENT;
+  if (src_t != ML_NO_TRANS && src_t != ML_TRANS) return ML_INVALID_ARGUMENT;
+
+  const u64 rows = src_t == ML_TRANS ? src.cols : src.rows;
+  const u64 cols = src_t == ML_TRANS ? src.rows : src.cols;
+  const u64 rs = src_t == ML_TRANS ? 1 : Mat_ld(src);
+  const u64 cs = src_t == ML_TRANS ? Mat_ld(src) : 1;
+
+  if (dest->rows != rows || dest->cols != cols) return ML_INVALID_ARGUMENT;
+
+  const f32 scale = (f32)((u32)1 << dest->frac);
+  const u64 ld = matq7_ld(*dest);
+
+  for (u64 r = 0; r < rows; ++r) {
+    const f32* in = src.data + r * rs;
+    i8* q = dest->data + r * ld;
+    for (u64 c = 0; c < cols; ++c)
+      q[c] = (i8)fixed_round(in[c * cs] * scale, ML_Q7_MIN, ML_Q7_MAX);
+  }
+
+  return ML_OK;
+}
+
+ML_Status Matq15_to_Mat(Matf32* dest, const Matq15 src) {
+  if (!dest) return ML_INVALID_ARGUMENT;
+  if (!dest->data || !src.data) return ML_INVALID_ARGUMENT;
+  if (dest->rows != src.rows || dest->cols != src.cols) return ML_INVALID_ARGUMENT;
+
+  const f32 inv = 1.0f / (f32)((u32)1 << src.frac);
+  const u64 ld = matq15_ld(src);
+
+  for (u64 r = 0; r < src.rows; ++r) {
+    const i16* q = src.data + r * ld;
+    f32* out = Mat_row_ptr(*dest, r);
+    for (u64 c = 0; c < src.cols; ++c) out[c] = (f32)q[c] * inv;
+  }
+
+  return ML_OK;
+}
+
+static i64 fixed_dot_q15_q7(const i16* x, const i8* w, u64 n) {
+  i64 acc = 0;
+  for (u64 i0 = 0; i0 < n; i0 += ML_FIXED_Q7_BLOCK) {
+    const u64 i1 = i0 + ML_FIXED_Q7_BLOCK < n ? i0 + ML_FIXED_Q7_BLOCK : n;
+    i32 s = 0;
+    for (u64 i = i0; i < i1; ++i) s += (i32)x[i] * (i32)w[i];
+    acc += s;
+  }
+  return acc;
+}
+
+static i64 fixed_dot_q15_q15(const i16* x, const i16* w, u64 n) {
+  i64 acc = 0;
+  for (u64 i = 0; i < n; ++i) acc += (i32)x[i] * (i32)w[i];
+  return acc;
+}
+
+ML_Status Matq15_Mul_Matq7_trans_into(Matq15* out, const Matq15 lhs,
+                                      const Matq7 rhs_t, const Matq15* bias) {
+  if (!out) return ML_INVALID_ARGUMENT;
+  if (!out->data || !lhs.data || !rhs_t.data) return ML_INVALID_ARGUMENT;
+
+  if (lhs.cols != rhs_t.cols) return ML_INVALID_ARGUMENT;
+  if (out->rows != lhs.rows || out->cols != rhs_t.rows) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = fixed_check_bias(out, bias, rhs_t.rows);
+  if (status != ML_OK) return status;
+
+  const i32 shift = (i32)lhs.frac + (i32)rhs_t.frac - (i32)out->frac;
+  const u64 ld_a = matq15_ld(lhs);
+  const u64 ld_b = matq7_ld(rhs_t);
+  const u64 ld_c = matq15_ld(*out);
+
+  for (u64 i = 0; i < lhs.rows; ++i) {
+    const i16* a = lhs.data + i * ld_a;
+    i16* c = out->data + i * ld_c;
+    for (u64 j = 0; j < rhs_t.rows; ++j) {
+      const i64 acc = fixed_dot_q15_q7(a, rhs_t.data + j * ld_b, lhs.cols);
+      c[j] = fixed_requant(acc, shift, bias ? bias->data[j] : 0);
+    }
+  }
+
+  return ML_OK;
+}
+
+ML_Status Matq15_Mul_Matq15_trans_into(Matq15* out, const Matq15 lhs,
+                                       const Matq15 rhs_t, const Matq15* bias) {
+  if (!out) return ML_INVALID_ARGUMENT;
+  if (!out->data || !lhs.data || !rhs_t.data) return ML_INVALID_ARGUMENT;
+
+  if (lhs.cols != rhs_t.cols) return ML_INVALID_ARGUMENT;
+  if (out->rows != lhs.rows || out->cols != rhs_t.rows) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = fixed_check_bias(out, bias, rhs_t.rows);
+  if (status != ML_OK) return status;
+
+  const i32 shift = (i32)lhs.frac + (i32)rhs_t.frac - (i32)out->frac;
+  const u64 ld_a = matq15_ld(lhs);
+  const u64 ld_b = matq15_ld(rhs_t);
+  const u64 ld_c = matq15_ld(*out);
+
+  for (u64 i = 0; i < lhs.rows; ++i) {
+    const i16* a = lhs.data + i * ld_a;
+    i16* c = out->data + i * ld_c;
+    for (u64 j = 0; j < rhs_t.rows; ++j) {
+      const i64 acc = fixed_dot_q15_q15(a, rhs_t.data + j * ld_b, lhs.cols);
+      c[j] = fixed_requant(acc, shift, bias ? bias->data[j] : 0);
+    }
+  }
+
+  return ML_OK;
+}
+
+// exp(-u / 2^frac) scaled by 2^15, for u >= 0
+static u32 fixed_exp_neg(u32 u, u8 frac) {
+  // t = u * log2(e) with frac + 15 fractional bits: exp(-x) = 2^-t
+  const u32 tf = (u32)frac + 15;
+  const u64 t = (u64)u * ML_FIXED_LOG2E_Q15;
+  const u64 k = t >> tf;
+  if (k >= 16) return 0;
+
+  // Fractional part of t as a 16-bit fraction: 8 bits index, 8 interpolate
+  const u64 r = t & (((u64)1 << tf) - 1);
+  const u32 r16 = (u32)(tf <= 16 ? r << (16 - tf) : r >> (tf - 16));
+  const u32 j = r16 >> 8;
+  const u32 w = r16 & 0xffu;
+
+  const u32 hi = fixed_exp2_lut[j];
+  const u32 lo = fixed_exp2_lut[j + 1];
+  const u32 e = hi - (((hi - lo) * w + 128u) >> 8);
+
+  return (e + (((u32)1 << k) >> 1)) >> k;
+}
+
+ML_Status Matq15_softmax_into(Matq15* out, const Matq15 in) {
+  if (!out) return ML_INVALID_ARGUMENT;
+  if (!out->data || !in.data) return ML_INVALID_ARGUMENT;
+  if (out->rows != in.rows || out->cols != in.cols) return ML_INVALID_ARGUMENT;
+  if (in.rows != 0 && in.cols == 0) return ML_INVALID_ARGUMENT;
+
+  const u8 frac = in.frac;
+  const u64 ld_in = matq15_ld(in);
+  const u64 ld_out = matq15_ld(*out);
+
+  for (u64 r = 0; r < in.rows; ++r) {
+    const i16* z = in.data + r * ld_in;
+    i16* p = out->data + r * ld_out;
+
+    i32 m = z[0];
+    for (u64 c = 1; c < in.cols; ++c) if (z[c] > m) m = z[c];
+
+    // The max maps to exp(0) = 2^15, so the sum is never zero. Values are
+    // staged in p as e - 2^15 so they fit 16 bits until normalised.
+    u64 sum = 0;
+    for (u64 c = 0; c < in.cols; ++c) {
+      const u32 e = fixed_exp_neg((u32)(m - (i32)z[c]), frac);
+      sum += e;
+      p[c] = (i16)((i32)e - 32768);
+    }
+
+    for (u64 c = 0; c < in.cols; ++c) {
+      const u64 e = (u64)((i32)p[c] + 32768);
+      const u64 q = ((e << ML_FIXED_PROB_FRAC) + sum / 2) / sum;
+      p[c] = (i16)(q > ML_Q15_MAX ? ML_Q15_MAX : q);
+    }
+  }
+
+  out->frac = ML_FIXED_PROB_FRAC;
+
+  return ML_OK;
+}
+
+ML_Status Matq15_argmax_rows(const Matq15 in, u64* out_idx) {
+  if (!out_idx || !in.data) return ML_INVALID_ARGUMENT;
+  if (in.rows != 0 && in.cols == 0) return ML_INVALID_ARGUMENT;
+
+  const u64 ld = matq15_ld(in);
+
+  for (u64 r = 0; r < in.rows; ++r) {
+    const i16* z = in.data + r * ld;
+    u64 best = 0;
+    for (u64 c = 1; c < in.cols; ++c) if (z[c] > z[best]) best = c;
+    out_idx[r] = best;
+  }
+
+  return ML_OK;
+}
@@ -0,0 +1,197 @@
+#include "ml_fuse.h"
+#include "ml_error.h"
+#include "ml_kernels.h"
+#include "ml_primitives.h"
+#include "ml_simd.h"
+#include "ml_thread.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+static ML_Status fuse_check_op(const ML_FuseOp* op, const Matf32 out) {
+  const Matf32 v = op->operand;
+  const u64 rows = out.rows;
+  const u64 cols = out.cols;
+
+  // Rows of out are written while other chunks still read the operand
+  if (v.data && mat_overlaps(v, out)) return ML_INVALID_ARGUMENT;
+
+  switch (op->kind) {
+   case ML_FUSE_ADD_ROWVEC:
+     if (!v.data || v.rows != 1 || v.cols != cols) return ML_INVALID_ARGUMENT;
+     return ML_OK;
+   case ML_FUSE_SUB_COLVEC:
+   case ML_FUSE_DIV_COLVEC:
+     if (!v.data || v.rows != rows || v.cols != 1) return ML_INVALID_ARGUMENT;
+     return ML_OK;
+   case ML_FUSE_ADD_MAT:
+   case ML_FUSE_SUB_MAT:
+     if (!v.data || v.rows != rows || v.cols != cols) return ML_INVALID_ARGUMENT;
+     return ML_OK;
+   case ML_FUSE_SCALE:
+   case ML_FUSE_ADD_SCALAR:
+   case ML_FUSE_EXP:
+     return ML_OK;
+   case ML_FUSE_SUB_ROWMAX:
+     // max of an empty row is undefined
+     if (rows != 0 && cols == 0) return ML_INVALID_ARGUMENT;
+     if (v.data && (v.rows != rows || v.cols != 1)) return ML_INVALID_ARGUMENT;
+     return ML_OK;
+   case ML_FUSE_DIV_ROWSUM:
+     if (v.data && (v.rows != rows || v.cols != 1)) return ML_INVALID_ARGUMENT;
+     return ML_OK;
+   default:
+     return ML_INVALID_ARGUMENT;
+  }
+}
+
+// Apply every op to one row x (length n) of logical row index r
+static ML_Status fuse_row(const ML_SimdKernels* K, f32* x, u64 r, u64 n,
+                          const ML_FuseOp* ops, u64 n_ops) {
+  for (u64 i = 0; i < n_ops; ++i) {
+    const ML_FuseOp* op = &ops[i];
+    const Matf32 v = op->operand;
+    const u64 ld = Mat_ld(v);
+
+    switch (op->kind) {
+     case ML_FUSE_ADD_ROWVEC:
+       K->add(x, v.data, n);
+       break;
+     case ML_FUSE_SUB_COLVEC:
+       K->add_scalar(x, n, -v.data[r * ld]);
+       break;
+     case ML_FUSE_DIV_COLVEC: {
+       f32 d = v.data[r * ld];
+       if (d == 0.0f) return ML_INVALID_ARGUMENT;
+       K->scale(x, n, 1.0f / d);
+       break;
+     }
+     case ML_FUSE_ADD_MAT:
+       K->add(x, v.data + r * ld, n);
+       break;
+     case ML_FUSE_SUB_MAT:
+       K->axpy(x, v.data + r * ld, n, -1.0f);
+       break;
+     case ML_FUSE_SCALE:
+       K->scale(x, n, op->scalar);
+       break;
+     case ML_FUSE_ADD_SCALAR:
+       K->add_scalar(x, n, op->scalar);
+       break;
+     case ML_FUSE_EXP:
+       K->exp(x, n);
+       break;
+     case ML_FUSE_SUB_ROWMAX: {
+       f32 m = K->max(x, n);
+       if (v.data) v.data[r * ld] = m;
+       K->add_scalar(x, n, -m);
+       break;
+     }
+     case ML_FUSE_DIV_ROWSUM: {
+       f32 s = K->sum(x, n);
+       if (v.data) v.data[r * ld] = s;
+       if (s == 0.0f) return ML_INVALID_ARGUMENT;
+       K->scale(x, n, 1.0f / s);
+       break;
+     }
+     default:
+       return ML_INVALID_ARGUMENT;
+    }
+  }
+
+  return ML_OK;
+}
+
+// Rows of one fused call, shared by the chunks of a parallel loop
+typedef struct {
+  Matf32 out;
+  const void* in;
+  u64 ld_in;
+  void (*widen)(f32*, const u16*, u64); // NULL for an f32 input
+  const ML_FuseOp* ops;
+  u64 n_ops;
+  atomic_int status;  // first failure of any chunk, ML_OK otherwise
+} fuse_job;
+
+static void fuse_rows(void* p, u64 begin, u64 end, u64 tid) {
+  fuse_job* job = p;
+  const ML_SimdKernels* K = ml_simd();
+  const u64 ld_out = Mat_ld(job->out);
+  (void)tid;
+
+  for (u64 r = begin; r < end; ++r) {
+    f32* x = job->out.data + r * ld_out;
+
+    // Load the row once; everything after runs on the cached copy in out
+    if (job->widen)
+      job->widen(x, (const u16*)job->in + r * job->ld_in, job->out.cols);
+    else
+      K->copy(x, (const f32*)job->in + r * job->ld_in, job->out.cols);
+
+    ML_Status status = fuse_row(K, x, r, job->out.cols, job->ops, job->n_ops);
+    if (status != ML_OK) {
+      int ok = ML_OK;
+      atomic_compare_exchange_strong(&job->status, &ok, (int)status);
+      return;
+    }
+  }
+}
+
+ML_Status Mat_fused_into(Matf32* out, const Matf32 in,
+                         const ML_FuseOp* ops, u64 n_ops) {
+  if (!out) return ML_INVALID_ARGUMENT;
+  if (!out->data || !in.data) return ML_INVALID_ARGUMENT;
+  if (n_ops != 0 && !ops) return ML_INVALID_ARGUMENT;
+
+  if (out->rows != in.rows || out->cols != in.cols) return ML_INVALID_ARGUMENT;
+  if (!mat_same_or_disjoint(*out, in)) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  for (u64 i = 0; i < n_ops; ++i) {
+    status = fuse_check_op(&ops[i], *out);
+    if (status != ML_OK) return status;
+  }
+
+  fuse_job job = {
+    .out = *out, .in = in.data, .ld_in = Mat_ld(in),
+    .ops = ops, .n_ops = n_ops, .status = ML_OK,
+  };
+
+  ml_parallel_for(in.rows, ml_parallel_grain(in.cols * (n_ops + 1), 1), fuse_rows, &job);
+
+  return (ML_Status)atomic_load(&job.status);
+}
+
+ML_Status Mat16_fused_into(Matf32* out, const Mat16 in,
+                           const ML_FuseOp* ops, u64 n_ops) {
+  if (!out) return ML_INVALID_ARGUMENT;
+  if (!out->data || !in.data) return ML_INVALID_ARGUMENT;
+  if (in.format != ML_HALF_F16 && in.format != ML_HALF_BF16) return ML_INVALID_ARGUMENT;
+  if (n_ops != 0 && !ops) return ML_INVALID_ARGUMENT;
+
+  if (out->rows != in.rows || out->cols != in.cols) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  for (u64 i = 0; i < n_ops; ++i) {
+    status = fuse_check_op(&ops[i], *out);
+    if (status != ML_OK) return status;
+  }
+
+  const ML_SimdKernels* K = ml_simd();
+  fuse_job job = {
+    .out = *out, .in = in.data, .ld_in = Mat16_ld(in),
+    .widen = in.format == ML_HALF_BF16 ? K->bf16_to_f32 : K->f16_to_f32,
+    .ops = ops, .n_ops = n_ops, .status = ML_OK,
+  };
+
+  ml_parallel_for(in.rows, ml_parallel_grain(in.cols * (n_ops + 1), 1), fuse_rows, &job);
+
+  return (ML_Status)atomic_load(&job.status);
+}
+
+ML_Status Mat_fused_inplace(Matf32* target, const ML_FuseOp* ops, u64 n_ops) {
+  if (!target) return ML_INVALID_ARGUMENT;
+  return Mat_fused_into(target, *target, ops, n_ops);
+}
@@ -0,0 +1,491 @@
+#include "ml_gemm.h"
+#include "ml_kernels.h"
+#include "ml_simd.h"
+#include "ml_half_conv.h"
+#include "ml_pool.h"
+#include "ml_thread.h"
+
+#include <stddef.h>
+#include <string.h>
+
+static inline u64 gemm_min(u64 a, u64 b) { return a < b ? a : b; }
+
+// Columns of B widened to f32 at a time on the mixed direct path
+#define ML_GEMM_ROW_CHUNK 256
+
+static inline const void* gemm_at(const void* p, ML_GemmElem t, u64 off) {
+  if (t == ML_GEMM_F32) return (const f32*)p + off;
+  return (const u16*)p + off;
+}
+
+static inline f32 gemm_load(const void* p, ML_GemmElem t, u64 off) {
+  switch (t) {
+   case ML_GEMM_F16:  return ml_f16_to_f32(((const u16*)p)[off]);
+   case ML_GEMM_BF16: return ml_bf16_to_f32(((const u16*)p)[off]);
+   default:           return ((const f32*)p)[off];
+  }
+}
+
+// Widen a contiguous run of n elements to f32
+static inline void gemm_load_run(const ML_SimdKernels* K, f32* dst,
+                                 const void* src, ML_GemmElem t, u64 n) {
+  switch (t) {
+   case ML_GEMM_F16:  K->f16_to_f32(dst, (const u16*)src, n); break;
+   case ML_GEMM_BF16: K->bf16_to_f32(dst, (const u16*)src, n); break;
+   default:           memcpy(dst, src, (size_t)n * sizeof(f32)); break;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Epilogue                                                                    */
+/* -------------------------------------------------------------------------- */
+
+// Finish a (rows x cols) block of C whose first column is column j0 of the
+// full product. Called on blocks that were just written, so they are
+// still in L1.
+static void gemm_epilogue(const ML_SimdKernels* K, const ML_GemmEpilogue* ep,
+                          f32* c, u64 ldc, u64 rows, u64 cols, u64 j0) {
+  for (u64 r = 0; r < rows; ++r) {
+    f32* row = c + r * ldc;
+    if (ep->scale != 1.0f) K->scale(row, cols, ep->scale);
+    if (ep->bias) K->add(row, ep->bias + j0, cols);
+    if (ep->act != ML_ACT_NONE) K->act(row, row, cols, ep->act, ep->alpha);
+  }
+}
+
+ML_Status ml_gemm_epilogue_from(ML_GemmEpilogue* out, const Matf32 C,
+                                const ML_Epilogue* ep) {
+  if (!out) return ML_INVALID_ARGUMENT;
+  if (!ep) return ML_OK;
+
+  if ((u32)ep->act > (u32)ML_ACT_GELU) return ML_INVALID_ARGUMENT;
+
+  const Matf32 b = ep->bias;
+  if (b.data) {
+    if (b.rows != 1 || b.cols != C.cols) return ML_INVALID_ARGUMENT;
+    // The bias is read while C is written
+    const f32* c_end = C.data + (C.rows ? (C.rows - 1) * Mat_ld(C) + C.cols : 0);
+    if (C.rows && C.cols && b.data < c_end && C.data < b.data + b.cols)
+      return ML_INVALID_ARGUMENT;
+  }
+
+  out->scale = ep->scale;
+  out->bias = b.data;
+  out->act = ep->act;
+  out->alpha = ep->alpha;
+  return ML_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Direct path                                                                 */
+/* -------------------------------------------------------------------------- */
+
+// When B rows are contiguous, C row i accumulates a[i,p] * B row p: every
+// access is unit-stride and B is streamed row by row instead of down columns.
+// When B is transposed its columns are contiguous instead, so each C element
+// becomes a dot product of two unit-stride runs (if A rows are contiguous).
+// Each row of C is finished by the epilogue right after it is complete.
+static void gemm_direct(u64 m, u64 n, u64 k,
+                        const f32* A, u64 rs_a, u64 cs_a,
+                        const f32* B, u64 rs_b, u64 cs_b,
+                        f32* C, u64 ldc, const ML_GemmEpilogue* ep) {
+  const ML_SimdKernels* K = ml_simd();
+
+  if (cs_b == 1) {
+    for (u64 i = 0; i < m; ++i) {
+      f32* c = C + i * ldc;
+      const f32* a = A + i * rs_a;
+
+      K->fill(c, n, 0.0f);
+      for (u64 p = 0; p < k; ++p) K->axpy(c, B + p * rs_b, n, a[p * cs_a]);
+      if (ep) gemm_epilogue(K, ep, c, ldc, 1, n, 0);
+    }
+    return;
+  }
+
+  if (cs_a == 1 && rs_b == 1) {
+    for (u64 i = 0; i < m; ++i) {
+      for (u64 j = 0; j < n; ++j)
+        C[i * ldc + j] = K->dot(A + i * rs_a, B + j * cs_b, k);
+      if (ep) gemm_epilogue(K, ep, C + i * ldc, ldc, 1, n, 0);
+    }
+    return;
+  }
+
+  for (u64 i = 0; i < m; ++i) {
+    for (u64 j = 0; j < n; ++j) {
+      f32 sum = 0.0f;
+      for (u64 p = 0; p < k; ++p)
+        sum += A[i * rs_a + p * cs_a] * B[p * rs_b + j * cs_b];
+      C[i * ldc + j] = sum;
+    }
+    if (ep) gemm_epilogue(K, ep, C + i * ldc, ldc, 1, n, 0);
+  }
+}
+
+// 16-bit operands: widen one chunk of a B row at a time and sweep every C
+// row with it, so each B element is converted once rather than m times
+static void gemm_direct_mixed(u64 m, u64 n, u64 k,
+                              const void* A, ML_GemmElem ta, u64 rs_a, u64 cs_a,
+                              const void* B, ML_GemmElem tb, u64 rs_b, u64 cs_b,
+                              f32* C, u64 ldc, const ML_GemmEpilogue* ep) {
+  const ML_SimdKernels* K = ml_simd();
+  f32 brow[ML_GEMM_ROW_CHUNK];
+
+  for (u64 j0 = 0; j0 < n; j0 += ML_GEMM_ROW_CHUNK) {
+    const u64 nc = gemm_min(ML_GEMM_ROW_CHUNK, n - j0);
+
+    for (u64 i = 0; i < m; ++i) K->fill(C + i * ldc + j0, nc, 0.0f);
+
+    for (u64 p = 0; p < k; ++p) {
+      if (cs_b == 1) {
+        gemm_load_run(K, brow, gemm_at(B, tb, p * rs_b + j0), tb, nc);
+      } else {
+        for (u64 j = 0; j < nc; ++j) brow[j] = gemm_load(B, tb, p * rs_b + (j0 + j) * cs_b);
+      }
+
+      for (u64 i = 0; i < m; ++i)
+        K->axpy(C + i * ldc + j0, brow, nc, gemm_load(A, ta, i * rs_a + p * cs_a));
+    }
+
+    if (ep) gemm_epilogue(K, ep, C + j0, ldc, m, nc, j0);
+  }
+}
+
+// Operands of one product, shared by the chunks of a parallel loop
+typedef struct {
+  u64 m, n, k;
+  const void* A;
+  ML_GemmElem ta;
+  u64 rs_a, cs_a;
+  const void* B;
+  ML_GemmElem tb;
+  u64 rs_b, cs_b;
+  f32* C;
+  u64 ldc;
+  const ML_GemmEpilogue* ep;  // NULL for none
+  // Blocked path only: current block and its task grid
+  u64 jc, nc, pc, kc;
+  u64 col_groups, group_nc;
+  // Pack panels borrowed from the pool: one A panel of packA_len floats
+  // per thread, one B panel shared by all of them
+  f32* packA;
+  u64 packA_len;
+  f32* packB;
+} gemm_job;
+
+// Rows [begin, end) of C on the direct path. Every C element is still
+// accumulated in the serial order, whichever rows a chunk holds.
+static void gemm_direct_rows(void* p, u64 begin, u64 end, u64 tid) {
+  const gemm_job* g = p;
+  (void)tid;
+
+  if (g->ta == ML_GEMM_F32 && g->tb == ML_GEMM_F32) {
+    gemm_direct(end - begin, g->n, g->k,
+                (const f32*)g->A + begin * g->rs_a, g->rs_a, g->cs_a,
+                g->B, g->rs_b, g->cs_b, g->C + begin * g->ldc, g->ldc, g->ep);
+    return;
+  }
+
+  gemm_direct_mixed(end - begin, g->n, g->k,
+                    gemm_at(g->A, g->ta, begin * g->rs_a), g->ta, g->rs_a, g->cs_a,
+                    g->B, g->tb, g->rs_b, g->cs_b, g->C + begin * g->ldc, g->ldc, g->ep);
+}
+
+#if ML_GEMM_PACKED
+
+/* -------------------------------------------------------------------------- */
+/* Packing                                                                     */
+/* -------------------------------------------------------------------------- */
+
+// The panels are owned by the pool (ml_pool.h) and start on a cache line,
+// as the micro-kernels use aligned B loads
+
+// Pack an (mc x kc) block of A into MR-row micro-panels.
+// Panel layout: for each p, MR consecutive values A[i..i+MR, p].
+// Rows past mc are zero padded so the kernel never branches.
+// 16-bit operands are widened here, so the micro-kernel only sees f32.
+static void gemm_pack_A(const ML_SimdKernels* K, u64 MR, u64 mc, u64 kc,
+                        const void* A, ML_GemmElem ta, u64 rs_a, u64 cs_a,
+                        f32* dst) {
+  for (u64 i = 0; i < mc; i += MR) {
+    const u64 mr = gemm_min(MR, mc - i);
+    const void* a = gemm_at(A, ta, i * rs_a);
+
+    if (mr == MR && rs_a == 1) {
+      // Transposed A: the MR values of each step are already contiguous
+      for (u64 p = 0; p < kc; ++p) {
+        gemm_load_run(K, dst, gemm_at(a, ta, p * cs_a), ta, MR);
+        dst += MR;
+      }
+      continue;
+    }
+
+    if (ta == ML_GEMM_F32) {
+      const f32* af = a;
+      for (u64 p = 0; p < kc; ++p) {
+        u64 r = 0;
+        for (; r < mr; ++r) dst[r] = af[r * rs_a + p * cs_a];
+        for (; r < MR; ++r) dst[r] = 0.0f;
+        dst += MR;
+      }
+      continue;
+    }
+
+    for (u64 p = 0; p < kc; ++p) {
+      u64 r = 0;
+      for (; r < mr; ++r) dst[r] = gemm_load(a, ta, r * rs_a + p * cs_a);
+      for (; r < MR; ++r) dst[r] = 0.0f;
+      dst += MR;
+    }
+  }
+}
+
+// Pack a (kc x nc) block of B into NR-column micro-panels.
+// Panel layout: for each p, NR consecutive values B[p, j..j+NR].
+static void gemm_pack_B(const ML_SimdKernels* K, u64 NR, u64 kc, u64 nc,
+                        const void* B, ML_GemmElem tb, u64 rs_b, u64 cs_b,
+                        f32* dst) {
+  for (u64 j = 0; j < nc; j += NR) {
+    const u64 nr = gemm_min(NR, nc - j);
+    const void* b = gemm_at(B, tb, j * cs_b);
+
+    if (nr == NR && cs_b == 1) {
+      for (u64 p = 0; p < kc; ++p) {
+        gemm_load_run(K, dst, gemm_at(b, tb, p * rs_b), tb, NR);
+        dst += NR;
+      }
+      continue;
+    }
+
+    if (tb == ML_GEMM_F32) {
+      const f32* bf = b;
+      for (u64 p = 0; p < kc; ++p) {
+        u64 c = 0;
+        for (; c < nr; ++c) dst[c] = bf[p * rs_b + c * cs_b];
+        for (; c < NR; ++c) dst[c] = 0.0f;
+        dst += NR;
+      }
+      continue;
+    }
+
+    for (u64 p = 0; p < kc; ++p) {
+      u64 c = 0;
+      for (; c < nr; ++c) dst[c] = gemm_load(b, tb, p * rs_b + c * cs_b);
+      for (; c < NR; ++c) dst[c] = 0.0f;
+      dst += NR;
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Edge tiles                                                                  */
+/* -------------------------------------------------------------------------- */
+
+// Partial tile at the bottom/right edge: run the full kernel into a
+// scratch tile and only write back the valid (mr x nr) corner.
+static void gemm_kernel_edge(const ML_SimdKernels* K, u64 mr, u64 nr, u64 kc,
+                             const f32* a, const f32* b,
+                             f32* c, u64 ldc, int accumulate) {
+  _Alignas(64) f32 tile[ML_SIMD_GEMM_MR_MAX * ML_SIMD_GEMM_NR_MAX];
+  const u64 NR = K->gemm_nr;
+
+  K->gemm_kernel(kc, a, b, tile, NR, 0);
+
+  for (u64 r = 0; r < mr; ++r) {
+    for (u64 j = 0; j < nr; ++j) {
+      f32 v = tile[r * NR + j];
+      c[r * ldc + j] = accumulate ? c[r * ldc + j] + v : v;
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Blocked driver                                                              */
+/* -------------------------------------------------------------------------- */
+
+// NR panels [begin, end) of the current B block
+static void gemm_pack_B_panels(void* p, u64 begin, u64 end, u64 tid) {
+  const gemm_job* g = p;
+  const ML_SimdKernels* K = ml_simd();
+  const u64 NR = K->gemm_nr;
+  const u64 j0 = begin * NR;
+  const u64 j1 = gemm_min(end * NR, g->nc);
+  (void)tid;
+
+  gemm_pack_B(K, NR, g->kc, j1 - j0,
+              gemm_at(g->B, g->tb, g->pc * g->rs_b + (g->jc + j0) * g->cs_b), g->tb,
+              g->rs_b, g->cs_b, g->packB + j0 * g->kc);
+}
+
+// Tasks [begin, end) of the current block. A task is one MC block of rows
+// times one group of NR panels; it packs its own A panel into the thread's
+// buffer and runs the micro-kernel over its tiles.
+static void gemm_block_tasks(void* p, u64 begin, u64 end, u64 tid) {
+  const gemm_job* g = p;
+  const ML_SimdKernels* K = ml_simd();
+  const u64 MR = K->gemm_mr;
+  const u64 NR = K->gemm_nr;
+  const u64 kc = g->kc;
+  // First depth block overwrites C, later ones accumulate; the last one
+  // finishes each tile with the epilogue while it is still in L1.
+  const int accumulate = g->pc != 0;
+  const ML_GemmEpilogue* ep = g->pc + kc == g->k ? g->ep : NULL;
+  f32* packA = g->packA + tid * g->packA_len;
+
+  for (u64 t = begin; t < end; ++t) {
+    const u64 ic = (t / g->col_groups) * ML_GEMM_MC;
+    const u64 j0 = (t % g->col_groups) * g->group_nc;
+    const u64 mc = gemm_min(ML_GEMM_MC, g->m - ic);
+
+    if (j0 >= g->nc) continue;
+    const u64 j1 = gemm_min(j0 + g->group_nc, g->nc);
+
+    gemm_pack_A(K, MR, mc, kc, gemm_at(g->A, g->ta, ic * g->rs_a + g->pc * g->cs_a), g->ta,
+                g->rs_a, g->cs_a, packA);
+
+    for (u64 jr = j0; jr < j1; jr += NR) {
+      const u64 nr = gemm_min(NR, g->nc - jr);
+      const f32* bp = g->packB + jr * kc;
+
+      for (u64 ir = 0; ir < mc; ir += MR) {
+        const u64 mr = gemm_min(MR, mc - ir);
+        const f32* ap = packA + ir * kc;
+        f32* c = g->C + (ic + ir) * g->ldc + g->jc + jr;
+
+        if (mr == MR && nr == NR)
+          K->gemm_kernel(kc, ap, bp, c, g->ldc, accumulate);
+        else
+          gemm_kernel_edge(K, mr, nr, kc, ap, bp, c, g->ldc, accumulate);
+
+        if (ep) gemm_epilogue(K, ep, c, g->ldc, mr, nr, g->jc + jr);
+      }
+    }
+  }
+}
+
+// Returns 0 without touching C when the pool is held by someone else or
+// has no pack panels
+static int gemm_blocked(gemm_job* g) {
+  const ML_PoolScratch* scratch = ml_pool_acquire();
+  if (!scratch) return 0;
+
+  const ML_SimdKernels* K = ml_simd();
+  const u64 MR = K->gemm_mr;
+  const u64 NR = K->gemm_nr;
+  const u64 threads = get_ml_threads();
+  const u64 row_blocks = (g->m + ML_GEMM_MC - 1) / ML_GEMM_MC;
+
+  g->packA = scratch->packA;
+  g->packA_len = scratch->packA_len;
+  g->packB = scratch->packB;
+
+  for (u64 jc = 0; jc < g->n; jc += ML_GEMM_NC) {
+    const u64 nc = gemm_min(ML_GEMM_NC, g->n - jc);
+    const u64 panels = (nc + NR - 1) / NR;
+
+    // With fewer MC blocks than threads, split the columns too so every
+    // thread gets work; serially this is one group holding every panel
+    u64 groups = row_blocks < threads ? (threads + row_blocks - 1) / row_blocks : 1;
+    if (groups > panels) groups = panels;
+
+    g->jc = jc;
+    g->nc = nc;
+    g->col_groups = groups;
+    g->group_nc = ((panels + groups - 1) / groups) * NR;
+
+    for (u64 pc = 0; pc < g->k; pc += ML_GEMM_KC) {
+      g->pc = pc;
+      g->kc = gemm_min(ML_GEMM_KC, g->k - pc);
+
+      ml_parallel_for_held(panels, ml_parallel_grain(g->kc * NR, 1), gemm_pack_B_panels, g);
+      ml_parallel_for_held(row_blocks * groups, 1, gemm_block_tasks, g);
+    }
+  }
+
+  ml_pool_release();
+  return 1;
+}
+
+#endif // ML_GEMM_PACKED
+
+// C = 0 then the epilogue, for k == 0
+static void gemm_zero(u64 m, u64 n, f32* C, u64 ldc, const ML_GemmEpilogue* ep) {
+  const ML_SimdKernels* K = ml_simd();
+
+  for (u64 i = 0; i < m; ++i) K->fill(C + i * ldc, n, 0.0f);
+  if (ep) gemm_epilogue(K, ep, C, ldc, m, n, 0);
+}
+
+void ml_gemm_f32(u64 m, u64 n, u64 k,
+                 const f32* A, u64 rs_a, u64 cs_a,
+                 const f32* B, u64 rs_b, u64 cs_b,
+                 f32* C, u64 ldc) {
+  ml_gemm_f32_ep(m, n, k, A, rs_a, cs_a, B, rs_b, cs_b, C, ldc, NULL);
+}
+
+void ml_gemm_f32_ep(u64 m, u64 n, u64 k,
+                    const f32* A, u64 rs_a, u64 cs_a,
+                    const f32* B, u64 rs_b, u64 cs_b,
+                    f32* C, u64 ldc, const ML_GemmEpilogue* ep) {
+  if (m == 0 || n == 0) return;
+
+  if (k == 0) {
+    gemm_zero(m, n, C, ldc, ep);
+    return;
+  }
+
+  gemm_job g = {
+    .m = m, .n = n, .k = k,
+    .A = A, .ta = ML_GEMM_F32, .rs_a = rs_a, .cs_a = cs_a,
+    .B = B, .tb = ML_GEMM_F32, .rs_b = rs_b, .cs_b = cs_b,
+    .C = C, .ldc = ldc, .ep = ep,
+  };
+
+#if ML_GEMM_PACKED
+  // Pool busy (another product, or an enclosing parallel loop): the
+  // direct path needs no panels
+  if (m * n * k >= ML_GEMM_SMALL_MNK && gemm_blocked(&g)) return;
+#endif
+
+  ml_parallel_for(m, ml_parallel_grain(n * k, 1), gemm_direct_rows, &g);
+}
+
+void ml_gemm_mixed(u64 m, u64 n, u64 k,
+                   const void* A, ML_GemmElem ta, u64 rs_a, u64 cs_a,
+                   const void* B, ML_GemmElem tb, u64 rs_b, u64 cs_b,
+                   f32* C, u64 ldc) {
+  ml_gemm_mixed_ep(m, n, k, A, ta, rs_a, cs_a, B, tb, rs_b, cs_b, C, ldc, NULL);
+}
+
+void ml_gemm_mixed_ep(u64 m, u64 n, u64 k,
+                      const void* A, ML_GemmElem ta, u64 rs_a, u64 cs_a,
+                      const void* B, ML_GemmElem tb, u64 rs_b, u64 cs_b,
+                      f32* C, u64 ldc, const ML_GemmEpilogue* ep) {
+  if (ta == ML_GEMM_F32 && tb == ML_GEMM_F32) {
+    ml_gemm_f32_ep(m, n, k, A, rs_a, cs_a, B, rs_b, cs_b, C, ldc, ep);
+    return;
+  }
+
+  if (m == 0 || n == 0) return;
+
+  if (k == 0) {
+    gemm_zero(m, n, C, ldc, ep);
+    return;
+  }
+
+  gemm_job g = {
+    .m = m, .n = n, .k = k,
+    .A = A, .ta = ta, .rs_a = rs_a, .cs_a = cs_a,
+    .B = B, .tb = tb, .rs_b = rs_b, .cs_b = cs_b,
+    .C = C, .ldc = ldc, .ep = ep,
+  };
+
+#if ML_GEMM_PACKED
+  // Pool busy (another product, or an enclosing parallel loop): the
+  // direct path needs no panels
+  if (m * n * k >= ML_GEMM_SMALL_MNK && gemm_blocked(&g)) return;
+#endif
+
+  ml_parallel_for(m, ml_parallel_grain(n * k, 1), gemm_direct_rows, &g);
+}
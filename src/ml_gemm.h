@@ -0,0 +1,163 @@
+#ifndef ML_GEMM_H
+#define ML_GEMM_H
+
+#include "ml_defs.h"
+#include "ml_error.h"
+#include "ml_primitives.h"
+
+/**
+ * @file ml_gemm.h
+ * @brief Internal single precision GEMM engine.
+ *
+ * Computes C = A * B on raw row-major buffers with explicit leading
+ * dimensions. Shapes and pointers are NOT validated here; callers
+ * (Mat_Mul_Mat_into and friends) check them once at the API boundary.
+ *
+ * Large problems go through a cache-blocked path (KC x NC panels of B
+ * and MC x KC panels of A are packed into contiguous buffers and fed to
+ * an MR x NR register-tiled micro-kernel). Small problems use a direct
+ * row-streaming loop where packing would cost more than it saves.
+ *
+ * Both paths split their work through ml_parallel_for() (see ml_thread.h):
+ * the direct path by rows of C, the blocked path by MC row blocks and
+ * groups of NR column panels. Each C element is accumulated in the same
+ * order for any thread count.
+ *
+ * The *_ep entry points also take an epilogue that finishes each block
+ * of C as soon as its last depth panel is accumulated: a micro-tile on
+ * the blocked path, a row (or row chunk) on the direct path.
+ */
+
+/**
+ * @brief Cache blocking parameters (in elements).
+ *
+ * - ML_GEMM_MC: rows of A packed per block (A panel lives in L2).
+ * - ML_GEMM_KC: depth of a packed panel (B micro-panel lives in L1).
+ * - ML_GEMM_NC: columns of B packed per block (B panel lives in L3).
+ *
+ * ML_GEMM_MC must be a multiple of every micro-kernel MR and ML_GEMM_NC
+ * a multiple of every micro-kernel NR.
+ */
+#ifndef ML_GEMM_MC
+#define ML_GEMM_MC 96
+#endif
+#ifndef ML_GEMM_KC
+#define ML_GEMM_KC 256
+#endif
+#ifndef ML_GEMM_NC
+#define ML_GEMM_NC 2048
+#endif
+
+/**
+ * @brief Enable the packed/blocked path.
+ *
+ * The panels belong to the thread pool: one A panel of MC*KC floats per
+ * thread and a B panel of KC*NC floats they share, allocated from the heap
+ * when set_ml_threads() changes the thread count (or by the first packed
+ * product if it never does). A product packs into them only while it holds
+ * the pool; one that finds the pool busy (another application thread's
+ * product, or a product inside a parallel loop) or has no panels takes the
+ * direct path. On ESP-IDF builds the panels are far larger than the RAM
+ * budget, so the packed path defaults to off there and every product uses
+ * the direct path.
+ */
+#ifndef ML_GEMM_PACKED
+#ifdef ESP_PLATFORM
+#define ML_GEMM_PACKED 0
+#else
+#define ML_GEMM_PACKED 1
+#endif
+#endif
+
+/**
+ * @brief Products with m*n*k below this use the direct path.
+ */
+#ifndef ML_GEMM_SMALL_MNK
+#define ML_GEMM_SMALL_MNK (32u * 32u * 32u)
+#endif
+
+/**
+ * @brief Resolved ML_Epilogue: C[i,j] = act(scale * C[i,j] + bias[j]).
+ */
+typedef struct {
+  f32 scale;
+  /** n values, or NULL. */
+  const f32* bias;
+  ML_Activation act;
+  f32 alpha;
+} ML_GemmEpilogue;
+
+/**
+ * @brief Validate @p ep against the output @p C and resolve it.
+ *
+ * @return ML_OK (also for a NULL @p ep, which leaves @p out untouched).
+ * @return ML_INVALID_ARGUMENT if the bias is not (1 x C.cols), overlaps
+ *         @p C, or the activation is unknown.
+ */
+ML_Status ml_gemm_epilogue_from(ML_GemmEpilogue* out, const Matf32 C,
+                                const ML_Epilogue* ep);
+
+/**
+ * @brief C(m x n) = A(m x k) * B(k x n) with arbitrary operand strides.
+ *
+ * Each operand is addressed through a row stride and a column stride, so
+ * a transposed operand is just the stored matrix with its strides swapped:
+ * - A, row-major (m x k) buffer:   rs_a = lda, cs_a = 1
+ * - A^T, row-major (k x m) buffer: rs_a = 1,   cs_a = lda
+ *
+ * @param m Rows of op(A) and C.
+ * @param n Columns of op(B) and C.
+ * @param k Columns of op(A) / rows of op(B).
+ * @param A op(A) element (i,p) at A[i*rs_a + p*cs_a].
+ * @param rs_a Row stride of op(A).
+ * @param cs_a Column stride of op(A).
+ * @param B op(B) element (p,j) at B[p*rs_b + j*cs_b].
+ * @param rs_b Row stride of op(B).
+ * @param cs_b Column stride of op(B).
+ * @param C Row-major output, element (i,j) at C[i*ldc + j].
+ * @param ldc Leading dimension of C (>= n).
+ *
+ * @note C must not alias A or B.
+ */
+void ml_gemm_f32(u64 m, u64 n, u64 k,
+                 const f32* A, u64 rs_a, u64 cs_a,
+                 const f32* B, u64 rs_b, u64 cs_b,
+                 f32* C, u64 ldc);
+
+/**
+ * @brief ml_gemm_f32 followed by @p ep (NULL for none) on every element.
+ */
+void ml_gemm_f32_ep(u64 m, u64 n, u64 k,
+                    const f32* A, u64 rs_a, u64 cs_a,
+                    const f32* B, u64 rs_b, u64 cs_b,
+                    f32* C, u64 ldc, const ML_GemmEpilogue* ep);
+
+/** @brief Storage type of a GEMM operand. */
+typedef enum {
+  ML_GEMM_F32,
+  ML_GEMM_F16,
+  ML_GEMM_BF16,
+} ML_GemmElem;
+
+/**
+ * @brief ml_gemm_f32 with operands stored as f32, f16 or bf16.
+ *
+ * 16-bit operands are widened to f32 while they are packed (or, on the
+ * direct path, one row of B at a time), so accumulation is always f32 and
+ * no full-size f32 copy of either operand is made. Strides are in
+ * elements of the operand's own type.
+ */
+void ml_gemm_mixed(u64 m, u64 n, u64 k,
+                   const void* A, ML_GemmElem ta, u64 rs_a, u64 cs_a,
+                   const void* B, ML_GemmElem tb, u64 rs_b, u64 cs_b,
+                   f32* C, u64 ldc);
+
+/**
+ * @brief ml_gemm_mixed followed by @p ep (NULL for none) on every element.
+ */
+void ml_gemm_mixed_ep(u64 m, u64 n, u64 k,
+                      const void* A, ML_GemmElem ta, u64 rs_a, u64 cs_a,
+                      const void* B, ML_GemmElem tb, u64 rs_b, u64 cs_b,
+                      f32* C, u64 ldc, const ML_GemmEpilogue* ep);
+
+#endif // ML_GEMM_H
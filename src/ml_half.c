@@ -0,0 +1,136 @@
+#include "ml_half.h"
+#include "ml_alloc.h"
+#include "ml_error.h"
+#include "ml_gemm.h"
+#include "ml_simd.h"
+
+#include <stddef.h>
+
+static inline ML_GemmElem half_elem(ML_HalfFormat format) {
+  return format == ML_HALF_BF16 ? ML_GEMM_BF16 : ML_GEMM_F16;
+}
+
+static inline int half_format_ok(ML_HalfFormat format) {
+  return format == ML_HALF_F16 || format == ML_HALF_BF16;
+}
+
+ML_Status create_Mat16(ml_arena* arena, Mat16* dest, u64 rows, u64 cols,
+                       ML_HalfFormat format) {
+  if (!arena || !dest) return ML_INVALID_ARGUMENT;
+  if (!half_format_ok(format)) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+  void* data_ptr = NULL;
+
+  status = push_ml_arena(&data_ptr, arena, rows * cols * sizeof(u16));
+  if (status != ML_OK) return status;
+
+  dest->rows = rows;
+  dest->cols = cols;
+  dest->data = data_ptr;
+  dest->stride = cols;
+  dest->format = format;
+
+  return ML_OK;
+}
+
+ML_Status Mat_to_Mat16(Mat16* dest, const Matf32 src) {
+  if (!dest) return ML_INVALID_ARGUMENT;
+  if (!dest->data || !src.data) return ML_INVALID_ARGUMENT;
+  if (!half_format_ok(dest->format)) return ML_INVALID_ARGUMENT;
+  if (dest->rows != src.rows || dest->cols != src.cols) return ML_INVALID_ARGUMENT;
+
+  const ML_SimdKernels* K = ml_simd();
+  void (*narrow)(u16*, const f32*, u64) =
+    dest->format == ML_HALF_BF16 ? K->f32_to_bf16 : K->f32_to_f16;
+  const u64 ld = Mat16_ld(*dest);
+
+  for (u64 r = 0; r < src.rows; ++r)
+    narrow(dest->data + r * ld, Mat_row_ptr(src, r), src.cols);
+
+  return ML_OK;
+}
+
+ML_Status Mat16_to_Mat(Matf32* dest, const Mat16 src) {
+  if (!dest) return ML_INVALID_ARGUMENT;
+  if (!dest->data || !src.data) return ML_INVALID_ARGUMENT;
+  if (!half_format_ok(src.format)) return ML_INVALID_ARGUMENT;
+  if (dest->rows != src.rows || dest->cols != src.cols) return ML_INVALID_ARGUMENT;
+
+  const ML_SimdKernels* K = ml_simd();
+  void (*widen)(f32*, const u16*, u64) =
+    src.format == ML_HALF_BF16 ? K->bf16_to_f32 : K->f16_to_f32;
+  const u64 ld = Mat16_ld(src);
+
+  for (u64 r = 0; r < src.rows; ++r)
+    widen(Mat_row_ptr(*dest, r), src.data + r * ld, src.cols);
+
+  return ML_OK;
+}
+
+ML_Status Mat_Mul_Mat16_into(Matf32* out, const Matf32 lhs, const Mat16 rhs) {
+  return Mat_Mul_Mat16_fused_into(out, lhs, rhs, NULL);
+}
+
+ML_Status Mat_Mul_Mat16_fused_into(Matf32* out, const Matf32 lhs, const Mat16 rhs,
+                                   const ML_Epilogue* ep) {
+  if (!out) return ML_INVALID_ARGUMENT;
+  if (!out->data || !lhs.data || !rhs.data) return ML_INVALID_ARGUMENT;
+  if (!half_format_ok(rhs.format)) return ML_INVALID_ARGUMENT;
+
+  if (lhs.cols != rhs.rows) return ML_INVALID_ARGUMENT;
+  if (out->rows != lhs.rows || out->cols != rhs.cols) return ML_INVALID_ARGUMENT;
+
+  ML_GemmEpilogue gep;
+  ML_Status status = ml_gemm_epilogue_from(&gep, *out, ep);
+  if (status != ML_OK) return status;
+
+  ml_gemm_mixed_ep(lhs.rows, rhs.cols, lhs.cols,
+                   lhs.data, ML_GEMM_F32, Mat_ld(lhs), 1,
+                   rhs.data, half_elem(rhs.format), Mat16_ld(rhs), 1,
+                   out->data, Mat_ld(*out), ep ? &gep : NULL);
+
+  return ML_OK;
+}
+
+ML_Status Mat16_Mul_Mat_into(Matf32* out, const Mat16 lhs, const Matf32 rhs) {
+  if (!out) return ML_INVALID_ARGUMENT;
+  if (!out->data || !lhs.data || !rhs.data) return ML_INVALID_ARGUMENT;
+  if (!half_format_ok(lhs.format)) return ML_INVALID_ARGUMENT;
+
+  if (lhs.cols != rhs.rows) return ML_INVALID_ARGUMENT;
+  if (out->rows != lhs.rows || out->cols != rhs.cols) return ML_INVALID_ARGUMENT;
+
+  ml_gemm_mixed(lhs.rows, rhs.cols, lhs.cols,
+                lhs.data, half_elem(lhs.format), Mat16_ld(lhs), 1,
+                rhs.data, ML_GEMM_F32, Mat_ld(rhs), 1,
+                out->data, Mat_ld(*out));
+
+  return ML_OK;
+}
+
+ML_Status Mat16_Mul_Mat16_into(Matf32* out, const Mat16 lhs, const Mat16 rhs) {
+  return Mat16_Mul_Mat16_fused_into(out, lhs, rhs, NULL);
+}
+
+ML_Status Mat16_Mul_Mat16_fused_into(Matf32* out, const Mat16 lhs, const Mat16 rhs,
+                                     const ML_Epilogue* ep) {
+  if (!out) return ML_INVALID_ARGUMENT;
+  if (!out->data || !lhs.data || !rhs.data) return ML_INVALID_ARGUMENT;
+  if (!half_format_ok(lhs.format) || !half_format_ok(rhs.format))
+    return ML_INVALID_ARGUMENT;
+
+  if (lhs.cols != rhs.rows) return ML_INVALID_ARGUMENT;
+  if (out->rows != lhs.rows || out->cols != rhs.cols) return ML_INVALID_ARGUMENT;
+
+  ML_GemmEpilogue gep;
+  ML_Status status = ml_gemm_epilogue_from(&gep, *out, ep);
+  if (status != ML_OK) return status;
+
+  ml_gemm_mixed_ep(lhs.rows, rhs.cols, lhs.cols,
+                   lhs.data, half_elem(lhs.format), Mat16_ld(lhs), 1,
+                   rhs.data, half_elem(rhs.format), Mat16_ld(rhs), 1,
+                   out->data, Mat_ld(*out), ep ? &gep : NULL);
+
+  return ML_OK;
+}
@@ -0,0 +1,76 @@
+#ifndef ML_HALF_CONV_H
+#define ML_HALF_CONV_H
+
+#include "ml_defs.h"
+#include "ml_math.h"
+
+/**
+ * @file ml_half_conv.h
+ * @brief Internal scalar f16/bf16 <-> f32 conversions.
+ *
+ * f32 -> half rounds to nearest even; overflow gives infinity. half -> f32
+ * is exact for every non-NaN value. Subnormal halves are handled in both
+ * directions. A NaN keeps its sign and the top bits of its payload and
+ * comes out quiet, which is what the hardware converters do (F16C, NEON
+ * fcvt). These are the reference the SIMD conversion kernels match bit for
+ * bit, NaNs included, and are used for the remainder lanes and strided
+ * gathers.
+ */
+
+/** @brief Reference conversions over a run of n values (used by all backends). */
+void ml_f16_to_f32_ref(f32* dst, const u16* src, u64 n);
+void ml_f32_to_f16_ref(u16* dst, const f32* src, u64 n);
+
+static inline f32 ml_f16_to_f32(u16 h) {
+  const u32 shifted_exp = 0x7c00u << 13;
+  u32 o = ((u32)h & 0x7fffu) << 13;
+  const u32 e = o & shifted_exp;
+
+  o += (u32)(127 - 15) << 23;
+  if (e == shifted_exp) {
+    // Inf / NaN: exponent all ones; a NaN comes out quiet
+    o += (u32)(128 - 16) << 23;
+    if (o & 0x007fffffu) o |= 0x00400000u;
+  } else if (e == 0) {
+    // Zero / subnormal: renormalise through a float subtraction
+    o += 1u << 23;
+    o = ml_f32_bits(ml_bits_f32(o) - ml_bits_f32(113u << 23));
+  }
+  return ml_bits_f32(o | (((u32)h & 0x8000u) << 16));
+}
+
+static inline u16 ml_f32_to_f16(f32 f) {
+  u32 x = ml_f32_bits(f);
+  const u32 sign = (x >> 16) & 0x8000u;
+  u32 o;
+
+  x &= 0x7fffffffu;
+  if (x >= 0x47800000u) {
+    // Past the largest half (or Inf/NaN); a NaN keeps the top 10 payload
+    // bits and comes out quiet
+    o = x > 0x7f800000u ? 0x7e00u | ((x >> 13) & 0x3ffu) : 0x7c00u;
+  } else if (x < 0x38800000u) {
+    // Result is subnormal or zero: adding 0.5 aligns the half ULP to the
+    // f32 ULP, so the FPU does the round to nearest even
+    o = ml_f32_bits(ml_bits_f32(x) + 0.5f) - 0x3f000000u;
+  } else {
+    const u32 mant_odd = (x >> 13) & 1u;
+    x += ((u32)(15 - 127) << 23) + 0xfffu;
+    x += mant_odd;
+    o = x >> 13;
+  }
+  return (u16)(o | sign);
+}
+
+static inline f32 ml_bf16_to_f32(u16 h) {
+  return ml_bits_f32((u32)h << 16);
+}
+
+static inline u16 ml_f32_to_bf16(f32 f) {
+  const u32 x = ml_f32_bits(f);
+  // Keep NaNs NaN (a payload in the low half alone would round to Inf)
+  if ((x & 0x7fffffffu) > 0x7f800000u) return (u16)((x >> 16) | 0x40u);
+  return (u16)((x + 0x7fffu + ((x >> 16) & 1u)) >> 16);
+}
+
+#endif // ML_HALF_CONV_H
@@ -0,0 +1,325 @@
+#include "ml_kernels.h"
+#include "ml_simd.h"
+#include "ml_thread.h"
+
+// Flat runs are split on multiples of this many elements, which is a whole
+// number of vectors for every backend, so each chunk runs the same vector
+// body and only the last one has the scalar tail a serial call would have
+#define KERNEL_RUN_ALIGN 64
+
+// A (rows x cols) block with leading dimension ld is one packed run when
+// there is at most one row or the rows are back to back
+static inline int kernel_packed(u64 ld, u64 rows, u64 cols) {
+  return rows <= 1 || ld == cols;
+}
+
+// Operands of one kernel call, shared by every chunk of a parallel loop
+typedef struct {
+  f32* x;
+  u64 ld;
+  const f32* y;
+  u64 ld_y;
+  u64 cols;
+  f32 s;
+  void (*fn)(f32*, u64);
+  void (*fn_s)(f32*, u64, f32);
+  const ML_SimdKernels* K;
+} kernel_ctx;
+
+static void run_scalar(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_ctx* c = p;
+  (void)tid;
+  c->fn_s(c->x + begin, end - begin, c->s);
+}
+
+static void rows_scalar(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_ctx* c = p;
+  (void)tid;
+  for (u64 r = begin; r < end; ++r) c->fn_s(c->x + r * c->ld, c->cols, c->s);
+}
+
+static void run_unary(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_ctx* c = p;
+  (void)tid;
+  c->fn(c->x + begin, end - begin);
+}
+
+static void rows_unary(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_ctx* c = p;
+  (void)tid;
+  for (u64 r = begin; r < end; ++r) c->fn(c->x + r * c->ld, c->cols);
+}
+
+// Apply an in-place (x, n, scalar) kernel over a block
+static inline void kernel_apply_scalar(void (*fn)(f32*, u64, f32),
+                                       f32* x, u64 ld, u64 rows, u64 cols,
+                                       f32 s) {
+  kernel_ctx c = { .x = x, .ld = ld, .cols = cols, .s = s, .fn_s = fn };
+
+  if (kernel_packed(ld, rows, cols)) {
+    ml_parallel_for(rows * cols, ml_parallel_grain(1, KERNEL_RUN_ALIGN), run_scalar, &c);
+    return;
+  }
+  ml_parallel_for(rows, ml_parallel_grain(cols, 1), rows_scalar, &c);
+}
+
+static inline void kernel_apply(void (*fn)(f32*, u64),
+                                f32* x, u64 ld, u64 rows, u64 cols) {
+  kernel_ctx c = { .x = x, .ld = ld, .cols = cols, .fn = fn };
+
+  if (kernel_packed(ld, rows, cols)) {
+    ml_parallel_for(rows * cols, ml_parallel_grain(1, KERNEL_RUN_ALIGN), run_unary, &c);
+    return;
+  }
+  ml_parallel_for(rows, ml_parallel_grain(cols, 1), rows_unary, &c);
+}
+
+void ml_kernel_fill(f32* x, u64 ld, u64 rows, u64 cols, f32 v) {
+  kernel_apply_scalar(ml_simd()->fill, x, ld, rows, cols, v);
+}
+
+static void run_copy(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_ctx* c = p;
+  (void)tid;
+  c->K->copy(c->x + begin, c->y + begin, end - begin);
+}
+
+static void rows_copy(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_ctx* c = p;
+  (void)tid;
+  for (u64 r = begin; r < end; ++r) c->K->copy(c->x + r * c->ld, c->y + r * c->ld_y, c->cols);
+}
+
+void ml_kernel_copy(f32* dst, u64 ld_dst, const f32* src, u64 ld_src,
+                    u64 rows, u64 cols) {
+  const ML_SimdKernels* K = ml_simd();
+
+  if (rows == 0 || cols == 0) return;
+
+  // Chunks only run in parallel when the two blocks are disjoint
+  const f32* dst_end = dst + (rows - 1) * ld_dst + cols;
+  const f32* src_end = src + (rows - 1) * ld_src + cols;
+  const int disjoint = dst_end <= src || src_end <= dst;
+  kernel_ctx c = { .x = dst, .ld = ld_dst, .y = src, .ld_y = ld_src, .cols = cols, .K = K };
+
+  if (kernel_packed(ld_dst, rows, cols) && kernel_packed(ld_src, rows, cols)) {
+    if (!disjoint) {
+      K->copy(dst, src, rows * cols);
+      return;
+    }
+    ml_parallel_for(rows * cols, ml_parallel_grain(1, KERNEL_RUN_ALIGN), run_copy, &c);
+    return;
+  }
+
+  if (disjoint) {
+    ml_parallel_for(rows, ml_parallel_grain(cols, 1), rows_copy, &c);
+    return;
+  }
+
+  // Row copies are overlap-safe; walk rows backwards when dst is ahead of
+  // src so an earlier row is never overwritten before it is read
+  if (dst > src) {
+    for (u64 r = rows; r-- > 0;) K->copy(dst + r * ld_dst, src + r * ld_src, cols);
+  } else {
+    for (u64 r = 0; r < rows; ++r) K->copy(dst + r * ld_dst, src + r * ld_src, cols);
+  }
+}
+
+void ml_kernel_scale(f32* x, u64 ld, u64 rows, u64 cols, f32 s) {
+  kernel_apply_scalar(ml_simd()->scale, x, ld, rows, cols, s);
+}
+
+void ml_kernel_add_scalar(f32* x, u64 ld, u64 rows, u64 cols, f32 s) {
+  kernel_apply_scalar(ml_simd()->add_scalar, x, ld, rows, cols, s);
+}
+
+static void run_axpy(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_ctx* c = p;
+  (void)tid;
+  c->K->axpy(c->x + begin, c->y + begin, end - begin, c->s);
+}
+
+static void rows_axpy(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_ctx* c = p;
+  (void)tid;
+  for (u64 r = begin; r < end; ++r)
+    c->K->axpy(c->x + r * c->ld, c->y + r * c->ld_y, c->cols, c->s);
+}
+
+void ml_kernel_axpy(f32* y, u64 ld_y, const f32* x, u64 ld_x,
+                    u64 rows, u64 cols, f32 a) {
+  kernel_ctx c = { .x = y, .ld = ld_y, .y = x, .ld_y = ld_x, .cols = cols, .s = a, .K = ml_simd() };
+
+  if (kernel_packed(ld_y, rows, cols) && kernel_packed(ld_x, rows, cols)) {
+    ml_parallel_for(rows * cols, ml_parallel_grain(1, KERNEL_RUN_ALIGN), run_axpy, &c);
+    return;
+  }
+  ml_parallel_for(rows, ml_parallel_grain(cols, 1), rows_axpy, &c);
+}
+
+void ml_kernel_exp(f32* x, u64 ld, u64 rows, u64 cols) {
+  kernel_apply(ml_simd()->exp, x, ld, rows, cols);
+}
+
+void ml_kernel_log(f32* x, u64 ld, u64 rows, u64 cols) {
+  kernel_apply(ml_simd()->log, x, ld, rows, cols);
+}
+
+static void rows_add_rowvec(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_ctx* c = p;
+  (void)tid;
+  for (u64 r = begin; r < end; ++r) c->K->add(c->x + r * c->ld, c->y, c->cols);
+}
+
+void ml_kernel_add_rowvec(f32* x, u64 ld, u64 rows, u64 cols, const f32* v) {
+  kernel_ctx c = { .x = x, .ld = ld, .y = v, .cols = cols, .K = ml_simd() };
+
+  ml_parallel_for(rows, ml_parallel_grain(cols, 1), rows_add_rowvec, &c);
+}
+
+static void rows_add_colvec(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_ctx* c = p;
+  (void)tid;
+  for (u64 r = begin; r < end; ++r)
+    c->K->add_scalar(c->x + r * c->ld, c->cols, c->s * c->y[r * c->ld_y]);
+}
+
+void ml_kernel_add_colvec(f32* x, u64 ld, u64 rows, u64 cols,
+                          const f32* v, u64 ld_v, f32 s) {
+  kernel_ctx c = { .x = x, .ld = ld, .y = v, .ld_y = ld_v, .cols = cols, .s = s, .K = ml_simd() };
+
+  ml_parallel_for(rows, ml_parallel_grain(cols, 1), rows_add_colvec, &c);
+}
+
+// For the reductions x is the output column (stride ld) and y the input
+static void rows_max(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_ctx* c = p;
+  (void)tid;
+  for (u64 r = begin; r < end; ++r) c->x[r * c->ld] = c->K->max(c->y + r * c->ld_y, c->cols);
+}
+
+static void rows_sum(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_ctx* c = p;
+  (void)tid;
+  for (u64 r = begin; r < end; ++r) c->x[r * c->ld] = c->K->sum(c->y + r * c->ld_y, c->cols);
+}
+
+void ml_kernel_rowmax(f32* out, u64 ld_out, const f32* x, u64 ld,
+                      u64 rows, u64 cols) {
+  kernel_ctx c = { .x = out, .ld = ld_out, .y = x, .ld_y = ld, .cols = cols, .K = ml_simd() };
+
+  ml_parallel_for(rows, ml_parallel_grain(cols, 1), rows_max, &c);
+}
+
+void ml_kernel_rowsum(f32* out, u64 ld_out, const f32* x, u64 ld,
+                      u64 rows, u64 cols) {
+  kernel_ctx c = { .x = out, .ld = ld_out, .y = x, .ld_y = ld, .cols = cols, .K = ml_simd() };
+
+  ml_parallel_for(rows, ml_parallel_grain(cols, 1), rows_sum, &c);
+}
+
+// Column range [begin, end) of the sum; rows is carried in cols
+static void cols_sum(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_ctx* c = p;
+  const u64 n = end - begin;
+  (void)tid;
+
+  // Accumulate whole rows so every pass is unit-stride
+  c->K->fill(c->x + begin, n, 0.0f);
+  for (u64 r = 0; r < c->cols; ++r) c->K->add(c->x + begin, c->y + r * c->ld_y + begin, n);
+}
+
+void ml_kernel_colsum(f32* out, const f32* x, u64 ld, u64 rows, u64 cols) {
+  kernel_ctx c = { .x = out, .y = x, .ld_y = ld, .cols = rows, .K = ml_simd() };
+
+  // Split across columns so each thread owns its slice of out and the
+  // per-element summation order is the serial one
+  ml_parallel_for(cols, ml_parallel_grain(rows, KERNEL_RUN_ALIGN), cols_sum, &c);
+}
+
+static void rows_transpose(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_ctx* c = p;
+  (void)tid;
+  for (u64 r = begin; r < end; ++r) {
+    const f32* in = c->y + r * c->ld_y;
+    for (u64 col = 0; col < c->cols; ++col) c->x[col * c->ld + r] = in[col];
+  }
+}
+
+void ml_kernel_transpose(f32* dst, u64 ld_dst, const f32* src, u64 ld_src,
+                         u64 rows, u64 cols) {
+  kernel_ctx c = { .x = dst, .ld = ld_dst, .y = src, .ld_y = ld_src, .cols = cols };
+
+  // Whole groups of 16 source rows per chunk, so threads write separate
+  // cache lines of each destination row
+  ml_parallel_for(rows, ml_parallel_grain(cols, 16), rows_transpose, &c);
+}
+
+// Operands of an activation call: out = act(in), or out = in * act'(.)
+// read through v. out may be in itself; every chunk only touches its own
+// elements, so that is safe in parallel.
+typedef struct {
+  f32* out;
+  u64 ld_out;
+  const f32* in;
+  u64 ld_in;
+  const f32* v;
+  u64 ld_v;
+  u64 cols;
+  ML_Activation act;
+  f32 alpha;
+  const ML_SimdKernels* K;
+} kernel_act_ctx;
+
+static void run_act(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_act_ctx* c = p;
+  (void)tid;
+  c->K->act(c->out + begin, c->in + begin, end - begin, c->act, c->alpha);
+}
+
+static void rows_act(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_act_ctx* c = p;
+  (void)tid;
+  for (u64 r = begin; r < end; ++r)
+    c->K->act(c->out + r * c->ld_out, c->in + r * c->ld_in, c->cols, c->act, c->alpha);
+}
+
+void ml_kernel_act(f32* y, u64 ld_y, const f32* x, u64 ld_x,
+                   u64 rows, u64 cols, ML_Activation act, f32 alpha) {
+  kernel_act_ctx c = { .out = y, .ld_out = ld_y, .in = x, .ld_in = ld_x, .cols = cols,
+                       .act = act, .alpha = alpha, .K = ml_simd() };
+
+  if (kernel_packed(ld_y, rows, cols) && kernel_packed(ld_x, rows, cols)) {
+    ml_parallel_for(rows * cols, ml_parallel_grain(1, KERNEL_RUN_ALIGN), run_act, &c);
+    return;
+  }
+  ml_parallel_for(rows, ml_parallel_grain(cols, 1), rows_act, &c);
+}
+
+static void run_act_grad(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_act_ctx* c = p;
+  (void)tid;
+  c->K->act_grad(c->out + begin, c->in + begin, c->v + begin, end - begin, c->act, c->alpha);
+}
+
+static void rows_act_grad(void* p, u64 begin, u64 end, u64 tid) {
+  const kernel_act_ctx* c = p;
+  (void)tid;
+  for (u64 r = begin; r < end; ++r)
+    c->K->act_grad(c->out + r * c->ld_out, c->in + r * c->ld_in, c->v + r * c->ld_v,
+                   c->cols, c->act, c->alpha);
+}
+
+void ml_kernel_act_grad(f32* dx, u64 ld_dx, const f32* dy, u64 ld_dy,
+                        const f32* v, u64 ld_v, u64 rows, u64 cols,
+                        ML_Activation act, f32 alpha) {
+  kernel_act_ctx c = { .out = dx, .ld_out = ld_dx, .in = dy, .ld_in = ld_dy, .v = v, .ld_v = ld_v,
+                       .cols = cols, .act = act, .alpha = alpha, .K = ml_simd() };
+
+  if (kernel_packed(ld_dx, rows, cols) && kernel_packed(ld_dy, rows, cols) &&
+      kernel_packed(ld_v, rows, cols)) {
+    ml_parallel_for(rows * cols, ml_parallel_grain(1, KERNEL_RUN_ALIGN), run_act_grad, &c);
+    return;
+  }
+  ml_parallel_for(rows, ml_parallel_grain(cols, 1), rows_act_grad, &c);
+}
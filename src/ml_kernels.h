@@ -0,0 +1,97 @@
+#ifndef ML_KERNELS_H
+#define ML_KERNELS_H
+
+#include "ml_defs.h"
+#include "ml_primitives.h"
+
+/**
+ * @file ml_kernels.h
+ * @brief Internal raw-kernel layer behind the Mat_* primitives.
+ *
+ * Every kernel takes raw pointers, a (rows x cols) extent and the leading
+ * dimension of each operand, and does no argument checking at all: the
+ * public API validates pointers and shapes once and then calls in here.
+ * Runs whose rows are packed back to back are collapsed into a single call
+ * of the active SIMD kernel, everything else goes row by row.
+ *
+ * Column vectors are addressed with their own leading dimension (@p ld_v),
+ * so strided (N x 1) views work as well as packed ones.
+ */
+
+/**
+ * Conservative overlap test on the address ranges two matrices span. The
+ * entry points use it to reject outputs that share memory with an input.
+ */
+static inline int mat_overlaps(const Matf32 a, const Matf32 b) {
+  if (a.rows == 0 || a.cols == 0 || b.rows == 0 || b.cols == 0) return 0;
+  const f32* a_end = a.data + (a.rows - 1) * Mat_ld(a) + a.cols;
+  const f32* b_end = b.data + (b.rows - 1) * Mat_ld(b) + b.cols;
+  return a.data < b_end && b.data < a_end;
+}
+
+/**
+ * Elementwise kernels may write in place over the very same block, but a
+ * shifted overlap would read elements another chunk already wrote.
+ */
+static inline int mat_same_or_disjoint(const Matf32 a, const Matf32 b) {
+  return (a.data == b.data && Mat_ld(a) == Mat_ld(b)) || !mat_overlaps(a, b);
+}
+
+/** x = v */
+void ml_kernel_fill(f32* x, u64 ld, u64 rows, u64 cols, f32 v);
+
+/** dst = src. Rows may overlap (forwards or backwards). */
+void ml_kernel_copy(f32* dst, u64 ld_dst, const f32* src, u64 ld_src,
+                    u64 rows, u64 cols);
+
+/** x *= s */
+void ml_kernel_scale(f32* x, u64 ld, u64 rows, u64 cols, f32 s);
+
+/** x += s */
+void ml_kernel_add_scalar(f32* x, u64 ld, u64 rows, u64 cols, f32 s);
+
+/** y += a * x */
+void ml_kernel_axpy(f32* y, u64 ld_y, const f32* x, u64 ld_x,
+                    u64 rows, u64 cols, f32 a);
+
+/** x = exp(x) */
+void ml_kernel_exp(f32* x, u64 ld, u64 rows, u64 cols);
+
+/** x = log(x) */
+void ml_kernel_log(f32* x, u64 ld, u64 rows, u64 cols);
+
+/** x[r, :] += v[0, :] */
+void ml_kernel_add_rowvec(f32* x, u64 ld, u64 rows, u64 cols, const f32* v);
+
+/** x[r, :] += s * v[r, 0] */
+void ml_kernel_add_colvec(f32* x, u64 ld, u64 rows, u64 cols,
+                          const f32* v, u64 ld_v, f32 s);
+
+/** out[r, 0] = max_c x[r, c], cols >= 1 */
+void ml_kernel_rowmax(f32* out, u64 ld_out, const f32* x, u64 ld,
+                      u64 rows, u64 cols);
+
+/** out[r, 0] = sum_c x[r, c] */
+void ml_kernel_rowsum(f32* out, u64 ld_out, const f32* x, u64 ld,
+                      u64 rows, u64 cols);
+
+/** out[0, c] = sum_r x[r, c] */
+void ml_kernel_colsum(f32* out, const f32* x, u64 ld, u64 rows, u64 cols);
+
+/** dst (cols x rows) = src (rows x cols)^T. Must not overlap. */
+void ml_kernel_transpose(f32* dst, u64 ld_dst, const f32* src, u64 ld_src,
+                         u64 rows, u64 cols);
+
+/** y = act(x). y may be x itself (same ld). */
+void ml_kernel_act(f32* y, u64 ld_y, const f32* x, u64 ld_x,
+                   u64 rows, u64 cols, ML_Activation act, f32 alpha);
+
+/**
+ * dx = dy * act'(x), with v = act(x) (or x itself for GELU), see
+ * ML_SimdKernels::act_grad. dx may be dy itself (same ld).
+ */
+void ml_kernel_act_grad(f32* dx, u64 ld_dx, const f32* dy, u64 ld_dy,
+                        const f32* v, u64 ld_v, u64 rows, u64 cols,
+                        ML_Activation act, f32 alpha);
+
+#endif // ML_KERNELS_H
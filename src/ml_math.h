@@ -0,0 +1,224 @@
+#ifndef ML_MATH_H
+#define ML_MATH_H
+
+#include "ml_defs.h"
+#include "ml_backend.h"
+#include "ml_primitives.h"
+
+#include <math.h>
+#include <string.h>
+
+/**
+ * @file ml_math.h
+ * @brief Internal fast exp/log: shared constants and scalar reference.
+ *
+ * Every backend uses the same algorithm so the accuracy tiers documented in
+ * ml_backend.h hold regardless of which table is active:
+ *
+ * exp(x): n = round(x / ln2), r = x - n*ln2 (Cody-Waite, two-part ln2),
+ *         e^r = 1 + r + r^2 * Q(r), result = e^r * 2^(n/2) * 2^(n - n/2).
+ *         Splitting the scale keeps both factors normal, so results in the
+ *         subnormal range are produced correctly.
+ *
+ * log(x): x = m * 2^e with m in [sqrt(1/2), sqrt(2)), f = m - 1,
+ *         log(1 + f) = f - f^2/2 + f^3 * R(f), plus e*ln2 (two-part).
+ *
+ * Q and R are minimax polynomials: degree 5 / 8 for ML_MATH_FAST and
+ * degree 2 / 3 for ML_MATH_FASTEST.
+ *
+ * The scalar versions below are used by the scalar backend and for the
+ * remainder lanes of the vector ones.
+ */
+
+/** @brief Active accuracy tier, read by the kernels on every call. */
+extern ML_MathAccuracy ml_math_accuracy;
+
+/** @brief ML_MATH_EXACT: libm over a run of n floats (shared by all backends). */
+void ml_exp_libm(f32* x, u64 n);
+void ml_log_libm(f32* x, u64 n);
+
+// exp: overflow/underflow thresholds (ln(FLT_MAX), ln of smallest subnormal)
+#define ML_EXP_HI 88.72283905206835f
+#define ML_EXP_LO -103.97207708399179f
+
+#define ML_LOG2E 1.44269504088896341f
+#define ML_LN2_HI 0.693359375f
+#define ML_LN2_LO -2.12194440e-4f
+
+// 1.5 * 2^23: adding and subtracting it rounds to nearest integer
+#define ML_ROUND_MAGIC 12582912.0f
+
+// Q(r) for ML_MATH_FAST (Cephes expf), highest degree first
+#define ML_EXP_F_Q5 1.9875691500e-4f
+#define ML_EXP_F_Q4 1.3981999507e-3f
+#define ML_EXP_F_Q3 8.3334519073e-3f
+#define ML_EXP_F_Q2 4.1665795894e-2f
+#define ML_EXP_F_Q1 1.6666665459e-1f
+#define ML_EXP_F_Q0 5.0000001201e-1f
+
+// Q(r) for ML_MATH_FASTEST
+#define ML_EXP_X_Q2 4.12777476e-2f
+#define ML_EXP_X_Q1 1.67535139e-1f
+#define ML_EXP_X_Q0 5.00051160e-1f
+
+#define ML_SQRTHF 0.707106781186547524f
+
+// R(f) for ML_MATH_FAST (Cephes logf), highest degree first
+#define ML_LOG_F_R8 7.0376836292e-2f
+#define ML_LOG_F_R7 -1.1514610310e-1f
+#define ML_LOG_F_R6 1.1676998740e-1f
+#define ML_LOG_F_R5 -1.2420140846e-1f
+#define ML_LOG_F_R4 1.4249322787e-1f
+#define ML_LOG_F_R3 -1.6668057665e-1f
+#define ML_LOG_F_R2 2.0000714765e-1f
+#define ML_LOG_F_R1 -2.4999993993e-1f
+#define ML_LOG_F_R0 3.3333331174e-1f
+
+// R(f) for ML_MATH_FASTEST
+#define ML_LOG_X_R3 -1.45925190e-1f
+#define ML_LOG_X_R2 2.17765106e-1f
+#define ML_LOG_X_R1 -2.52449971e-1f
+#define ML_LOG_X_R0 3.32854710e-1f
+
+static inline f32 ml_bits_f32(u32 b) {
+  f32 f;
+  memcpy(&f, &b, sizeof(f));
+  return f;
+}
+
+static inline u32 ml_f32_bits(f32 f) {
+  u32 b;
+  memcpy(&b, &f, sizeof(b));
+  return b;
+}
+
+// 2^n for n in [-126, 127]
+static inline f32 ml_pow2i(i32 n) {
+  return ml_bits_f32((u32)(n + 127) << 23);
+}
+
+// Branch-free so the scalar backend's loops auto-vectorise: every select
+// picks between values that are already computed, and special inputs are
+// patched at the end
+static inline f32 ml_expf_approx(f32 x, int fastest) {
+  f32 xc = x < ML_EXP_LO ? ML_EXP_LO : x;
+  xc = xc > ML_EXP_HI ? ML_EXP_HI : xc;
+
+  // Round to nearest; the integer sits in the low mantissa bits of t
+  const f32 t = xc * ML_LOG2E + ML_ROUND_MAGIC;
+  const f32 n = t - ML_ROUND_MAGIC;
+  const i32 ni = (i32)(ml_f32_bits(t) - ml_f32_bits(ML_ROUND_MAGIC));
+
+  f32 r = xc - n * ML_LN2_HI;
+  r = r - n * ML_LN2_LO;
+
+  f32 q;
+  if (fastest) {
+    q = (ML_EXP_X_Q2 * r + ML_EXP_X_Q1) * r + ML_EXP_X_Q0;
+  } else {
+    q = ML_EXP_F_Q5;
+    q = q * r + ML_EXP_F_Q4;
+    q = q * r + ML_EXP_F_Q3;
+    q = q * r + ML_EXP_F_Q2;
+    q = q * r + ML_EXP_F_Q1;
+    q = q * r + ML_EXP_F_Q0;
+  }
+  f32 p = q * (r * r) + r + 1.0f;
+
+  const i32 n1 = ni >> 1;
+  p = p * ml_pow2i(n1) * ml_pow2i(ni - n1);
+
+  p = x > ML_EXP_HI ? INFINITY : p;
+  p = x < ML_EXP_LO ? 0.0f : p;
+  const f32 nan = x + x;
+  return x != x ? nan : p;
+}
+
+static inline f32 ml_logf_approx(f32 x, int fastest) {
+  // Renormalise subnormals with 2^23
+  const int sub = x < 1.17549435e-38f;
+  const f32 xs = x * 8388608.0f;
+  const u32 b = ml_f32_bits(sub ? xs : x);
+
+  i32 e = (i32)(b >> 23) - 126 - (sub ? 23 : 0);
+  f32 m = ml_bits_f32((b & 0x007fffffu) | 0x3f000000u); // [0.5, 1)
+  const int small = m < ML_SQRTHF;
+  const f32 m2 = m + m;
+  m = small ? m2 : m;
+  e -= small;
+
+  const f32 f = m - 1.0f;
+  const f32 z = f * f;
+
+  f32 rr;
+  if (fastest) {
+    rr = ((ML_LOG_X_R3 * f + ML_LOG_X_R2) * f + ML_LOG_X_R1) * f + ML_LOG_X_R0;
+  } else {
+    rr = ML_LOG_F_R8;
+    rr = rr * f + ML_LOG_F_R7;
+    rr = rr * f + ML_LOG_F_R6;
+    rr = rr * f + ML_LOG_F_R5;
+    rr = rr * f + ML_LOG_F_R4;
+    rr = rr * f + ML_LOG_F_R3;
+    rr = rr * f + ML_LOG_F_R2;
+    rr = rr * f + ML_LOG_F_R1;
+    rr = rr * f + ML_LOG_F_R0;
+  }
+
+  const f32 fe = (f32)e;
+  f32 y = rr * f * z;
+  y += fe * ML_LN2_LO;
+  y += -0.5f * z;
+  y = f + y + fe * ML_LN2_HI;
+
+  y = x == 0.0f ? -INFINITY : y;
+  y = x == INFINITY ? x : y;
+  y = x < 0.0f ? NAN : y;
+  const f32 nan = x + x;
+  return x != x ? nan : y;
+}
+
+// Smooth activations on top of ml_expf_approx. tanh(v) is taken as
+// (1 - e^-2v) / (1 + e^-2v) with |v| clamped to ML_TANH_CLAMP, where tanh
+// is 1 to within float precision, so e^-2v never overflows. GELU is the
+// tanh form 0.5 x (1 + tanh(ML_GELU_K x (1 + ML_GELU_C x^2))).
+#define ML_TANH_CLAMP 9.0f
+#define ML_GELU_K 0.7978845608028654f // sqrt(2/pi)
+#define ML_GELU_C 0.044715f
+
+static inline f32 ml_sigmoidf_approx(f32 x, int fastest) {
+  // e^-x overflows to inf for very negative x, giving exactly 0
+  return 1.0f / (1.0f + ml_expf_approx(-x, fastest));
+}
+
+static inline f32 ml_tanhf_approx(f32 x, int fastest) {
+  // Compares written so a NaN x falls through unclamped
+  f32 v = x > ML_TANH_CLAMP ? ML_TANH_CLAMP : x;
+  v = v < -ML_TANH_CLAMP ? -ML_TANH_CLAMP : v;
+  const f32 e = ml_expf_approx(-2.0f * v, fastest);
+  return (1.0f - e) / (1.0f + e);
+}
+
+static inline f32 ml_geluf_approx(f32 x, int fastest) {
+  const f32 t = ml_tanhf_approx(ML_GELU_K * x * (1.0f + ML_GELU_C * x * x), fastest);
+  return 0.5f * x * (1.0f + t);
+}
+
+// d/dx of the GELU above: 0.5 (1 + t) + 0.5 x (1 - t^2) K (1 + 3 C x^2)
+static inline f32 ml_gelu_gradf_approx(f32 x, int fastest) {
+  const f32 x2 = x * x;
+  const f32 t = ml_tanhf_approx(ML_GELU_K * x * (1.0f + ML_GELU_C * x2), fastest);
+  const f32 du = ML_GELU_K * (1.0f + 3.0f * ML_GELU_C * x2);
+  return 0.5f * (1.0f + t) + 0.5f * x * (1.0f - t * t) * du;
+}
+
+/**
+ * @brief ML_MATH_EXACT activations over a run, with libm's expf/tanhf
+ * (shared by all backends). Same contract as ML_SimdKernels::act and
+ * ::act_grad.
+ */
+void ml_act_libm(f32* y, const f32* x, u64 n, ML_Activation act, f32 alpha);
+void ml_act_grad_libm(f32* dx, const f32* dy, const f32* v, u64 n,
+                      ML_Activation act, f32 alpha);
+
+#endif // ML_MATH_H
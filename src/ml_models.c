@@ -2,9 +2,43 @@
 
 #include "ml_models.h"
 #include "ml_alloc.h"
+#include "ml_plan.h"
 #include "ml_primitives.h"
 #include "ml_error.h"
 
+#include <stddef.h>
+
+// Operator order of train_step_SoftmaxRegression; infer runs the first
+// two, with the plain Softmax where training runs the fused softmax + CE
+enum {
+  SR_STEP_LINEAR_FWD,
+  SR_STEP_SOFTMAX,
+  SR_STEP_LINEAR_BWD,
+  SR_STEP_SGD,
+};
+
+static ML_Status plan_SoftmaxRegression(ml_arena* arena, SoftmaxRegression* m) {
+  // X is borrowed from the caller, so it takes no space here
+  ML_PlanBuffer bufs[] = {
+    { .mat = &m->lin.Z,      .first = SR_STEP_LINEAR_FWD, .last = SR_STEP_SOFTMAX },
+    { .mat = &m->sm.rowmax,  .first = SR_STEP_SOFTMAX,    .last = SR_STEP_SOFTMAX },
+    { .mat = &m->sm.rowsum,  .first = SR_STEP_SOFTMAX,    .last = SR_STEP_SOFTMAX },
+    { .mat = &m->sm.P,       .first = SR_STEP_SOFTMAX,    .last = SR_STEP_SOFTMAX },
+    // Training only from here on
+    { .mat = &m->ce.rowloss, .first = SR_STEP_SOFTMAX,    .last = SR_STEP_SOFTMAX },
+    { .mat = &m->ce.dZ,      .first = SR_STEP_SOFTMAX,    .last = SR_STEP_LINEAR_BWD },
+    { .mat = &m->lin.dW,     .first = SR_STEP_LINEAR_BWD, .last = SR_STEP_SGD },
+    { .mat = &m->lin.db,     .first = SR_STEP_LINEAR_BWD, .last = SR_STEP_SGD },
+  };
+  const u64 n = m->conf.inference_only ? 4 : sizeof(bufs) / sizeof(bufs[0]);
+  u64 bytes = 0;
+
+  ML_Status status = plan_buffers(bufs, n, &bytes);
+  if (status != ML_OK) return status;
+
+  return bind_plan_buffers(arena, bufs, n, bytes);
+}
+
 ML_Status create_config_SoftmaxRegression(SoftmaxRegressionConfig* conf,
                                          u64 N, u64 D, u64 C,
                                          ML_Rng* rng,
@@ -19,6 +53,8 @@ ML_Status create_config_SoftmaxRegression(SoftmaxRegressionConfig* conf,
   conf->rng = rng;
   conf->w_init = w_init;
   conf->b_init = b_init;
+  conf->plan_workspace = 0;
+  conf->inference_only = 0;
 
   return ML_OK;
 }
@@ -43,6 +79,11 @@ ML_Status create_model_SoftmaxRegression(ml_arena* arena,
                                 conf.w_init,
                                 conf.b_init);
   if (status != ML_OK) return status;
+  lconf.external_workspace = conf.plan_workspace;
+  lconf.inference_only = conf.inference_only;
+  // X is a live argument for the whole of infer / train_step, so the
+  // Linear reads it in place rather than keeping an (N×D) copy
+  lconf.borrow_input = 1;
 
   status = create_op_Linear(arena, &m->lin, lconf);
   if (status != ML_OK) return status;
@@ -51,19 +92,86 @@ ML_Status create_model_SoftmaxRegression(ml_arena* arena,
   SoftmaxConfig sconf;
   status = create_config_Softmax(&sconf, conf.N, conf.C);
   if (status != ML_OK) return status;
+  sconf.external_workspace = conf.plan_workspace;
 
   status = create_op_Softmax(arena, &m->sm, sconf);
   if (status != ML_OK) return status;
 
-  // ---- CrossEntropy ----
-  // Assumes you have CEConfig + create_config_CrossEntropy + create_op_CrossEntropy
-  CEConfig ceconf;
-  status = create_config_CrossEntropy(&ceconf, conf.N, conf.C);
+  // ---- Softmax + CrossEntropy (training) ----
+  m->ce = (SoftmaxCrossEntropy){0};
+  if (!conf.inference_only) {
+    SoftmaxCEConfig ceconf;
+    status = create_config_SoftmaxCrossEntropy(&ceconf, conf.N, conf.C);
+    if (status != ML_OK) return status;
+    ceconf.external_workspace = conf.plan_workspace;
+
+    status = create_op_SoftmaxCrossEntropy(arena, &m->ce, ceconf);
+    if (status != ML_OK) return status;
+  }
+
+  // ---- Workspace plan ----
+  if (conf.plan_workspace) {
+    status = plan_SoftmaxRegression(arena, m);
+    if (status != ML_OK) return status;
+  }
+
+  return ML_OK;
+}
+
+ML_Status footprint_SoftmaxRegression(SoftmaxRegressionConfig conf, u64* out_bytes) {
+  if (!out_bytes) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+  ml_arena counter;
+  SoftmaxRegression m;
+
+  status = create_counting_ml_arena(&counter);
   if (status != ML_OK) return status;
 
-  status = create_op_CrossEntropy(arena, &m->ce, ceconf);
+  status = create_model_SoftmaxRegression(&counter, &m, conf);
   if (status != ML_OK) return status;
 
+  // A real arena may start at any position, so the first allocation can
+  // need up to ARENA_ALIGN - 1 more bytes of padding
+  *out_bytes = get_used_ml_arena_bytes(&counter) + (u64)ARENA_ALIGN - 1;
+  return ML_OK;
+}
+
+ML_Status max_batch_SoftmaxRegression(SoftmaxRegressionConfig conf, u64 bytes, u64* out_N) {
+  if (!out_N) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+  u64 need = 0;
+
+  // The footprint grows with N: double until it no longer fits, then
+  // bisect between the last fit (lo) and the first miss (hi). Once N = 1
+  // fits, a footprint that fails (its size overflows the counting arena
+  // when bytes is huge) counts as a miss too.
+  u64 lo = 0;
+  u64 hi = 1;
+  for (;;) {
+    conf.N = hi;
+    status = footprint_SoftmaxRegression(conf, &need);
+    if (status != ML_OK && lo == 0) return status;
+    if (status != ML_OK || need > bytes) break;
+
+    lo = hi;
+    if (hi == UINT64_MAX) break;
+    hi = hi > UINT64_MAX / 2 ? UINT64_MAX : hi * 2;
+  }
+
+  while (hi - lo > 1) {
+    const u64 mid = lo + (hi - lo) / 2;
+    conf.N = mid;
+    status = footprint_SoftmaxRegression(conf, &need);
+
+    if (status == ML_OK && need <= bytes) lo = mid;
+    else hi = mid;
+  }
+
+  if (lo == 0) return ML_OUT_OF_MEMORY;
+
+  *out_N = lo;
   return ML_OK;
 }
 
@@ -92,33 +200,27 @@ ML_Status infer_SoftmaxRegression(SoftmaxRegression* m,
   return ML_OK;
 }
 
-ML_Status train_step_SoftmaxRegression(SoftmaxRegression* m,
-                                      const Matf32 X,
-                                      const Matf32 Y,
-                                      f32 lr,
-                                      f32* out_loss) {
-  if (!m || !out_loss) return ML_INVALID_ARGUMENT;
-  if (!X.data || !Y.data) return ML_INVALID_ARGUMENT;
-
-  if (X.rows != m->conf.N || X.cols != m->conf.D) return ML_INVALID_ARGUMENT;
-  if (Y.rows != m->conf.N || Y.cols != m->conf.C) return ML_INVALID_ARGUMENT;
-
+// Shared body of train_step_*: Y is used when labels is NULL
+static ML_Status train_step_SoftmaxRegression_any(SoftmaxRegression* m,
+                                                 const Matf32 X,
+                                                 const Matf32 Y,
+                                                 const u32* labels,
+                                                 f32 lr,
+                                                 f32* out_loss) {
   ML_Status status = ML_OK;
 
   // Forward
   status = execute_op_Linear_forward(&m->lin, X);
   if (status != ML_OK) return status;
 
-  status = execute_op_Softmax_forward(&m->sm, m->lin.Z);
-  if (status != ML_OK) return status;
-
-  status = execute_op_CrossEntropy_forward(&m->ce, m->sm.P, Y);
+  // Loss and dZ straight from the logits
+  if (labels)
+    status = execute_op_SoftmaxCrossEntropy_labels(&m->ce, m->lin.Z, labels);
+  else
+    status = execute_op_SoftmaxCrossEntropy(&m->ce, m->lin.Z, Y);
   if (status != ML_OK) return status;
 
   // Backward
-  status = execute_op_CrossEntropy_backward(&m->ce, m->sm.P, Y);
-  if (status != ML_OK) return status;
-
   status = execute_op_Linear_backward(&m->lin, m->ce.dZ);
   if (status != ML_OK) return status;
 
@@ -130,23 +232,48 @@ ML_Status train_step_SoftmaxRegression(SoftmaxRegression* m,
   return ML_OK;
 }
 
-ML_Status train_SoftmaxRegression(SoftmaxRegression* m,
-                                 ML_BatchProvider provider,
-                                 ML_TrainConfig tconf,
-                                 Matf32* Xbuf,
-                                 Matf32* Ybuf,
-                                 f32* out_last_loss) {
-  if (!m || !provider.next_batch || !Xbuf || !Ybuf || !out_last_loss)
-    return ML_INVALID_ARGUMENT;
+ML_Status train_step_SoftmaxRegression(SoftmaxRegression* m,
+                                      const Matf32 X,
+                                      const Matf32 Y,
+                                      f32 lr,
+                                      f32* out_loss) {
+  if (!m || !out_loss) return ML_INVALID_ARGUMENT;
+  if (!X.data || !Y.data) return ML_INVALID_ARGUMENT;
 
-  // Check buffer shapes match model
-  if (!Xbuf->data || Xbuf->rows != m->conf.N || Xbuf->cols != m->conf.D)
-    return ML_INVALID_ARGUMENT;
-  if (!Ybuf->data || Ybuf->rows != m->conf.N || Ybuf->cols != m->conf.C)
-    return ML_INVALID_ARGUMENT;
+  if (X.rows != m->conf.N || X.cols != m->conf.D) return ML_INVALID_ARGUMENT;
+  if (Y.rows != m->conf.N || Y.cols != m->conf.C) return ML_INVALID_ARGUMENT;
+  if (m->conf.inference_only) return ML_INVALID_ARGUMENT;
 
-  if (tconf.epochs == 0) return ML_INVALID_ARGUMENT;
+  return train_step_SoftmaxRegression_any(m, X, Y, NULL, lr, out_loss);
+}
 
+ML_Status train_step_SoftmaxRegression_labels(SoftmaxRegression* m,
+                                             const Matf32 X,
+                                             const u32* labels,
+                                             f32 lr,
+                                             f32* out_loss) {
+  if (!m || !out_loss) return ML_INVALID_ARGUMENT;
+  if (!X.data || !labels) return ML_INVALID_ARGUMENT;
+
+  if (X.rows != m->conf.N || X.cols != m->conf.D) return ML_INVALID_ARGUMENT;
+  if (m->conf.inference_only) return ML_INVALID_ARGUMENT;
+
+  return train_step_SoftmaxRegression_any(m, X, (Matf32){0}, labels, lr, out_loss);
+}
+
+// One training step of some model; Y is used when labels is NULL
+typedef ML_Status (*train_step_fn)(void* m, const Matf32 X, const Matf32 Y,
+                                   const u32* labels, f32 lr, f32* out_loss);
+
+// Shared loop of train_*: pulls sparse labels when label_buf is set
+static ML_Status train_loop(void* m,
+                            train_step_fn step,
+                            ML_BatchProvider provider,
+                            ML_TrainConfig tconf,
+                            Matf32* Xbuf,
+                            Matf32* Ybuf,
+                            u32* label_buf,
+                            f32* out_last_loss) {
   ML_Status status = ML_OK;
   f32 last_loss = 0.0f;
   u64 global_step = 0;
@@ -155,7 +282,15 @@ ML_Status train_SoftmaxRegression(SoftmaxRegression* m,
 
     // Consume batches until provider says epoch is done
     while (1) {
-      status = provider.next_batch(provider.ctx, Xbuf, Ybuf);
+      // The provider may fill the buffers or swap in views, so hand it
+      // copies of the descriptors and leave the caller's ones untouched
+      Matf32 Xb = *Xbuf;
+      Matf32 Yb = Ybuf ? *Ybuf : (Matf32){0};
+      u32* lb = label_buf;
+      if (label_buf)
+        status = provider.next_batch_labels(provider.ctx, &Xb, &lb);
+      else
+        status = provider.next_batch(provider.ctx, &Xb, &Yb);
 
       if (status == ML_DONE) {
         // end of epoch
@@ -165,7 +300,7 @@ ML_Status train_SoftmaxRegression(SoftmaxRegression* m,
         return status;
       }
 
-      status = train_step_SoftmaxRegression(m, *Xbuf, *Ybuf, tconf.lr, &last_loss);
+      status = step(m, Xb, Yb, label_buf ? lb : NULL, tconf.lr, &last_loss);
       if (status != ML_OK) return status;
 
       ++global_step;
@@ -183,3 +318,619 @@ ML_Status train_SoftmaxRegression(SoftmaxRegression* m,
   *out_last_loss = last_loss;
   return ML_OK;
 }
+
+static ML_Status train_step_SoftmaxRegression_fn(void* m, const Matf32 X, const Matf32 Y,
+                                                 const u32* labels, f32 lr, f32* out_loss) {
+  if (labels) return train_step_SoftmaxRegression_labels(m, X, labels, lr, out_loss);
+  return train_step_SoftmaxRegression(m, X, Y, lr, out_loss);
+}
+
+ML_Status train_SoftmaxRegression(SoftmaxRegression* m,
+                                 ML_BatchProvider provider,
+                                 ML_TrainConfig tconf,
+                                 Matf32* Xbuf,
+                                 Matf32* Ybuf,
+                                 f32* out_last_loss) {
+  if (!m || !provider.next_batch || !Xbuf || !Ybuf || !out_last_loss)
+    return ML_INVALID_ARGUMENT;
+
+  // Check buffer shapes match model
+  if (!Xbuf->data || Xbuf->rows != m->conf.N || Xbuf->cols != m->conf.D)
+    return ML_INVALID_ARGUMENT;
+  if (!Ybuf->data || Ybuf->rows != m->conf.N || Ybuf->cols != m->conf.C)
+    return ML_INVALID_ARGUMENT;
+
+  if (tconf.epochs == 0) return ML_INVALID_ARGUMENT;
+
+  return train_loop(m, train_step_SoftmaxRegression_fn, provider, tconf,
+                    Xbuf, Ybuf, NULL, out_last_loss);
+}
+
+ML_Status train_SoftmaxRegression_labels(SoftmaxRegression* m,
+                                        ML_BatchProvider provider,
+                                        ML_TrainConfig tconf,
+                                        Matf32* Xbuf,
+                                        u32* label_buf,
+                                        f32* out_last_loss) {
+  if (!m || !provider.next_batch_labels || !Xbuf || !label_buf || !out_last_loss)
+    return ML_INVALID_ARGUMENT;
+
+  if (!Xbuf->data || Xbuf->rows != m->conf.N || Xbuf->cols != m->conf.D)
+    return ML_INVALID_ARGUMENT;
+
+  if (tconf.epochs == 0) return ML_INVALID_ARGUMENT;
+
+  return train_loop(m, train_step_SoftmaxRegression_fn, provider, tconf,
+                    Xbuf, NULL, label_buf, out_last_loss);
+}
+
+// Schedule of train_step_MLP with L hidden layers. Forward: hidden layer l
+// runs its Linear at step 2l and its separate Activation (if any) at
+// 2l + 1, the output Linear at 2L and the loss at 2L + 1. Backward then
+// takes three steps per layer, top down, starting at mlp_step_bwd.
+enum {
+  MLP_BWD_W,    // dW, db from dZ and the layer input
+  MLP_BWD_X,    // dH of the layer below from dZ and the old W
+  MLP_BWD_SGD,  // update W, b; dH to the gradient wrt the pre-activation
+  MLP_BWD_STEPS,
+};
+
+static u32 mlp_step_fwd(u64 l) { return (u32)(2 * l); }
+static u32 mlp_step_act(u64 l) { return (u32)(2 * l + 1); }
+static u32 mlp_step_loss(u64 L) { return (u32)(2 * L + 1); }
+static u32 mlp_step_bwd(u64 L, u64 l) { return (u32)(2 * L + 2 + MLP_BWD_STEPS * (L - l)); }
+
+static ML_Status plan_MLP(ml_arena* arena, MLP* m) {
+  const u64 L = m->conf.n_hidden;
+  const int train = !m->conf.inference_only;
+  ML_PlanBuffer bufs[ML_PLAN_MAX_BUFFERS];
+  u64 n = 0;
+
+  // Hidden outputs: inference frees them once the next layer has read
+  // them, training keeps them for that layer's backward and for the
+  // activation derivative
+  for (u64 l = 0; l < L; ++l) {
+    const u32 back = mlp_step_bwd(L, l + 1) + MLP_BWD_SGD;
+    if (m->fused) {
+      bufs[n++] = (ML_PlanBuffer){ .mat = &m->lin[l].Z, .first = mlp_step_fwd(l),
+                                   .last = train ? back : mlp_step_fwd(l + 1) };
+    } else {
+      bufs[n++] = (ML_PlanBuffer){ .mat = &m->lin[l].Z, .first = mlp_step_fwd(l),
+                                   .last = train ? back : mlp_step_act(l) };
+      bufs[n++] = (ML_PlanBuffer){ .mat = &m->act[l].A, .first = mlp_step_act(l),
+                                   .last = train ? back : mlp_step_fwd(l + 1) };
+    }
+  }
+
+  // Logits and the softmax
+  const u32 loss = mlp_step_loss(L);
+  bufs[n++] = (ML_PlanBuffer){ .mat = &m->lin[L].Z,     .first = mlp_step_fwd(L), .last = loss };
+  bufs[n++] = (ML_PlanBuffer){ .mat = &m->sm.rowmax,    .first = loss, .last = loss };
+  bufs[n++] = (ML_PlanBuffer){ .mat = &m->sm.rowsum,    .first = loss, .last = loss };
+  bufs[n++] = (ML_PlanBuffer){ .mat = &m->sm.P,         .first = loss, .last = loss };
+
+  if (train) {
+    bufs[n++] = (ML_PlanBuffer){ .mat = &m->ce.rowloss, .first = loss, .last = loss };
+    bufs[n++] = (ML_PlanBuffer){ .mat = &m->ce.dZ,      .first = loss,
+                                 .last = mlp_step_bwd(L, L) + MLP_BWD_X };
+
+    // Each layer's weight gradients only live for its own update, so all
+    // layers share one slot
+    for (u64 l = 0; l <= L; ++l) {
+      const u32 b = mlp_step_bwd(L, l);
+      bufs[n++] = (ML_PlanBuffer){ .mat = &m->lin[l].dW, .first = b + MLP_BWD_W, .last = b + MLP_BWD_SGD };
+      bufs[n++] = (ML_PlanBuffer){ .mat = &m->lin[l].db, .first = b + MLP_BWD_W, .last = b + MLP_BWD_SGD };
+    }
+
+    // dH[l] is written by layer l + 1 and consumed as layer l's dZ
+    for (u64 l = 0; l < L; ++l) {
+      bufs[n++] = (ML_PlanBuffer){ .mat = &m->dH[l], .first = mlp_step_bwd(L, l + 1) + MLP_BWD_X,
+                                   .last = mlp_step_bwd(L, l) + MLP_BWD_X };
+    }
+  }
+
+  u64 bytes = 0;
+  ML_Status status = plan_buffers(bufs, n, &bytes);
+  if (status != ML_OK) return status;
+
+  return bind_plan_buffers(arena, bufs, n, bytes);
+}
+
+ML_Status create_config_MLP(MLPConfig* conf,
+                            u64 N, u64 D, u64 C,
+                            const u64* hidden, u64 n_hidden,
+                            ML_Activation act,
+                            ML_Rng* rng,
+                            FillStrategy w_init,
+                            FillStrategy b_init) {
+  if (!conf || !hidden) return ML_INVALID_ARGUMENT;
+  if (N == 0 || D == 0 || C == 0) return ML_INVALID_ARGUMENT;
+  if (n_hidden == 0 || n_hidden > ML_MLP_MAX_HIDDEN) return ML_INVALID_ARGUMENT;
+  if ((u32)act > (u32)ML_ACT_GELU) return ML_INVALID_ARGUMENT;
+
+  conf->N = N;
+  conf->D = D;
+  conf->C = C;
+  conf->n_hidden = n_hidden;
+  for (u64 l = 0; l < ML_MLP_MAX_HIDDEN; ++l) {
+    conf->hidden[l] = l < n_hidden ? hidden[l] : 0;
+    if (l < n_hidden && hidden[l] == 0) return ML_INVALID_ARGUMENT;
+  }
+  conf->act = act;
+  conf->alpha = 0.01f;
+  conf->rng = rng;
+  conf->w_init = w_init;
+  conf->b_init = b_init;
+  conf->plan_workspace = 1;
+  conf->inference_only = 0;
+
+  return ML_OK;
+}
+
+ML_Status create_model_MLP(ml_arena* arena, MLP* m, MLPConfig conf) {
+  if (!arena || !m) return ML_INVALID_ARGUMENT;
+  if (conf.n_hidden == 0 || conf.n_hidden > ML_MLP_MAX_HIDDEN) return ML_INVALID_ARGUMENT;
+  if ((u32)conf.act > (u32)ML_ACT_GELU) return ML_INVALID_ARGUMENT;
+  // Backward tells the leaky branches apart by the sign of the output
+  if (conf.act == ML_ACT_LEAKY_RELU && !(conf.alpha >= 0.0f)) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+  const u64 L = conf.n_hidden;
+
+  // Store config in the model
+  m->conf = conf;
+  // GELU cannot be differentiated from its output, so training keeps
+  // the pre-activation and runs the activation separately
+  m->fused = conf.act != ML_ACT_GELU || conf.inference_only;
+
+  u64 in = conf.D;
+  for (u64 l = 0; l <= L; ++l) {
+    const u64 out = l < L ? conf.hidden[l] : conf.C;
+    if (out == 0) return ML_INVALID_ARGUMENT;
+
+    // ---- Linear ----
+    LinearConfig lconf;
+    status = create_config_Linear(&lconf, conf.N, in, out, conf.rng, conf.w_init, conf.b_init);
+    if (status != ML_OK) return status;
+    lconf.external_workspace = conf.plan_workspace;
+    lconf.inference_only = conf.inference_only;
+    // Every layer reads its input in place: X from the caller, then the
+    // hidden outputs, which stay live until backward anyway
+    lconf.borrow_input = 1;
+    if (l < L && m->fused) {
+      lconf.act = conf.act;
+      lconf.alpha = conf.alpha;
+    }
+
+    status = create_op_Linear(arena, &m->lin[l], lconf);
+    if (status != ML_OK) return status;
+
+    if (l == L) break;
+
+    // ---- Activation (unfused only) ----
+    m->act[l] = (Activation){0};
+    if (!m->fused) {
+      ActivationConfig aconf;
+      status = create_config_Activation(&aconf, conf.N, out, conf.act);
+      if (status != ML_OK) return status;
+      aconf.alpha = conf.alpha;
+      aconf.external_workspace = conf.plan_workspace;
+      // The gradient is rewritten in place in dH
+      aconf.inplace_backward = 1;
+
+      status = create_op_Activation(arena, &m->act[l], aconf);
+      if (status != ML_OK) return status;
+    }
+
+    // ---- Hidden gradient ----
+    m->dH[l] = (Matf32){0};
+    if (!conf.inference_only) {
+      m->dH[l] = (Matf32){ .rows = conf.N, .cols = out };
+      if (!conf.plan_workspace) {
+        const char* prev_tag = set_tag_ml_arena(arena, "MLP.dH");
+        status = create_Mat(arena, &m->dH[l], conf.N, out);
+        set_tag_ml_arena(arena, prev_tag);
+        if (status != ML_OK) return status;
+      }
+    }
+
+    in = out;
+  }
+
+  // ---- Softmax ----
+  SoftmaxConfig sconf;
+  status = create_config_Softmax(&sconf, conf.N, conf.C);
+  if (status != ML_OK) return status;
+  sconf.external_workspace = conf.plan_workspace;
+
+  status = create_op_Softmax(arena, &m->sm, sconf);
+  if (status != ML_OK) return status;
+
+  // ---- Softmax + CrossEntropy (training) ----
+  m->ce = (SoftmaxCrossEntropy){0};
+  if (!conf.inference_only) {
+    SoftmaxCEConfig ceconf;
+    status = create_config_SoftmaxCrossEntropy(&ceconf, conf.N, conf.C);
+    if (status != ML_OK) return status;
+    ceconf.external_workspace = conf.plan_workspace;
+
+    status = create_op_SoftmaxCrossEntropy(arena, &m->ce, ceconf);
+    if (status != ML_OK) return status;
+  }
+
+  // ---- Workspace plan ----
+  if (conf.plan_workspace) {
+    status = plan_MLP(arena, m);
+    if (status != ML_OK) return status;
+  }
+
+  return ML_OK;
+}
+
+ML_Status footprint_MLP(MLPConfig conf, u64* out_bytes) {
+  if (!out_bytes) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+  ml_arena counter;
+  MLP m;
+
+  status = create_counting_ml_arena(&counter);
+  if (status != ML_OK) return status;
+
+  status = create_model_MLP(&counter, &m, conf);
+  if (status != ML_OK) return status;
+
+  // Same padding allowance as footprint_SoftmaxRegression
+  *out_bytes = get_used_ml_arena_bytes(&counter) + (u64)ARENA_ALIGN - 1;
+  return ML_OK;
+}
+
+// All layers up to the logits in m->lin[n_hidden].Z
+static ML_Status mlp_forward(MLP* m, const Matf32 X) {
+  const u64 L = m->conf.n_hidden;
+  ML_Status status = ML_OK;
+  Matf32 H = X;
+
+  for (u64 l = 0; l <= L; ++l) {
+    status = execute_op_Linear_forward(&m->lin[l], H);
+    if (status != ML_OK) return status;
+    if (l == L) break;
+
+    H = m->lin[l].Z;
+    if (!m->fused) {
+      status = execute_op_Activation_forward(&m->act[l], H);
+      if (status != ML_OK) return status;
+      H = m->act[l].A;
+    }
+  }
+
+  return ML_OK;
+}
+
+ML_Status infer_MLP(MLP* m, const Matf32 X, Matf32* outP) {
+  if (!m || !outP) return ML_INVALID_ARGUMENT;
+  if (!X.data || !outP->data) return ML_INVALID_ARGUMENT;
+
+  // Shape checks
+  if (X.rows != m->conf.N || X.cols != m->conf.D) return ML_INVALID_ARGUMENT;
+  if (outP->rows != m->conf.N || outP->cols != m->conf.C) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  status = mlp_forward(m, X);
+  if (status != ML_OK) return status;
+
+  status = execute_op_Softmax_forward(&m->sm, m->lin[m->conf.n_hidden].Z);
+  if (status != ML_OK) return status;
+
+  // Copy probabilities out
+  status = MatCopy_into(outP, m->sm.P);
+  if (status != ML_OK) return status;
+
+  return ML_OK;
+}
+
+// Shared body of train_step_MLP*: Y is used when labels is NULL
+static ML_Status train_step_MLP_any(MLP* m,
+                                    const Matf32 X,
+                                    const Matf32 Y,
+                                    const u32* labels,
+                                    f32 lr,
+                                    f32* out_loss) {
+  const u64 L = m->conf.n_hidden;
+  ML_Status status = ML_OK;
+
+  // Forward
+  status = mlp_forward(m, X);
+  if (status != ML_OK) return status;
+
+  // Loss and dZ straight from the logits
+  if (labels)
+    status = execute_op_SoftmaxCrossEntropy_labels(&m->ce, m->lin[L].Z, labels);
+  else
+    status = execute_op_SoftmaxCrossEntropy(&m->ce, m->lin[L].Z, Y);
+  if (status != ML_OK) return status;
+
+  // Backward, top down; each layer is updated once the gradient for the
+  // layer below has been taken from its old weights
+  Matf32 dZ = m->ce.dZ;
+  for (u64 l = L + 1; l-- > 0;) {
+    status = execute_op_Linear_backward(&m->lin[l], dZ);
+    if (status != ML_OK) return status;
+
+    if (l > 0) {
+      status = execute_op_Linear_backward_input(&m->lin[l], dZ, &m->dH[l - 1]);
+      if (status != ML_OK) return status;
+    }
+
+    status = execute_op_Linear_sgd_step(&m->lin[l], lr);
+    if (status != ML_OK) return status;
+
+    if (l == 0) break;
+
+    // Gradient wrt the hidden output -> wrt its pre-activation, in place
+    Matf32* dH = &m->dH[l - 1];
+    if (m->fused)
+      status = Mat_act_grad_into(dH, *dH, m->lin[l - 1].Z, m->conf.act, m->conf.alpha);
+    else
+      status = execute_op_Activation_backward_inplace(&m->act[l - 1], dH);
+    if (status != ML_OK) return status;
+
+    dZ = *dH;
+  }
+
+  *out_loss = m->ce.loss;
+  return ML_OK;
+}
+
+ML_Status train_step_MLP(MLP* m, const Matf32 X, const Matf32 Y, f32 lr, f32* out_loss) {
+  if (!m || !out_loss) return ML_INVALID_ARGUMENT;
+  if (!X.data || !Y.data) return ML_INVALID_ARGUMENT;
+
+  if (X.rows != m->conf.N || X.cols != m->conf.D) return ML_INVALID_ARGUMENT;
+  if (Y.rows != m->conf.N || Y.cols != m->conf.C) return ML_INVALID_ARGUMENT;
+  if (m->conf.inference_only) return ML_INVALID_ARGUMENT;
+
+  return train_step_MLP_any(m, X, Y, NULL, lr, out_loss);
+}
+
+ML_Status train_step_MLP_labels(MLP* m, const Matf32 X, const u32* labels,
+                                f32 lr, f32* out_loss) {
+  if (!m || !out_loss) return ML_INVALID_ARGUMENT;
+  if (!X.data || !labels) return ML_INVALID_ARGUMENT;
+
+  if (X.rows != m->conf.N || X.cols != m->conf.D) return ML_INVALID_ARGUMENT;
+  if (m->conf.inference_only) return ML_INVALID_ARGUMENT;
+
+  return train_step_MLP_any(m, X, (Matf32){0}, labels, lr, out_loss);
+}
+
+static ML_Status train_step_MLP_fn(void* m, const Matf32 X, const Matf32 Y,
+                                   const u32* labels, f32 lr, f32* out_loss) {
+  if (labels) return train_step_MLP_labels(m, X, labels, lr, out_loss);
+  return train_step_MLP(m, X, Y, lr, out_loss);
+}
+
+ML_Status train_MLP(MLP* m,
+                    ML_BatchProvider provider,
+                    ML_TrainConfig tconf,
+                    Matf32* Xbuf,
+                    Matf32* Ybuf,
+                    f32* out_last_loss) {
+  if (!m || !provider.next_batch || !Xbuf || !Ybuf || !out_last_loss)
+    return ML_INVALID_ARGUMENT;
+
+  // Check buffer shapes match model
+  if (!Xbuf->data || Xbuf->rows != m->conf.N || Xbuf->cols != m->conf.D)
+    return ML_INVALID_ARGUMENT;
+  if (!Ybuf->data || Ybuf->rows != m->conf.N || Ybuf->cols != m->conf.C)
+    return ML_INVALID_ARGUMENT;
+
+  if (tconf.epochs == 0) return ML_INVALID_ARGUMENT;
+
+  return train_loop(m, train_step_MLP_fn, provider, tconf, Xbuf, Ybuf, NULL, out_last_loss);
+}
+
+ML_Status train_MLP_labels(MLP* m,
+                           ML_BatchProvider provider,
+                           ML_TrainConfig tconf,
+                           Matf32* Xbuf,
+                           u32* label_buf,
+                           f32* out_last_loss) {
+  if (!m || !provider.next_batch_labels || !Xbuf || !label_buf || !out_last_loss)
+    return ML_INVALID_ARGUMENT;
+
+  if (!Xbuf->data || Xbuf->rows != m->conf.N || Xbuf->cols != m->conf.D)
+    return ML_INVALID_ARGUMENT;
+
+  if (tconf.epochs == 0) return ML_INVALID_ARGUMENT;
+
+  return train_loop(m, train_step_MLP_fn, provider, tconf, Xbuf, NULL, label_buf, out_last_loss);
+}
+
+ML_Status create_config_SoftmaxRegressionI8(SoftmaxRegressionI8Config* conf,
+                                           ML_QuantGranularity w_gran,
+                                           const Matf32* calib_X) {
+  if (!conf) return ML_INVALID_ARGUMENT;
+  if (w_gran != ML_QUANT_PER_TENSOR && w_gran != ML_QUANT_PER_ROW)
+    return ML_INVALID_ARGUMENT;
+  if (calib_X && (!calib_X->data || calib_X->rows == 0)) return ML_INVALID_ARGUMENT;
+
+  conf->w_gran = w_gran;
+  conf->calib_X = calib_X;
+
+  return ML_OK;
+}
+
+ML_Status create_model_SoftmaxRegressionI8(ml_arena* arena,
+                                          SoftmaxRegressionI8* q,
+                                          const SoftmaxRegression* src,
+                                          SoftmaxRegressionI8Config conf) {
+  if (!arena || !q || !src) return ML_INVALID_ARGUMENT;
+  if (conf.calib_X && conf.calib_X->cols != src->conf.D) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  q->conf = src->conf;
+
+  // ---- Calibration ----
+  // Static input scale maps the largest |x| seen to 127
+  f32 x_scale = 0.0f;
+  if (conf.calib_X) {
+    const Matf32 cx = *conf.calib_X;
+    f32 absmax = 0.0f;
+    for (u64 r = 0; r < cx.rows; ++r) {
+      const f32* row = Mat_row_ptr(cx, r);
+      for (u64 c = 0; c < cx.cols; ++c) {
+        f32 v = row[c] < 0.0f ? -row[c] : row[c];
+        if (v > absmax) absmax = v;
+      }
+    }
+    x_scale = absmax > 0.0f ? absmax / 127.0f : 0.0f;
+  }
+
+  // ---- LinearI8 ----
+  LinearI8Config lconf;
+  status = create_config_LinearI8(&lconf, &src->lin, conf.w_gran, x_scale);
+  if (status != ML_OK) return status;
+
+  status = create_op_LinearI8(arena, &q->lin, lconf);
+  if (status != ML_OK) return status;
+
+  // ---- Softmax ----
+  SoftmaxConfig sconf;
+  status = create_config_Softmax(&sconf, src->conf.N, src->conf.C);
+  if (status != ML_OK) return status;
+
+  status = create_op_Softmax(arena, &q->sm, sconf);
+  if (status != ML_OK) return status;
+
+  return ML_OK;
+}
+
+ML_Status infer_SoftmaxRegressionI8(SoftmaxRegressionI8* q,
+                                   const Matf32 X,
+                                   Matf32* outP) {
+  if (!q || !outP) return ML_INVALID_ARGUMENT;
+  if (!X.data || !outP->data) return ML_INVALID_ARGUMENT;
+
+  // Shape checks
+  if (X.rows != q->conf.N || X.cols != q->conf.D) return ML_INVALID_ARGUMENT;
+  if (outP->rows != q->conf.N || outP->cols != q->conf.C) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  status = execute_op_LinearI8_forward(&q->lin, X);
+  if (status != ML_OK) return status;
+
+  status = execute_op_Softmax_forward(&q->sm, q->lin.Z);
+  if (status != ML_OK) return status;
+
+  // Copy probabilities out
+  status = MatCopy_into(outP, q->sm.P);
+  if (status != ML_OK) return status;
+
+  return ML_OK;
+}
+
+ML_Status create_config_SoftmaxRegressionQ(SoftmaxRegressionQConfig* conf,
+                                          ML_FixedType w_type,
+                                          const Matf32* calib_X) {
+  if (!conf || !calib_X) return ML_INVALID_ARGUMENT;
+  if (w_type != ML_FIXED_Q7 && w_type != ML_FIXED_Q15) return ML_INVALID_ARGUMENT;
+  if (!calib_X->data || calib_X->rows == 0) return ML_INVALID_ARGUMENT;
+
+  conf->w_type = w_type;
+  conf->calib_X = calib_X;
+
+  return ML_OK;
+}
+
+ML_Status create_model_SoftmaxRegressionQ(ml_arena* arena,
+                                         SoftmaxRegressionQ* q,
+                                         const SoftmaxRegression* src,
+                                         SoftmaxRegressionQConfig conf) {
+  if (!arena || !q || !src || !conf.calib_X) return ML_INVALID_ARGUMENT;
+
+  const Matf32 cx = *conf.calib_X;
+  const Matf32 W = src->lin.W;
+  const Matf32 b = src->lin.b;
+  if (!cx.data || cx.cols != src->conf.D) return ML_INVALID_ARGUMENT;
+  if (!W.data || !b.data) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  q->conf = src->conf;
+
+  // ---- Calibration ----
+  // Largest |x| and largest |z| = |x W + b| over the calibration rows
+  f32 x_absmax = 0.0f;
+  f32 z_absmax = 0.0f;
+  for (u64 r = 0; r < cx.rows; ++r) {
+    const f32* x = Mat_row_ptr(cx, r);
+    for (u64 d = 0; d < cx.cols; ++d) {
+      f32 v = x[d] < 0.0f ? -x[d] : x[d];
+      if (v > x_absmax) x_absmax = v;
+    }
+    for (u64 c = 0; c < W.cols; ++c) {
+      f32 z = Mat_at(b, 0, c);
+      for (u64 d = 0; d < W.rows; ++d) z += x[d] * Mat_at(W, d, c);
+      if (z < 0.0f) z = -z;
+      if (z > z_absmax) z_absmax = z;
+    }
+  }
+
+  // ---- LinearQ ----
+  LinearQConfig lconf;
+  status = create_config_LinearQ(&lconf, &src->lin, conf.w_type,
+                                 ml_fixed_frac_for(x_absmax, ML_FIXED_Q15),
+                                 ml_fixed_frac_for(z_absmax, ML_FIXED_Q15));
+  if (status != ML_OK) return status;
+
+  status = create_op_LinearQ(arena, &q->lin, lconf);
+  if (status != ML_OK) return status;
+
+  return ML_OK;
+}
+
+ML_Status infer_SoftmaxRegressionQ(SoftmaxRegressionQ* q,
+                                  const Matq15 X,
+                                  Matq15* outP) {
+  if (!q || !outP) return ML_INVALID_ARGUMENT;
+  if (!X.data || !outP->data) return ML_INVALID_ARGUMENT;
+
+  // Shape checks
+  if (X.rows != q->conf.N || X.cols != q->conf.D) return ML_INVALID_ARGUMENT;
+  if (outP->rows != q->conf.N || outP->cols != q->conf.C) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  status = execute_op_LinearQ_forward(&q->lin, X);
+  if (status != ML_OK) return status;
+
+  // Softmax straight into the caller's buffer
+  status = Matq15_softmax_into(outP, q->lin.Z);
+  if (status != ML_OK) return status;
+
+  return ML_OK;
+}
+
+ML_Status predict_SoftmaxRegressionQ(SoftmaxRegressionQ* q,
+                                    const Matq15 X,
+                                    u64* out_class) {
+  if (!q || !out_class) return ML_INVALID_ARGUMENT;
+  if (!X.data) return ML_INVALID_ARGUMENT;
+
+  if (X.rows != q->conf.N || X.cols != q->conf.D) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  status = execute_op_LinearQ_forward(&q->lin, X);
+  if (status != ML_OK) return status;
+
+  // Softmax is monotonic, so the logits already give the class
+  status = Matq15_argmax_rows(q->lin.Z, out_class);
+  if (status != ML_OK) return status;
+
+  return ML_OK;
+}
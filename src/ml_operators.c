@@ -1,7 +1,16 @@
 #include "ml_operators.h"
+#include "ml_conv.h"
 #include "ml_error.h"
+#include "ml_fuse.h"
+#include "ml_kernels.h"
 #include "ml_primitives.h"
-#include <math.h>
+#include "ml_simd.h"
+#include "ml_thread.h"
+
+#include <stddef.h>
+
+// Labels gathered per vectorised log call in CrossEntropy forward
+#define ML_CE_LOG_CHUNK 64
 
 ML_Status create_config_Linear(LinearConfig* conf,u64 inrows, u64 incols, u64 outcols,
                                ML_Rng* rng,FillStrategy w_strat, FillStrategy b_strat) {
@@ -12,54 +21,55 @@ ML_Status create_config_Linear(LinearConfig* conf,u64 inrows, u64 incols, u64 ou
   conf->fillW_strat = w_strat;
   conf->fillb_strat = b_strat;
   conf->rng = rng;
+  conf->sparse_input = 0;
+  conf->external_workspace = 0;
+  conf->inference_only = 0;
+  conf->borrow_input = 0;
+  conf->act = ML_ACT_NONE;
+  conf->alpha = 0.01f;
 
   return ML_OK;
 }
 
-ML_Status create_op_Linear(ml_arena *arena, Linear *lin, LinearConfig conf) {
-  if(!arena || !lin) return ML_INVALID_ARGUMENT;
+// Put back the tag a creator found on the arena and pass status through,
+// so a failed allocation does not leave the operator's tag on whatever the
+// caller allocates next
+static ML_Status restore_tag(ml_arena* arena, const char* prev_tag, ML_Status status) {
+  set_tag_ml_arena(arena, prev_tag);
+  return status;
+}
 
-  ML_Status status = ML_OK;
-  Matf32 W,X,b,Z;
-  Matf32 dW,db,X_T;
+static void linear_bias_epilogue(ML_Epilogue* ep, const Matf32 b) {
+  create_Epilogue(ep);
+  ep->bias = b;
+}
 
-  //Allocate feature Matrix
-  status = create_Mat(arena,&X,conf.in_rows,conf.in_cols);
-  if (status != ML_OK) return status;
-  //Allocate weight Matrix
-  status = create_Mat(arena,&W,conf.in_cols,conf.out_cols);
-  if (status != ML_OK) return status;
-  //Allocate bias Matrix
-  status = create_Mat(arena, &b, 1, conf.out_cols);
-  if (status != ML_OK) return status;
-  //Allocate logits Matrix
-  status = create_Mat(arena, &Z, conf.in_rows, conf.out_cols);
-  if (status != ML_OK) return status;
+// Bias plus the layer's fused activation
+static void linear_epilogue(ML_Epilogue* ep, const Linear* lin) {
+  linear_bias_epilogue(ep, lin->b);
+  ep->act = lin->act;
+  ep->alpha = lin->alpha;
+}
 
-  //Allocate dW
-  status = create_Mat(arena,&dW,conf.in_cols,conf.out_cols);
-  if (status != ML_OK) return status;
-  //Allocate db
-  status = create_Mat(arena, &db, 1, conf.out_cols);
-  if (status != ML_OK) return status;
-  //Allocate XT
-  status = create_Mat(arena, &X_T, conf.in_cols, conf.in_rows);
-  if (status != ML_OK) return status;
+// Fill the weights and bias of a parametrised operator (Linear, Conv1D)
+static ML_Status init_params(Matf32* W, Matf32* b, FillStrategy w_strat,
+                             FillStrategy b_strat, ML_Rng* rng) {
+  ML_Status status = ML_OK;
 
   //Init weights
-  switch (conf.fillW_strat) {
+  switch (w_strat) {
    case FILL_XAVIER_UNIFORM: {
-     status = Mat_xavier_uniform_dense(&W,conf.rng);
+     status = Mat_xavier_uniform_dense(W,rng);
      if(status != ML_OK) return status;
      break;
    }
    case FILL_ONES: {
-     status = MatFillScalar(&W,1.0f);
+     status = MatFillScalar(W,1.0f);
      if(status != ML_OK) return status;
      break; 
    }
    case FILL_ZEROS: {
-     status = MatFillScalar(&W,0.0f);
+     status = MatFillScalar(W,0.0f);
      if(status != ML_OK) return status;
      break; 
    }
@@ -68,19 +78,19 @@ ML_Status create_op_Linear(ml_arena *arena, Linear *lin, LinearConfig conf) {
   }
 
   //Init bias
-  switch (conf.fillb_strat) {
+  switch (b_strat) {
    case FILL_XAVIER_UNIFORM: {
-     status = Mat_xavier_uniform_dense(&b,conf.rng);
+     status = Mat_xavier_uniform_dense(b,rng);
      if(status != ML_OK) return status;
      break;
    }
    case FILL_ONES: {
-     status = MatFillScalar(&b,1.0f);
+     status = MatFillScalar(b,1.0f);
      if(status != ML_OK) return status;
      break; 
    }
    case FILL_ZEROS: {
-     status = MatFillScalar(&b,0.0f);
+     status = MatFillScalar(b,0.0f);
      if(status != ML_OK) return status;
      break; 
    }
@@ -88,13 +98,74 @@ ML_Status create_op_Linear(ml_arena *arena, Linear *lin, LinearConfig conf) {
      return ML_UNIMPLEMENTED;
   }
 
+  return ML_OK;
+}
+
+ML_Status create_op_Linear(ml_arena *arena, Linear *lin, LinearConfig conf) {
+  if(!arena || !lin) return ML_INVALID_ARGUMENT;
+  if ((u32)conf.act > (u32)ML_ACT_GELU) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+  Matf32 W,X,b,Z;
+  Matf32 dW,db;
+
+  //Workspaces get their shapes here; storage comes from the arena below
+  //unless the caller binds it
+  X = (Matf32){ .rows = conf.in_rows, .cols = conf.in_cols };
+  Z = (Matf32){ .rows = conf.in_rows, .cols = conf.out_cols };
+  dW = (Matf32){ .rows = conf.in_cols, .cols = conf.out_cols };
+  db = (Matf32){ .rows = 1, .cols = conf.out_cols };
+
+  //Allocate weight Matrix
+  const char* prev_tag = set_tag_ml_arena(arena, "Linear.W");
+  status = create_Mat(arena,&W,conf.in_cols,conf.out_cols);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+  //Allocate bias Matrix
+  set_tag_ml_arena(arena, "Linear.b");
+  status = create_Mat(arena, &b, 1, conf.out_cols);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+
+  if (!conf.external_workspace) {
+    //Allocate feature Matrix (sparse and borrowed inputs are never copied)
+    if (!conf.sparse_input && !conf.borrow_input) {
+      set_tag_ml_arena(arena, "Linear.X");
+      status = create_Mat(arena,&X,conf.in_rows,conf.in_cols);
+      if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+    }
+    //Allocate logits Matrix
+    set_tag_ml_arena(arena, "Linear.Z");
+    status = create_Mat(arena, &Z, conf.in_rows, conf.out_cols);
+    if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+
+    if (!conf.inference_only) {
+      //Allocate dW
+      set_tag_ml_arena(arena, "Linear.dW");
+      status = create_Mat(arena,&dW,conf.in_cols,conf.out_cols);
+      if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+      //Allocate db
+      set_tag_ml_arena(arena, "Linear.db");
+      status = create_Mat(arena, &db, 1, conf.out_cols);
+      if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+    }
+  }
+  set_tag_ml_arena(arena, prev_tag);
+
+  //A dry run on a counting arena has nothing to initialise
+  if (!arena->counting) {
+    status = init_params(&W, &b, conf.fillW_strat, conf.fillb_strat, conf.rng);
+    if (status != ML_OK) return status;
+  }
+
   lin->W = W;
   lin->X = X;
+  lin->Xs = (MatCSR){0};
+  lin->Xb = (Matf32){0};
   lin->b = b;
   lin->Z = Z;
-  lin->X_T = X_T;
   lin->dW = dW;
   lin->db = db;
+  lin->act = conf.act;
+  lin->alpha = conf.alpha;
 
   return status;
 }
@@ -102,30 +173,100 @@ ML_Status create_op_Linear(ml_arena *arena, Linear *lin, LinearConfig conf) {
 ML_Status execute_op_Linear_forward(Linear *lin, Matf32 in) {
   if (!lin) return ML_INVALID_ARGUMENT;
   if (!in.data) return ML_INVALID_ARGUMENT;
-  if (!lin->X.data || !lin->W.data || !lin->b.data || !lin->Z.data)
+
+  // No X to copy into: borrow the input instead
+  if (!lin->X.data) return execute_op_Linear_forward_borrow(lin, in);
+
+  if (!lin->W.data || !lin->b.data || !lin->Z.data)
     return ML_INVALID_ARGUMENT;
 
   ML_Status status = ML_OK;
 
   // Copy input into lin->X (since lin owns X)
-  // This should be replaced by a MatCopy_into
-  for (u64 r = 0; r < in.rows; ++r) {
-    for (u64 c = 0; c < in.cols; ++c) {
-      f32 v = 0.0f;
-      status = MatGet(in, r, c, &v);
-      if (status != ML_OK) return status;
-
-      status = MatSet(&lin->X, r, c, v);
-      if (status != ML_OK) return status;
-    }
-  }
+  status = MatCopy_into(&lin->X, in);
+  if (status != ML_OK) return status;
+  lin->Xs = (MatCSR){0};
+  lin->Xb = (Matf32){0};
+
+  // Z = act(in*W + b), applied as each block of Z is finished
+  ML_Epilogue ep;
+  linear_epilogue(&ep, lin);
+  status = Mat_Mul_Mat_fused_into(&lin->Z, lin->X, ML_NO_TRANS, lin->W, ML_NO_TRANS, &ep);
+  if (status != ML_OK) return status;
+
+  return status;
+}
+
+ML_Status execute_op_Linear_forward_borrow(Linear* lin, const Matf32 in) {
+  if (!lin) return ML_INVALID_ARGUMENT;
+  if (!in.data) return ML_INVALID_ARGUMENT;
+  if (!lin->W.data || !lin->b.data || !lin->Z.data) return ML_INVALID_ARGUMENT;
+
+  // X keeps the (N×D) shape even without storage
+  if (in.rows != lin->X.rows || in.cols != lin->X.cols) return ML_INVALID_ARGUMENT;
 
-  status = Mat_Mul_Mat_into(&lin->Z,lin->X,lin->W);
+  ML_Status status = ML_OK;
+
+  // Z = act(in*W + b), applied as each block of Z is finished
+  ML_Epilogue ep;
+  linear_epilogue(&ep, lin);
+  status = Mat_Mul_Mat_fused_into(&lin->Z, in, ML_NO_TRANS, lin->W, ML_NO_TRANS, &ep);
+  if (status != ML_OK) return status;
+
+  // Remember the batch for backward
+  lin->Xs = (MatCSR){0};
+  lin->Xb = in;
+
+  return status;
+}
+
+ML_Status execute_op_Linear_forward_half(Linear* lin, const Mat16 in) {
+  if (!lin) return ML_INVALID_ARGUMENT;
+  if (!in.data) return ML_INVALID_ARGUMENT;
+  if (!lin->X.data || !lin->W.data || !lin->b.data || !lin->Z.data)
+    return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  // X is kept in f32 for the backward pass
+  status = Mat16_to_Mat(&lin->X, in);
+  if (status != ML_OK) return status;
+  lin->Xs = (MatCSR){0};
+  lin->Xb = (Matf32){0};
+
+  // Z = act(in*W + b), applied as each block of Z is finished
+  ML_Epilogue ep;
+  linear_epilogue(&ep, lin);
+  status = Mat_Mul_Mat_fused_into(&lin->Z, lin->X, ML_NO_TRANS, lin->W, ML_NO_TRANS, &ep);
+  if (status != ML_OK) return status;
+
+  return status;
+}
+
+ML_Status execute_op_Linear_forward_sparse(Linear* lin, const MatCSR in) {
+  if (!lin) return ML_INVALID_ARGUMENT;
+  if (!in.row_ptr) return ML_INVALID_ARGUMENT;
+  if (!lin->W.data || !lin->b.data || !lin->Z.data) return ML_INVALID_ARGUMENT;
+
+  if (in.rows != lin->X.rows || in.cols != lin->X.cols) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  status = MatCSR_Mul_Mat_into(&lin->Z, in, lin->W);
   if (status != ML_OK) return status;
 
   status = Mat_rowwise_add_RowVec_inplace(&lin->Z,lin->b);
   if (status != ML_OK) return status;
 
+  if (lin->act != ML_ACT_NONE) {
+    status = Mat_act_into(&lin->Z, lin->Z, lin->act, lin->alpha);
+    if (status != ML_OK) return status;
+  }
+
+  // Remember the batch for backward
+  lin->Xs = in;
+  lin->Xb = (Matf32){0};
+
   return status;
 }
 
@@ -133,8 +274,12 @@ ML_Status execute_op_Linear_backward(Linear* lin, const Matf32 dZ) {
   if (!lin) return ML_INVALID_ARGUMENT;
   if (!dZ.data) return ML_INVALID_ARGUMENT;
 
-  if (!lin->X.data || !lin->W.data || !lin->b.data ||
-      !lin->dW.data || !lin->db.data || !lin->X_T.data)
+  const int sparse = lin->Xs.row_ptr != NULL;
+  // The dense input of the last forward: borrowed or our own copy
+  const Matf32 X = lin->Xb.data ? lin->Xb : lin->X;
+
+  if ((!sparse && !X.data) || !lin->W.data || !lin->b.data ||
+      !lin->dW.data || !lin->db.data)
     return ML_INVALID_ARGUMENT;
 
   // Shape checks:
@@ -149,17 +294,13 @@ ML_Status execute_op_Linear_backward(Linear* lin, const Matf32 dZ) {
     return ML_INVALID_ARGUMENT;
   if (lin->db.rows != 1 || lin->db.cols != lin->W.cols) return ML_INVALID_ARGUMENT;
 
-  if (lin->X_T.rows != lin->X.cols || lin->X_T.cols != lin->X.rows)
-    return ML_INVALID_ARGUMENT;
-
   ML_Status status = ML_OK;
 
-  // Transpose X
-  status = Mat_transpose_into(&lin->X_T, lin->X);
-  if (status != ML_OK) return status;
-
-  // dW = X_T * dZ
-  status = Mat_Mul_Mat_into(&lin->dW, lin->X_T, dZ);
+  // dW = X^T * dZ (transpose folded into the GEMM operand read)
+  if (sparse)
+    status = MatCSR_trans_Mul_Mat_into(&lin->dW, lin->Xs, dZ);
+  else
+    status = Mat_Mul_Mat_trans_into(&lin->dW, X, ML_TRANS, dZ, ML_NO_TRANS);
   if (status != ML_OK) return status;
 
   // db = colsum(dZ) into (1×C)
@@ -169,6 +310,18 @@ ML_Status execute_op_Linear_backward(Linear* lin, const Matf32 dZ) {
   return ML_OK;
 }
 
+ML_Status execute_op_Linear_backward_input(Linear* lin, const Matf32 dZ, Matf32* dX) {
+  if (!lin || !dX) return ML_INVALID_ARGUMENT;
+  if (!dZ.data || !dX->data || !lin->W.data) return ML_INVALID_ARGUMENT;
+
+  // dZ: (N×C), dX: (N×D)
+  if (dZ.rows != lin->X.rows || dZ.cols != lin->W.cols) return ML_INVALID_ARGUMENT;
+  if (dX->rows != lin->X.rows || dX->cols != lin->W.rows) return ML_INVALID_ARGUMENT;
+
+  // dX = dZ * W^T (transpose folded into the GEMM operand read)
+  return Mat_Mul_Mat_trans_into(dX, dZ, ML_NO_TRANS, lin->W, ML_TRANS);
+}
+
 ML_Status execute_op_Linear_sgd_step(Linear* lin, f32 lr) {
   if (!lin) return ML_INVALID_ARGUMENT;
   if (!lin->W.data || !lin->b.data || !lin->dW.data || !lin->db.data)
@@ -185,6 +338,162 @@ ML_Status execute_op_Linear_sgd_step(Linear* lin, f32 lr) {
   return ML_OK;
 }
 
+ML_Status create_config_LinearI8(LinearI8Config* conf, const Linear* src,
+                                 ML_QuantGranularity w_gran, f32 x_scale) {
+  if (!conf || !src) return ML_INVALID_ARGUMENT;
+  // The converted forwards only add the bias
+  if (src->act != ML_ACT_NONE) return ML_INVALID_ARGUMENT;
+  if (!(x_scale >= 0.0f)) return ML_INVALID_ARGUMENT;
+
+  conf->src = src;
+  conf->w_gran = w_gran;
+  conf->x_scale = x_scale;
+
+  return ML_OK;
+}
+
+ML_Status create_op_LinearI8(ml_arena* arena, LinearI8* qlin, LinearI8Config conf) {
+  if (!arena || !qlin || !conf.src) return ML_INVALID_ARGUMENT;
+
+  const Linear* lin = conf.src;
+  if (!lin->W.data || !lin->b.data || !lin->Z.data) return ML_INVALID_ARGUMENT;
+
+  // W: (D x C), Z: (N x C)
+  const u64 N = lin->Z.rows;
+  const u64 D = lin->W.rows;
+  const u64 C = lin->W.cols;
+
+  ML_Status status = ML_OK;
+
+  //Allocate and quantize W^T (C x D)
+  const char* prev_tag = set_tag_ml_arena(arena, "LinearI8.WT");
+  status = create_Mati8(arena, &qlin->WT, C, D, conf.w_gran);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+  status = Mat_quantize_i8(&qlin->WT, lin->W, ML_TRANS);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+
+  //Copy bias
+  set_tag_ml_arena(arena, "LinearI8.b");
+  status = create_Mat(arena, &qlin->b, 1, C);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+  status = MatCopy_into(&qlin->b, lin->b);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+
+  //Allocate quantized input and logits
+  set_tag_ml_arena(arena, "LinearI8.Xq");
+  status = create_Mati8(arena, &qlin->Xq, N, D, ML_QUANT_PER_TENSOR);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+  set_tag_ml_arena(arena, "LinearI8.Z");
+  status = create_Mat(arena, &qlin->Z, N, C);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+  set_tag_ml_arena(arena, prev_tag);
+
+  qlin->x_scale = conf.x_scale;
+
+  return ML_OK;
+}
+
+ML_Status execute_op_LinearI8_forward(LinearI8* qlin, const Matf32 in) {
+  if (!qlin) return ML_INVALID_ARGUMENT;
+  if (!in.data) return ML_INVALID_ARGUMENT;
+  if (!qlin->WT.data || !qlin->b.data || !qlin->Xq.data || !qlin->Z.data)
+    return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  // Xq = quant(in)
+  if (qlin->x_scale > 0.0f)
+    status = Mat_quantize_i8_scaled(&qlin->Xq, in, qlin->x_scale);
+  else
+    status = Mat_quantize_i8(&qlin->Xq, in, ML_NO_TRANS);
+  if (status != ML_OK) return status;
+
+  // Z = Xq * WT^T (int32 accumulate), then + b
+  status = Mat_Mul_Mati8_into(&qlin->Z, qlin->Xq, qlin->WT);
+  if (status != ML_OK) return status;
+
+  status = Mat_rowwise_add_RowVec_inplace(&qlin->Z, qlin->b);
+  if (status != ML_OK) return status;
+
+  return ML_OK;
+}
+
+ML_Status create_config_Linear16(Linear16Config* conf, const Linear* src,
+                                 ML_HalfFormat format) {
+  if (!conf || !src) return ML_INVALID_ARGUMENT;
+  // The converted forwards only add the bias
+  if (src->act != ML_ACT_NONE) return ML_INVALID_ARGUMENT;
+  if (format != ML_HALF_F16 && format != ML_HALF_BF16) return ML_INVALID_ARGUMENT;
+
+  conf->src = src;
+  conf->format = format;
+
+  return ML_OK;
+}
+
+ML_Status create_op_Linear16(ml_arena* arena, Linear16* hlin, Linear16Config conf) {
+  if (!arena || !hlin || !conf.src) return ML_INVALID_ARGUMENT;
+
+  const Linear* lin = conf.src;
+  if (!lin->W.data || !lin->b.data || !lin->Z.data) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  //Allocate and narrow W (D x C)
+  const char* prev_tag = set_tag_ml_arena(arena, "Linear16.W");
+  status = create_Mat16(arena, &hlin->W, lin->W.rows, lin->W.cols, conf.format);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+  status = Mat_to_Mat16(&hlin->W, lin->W);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+
+  //Copy bias
+  set_tag_ml_arena(arena, "Linear16.b");
+  status = create_Mat(arena, &hlin->b, 1, lin->b.cols);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+  status = MatCopy_into(&hlin->b, lin->b);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+
+  //Allocate output
+  set_tag_ml_arena(arena, "Linear16.Z");
+  status = create_Mat(arena, &hlin->Z, lin->Z.rows, lin->Z.cols);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+  set_tag_ml_arena(arena, prev_tag);
+
+  return ML_OK;
+}
+
+ML_Status execute_op_Linear16_forward(Linear16* hlin, const Matf32 in) {
+  if (!hlin) return ML_INVALID_ARGUMENT;
+  if (!in.data) return ML_INVALID_ARGUMENT;
+  if (!hlin->W.data || !hlin->b.data || !hlin->Z.data) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  // Z = in*W + b, the bias added as each block of Z is finished
+  ML_Epilogue ep;
+  linear_bias_epilogue(&ep, hlin->b);
+  status = Mat_Mul_Mat16_fused_into(&hlin->Z, in, hlin->W, &ep);
+  if (status != ML_OK) return status;
+
+  return ML_OK;
+}
+
+ML_Status execute_op_Linear16_forward_half(Linear16* hlin, const Mat16 in) {
+  if (!hlin) return ML_INVALID_ARGUMENT;
+  if (!in.data) return ML_INVALID_ARGUMENT;
+  if (!hlin->W.data || !hlin->b.data || !hlin->Z.data) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  // Z = in*W + b, the bias added as each block of Z is finished
+  ML_Epilogue ep;
+  linear_bias_epilogue(&ep, hlin->b);
+  status = Mat16_Mul_Mat16_fused_into(&hlin->Z, in, hlin->W, &ep);
+  if (status != ML_OK) return status;
+
+  return ML_OK;
+}
+
 ML_Status create_config_Softmax(SoftmaxConfig *conf, u64 inrows, u64 incols) {
   if (!conf) return ML_INVALID_ARGUMENT;
   if (inrows == 0 || incols == 0) return ML_INVALID_ARGUMENT;
@@ -192,6 +501,7 @@ ML_Status create_config_Softmax(SoftmaxConfig *conf, u64 inrows, u64 incols) {
   ML_Status status = ML_OK;
   conf->in_rows = inrows;
   conf->in_cols = incols;
+  conf->external_workspace = 0;
   
   return status;
 }
@@ -201,17 +511,28 @@ ML_Status create_op_Softmax(ml_arena* arena, Softmax* softmax, SoftmaxConfig con
 
   ML_Status status = ML_OK;
 
+  if (conf.external_workspace) {
+    softmax->rowmax = (Matf32){ .rows = conf.in_rows, .cols = 1 };
+    softmax->rowsum = (Matf32){ .rows = conf.in_rows, .cols = 1 };
+    softmax->P = (Matf32){ .rows = conf.in_rows, .cols = conf.in_cols };
+    return ML_OK;
+  }
+
   // Allocate rowmax: (N x 1)
+  const char* prev_tag = set_tag_ml_arena(arena, "Softmax.rowmax");
   status = create_Mat(arena, &softmax->rowmax, conf.in_rows, 1);
-  if (status != ML_OK) return status;
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
 
   // Allocate rowsum: (N x 1)
+  set_tag_ml_arena(arena, "Softmax.rowsum");
   status = create_Mat(arena, &softmax->rowsum, conf.in_rows, 1);
-  if (status != ML_OK) return status;
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
 
   // Allocate P: (N x C)
+  set_tag_ml_arena(arena, "Softmax.P");
   status = create_Mat(arena, &softmax->P, conf.in_rows, conf.in_cols);
-  if (status != ML_OK) return status;
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+  set_tag_ml_arena(arena, prev_tag);
 
   return ML_OK;
 }
@@ -230,36 +551,15 @@ ML_Status create_op_Softmax(ml_arena* arena, Softmax* softmax, SoftmaxConfig con
 
   ML_Status status = ML_OK;
 
-  // 1) P <- Z (workspace/output)
-  for (u64 r = 0; r < Z.rows; ++r) {
-    for (u64 c = 0; c < Z.cols; ++c) {
-      f32 v = 0.0f;
-      status = MatGet(Z, r, c, &v);
-      if (status != ML_OK) return status;
-
-      status = MatSet(&sm->P, r, c, v);
-      if (status != ML_OK) return status;
-    }
-  }
-
-  // 2) rowmax <- rowmax(P)
-  status = Mat_rowmax_into(&sm->rowmax, sm->P);
-  if (status != ML_OK) return status;
-
-  // 3) P <- P - rowmax   (broadcast N×1)
-  status = Mat_rowwise_sub_ColVec_inplace(&sm->P, sm->rowmax);
-  if (status != ML_OK) return status;
-
-  // 4) P <- exp(P)
-  status = Mat_exp_inplace(&sm->P);
-  if (status != ML_OK) return status;
-
-  // 5) rowsum <- rowsum(P)
-  status = Mat_rowsum_into(&sm->rowsum, sm->P);
-  if (status != ML_OK) return status;
+  // P = Z - rowmax, exp, / rowsum, all on one cached row at a time.
+  // rowmax/rowsum are still filled in for anything that inspects them.
+  const ML_FuseOp ops[] = {
+    { .kind = ML_FUSE_SUB_ROWMAX, .operand = sm->rowmax },
+    { .kind = ML_FUSE_EXP },
+    { .kind = ML_FUSE_DIV_ROWSUM, .operand = sm->rowsum },
+  };
 
-  // 6) P <- P / rowsum   (broadcast N×1)
-  status = Mat_rowwise_div_ColVec_inplace(&sm->P, sm->rowsum);
+  status = Mat_fused_into(&sm->P, Z, ops, sizeof(ops) / sizeof(ops[0]));
   if (status != ML_OK) return status;
 
   return ML_OK;
@@ -271,17 +571,25 @@ ML_Status create_config_CrossEntropy(CEConfig* conf, u64 inrows, u64 incols) {
 
   conf->in_rows = inrows;
   conf->in_cols = incols;
+  conf->external_workspace = 0;
   return ML_OK;
 }
 
 ML_Status create_op_CrossEntropy(ml_arena* arena, CrossEntropy* ce, CEConfig conf) {
   if (!arena || !ce) return ML_INVALID_ARGUMENT;
 
+  ce->loss = 0.0f;
+  if (conf.external_workspace) {
+    ce->dZ = (Matf32){ .rows = conf.in_rows, .cols = conf.in_cols };
+    return ML_OK;
+  }
+
+  const char* prev_tag = set_tag_ml_arena(arena, "CrossEntropy.dZ");
   ML_Status status =
     create_Mat(arena, &ce->dZ, conf.in_rows, conf.in_cols);
+  set_tag_ml_arena(arena, prev_tag);
   if (status != ML_OK) return status;
 
-  ce->loss = 0.0f;
   return ML_OK;
 }
 
@@ -294,29 +602,44 @@ ML_Status execute_op_CrossEntropy_forward(CrossEntropy *ce, const Matf32 P,
   if (P.rows != Y.rows || P.cols != Y.cols) return ML_INVALID_ARGUMENT;
   if (ce->dZ.rows != P.rows || ce->dZ.cols != P.cols) return ML_INVALID_ARGUMENT;
 
-  ML_Status status = ML_OK;
-
+  const ML_SimdKernels* K = ml_simd();
   const f32 eps = 1e-12f; // avoid log(0)
+  const u64 ld_p = Mat_ld(P);
+  const u64 ld_y = Mat_ld(Y);
   f32 acc = 0.0f;
 
+  // Gather (y, p) for the non-zero labels and take the logs a chunk at a
+  // time, so one-hot rows cost one log each and soft labels still vectorise
+  f32 pbuf[ML_CE_LOG_CHUNK];
+  f32 ybuf[ML_CE_LOG_CHUNK];
+  u64 k = 0;
+
   for (u64 r = 0; r < P.rows; ++r) {
-    for (u64 c = 0; c < P.cols; ++c) {
-      f32 y = 0.0f;
-      status = MatGet(Y, r, c, &y);
-      if (status != ML_OK) return status;
+    const f32* prow = P.data + r * ld_p;
+    const f32* yrow = Y.data + r * ld_y;
 
+    for (u64 c = 0; c < P.cols; ++c) {
       // Skip zeros (common for one-hot)
-      if (y == 0.0f) continue;
-
-      f32 p = 0.0f;
-      status = MatGet(P, r, c, &p);
-      if (status != ML_OK) return status;
+      if (yrow[c] == 0.0f) continue;
 
+      f32 p = prow[c];
       if (p < eps) p = eps;
-      acc += -y * logf(p);
+      pbuf[k] = p;
+      ybuf[k] = yrow[c];
+
+      if (++k == ML_CE_LOG_CHUNK) {
+        K->log(pbuf, k);
+        acc -= K->dot(ybuf, pbuf, k);
+        k = 0;
+      }
     }
   }
 
+  if (k != 0) {
+    K->log(pbuf, k);
+    acc -= K->dot(ybuf, pbuf, k);
+  }
+
   ce->loss = acc / (f32)P.rows; // mean over samples
   return ML_OK;
 }
@@ -332,25 +655,798 @@ ML_Status execute_op_CrossEntropy_backward(CrossEntropy *ce, const Matf32 P,
 
   ML_Status status = ML_OK;
 
-  // dZ = P - Y
-  for (u64 r = 0; r < P.rows; ++r) {
-    for (u64 c = 0; c < P.cols; ++c) {
-      f32 p = 0.0f, y = 0.0f;
-      status = MatGet(P, r, c, &p);
-      if (status != ML_OK) return status;
-      status = MatGet(Y, r, c, &y);
-      if (status != ML_OK) return status;
-
-      status = MatSet(&ce->dZ, r, c, p - y);
-      if (status != ML_OK) return status;
+  // dZ = (P - Y) / N in a single pass per row
+  const ML_FuseOp ops[] = {
+    { .kind = ML_FUSE_SUB_MAT, .operand = Y },
+    { .kind = ML_FUSE_SCALE, .scalar = 1.0f / (f32)P.rows },
+  };
+
+  status = Mat_fused_into(&ce->dZ, P, ops, sizeof(ops) / sizeof(ops[0]));
+  if (status != ML_OK) return status;
+
+  return ML_OK;
+}
+
+// Every label must name one of the classes
+static ML_Status check_labels(const u32* labels, u64 n, u64 classes) {
+  if (!labels) return ML_INVALID_ARGUMENT;
+
+  for (u64 i = 0; i < n; ++i)
+    if ((u64)labels[i] >= classes) return ML_INVALID_ARGUMENT;
+
+  return ML_OK;
+}
+
+ML_Status execute_op_CrossEntropy_forward_labels(CrossEntropy* ce, const Matf32 P,
+                                                 const u32* labels) {
+  if (!ce) return ML_INVALID_ARGUMENT;
+  if (!P.data) return ML_INVALID_ARGUMENT;
+  if (ce->dZ.rows != P.rows || ce->dZ.cols != P.cols) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = check_labels(labels, P.rows, P.cols);
+  if (status != ML_OK) return status;
+
+  const ML_SimdKernels* K = ml_simd();
+  const f32 eps = 1e-12f; // avoid log(0)
+  const u64 ld_p = Mat_ld(P);
+  f32 acc = 0.0f;
+
+  // One probability per row, logged a chunk at a time
+  f32 pbuf[ML_CE_LOG_CHUNK];
+
+  for (u64 r0 = 0; r0 < P.rows; r0 += ML_CE_LOG_CHUNK) {
+    const u64 n = P.rows - r0 < ML_CE_LOG_CHUNK ? P.rows - r0 : ML_CE_LOG_CHUNK;
+
+    for (u64 i = 0; i < n; ++i) {
+      f32 p = P.data[(r0 + i) * ld_p + labels[r0 + i]];
+      pbuf[i] = p < eps ? eps : p;
+    }
+
+    K->log(pbuf, n);
+    acc -= K->sum(pbuf, n);
+  }
+
+  ce->loss = acc / (f32)P.rows; // mean over samples
+  return ML_OK;
+}
+
+ML_Status execute_op_CrossEntropy_backward_labels(CrossEntropy* ce, const Matf32 P,
+                                                  const u32* labels) {
+  if (!ce) return ML_INVALID_ARGUMENT;
+  if (!P.data) return ML_INVALID_ARGUMENT;
+  if (!ce->dZ.data) return ML_INVALID_ARGUMENT;
+  if (ce->dZ.rows != P.rows || ce->dZ.cols != P.cols) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = check_labels(labels, P.rows, P.cols);
+  if (status != ML_OK) return status;
+
+  // dZ = P / N, then scatter -1/N at the labels
+  const f32 inv_n = 1.0f / (f32)P.rows;
+  const ML_FuseOp ops[] = {
+    { .kind = ML_FUSE_SCALE, .scalar = inv_n },
+  };
+
+  status = Mat_fused_into(&ce->dZ, P, ops, sizeof(ops) / sizeof(ops[0]));
+  if (status != ML_OK) return status;
+
+  const u64 ld_d = Mat_ld(ce->dZ);
+  for (u64 r = 0; r < P.rows; ++r) ce->dZ.data[r * ld_d + labels[r]] -= inv_n;
+
+  return ML_OK;
+}
+
+ML_Status create_config_SoftmaxCrossEntropy(SoftmaxCEConfig* conf, u64 inrows, u64 incols) {
+  if (!conf) return ML_INVALID_ARGUMENT;
+  if (inrows == 0 || incols == 0) return ML_INVALID_ARGUMENT;
+
+  conf->in_rows = inrows;
+  conf->in_cols = incols;
+  conf->external_workspace = 0;
+  return ML_OK;
+}
+
+ML_Status create_op_SoftmaxCrossEntropy(ml_arena* arena, SoftmaxCrossEntropy* sce,
+                                        SoftmaxCEConfig conf) {
+  if (!arena || !sce) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  sce->loss = 0.0f;
+  if (conf.external_workspace) {
+    sce->rowloss = (Matf32){ .rows = conf.in_rows, .cols = 1 };
+    sce->dZ = (Matf32){ .rows = conf.in_rows, .cols = conf.in_cols };
+    return ML_OK;
+  }
+
+  // Allocate rowloss: (N x 1)
+  const char* prev_tag = set_tag_ml_arena(arena, "SoftmaxCrossEntropy.rowloss");
+  status = create_Mat(arena, &sce->rowloss, conf.in_rows, 1);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+
+  // Allocate dZ: (N x C)
+  set_tag_ml_arena(arena, "SoftmaxCrossEntropy.dZ");
+  status = create_Mat(arena, &sce->dZ, conf.in_rows, conf.in_cols);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+  set_tag_ml_arena(arena, prev_tag);
+
+  return ML_OK;
+}
+
+typedef struct {
+  Matf32 Z;
+  Matf32 Y;          // dense labels, or
+  const u32* labels; // class indices (Y unused when set)
+  Matf32 dZ;
+  f32* rowloss;
+  u64 ld_l;
+  f32 inv_n;
+} sce_job;
+
+// Per row, with m = max(z) and s = sum(exp(z - m)):
+//   loss = sum_c y_c * (m + log s - z_c) = (m + log s) * sum(y) - y.z
+//   dZ   = (exp(z - m)/s - y)/N
+// Only z, y and the dZ row are touched, each while hot in cache. With a
+// label l the sums collapse to loss = m + log s - z_l and a single -1/N.
+static void sce_rows(void* p, u64 begin, u64 end, u64 tid) {
+  sce_job* job = p;
+  const ML_SimdKernels* K = ml_simd();
+  const u64 C = job->Z.cols;
+  const u64 ld_z = Mat_ld(job->Z);
+  const u64 ld_y = Mat_ld(job->Y);
+  const u64 ld_d = Mat_ld(job->dZ);
+  (void)tid;
+
+  for (u64 r = begin; r < end; ++r) {
+    const f32* z = job->Z.data + r * ld_z;
+    f32* d = job->dZ.data + r * ld_d;
+
+    const f32 m = K->max(z, C);
+    K->copy(d, z, C);
+    K->add_scalar(d, C, -m);
+    K->exp(d, C);
+
+    // s >= 1 (the max term is exp(0)), so the log is always finite
+    f32 lse = K->sum(d, C);
+    const f32 inv_s = 1.0f / lse;
+    K->log(&lse, 1);
+    lse += m;
+
+    K->scale(d, C, inv_s * job->inv_n);
+
+    if (job->labels) {
+      const u32 l = job->labels[r];
+      job->rowloss[r * job->ld_l] = lse - z[l];
+      d[l] -= job->inv_n;
+    } else {
+      const f32* y = job->Y.data + r * ld_y;
+      job->rowloss[r * job->ld_l] = lse * K->sum(y, C) - K->dot(y, z, C);
+      K->axpy(d, y, C, -job->inv_n);
+    }
+  }
+}
+
+static ML_Status sce_run(SoftmaxCrossEntropy* sce, sce_job* job) {
+  const ML_SimdKernels* K = ml_simd();
+  const Matf32 Z = job->Z;
+
+  job->dZ = sce->dZ;
+  job->rowloss = sce->rowloss.data;
+  job->ld_l = Mat_ld(sce->rowloss);
+  job->inv_n = 1.0f / (f32)Z.rows;
+
+  ml_parallel_for(Z.rows, ml_parallel_grain(Z.cols * 8, 1), sce_rows, job);
+
+  // Summed in row order, so the loss does not depend on the thread count
+  f32 acc = 0.0f;
+  if (job->ld_l == 1) {
+    acc = K->sum(sce->rowloss.data, Z.rows);
+  } else {
+    for (u64 r = 0; r < Z.rows; ++r) acc += sce->rowloss.data[r * job->ld_l];
+  }
+  sce->loss = acc * job->inv_n;
+
+  return ML_OK;
+}
+
+// Y is NULL for integer labels. Every input row is read while dZ and
+// rowloss are being written, so the outputs must not overlap any input
+static ML_Status sce_check(const SoftmaxCrossEntropy* sce, const Matf32 Z, const Matf32* Y) {
+  if (!Z.data) return ML_INVALID_ARGUMENT;
+  if (!sce->dZ.data || !sce->rowloss.data) return ML_INVALID_ARGUMENT;
+
+  if (sce->dZ.rows != Z.rows || sce->dZ.cols != Z.cols) return ML_INVALID_ARGUMENT;
+  if (sce->rowloss.rows != Z.rows || sce->rowloss.cols != 1) return ML_INVALID_ARGUMENT;
+
+  if (mat_overlaps(sce->dZ, Z) || mat_overlaps(sce->rowloss, Z)) return ML_INVALID_ARGUMENT;
+  if (mat_overlaps(sce->dZ, sce->rowloss)) return ML_INVALID_ARGUMENT;
+  if (Y && (mat_overlaps(sce->dZ, *Y) || mat_overlaps(sce->rowloss, *Y))) return ML_INVALID_ARGUMENT;
+
+  return ML_OK;
+}
+
+ML_Status execute_op_SoftmaxCrossEntropy(SoftmaxCrossEntropy* sce, const Matf32 Z,
+                                         const Matf32 Y) {
+  if (!sce) return ML_INVALID_ARGUMENT;
+  if (!Y.data) return ML_INVALID_ARGUMENT;
+  if (Z.rows != Y.rows || Z.cols != Y.cols) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = sce_check(sce, Z, &Y);
+  if (status != ML_OK) return status;
+
+  sce_job job = { .Z = Z, .Y = Y };
+  return sce_run(sce, &job);
+}
+
+ML_Status execute_op_SoftmaxCrossEntropy_labels(SoftmaxCrossEntropy* sce, const Matf32 Z,
+                                                const u32* labels) {
+  if (!sce) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = sce_check(sce, Z, NULL);
+  if (status != ML_OK) return status;
+
+  status = check_labels(labels, Z.rows, Z.cols);
+  if (status != ML_OK) return status;
+
+  sce_job job = { .Z = Z, .labels = labels };
+  return sce_run(sce, &job);
+}
+
+ML_Status create_config_Activation(ActivationConfig* conf, u64 inrows, u64 incols,
+                                   ML_Activation act) {
+  if (!conf) return ML_INVALID_ARGUMENT;
+  if (inrows == 0 || incols == 0) return ML_INVALID_ARGUMENT;
+  if ((u32)act > (u32)ML_ACT_GELU) return ML_INVALID_ARGUMENT;
+
+  conf->in_rows = inrows;
+  conf->in_cols = incols;
+  conf->act = act;
+  conf->alpha = 0.01f;
+  conf->external_workspace = 0;
+  conf->inplace_backward = 0;
+  return ML_OK;
+}
+
+ML_Status create_op_Activation(ml_arena* arena, Activation* op, ActivationConfig conf) {
+  if (!arena || !op) return ML_INVALID_ARGUMENT;
+  if ((u32)conf.act > (u32)ML_ACT_GELU) return ML_INVALID_ARGUMENT;
+  // Backward tells the leaky branches apart by the sign of A
+  if (conf.act == ML_ACT_LEAKY_RELU && !(conf.alpha >= 0.0f)) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  op->act = conf.act;
+  op->alpha = conf.alpha;
+  op->Xb = (Matf32){0};
+  op->A = (Matf32){ .rows = conf.in_rows, .cols = conf.in_cols };
+  op->dX = (Matf32){ .rows = conf.in_rows, .cols = conf.in_cols };
+  if (conf.external_workspace) return ML_OK;
+
+  // Allocate A: (N x D)
+  const char* prev_tag = set_tag_ml_arena(arena, "Activation.A");
+  status = create_Mat(arena, &op->A, conf.in_rows, conf.in_cols);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+
+  // Allocate dX: (N x D)
+  if (!conf.inplace_backward) {
+    set_tag_ml_arena(arena, "Activation.dX");
+    status = create_Mat(arena, &op->dX, conf.in_rows, conf.in_cols);
+    if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+  }
+  set_tag_ml_arena(arena, prev_tag);
+
+  return ML_OK;
+}
+
+ML_Status execute_op_Activation_forward(Activation* op, const Matf32 X) {
+  if (!op) return ML_INVALID_ARGUMENT;
+  if (!X.data || !op->A.data) return ML_INVALID_ARGUMENT;
+  if (X.rows != op->A.rows || X.cols != op->A.cols) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = Mat_act_into(&op->A, X, op->act, op->alpha);
+  if (status != ML_OK) return status;
+
+  // Remember the batch for backward
+  op->Xb = X;
+
+  return ML_OK;
+}
+
+// The matrix act'(.) is read from: A, or the borrowed input for GELU
+static ML_Status act_grad_source(const Activation* op, const Matf32 dA, Matf32* v) {
+  if (!op->Xb.data) return ML_INVALID_ARGUMENT;  // no forward yet
+  if (dA.rows != op->A.rows || dA.cols != op->A.cols) return ML_INVALID_ARGUMENT;
+
+  if (op->act == ML_ACT_GELU) {
+    // An in-place forward has overwritten X with A
+    if (op->Xb.data == op->A.data) return ML_INVALID_ARGUMENT;
+    *v = op->Xb;
+  } else {
+    *v = op->A;
+  }
+  return ML_OK;
+}
+
+ML_Status execute_op_Activation_backward(Activation* op, const Matf32 dA) {
+  if (!op) return ML_INVALID_ARGUMENT;
+  if (!dA.data || !op->dX.data) return ML_INVALID_ARGUMENT;
+
+  Matf32 v;
+  ML_Status status = act_grad_source(op, dA, &v);
+  if (status != ML_OK) return status;
+
+  return Mat_act_grad_into(&op->dX, dA, v, op->act, op->alpha);
+}
+
+ML_Status execute_op_Activation_backward_inplace(Activation* op, Matf32* dA) {
+  if (!op || !dA) return ML_INVALID_ARGUMENT;
+  if (!dA->data) return ML_INVALID_ARGUMENT;
+
+  Matf32 v;
+  ML_Status status = act_grad_source(op, *dA, &v);
+  if (status != ML_OK) return status;
+
+  return Mat_act_grad_into(dA, *dA, v, op->act, op->alpha);
+}
+
+ML_Status create_config_Conv1D(Conv1DConfig* conf, u64 inrows, u64 insteps,
+                               u64 inch, u64 outch, u64 kernel, ML_Rng* rng,
+                               FillStrategy w_strat, FillStrategy b_strat) {
+  if (!conf) return ML_INVALID_ARGUMENT;
+  if (inrows == 0 || inch == 0 || outch == 0 || kernel == 0) return ML_INVALID_ARGUMENT;
+  if (insteps < kernel) return ML_INVALID_ARGUMENT;
+
+  conf->in_rows = inrows;
+  conf->in_steps = insteps;
+  conf->in_ch = inch;
+  conf->out_ch = outch;
+  conf->kernel = kernel;
+  conf->stride = 1;
+  conf->dilation = 1;
+  conf->fillW_strat = w_strat;
+  conf->fillb_strat = b_strat;
+  conf->rng = rng;
+  conf->act = ML_ACT_NONE;
+  conf->alpha = 0.01f;
+  conf->external_workspace = 0;
+  conf->inference_only = 0;
+  conf->no_input_grad = 0;
+  return ML_OK;
+}
+
+// Output steps of a valid-padded window, 0 when the window does not fit
+static u64 window_out_steps(u64 steps, u64 span, u64 stride) {
+  if (steps < span) return 0;
+  return (steps - span) / stride + 1;
+}
+
+static ML_Conv1DShape conv1d_shape(const Conv1D* conv) {
+  return (ML_Conv1DShape){
+    .steps = conv->in_steps, .in_ch = conv->in_ch,
+    .out_steps = conv->out_steps, .out_ch = conv->out_ch,
+    .kernel = conv->kernel, .stride = conv->stride, .dilation = conv->dilation,
+  };
+}
+
+ML_Status create_op_Conv1D(ml_arena* arena, Conv1D* conv, Conv1DConfig conf) {
+  if (!arena || !conv) return ML_INVALID_ARGUMENT;
+  if (conf.in_rows == 0 || conf.in_ch == 0 || conf.out_ch == 0 || conf.kernel == 0)
+    return ML_INVALID_ARGUMENT;
+  if (conf.stride == 0 || conf.dilation == 0) return ML_INVALID_ARGUMENT;
+  if ((u32)conf.act > (u32)ML_ACT_GELU) return ML_INVALID_ARGUMENT;
+
+  const u64 T_out = window_out_steps(conf.in_steps,
+                                     conf.dilation * (conf.kernel - 1) + 1, conf.stride);
+  if (T_out == 0) return ML_INVALID_ARGUMENT;
+
+  conv->in_steps = conf.in_steps;
+  conv->in_ch = conf.in_ch;
+  conv->out_steps = T_out;
+  conv->out_ch = conf.out_ch;
+  conv->kernel = conf.kernel;
+  conv->stride = conf.stride;
+  conv->dilation = conf.dilation;
+  conv->act = conf.act;
+  conv->alpha = conf.alpha;
+
+  const u64 KC = conf.kernel * conf.in_ch;
+  const ML_Conv1DShape s = conv1d_shape(conv);
+  const int gemm = ml_conv1d_uses_gemm(&s);
+  const int train = !conf.inference_only;
+
+  //Workspaces get their shapes here; storage comes from the arena below
+  //unless the caller binds it. The GEMM path unfolds patches into cols
+  //in forward only when dilated, in backward always.
+  conv->Xb = (Matf32){0};
+  conv->Y = (Matf32){ .rows = conf.in_rows, .cols = T_out * conf.out_ch };
+  conv->dW = (Matf32){ .rows = KC, .cols = conf.out_ch };
+  conv->db = (Matf32){ .rows = 1, .cols = conf.out_ch };
+  conv->dX = (Matf32){ .rows = conf.in_rows, .cols = conf.in_steps * conf.in_ch };
+  conv->cols = (Matf32){0};
+  conv->dWn = (Matf32){0};
+  if (gemm && (train || conf.dilation > 1))
+    conv->cols = (Matf32){ .rows = T_out, .cols = KC };
+  if (gemm && train && conf.in_rows > 1)
+    conv->dWn = (Matf32){ .rows = KC, .cols = conf.out_ch };
+
+  ML_Status status = ML_OK;
+
+  //Allocate weights and bias
+  const char* prev_tag = set_tag_ml_arena(arena, "Conv1D.W");
+  status = create_Mat(arena, &conv->W, KC, conf.out_ch);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+  set_tag_ml_arena(arena, "Conv1D.b");
+  status = create_Mat(arena, &conv->b, 1, conf.out_ch);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+
+  if (!conf.external_workspace) {
+    set_tag_ml_arena(arena, "Conv1D.Y");
+    status = create_Mat(arena, &conv->Y, conv->Y.rows, conv->Y.cols);
+    if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+
+    if (conv->cols.rows) {
+      set_tag_ml_arena(arena, "Conv1D.cols");
+      status = create_Mat(arena, &conv->cols, conv->cols.rows, conv->cols.cols);
+      if (status != ML_OK) return restore_tag(arena, prev_tag, status);
     }
+
+    if (train) {
+      set_tag_ml_arena(arena, "Conv1D.dW");
+      status = create_Mat(arena, &conv->dW, KC, conf.out_ch);
+      if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+      set_tag_ml_arena(arena, "Conv1D.db");
+      status = create_Mat(arena, &conv->db, 1, conf.out_ch);
+      if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+
+      if (conv->dWn.rows) {
+        set_tag_ml_arena(arena, "Conv1D.dWn");
+        status = create_Mat(arena, &conv->dWn, KC, conf.out_ch);
+        if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+      }
+      if (!conf.no_input_grad) {
+        set_tag_ml_arena(arena, "Conv1D.dX");
+        status = create_Mat(arena, &conv->dX, conv->dX.rows, conv->dX.cols);
+        if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+      }
+    }
+  }
+  set_tag_ml_arena(arena, prev_tag);
+
+  //A dry run on a counting arena has nothing to initialise
+  if (!arena->counting) {
+    status = init_params(&conv->W, &conv->b, conf.fillW_strat, conf.fillb_strat, conf.rng);
+    if (status != ML_OK) return status;
+  }
+
+  return ML_OK;
+}
+
+ML_Status execute_op_Conv1D_forward(Conv1D* conv, const Matf32 X) {
+  if (!conv) return ML_INVALID_ARGUMENT;
+  if (!X.data || !conv->W.data || !conv->b.data || !conv->Y.data) return ML_INVALID_ARGUMENT;
+  if (mat_overlaps(X, conv->Y)) return ML_INVALID_ARGUMENT;
+  if (conv->cols.data && mat_overlaps(conv->cols, conv->Y)) return ML_INVALID_ARGUMENT;
+
+  // X: (N x T*Cin), Y: (N x T_out*Cout)
+  if (X.rows != conv->Y.rows || X.cols != conv->in_steps * conv->in_ch)
+    return ML_INVALID_ARGUMENT;
+
+  const ML_Conv1DShape s = conv1d_shape(conv);
+  if (ml_conv1d_uses_gemm(&s) && conv->dilation > 1 && !conv->cols.data)
+    return ML_INVALID_ARGUMENT;
+
+  // Y = act(conv(X, W) + b), finished while each block is in cache
+  const ML_GemmEpilogue ep = {
+    .scale = 1.0f, .bias = conv->b.data, .act = conv->act, .alpha = conv->alpha,
+  };
+  ml_conv1d_forward(&s, X.rows, X.data, Mat_ld(X), conv->W.data, &ep,
+                    conv->Y.data, Mat_ld(conv->Y), conv->cols.data);
+
+  // Remember the batch for backward
+  conv->Xb = X;
+
+  return ML_OK;
+}
+
+ML_Status execute_op_Conv1D_backward(Conv1D* conv, const Matf32 dY) {
+  if (!conv) return ML_INVALID_ARGUMENT;
+  if (!dY.data || !conv->Xb.data) return ML_INVALID_ARGUMENT;  // no forward yet
+  if (!conv->W.data || !conv->dW.data || !conv->db.data) return ML_INVALID_ARGUMENT;
+  if (dY.rows != conv->Y.rows || dY.cols != conv->Y.cols) return ML_INVALID_ARGUMENT;
+  if (conv->dX.data && mat_overlaps(conv->dX, dY)) return ML_INVALID_ARGUMENT;
+  if (conv->dX.data && conv->cols.data && mat_overlaps(conv->dX, conv->cols))
+    return ML_INVALID_ARGUMENT;
+
+  const ML_Conv1DShape s = conv1d_shape(conv);
+  const u64 N = dY.rows;
+  if (ml_conv1d_uses_gemm(&s)) {
+    if (!conv->cols.data) return ML_INVALID_ARGUMENT;
+    if (N > 1 && !conv->dWn.data) return ML_INVALID_ARGUMENT;
   }
 
-  // dZ *= 1/N
-  f32 invN = 1.0f / (f32)P.rows;
-  status = Mat_Scale_inplace(&ce->dZ, invN);
+  // dW = sum_n patches(X_n)^T dY_n, db = colsum over samples and steps
+  ml_conv1d_backward_weights(&s, N, conv->Xb.data, Mat_ld(conv->Xb),
+                             dY.data, Mat_ld(dY), conv->dW.data, conv->db.data,
+                             conv->dWn.data, conv->cols.data);
+
+  // dX: the transposed convolution of dY with W
+  if (conv->dX.data)
+    ml_conv1d_backward_input(&s, N, dY.data, Mat_ld(dY), conv->W.data,
+                             conv->dX.data, Mat_ld(conv->dX), conv->cols.data);
+
+  return ML_OK;
+}
+
+ML_Status execute_op_Conv1D_sgd_step(Conv1D* conv, f32 lr) {
+  if (!conv) return ML_INVALID_ARGUMENT;
+  if (!conv->W.data || !conv->b.data || !conv->dW.data || !conv->db.data)
+    return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  status = Mat_SGD_inplace(&conv->W, conv->dW, lr);
   if (status != ML_OK) return status;
 
+  status = Mat_SGD_inplace(&conv->b, conv->db, lr);
+  if (status != ML_OK) return status;
+
+  return ML_OK;
+}
+
+ML_Status create_config_MaxPool1D(MaxPool1DConfig* conf, u64 inrows, u64 insteps,
+                                  u64 channels, u64 pool) {
+  if (!conf) return ML_INVALID_ARGUMENT;
+  if (inrows == 0 || channels == 0 || pool == 0) return ML_INVALID_ARGUMENT;
+  if (insteps < pool) return ML_INVALID_ARGUMENT;
+
+  conf->in_rows = inrows;
+  conf->in_steps = insteps;
+  conf->channels = channels;
+  conf->pool = pool;
+  conf->stride = pool;
+  conf->external_workspace = 0;
+  conf->inference_only = 0;
+  return ML_OK;
+}
+
+ML_Status create_op_MaxPool1D(ml_arena* arena, MaxPool1D* mp, MaxPool1DConfig conf) {
+  if (!arena || !mp) return ML_INVALID_ARGUMENT;
+  if (conf.in_rows == 0 || conf.channels == 0 || conf.pool == 0 || conf.stride == 0)
+    return ML_INVALID_ARGUMENT;
+  // Winning steps are kept as u32
+  if (conf.in_steps > (u64)UINT32_MAX) return ML_INVALID_ARGUMENT;
+
+  const u64 T_out = window_out_steps(conf.in_steps, conf.pool, conf.stride);
+  if (T_out == 0) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  mp->in_steps = conf.in_steps;
+  mp->channels = conf.channels;
+  mp->out_steps = T_out;
+  mp->pool = conf.pool;
+  mp->stride = conf.stride;
+  mp->idx = NULL;
+  mp->Y = (Matf32){ .rows = conf.in_rows, .cols = T_out * conf.channels };
+  mp->dX = (Matf32){ .rows = conf.in_rows, .cols = conf.in_steps * conf.channels };
+
+  // Allocate idx: (N x T_out*C)
+  const char* prev_tag = set_tag_ml_arena(arena, "MaxPool1D.idx");
+  if (!conf.inference_only) {
+    void* idx = NULL;
+    status = push_ml_arena(&idx, arena, conf.in_rows * T_out * conf.channels * sizeof(u32));
+    if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+    mp->idx = idx;
+  }
+
+  if (!conf.external_workspace) {
+    set_tag_ml_arena(arena, "MaxPool1D.Y");
+    status = create_Mat(arena, &mp->Y, mp->Y.rows, mp->Y.cols);
+    if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+
+    if (!conf.inference_only) {
+      set_tag_ml_arena(arena, "MaxPool1D.dX");
+      status = create_Mat(arena, &mp->dX, mp->dX.rows, mp->dX.cols);
+      if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+    }
+  }
+  set_tag_ml_arena(arena, prev_tag);
+
+  return ML_OK;
+}
+
+ML_Status execute_op_MaxPool1D_forward(MaxPool1D* mp, const Matf32 X) {
+  if (!mp) return ML_INVALID_ARGUMENT;
+  if (!X.data || !mp->Y.data || mat_overlaps(X, mp->Y)) return ML_INVALID_ARGUMENT;
+  if (X.rows != mp->Y.rows || X.cols != mp->dX.cols) return ML_INVALID_ARGUMENT;
+
+  ml_maxpool1d_forward(mp->in_steps, mp->channels, mp->out_steps, mp->pool, mp->stride,
+                       X.rows, X.data, Mat_ld(X), mp->Y.data, Mat_ld(mp->Y), mp->idx);
+  return ML_OK;
+}
+
+ML_Status execute_op_MaxPool1D_backward(MaxPool1D* mp, const Matf32 dY) {
+  if (!mp) return ML_INVALID_ARGUMENT;
+  if (!dY.data || !mp->idx || !mp->dX.data) return ML_INVALID_ARGUMENT;
+  if (dY.rows != mp->Y.rows || dY.cols != mp->Y.cols) return ML_INVALID_ARGUMENT;
+  if (mat_overlaps(dY, mp->dX)) return ML_INVALID_ARGUMENT;
+
+  ml_maxpool1d_backward(mp->in_steps, mp->channels, mp->out_steps,
+                        dY.rows, dY.data, Mat_ld(dY), mp->idx,
+                        mp->dX.data, Mat_ld(mp->dX));
+  return ML_OK;
+}
+
+ML_Status create_config_GlobalAvgPool(GlobalAvgPoolConfig* conf, u64 inrows,
+                                      u64 insteps, u64 channels) {
+  if (!conf) return ML_INVALID_ARGUMENT;
+  if (inrows == 0 || insteps == 0 || channels == 0) return ML_INVALID_ARGUMENT;
+
+  conf->in_rows = inrows;
+  conf->in_steps = insteps;
+  conf->channels = channels;
+  conf->external_workspace = 0;
+  conf->inference_only = 0;
+  return ML_OK;
+}
+
+ML_Status create_op_GlobalAvgPool(ml_arena* arena, GlobalAvgPool* gap,
+                                  GlobalAvgPoolConfig conf) {
+  if (!arena || !gap) return ML_INVALID_ARGUMENT;
+  if (conf.in_rows == 0 || conf.in_steps == 0 || conf.channels == 0)
+    return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+
+  gap->in_steps = conf.in_steps;
+  gap->channels = conf.channels;
+  gap->Y = (Matf32){ .rows = conf.in_rows, .cols = conf.channels };
+  gap->dX = (Matf32){ .rows = conf.in_rows, .cols = conf.in_steps * conf.channels };
+  if (conf.external_workspace) return ML_OK;
+
+  // Allocate Y: (N x C)
+  const char* prev_tag = set_tag_ml_arena(arena, "GlobalAvgPool.Y");
+  status = create_Mat(arena, &gap->Y, gap->Y.rows, gap->Y.cols);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+
+  // Allocate dX: (N x T*C)
+  if (!conf.inference_only) {
+    set_tag_ml_arena(arena, "GlobalAvgPool.dX");
+    status = create_Mat(arena, &gap->dX, gap->dX.rows, gap->dX.cols);
+    if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+  }
+  set_tag_ml_arena(arena, prev_tag);
+
+  return ML_OK;
+}
+
+ML_Status execute_op_GlobalAvgPool_forward(GlobalAvgPool* gap, const Matf32 X) {
+  if (!gap) return ML_INVALID_ARGUMENT;
+  if (!X.data || !gap->Y.data || mat_overlaps(X, gap->Y)) return ML_INVALID_ARGUMENT;
+  if (X.rows != gap->Y.rows || X.cols != gap->dX.cols) return ML_INVALID_ARGUMENT;
+
+  ml_gap1d_forward(gap->in_steps, gap->channels, X.rows, X.data, Mat_ld(X),
+                   gap->Y.data, Mat_ld(gap->Y));
+  return ML_OK;
+}
+
+ML_Status execute_op_GlobalAvgPool_backward(GlobalAvgPool* gap, const Matf32 dY) {
+  if (!gap) return ML_INVALID_ARGUMENT;
+  if (!dY.data || !gap->dX.data || mat_overlaps(dY, gap->dX)) return ML_INVALID_ARGUMENT;
+  if (dY.rows != gap->Y.rows || dY.cols != gap->Y.cols) return ML_INVALID_ARGUMENT;
+
+  ml_gap1d_backward(gap->in_steps, gap->channels, dY.rows, dY.data, Mat_ld(dY),
+                    gap->dX.data, Mat_ld(gap->dX));
   return ML_OK;
 }
 
+ML_Status create_config_LinearQ(LinearQConfig* conf, const Linear* src,
+                                ML_FixedType w_type, u8 x_frac, u8 z_frac) {
+  if (!conf || !src) return ML_INVALID_ARGUMENT;
+  // The converted forwards only add the bias
+  if (src->act != ML_ACT_NONE) return ML_INVALID_ARGUMENT;
+  if (w_type != ML_FIXED_Q7 && w_type != ML_FIXED_Q15) return ML_INVALID_ARGUMENT;
+  if (x_frac > ML_FIXED_MAX_FRAC || z_frac > ML_FIXED_MAX_FRAC) return ML_INVALID_ARGUMENT;
+
+  conf->src = src;
+  conf->w_type = w_type;
+  conf->x_frac = x_frac;
+  conf->z_frac = z_frac;
+
+  return ML_OK;
+}
+
+ML_Status create_op_LinearQ(ml_arena* arena, LinearQ* qlin, LinearQConfig conf) {
+  if (!arena || !qlin || !conf.src) return ML_INVALID_ARGUMENT;
+
+  const Linear* lin = conf.src;
+  if (!lin->W.data || !lin->b.data || !lin->Z.data) return ML_INVALID_ARGUMENT;
+
+  // W: (D x C), Z: (N x C)
+  const u64 N = lin->Z.rows;
+  const u64 D = lin->W.rows;
+  const u64 C = lin->W.cols;
+
+  ML_Status status = ML_OK;
+
+  f32 w_absmax = 0.0f;
+  for (u64 r = 0; r < D; ++r) {
+    const f32* row = Mat_row_ptr(lin->W, r);
+    for (u64 c = 0; c < C; ++c) {
+      f32 v = row[c] < 0.0f ? -row[c] : row[c];
+      if (v > w_absmax) w_absmax = v;
+    }
+  }
+  const u8 w_frac = ml_fixed_frac_for(w_absmax, conf.w_type);
+
+  //Allocate and convert W^T (C x D)
+  const char* prev_tag = set_tag_ml_arena(arena, "LinearQ.WT");
+  qlin->w_type = conf.w_type;
+  qlin->WT7 = (Matq7){0};
+  qlin->WT15 = (Matq15){0};
+  if (conf.w_type == ML_FIXED_Q7) {
+    status = create_Matq7(arena, &qlin->WT7, C, D, w_frac);
+    if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+    status = Mat_to_Matq7(&qlin->WT7, lin->W, ML_TRANS);
+  } else {
+    status = create_Matq15(arena, &qlin->WT15, C, D, w_frac);
+    if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+    status = Mat_to_Matq15(&qlin->WT15, lin->W, ML_TRANS);
+  }
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+
+  //Bias in the output format
+  set_tag_ml_arena(arena, "LinearQ.b");
+  status = create_Matq15(arena, &qlin->b, 1, C, conf.z_frac);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+  status = Mat_to_Matq15(&qlin->b, lin->b, ML_NO_TRANS);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+
+  set_tag_ml_arena(arena, "LinearQ.Z");
+  status = create_Matq15(arena, &qlin->Z, N, C, conf.z_frac);
+  if (status != ML_OK) return restore_tag(arena, prev_tag, status);
+  set_tag_ml_arena(arena, prev_tag);
+
+  qlin->x_frac = conf.x_frac;
+
+  return ML_OK;
+}
+
+ML_Status execute_op_LinearQ_forward(LinearQ* qlin, const Matq15 in) {
+  if (!qlin) return ML_INVALID_ARGUMENT;
+  if (!in.data) return ML_INVALID_ARGUMENT;
+  if (!qlin->b.data || !qlin->Z.data) return ML_INVALID_ARGUMENT;
+  if (in.frac != qlin->x_frac) return ML_INVALID_ARGUMENT;
+
+  // Z = in * W + b, integer accumulate, one rounding to z_frac
+  if (qlin->w_type == ML_FIXED_Q7)
+    return Matq15_Mul_Matq7_trans_into(&qlin->Z, in, qlin->WT7, &qlin->b);
+
+  return Matq15_Mul_Matq15_trans_into(&qlin->Z, in, qlin->WT15, &qlin->b);
+}
+
+ML_Status create_config_SoftmaxQ(SoftmaxQConfig* conf, u64 inrows, u64 incols) {
+  if (!conf) return ML_INVALID_ARGUMENT;
+  if (inrows == 0 || incols == 0) return ML_INVALID_ARGUMENT;
+
+  conf->in_rows = inrows;
+  conf->in_cols = incols;
+
+  return ML_OK;
+}
+
+ML_Status create_op_SoftmaxQ(ml_arena* arena, SoftmaxQ* sm, SoftmaxQConfig conf) {
+  if (!arena || !sm) return ML_INVALID_ARGUMENT;
+
+  const char* prev_tag = set_tag_ml_arena(arena, "SoftmaxQ.P");
+  ML_Status status = create_Matq15(arena, &sm->P, conf.in_rows, conf.in_cols, ML_FIXED_PROB_FRAC);
+  set_tag_ml_arena(arena, prev_tag);
+
+  return status;
+}
+
+ML_Status execute_op_SoftmaxQ_forward(SoftmaxQ* sm, const Matq15 Z) {
+  if (!sm) return ML_INVALID_ARGUMENT;
+  if (!Z.data || !sm->P.data) return ML_INVALID_ARGUMENT;
+
+  return Matq15_softmax_into(&sm->P, Z);
+}
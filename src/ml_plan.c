@@ -0,0 +1,90 @@
+#include "ml_plan.h"
+
+#include <stddef.h>
+
+static inline u64 plan_bytes(const ML_PlanBuffer* b) {
+  return ALIGN_UP_POW2(b->mat->rows * b->mat->cols * sizeof(f32), ML_PLAN_ALIGN);
+}
+
+static inline int plan_live_together(const ML_PlanBuffer* a, const ML_PlanBuffer* b) {
+  return a->first <= b->last && b->first <= a->last;
+}
+
+ML_Status plan_buffers(ML_PlanBuffer* bufs, u64 n, u64* out_bytes) {
+  if (!out_bytes) return ML_INVALID_ARGUMENT;
+  if (n != 0 && !bufs) return ML_INVALID_ARGUMENT;
+  if (n > ML_PLAN_MAX_BUFFERS) return ML_INVALID_ARGUMENT;
+
+  for (u64 i = 0; i < n; ++i) {
+    if (!bufs[i].mat || bufs[i].first > bufs[i].last) return ML_INVALID_ARGUMENT;
+    bufs[i].offset = 0;
+  }
+
+  // Visit largest first through an index list; the caller's order is kept
+  u64 order[ML_PLAN_MAX_BUFFERS];
+  for (u64 i = 0; i < n; ++i) {
+    u64 j = i;
+    while (j > 0 && plan_bytes(&bufs[order[j - 1]]) < plan_bytes(&bufs[i])) {
+      order[j] = order[j - 1];
+      --j;
+    }
+    order[j] = i;
+  }
+
+  u64 total = 0;
+
+  for (u64 k = 0; k < n; ++k) {
+    ML_PlanBuffer* b = &bufs[order[k]];
+    const u64 size = plan_bytes(b);
+    u64 offset = 0;
+
+    // Bump past any clash and rescan until the slot clears every placed
+    // buffer that is live together with b; each bump only moves forward
+    for (u64 moved = 1; moved;) {
+      moved = 0;
+      for (u64 p = 0; p < k; ++p) {
+        const ML_PlanBuffer* o = &bufs[order[p]];
+        if (!plan_live_together(b, o)) continue;
+
+        const u64 o_end = o->offset + plan_bytes(o);
+        if (offset < o_end && o->offset < offset + size) {
+          offset = o_end;
+          moved = 1;
+        }
+      }
+    }
+
+    b->offset = offset;
+    if (offset + size > total) total = offset + size;
+  }
+
+  *out_bytes = total;
+  return ML_OK;
+}
+
+ML_Status bind_plan_buffers(ml_arena* arena, ML_PlanBuffer* bufs, u64 n, u64 bytes) {
+  if (!arena) return ML_INVALID_ARGUMENT;
+  if (n != 0 && !bufs) return ML_INVALID_ARGUMENT;
+
+  for (u64 i = 0; i < n; ++i) {
+    if (!bufs[i].mat) return ML_INVALID_ARGUMENT;
+    if (bufs[i].offset + plan_bytes(&bufs[i]) > bytes) return ML_INVALID_ARGUMENT;
+  }
+
+  ML_Status status = ML_OK;
+  void* pool = NULL;
+
+  const char* prev_tag = set_tag_ml_arena(arena, "plan");
+  status = push_aligned_ml_arena(&pool, arena, bytes, ML_PLAN_ALIGN);
+  set_tag_ml_arena(arena, prev_tag);
+  if (status != ML_OK) return status;
+
+  for (u64 i = 0; i < n; ++i) {
+    Matf32* m = bufs[i].mat;
+    // A counting arena hands out no pool; leave the buffers unbound
+    m->data = pool ? (f32*)((unsigned char*)pool + bufs[i].offset) : NULL;
+    m->stride = m->cols;
+  }
+
+  return ML_OK;
+}
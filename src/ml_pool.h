@@ -0,0 +1,47 @@
+#ifndef ML_POOL_H
+#define ML_POOL_H
+
+#include "ml_defs.h"
+#include "ml_thread.h"
+
+/**
+ * @file ml_pool.h
+ * @brief Internal access to the worker pool and the scratch it owns.
+ *
+ * ml_parallel_for() takes the pool for a single loop. The packed GEMM
+ * runs many loops over panels that must not be shared with another
+ * product, so it takes the pool once for the whole product with
+ * ml_pool_acquire(), runs its loops with ml_parallel_for_held() and gives
+ * the pool back with ml_pool_release(). Whoever holds the pool owns its
+ * scratch; a caller that finds the pool taken gets none and must do
+ * without.
+ */
+
+/** @brief GEMM pack panels owned by the pool (see ML_GEMM_PACKED). */
+typedef struct {
+  f32* packA;      // get_ml_threads() panels of packA_len floats, one per tid
+  u64 packA_len;
+  f32* packB;      // one panel shared by every thread
+} ML_PoolScratch;
+
+/**
+ * @brief Take the pool and its scratch.
+ *
+ * @return The scratch, valid until ml_pool_release(); NULL if another
+ *         caller holds the pool (including an enclosing parallel loop),
+ *         or there are no panels (packed GEMM disabled, or they could not
+ *         be allocated). Call ml_pool_release() only after a non-NULL
+ *         return.
+ */
+const ML_PoolScratch* ml_pool_acquire(void);
+
+/** @brief Give back the pool taken by ml_pool_acquire(). */
+void ml_pool_release(void);
+
+/**
+ * @brief ml_parallel_for() for a caller that holds the pool: the loop
+ * runs on the workers without trying to take the pool again.
+ */
+void ml_parallel_for_held(u64 n, u64 grain, ML_ParallelFn fn, void* ctx);
+
+#endif // ML_POOL_H
@@ -1,9 +1,11 @@
 #include "ml_primitives.h"
 #include "ml_alloc.h"
 #include "ml_error.h"
+#include "ml_gemm.h"
+#include "ml_kernels.h"
+#include "ml_simd.h"
 
 #include <stddef.h>
-#include <math.h>
 
  ML_Status create_Mat(ml_arena *arena, Matf32* dest, u64 rows, u64 cols) {
   if(!arena || !dest) return ML_INVALID_ARGUMENT;
@@ -16,24 +18,78 @@
   dest->cols = cols;
   dest->rows = rows;
   dest->data = data_ptr;
+  dest->stride = cols;
 
   return status;
  }
 
+ ML_Status create_Mat_aligned(ml_arena* arena, Matf32* dest, u64 rows, u64 cols,
+                              u64 align, u8 pad_rows) {
+  if(!arena || !dest) return ML_INVALID_ARGUMENT;
+  if(align == 0 || (align & (align - 1)) != 0) return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+  void* data_ptr = NULL;
+  u64 ld = cols;
+
+  // Whole rows of align bytes; alignments below one f32 pad nothing
+  if(pad_rows && align > sizeof(f32))
+    ld = ALIGN_UP_POW2(cols * sizeof(f32), align) / sizeof(f32);
+
+  status = push_aligned_ml_arena(&data_ptr,arena,rows*ld*sizeof(f32),align);
+  if(status != ML_OK) return status;
+
+  dest->cols = cols;
+  dest->rows = rows;
+  dest->data = data_ptr;
+  dest->stride = ld;
+
+  return status;
+ }
+
+ ML_Status Mat_view(Matf32* view, const Matf32 src,
+                    u64 row0, u64 col0, u64 rows, u64 cols) {
+   if(!view) return ML_INVALID_ARGUMENT;
+   if(!src.data) return ML_INVALID_ARGUMENT;
+   if(row0 > src.rows || rows > src.rows - row0) return ML_OUT_OF_BOUNDS;
+   if(col0 > src.cols || cols > src.cols - col0) return ML_OUT_OF_BOUNDS;
+
+   view->rows = rows;
+   view->cols = cols;
+   view->data = src.data + row0 * Mat_ld(src) + col0;
+   view->stride = Mat_ld(src);
+
+   return ML_OK;
+ }
+
+ ML_Status Mat_view_rows(Matf32* view, const Matf32 src, u64 row0, u64 rows) {
+   return Mat_view(view, src, row0, 0, rows, src.cols);
+ }
+
+ ML_Status Mat_view_cols(Matf32* view, const Matf32 src, u64 col0, u64 cols) {
+   return Mat_view(view, src, 0, col0, src.rows, cols);
+ }
+
+ ML_Status Mat_view_buffer(Matf32* view, f32* base, u64 offset,
+                           u64 rows, u64 cols, u64 stride) {
+   if(!view || !base) return ML_INVALID_ARGUMENT;
+   if(stride != 0 && stride < cols) return ML_INVALID_ARGUMENT;
+
+   view->rows = rows;
+   view->cols = cols;
+   view->data = base + offset;
+   view->stride = stride ? stride : cols;
+
+   return ML_OK;
+ }
+
  ML_Status MatFillScalar(Matf32 *target, f32 val) {
    if(!target) return ML_INVALID_ARGUMENT;
    if(!target->data) return ML_INVALID_ARGUMENT;
 
-   ML_Status status = ML_OK;
-
-   for (u64 r = 0; r < target->rows; ++r) {
-    for (u64 c = 0; c < target->cols; ++c) {
-      status = MatSet(target,r,c,val);
-      if(status != ML_OK ) return status;
-    }  
-   }
+   ml_kernel_fill(target->data, Mat_ld(*target), target->rows, target->cols, val);
 
-   return status;
+   return ML_OK;
  }
 
  ML_Status MatFillRow(Matf32 *target, u64 row, const f32 *val) {
@@ -41,15 +97,10 @@
    if(!target->data) return ML_INVALID_ARGUMENT;
    if(row >= target->rows) return ML_INVALID_ARGUMENT;
    if(!val) return ML_INVALID_ARGUMENT;
-   
-   ML_Status status = ML_OK;
 
-   for (u64 col = 0; col < target->cols; ++col) {
-     status = MatSet(target,row,col,val[col]);
-     if(status != ML_OK ) return status;
-   }
-   
-   return status;
+   ml_simd()->copy(Mat_row_ptr(*target, row), val, target->cols);
+
+   return ML_OK;
  }
 
  ML_Status MatGet(const Matf32 target, u64 row, u64 col, f32 *val) {
@@ -58,11 +109,9 @@
    if(row >= target.rows) return ML_INVALID_ARGUMENT;
    if(col >= target.cols) return ML_INVALID_ARGUMENT;
 
-   ML_Status status = ML_OK; 
+   *val = Mat_at(target, row, col);
 
-   *val = target.data[row*target.cols + col];
-
-   return status;
+   return ML_OK;
  }
 
  ML_Status MatSet(Matf32 *target, u64 row, u64 col, const f32 val) { 
@@ -71,31 +120,20 @@
    if(row >= target->rows) return ML_INVALID_ARGUMENT;
    if(col >= target->cols) return ML_INVALID_ARGUMENT;
 
-   ML_Status status = ML_OK; 
-
-   target->data[row*target->cols + col] = val;
+   Mat_put(target, row, col, val);
 
-   return status;
+   return ML_OK;
  }
 
  ML_Status MatCopy(Matf32 src, Matf32 *dest, ml_arena *arena) {
    if(!dest || !arena) return ML_INVALID_ARGUMENT;
+   if(!src.data) return ML_INVALID_ARGUMENT;
    ML_Status status = ML_OK;
 
    status = create_Mat(arena,dest,src.rows,src.cols);
    if(status != ML_OK) return status;
 
-   for (u64 src_row = 0; src_row < src.rows; ++src_row) {
-     for (u64 src_col = 0; src_col < src.cols; ++src_col) {
-       f32 cur_val = 0.0f;
-       status = MatGet(src,src_row,src_col,&cur_val);
-       if(status != ML_OK) return status;
-       status = MatSet(dest,src_row,src_col,cur_val);
-       if(status != ML_OK) return status;
-     }
-   }
-
-   return status;
+   return MatCopy_into(dest,src);
  }
 
  ML_Status MatCopy_into(Matf32* dest, const Matf32 src) {
@@ -105,18 +143,8 @@
   if (dest->rows != src.rows) return ML_INVALID_ARGUMENT;
   if (dest->cols != src.cols) return ML_INVALID_ARGUMENT;
 
-  ML_Status status = ML_OK;
-
-  for (u64 r = 0; r < src.rows; ++r) {
-    for (u64 c = 0; c < src.cols; ++c) {
-      f32 v = 0.0f;
-      status = MatGet(src, r, c, &v);
-      if (status != ML_OK) return status;
-
-      status = MatSet(dest, r, c, v);
-      if (status != ML_OK) return status;
-    }
-  }
+  ml_kernel_copy(dest->data, Mat_ld(*dest), src.data, Mat_ld(src),
+                 src.rows, src.cols);
 
   return ML_OK;
  }
@@ -131,61 +159,67 @@
    status = create_Mat(arena,out,lhs.rows,rhs.cols);
    if(status != ML_OK) return status;
 
-   u64 m = lhs.rows;
-   u64 k = lhs.cols; // == rhs.rows
-   u64 n = rhs.cols;
-
-   for (u64 i = 0; i < m; ++i) {
-     for (u64 j = 0; j < n; ++j) {
-       f32 sum = 0.0f;
-       for (u64 t = 0; t < k; ++t) {
-	 f32 a;
-	 status = MatGet(lhs,i,t,&a);
-	 if(status != ML_OK) return status;
-	 f32 b;
-	 status = MatGet(rhs,t,j,&b);
-	 if(status != ML_OK) return status;
-	 sum += a * b;
-       }
-       status = MatSet(out,i,j,sum);
-       if(status != ML_OK) return status;
-     }
-   }
-
-   return status;
+   return Mat_Mul_Mat_into(out,lhs,rhs);
  }
 
 ML_Status Mat_Mul_Mat_into(Matf32 *out, const Matf32 lhs, const Matf32 rhs) {
+  return Mat_Mul_Mat_trans_into(out, lhs, ML_NO_TRANS, rhs, ML_NO_TRANS);
+}
+
+ML_Status create_Epilogue(ML_Epilogue* ep) {
+  if (!ep) return ML_INVALID_ARGUMENT;
+
+  ep->scale = 1.0f;
+  ep->bias = (Matf32){0};
+  ep->act = ML_ACT_NONE;
+  ep->alpha = 0.01f;
+  return ML_OK;
+}
+
+ML_Status Mat_Mul_Mat_trans_into(Matf32* out,
+                                 const Matf32 lhs, ML_Transpose lhs_t,
+                                 const Matf32 rhs, ML_Transpose rhs_t) {
+  return Mat_Mul_Mat_fused_into(out, lhs, lhs_t, rhs, rhs_t, NULL);
+}
+
+ML_Status Mat_Mul_Mat_fused_into(Matf32* out,
+                                 const Matf32 lhs, ML_Transpose lhs_t,
+                                 const Matf32 rhs, ML_Transpose rhs_t,
+                                 const ML_Epilogue* ep) {
   if (!out) return ML_INVALID_ARGUMENT;
   if (!out->data || !lhs.data || !rhs.data) return ML_INVALID_ARGUMENT;
+  if (lhs_t != ML_NO_TRANS && lhs_t != ML_TRANS) return ML_INVALID_ARGUMENT;
+  if (rhs_t != ML_NO_TRANS && rhs_t != ML_TRANS) return ML_INVALID_ARGUMENT;
 
-  if (lhs.cols != rhs.rows) return ML_INVALID_ARGUMENT;
+  // Logical shapes: op(lhs) is (m x k), op(rhs) is (k x n)
+  u64 m = lhs_t == ML_TRANS ? lhs.cols : lhs.rows;
+  u64 k = lhs_t == ML_TRANS ? lhs.rows : lhs.cols;
+  u64 rk = rhs_t == ML_TRANS ? rhs.cols : rhs.rows;
+  u64 n = rhs_t == ML_TRANS ? rhs.rows : rhs.cols;
+
+  if (k != rk) return ML_INVALID_ARGUMENT;
 
   // out must already be allocated with correct shape
-  if (out->rows != lhs.rows) return ML_INVALID_ARGUMENT;
-  if (out->cols != rhs.cols) return ML_INVALID_ARGUMENT;
+  if (out->rows != m) return ML_INVALID_ARGUMENT;
+  if (out->cols != n) return ML_INVALID_ARGUMENT;
 
-  ML_Status status = ML_OK;
+  // The engine reads A/B while writing C, so they must not overlap
+  if (mat_overlaps(*out, lhs) || mat_overlaps(*out, rhs)) return ML_INVALID_ARGUMENT;
 
-  u64 m = lhs.rows;
-  u64 k = lhs.cols;
-  u64 n = rhs.cols;
-
-  for (u64 i = 0; i < m; ++i) {
-    for (u64 j = 0; j < n; ++j) {
-      f32 sum = 0.0f;
-      for (u64 t = 0; t < k; ++t) {
-        f32 a = 0.0f, b = 0.0f;
-        status = MatGet(lhs, i, t, &a);
-        if (status != ML_OK) return status;
-        status = MatGet(rhs, t, j, &b);
-        if (status != ML_OK) return status;
-        sum += a * b;
-      }
-      status = MatSet(out, i, j, sum);
-      if (status != ML_OK) return status;
-    }
-  }
+  ML_GemmEpilogue gep;
+  ML_Status status = ml_gemm_epilogue_from(&gep, *out, ep);
+  if (status != ML_OK) return status;
+
+  // A transposed operand is the stored matrix with row/col strides swapped
+  u64 rs_a = lhs_t == ML_TRANS ? 1 : Mat_ld(lhs);
+  u64 cs_a = lhs_t == ML_TRANS ? Mat_ld(lhs) : 1;
+  u64 rs_b = rhs_t == ML_TRANS ? 1 : Mat_ld(rhs);
+  u64 cs_b = rhs_t == ML_TRANS ? Mat_ld(rhs) : 1;
+
+  ml_gemm_f32_ep(m, n, k,
+                 lhs.data, rs_a, cs_a,
+                 rhs.data, rs_b, cs_b,
+                 out->data, Mat_ld(*out), ep ? &gep : NULL);
 
   return ML_OK;
 }
@@ -200,19 +234,7 @@ ML_Status Mat_Mul_Mat_into(Matf32 *out, const Matf32 lhs, const Matf32 rhs) {
    status = create_Mat(arena,out,target.cols,target.rows);
    if (status != ML_OK) return status;
 
-   for (u64 r = 0; r < target.rows; ++r) {
-     for (u64 c = 0; c < target.cols; ++c) {
-       f32 v = 0.0f; 
-
-       status = MatGet(target,r,c,&v);
-       if (status != ML_OK) return status;
-
-       status = MatSet(out,c,r,v);
-       if (status != ML_OK) return status; 
-     }
-   }
-
-   return status;
+   return Mat_transpose_into(out,target);
  }
 
  ML_Status Mat_transpose_into(Matf32* out, const Matf32 target) {
@@ -222,19 +244,10 @@ ML_Status Mat_Mul_Mat_into(Matf32 *out, const Matf32 lhs, const Matf32 rhs) {
   // out must already be allocated as (target.cols x target.rows)
   if (out->rows != target.cols) return ML_INVALID_ARGUMENT;
   if (out->cols != target.rows) return ML_INVALID_ARGUMENT;
+  if (mat_overlaps(*out, target)) return ML_INVALID_ARGUMENT;
 
-  ML_Status status = ML_OK;
-
-  for (u64 r = 0; r < target.rows; ++r) {
-    for (u64 c = 0; c < target.cols; ++c) {
-      f32 v = 0.0f;
-      status = MatGet(target, r, c, &v);
-      if (status != ML_OK) return status;
-
-      status = MatSet(out, c, r, v);
-      if (status != ML_OK) return status;
-    }
-  }
+  ml_kernel_transpose(out->data, Mat_ld(*out), target.data, Mat_ld(target),
+                      target.rows, target.cols);
 
   return ML_OK;
 }
@@ -246,24 +259,9 @@ ML_Status Mat_Mul_Mat_into(Matf32 *out, const Matf32 lhs, const Matf32 rhs) {
    if(rhs.cols != lhs->cols) return ML_INVALID_ARGUMENT;
    if(rhs.rows != 1) return ML_INVALID_ARGUMENT;
 
-   ML_Status status = ML_OK;
-
-   for (u64 i = 0; i < lhs->rows; ++i) {  
-    for (u64 j = 0; j < lhs->cols; ++j) {
-      f32 lhs_val = 0.0f;
-      status = MatGet(*lhs,i,j,&lhs_val);
-      if (status != ML_OK) return status; 
-
-      f32 rhs_val = 0.0f;
-      status = MatGet(rhs,0,j,&rhs_val);
-      if (status != ML_OK) return status;
+   ml_kernel_add_rowvec(lhs->data, Mat_ld(*lhs), lhs->rows, lhs->cols, rhs.data);
 
-      status = MatSet(lhs,i,j,rhs_val + lhs_val);
-      if (status != ML_OK) return status;
-    }
-   }
-
-   return status;
+   return ML_OK;
  }
 
  ML_Status Mat_rowwise_sub_ColVec_inplace(Matf32 *lhs, Matf32 rhs) {
@@ -272,22 +270,10 @@ ML_Status Mat_Mul_Mat_into(Matf32 *out, const Matf32 lhs, const Matf32 rhs) {
    if(lhs->rows != rhs.rows) return ML_INVALID_ARGUMENT;
    if(rhs.cols != 1) return ML_INVALID_ARGUMENT;
 
-   ML_Status status = ML_OK;
+   ml_kernel_add_colvec(lhs->data, Mat_ld(*lhs), lhs->rows, lhs->cols,
+                        rhs.data, Mat_ld(rhs), -1.0f);
 
-   for (u64 r = 0; r < lhs->rows; ++r) {
-     f32 sub = 0.0f;
-     status = MatGet(rhs,r,0,&sub);
-     if (status != ML_OK) return status;
-     for (u64 c = 0; c < lhs->cols; ++c) {
-       f32 v = 0.0f;
-       status = MatGet(*lhs,r,c,&v);
-       if (status != ML_OK) return status;
-       status = MatSet(lhs,r,c,v-sub);
-       if (status != ML_OK) return status;
-     }
-   }
-
-   return status;
+   return ML_OK;
  }
 
  ML_Status Mat_rowmax(Matf32 *out, ml_arena *arena, const Matf32 Z) {
@@ -297,15 +283,7 @@ ML_Status Mat_Mul_Mat_into(Matf32 *out, const Matf32 lhs, const Matf32 rhs) {
    status = create_Mat(arena,out,Z.rows,1);
    if (status != ML_OK) return status;
 
-   f32 maxv = 0.0f;
-   for (u64 r = 0; r < out->rows; ++r) {
-     status = Mat_get_rowmax(Z,r,&maxv);
-     if (status != ML_OK) return status;
-     status = MatSet(out,r,0,maxv);
-     if (status != ML_OK) return status;
-   }
-     
-   return status;
+   return Mat_rowmax_into(out,Z);
  }
 
  ML_Status Mat_rowmax_into(Matf32* out, const Matf32 Z) {
@@ -316,16 +294,10 @@ ML_Status Mat_Mul_Mat_into(Matf32 *out, const Matf32 lhs, const Matf32 rhs) {
   if (out->rows != Z.rows) return ML_INVALID_ARGUMENT;
   if (out->cols != 1) return ML_INVALID_ARGUMENT;
 
-  ML_Status status = ML_OK;
-
-  for (u64 r = 0; r < Z.rows; ++r) {
-    f32 maxv = 0.0f;
-    status = Mat_get_rowmax(Z, r, &maxv);
-    if (status != ML_OK) return status;
+  // max of an empty row is undefined
+  if (Z.rows != 0 && Z.cols == 0) return ML_INVALID_ARGUMENT;
 
-    status = MatSet(out, r, 0, maxv);
-    if (status != ML_OK) return status;
-  }
+  ml_kernel_rowmax(out->data, Mat_ld(*out), Z.data, Mat_ld(Z), Z.rows, Z.cols);
 
   return ML_OK;
  }
@@ -338,21 +310,7 @@ ML_Status Mat_Mul_Mat_into(Matf32 *out, const Matf32 lhs, const Matf32 rhs) {
   if (out->rows != A.rows) return ML_INVALID_ARGUMENT;
   if (out->cols != 1) return ML_INVALID_ARGUMENT;
 
-  ML_Status status = ML_OK;
-
-  for (u64 r = 0; r < A.rows; ++r) {
-    f32 sum = 0.0f;
-
-    for (u64 c = 0; c < A.cols; ++c) {
-      f32 v = 0.0f;
-      status = MatGet(A, r, c, &v);
-      if (status != ML_OK) return status;
-      sum += v;
-    }
-
-    status = MatSet(out, r, 0, sum);
-    if (status != ML_OK) return status;
-  }
+  ml_kernel_rowsum(out->data, Mat_ld(*out), A.data, Mat_ld(A), A.rows, A.cols);
 
   return ML_OK;
  }
@@ -361,76 +319,34 @@ ML_Status Mat_Mul_Mat_into(Matf32 *out, const Matf32 lhs, const Matf32 rhs) {
    if(!val) return ML_INVALID_ARGUMENT;
    if(!target.data) return ML_INVALID_ARGUMENT;
    if (row >= target.rows) return ML_INVALID_ARGUMENT;
+   if (target.cols == 0) return ML_INVALID_ARGUMENT;
 
-   ML_Status status = ML_OK;
-
-
-   f32 maxv = 0.0f;
-   status = MatGet(target,row,0,&maxv);
-   if (status != ML_OK) return status;
+   *val = ml_simd()->max(Mat_row_ptr(target, row), target.cols);
 
-   for (u64 col = 1; col < target.cols; ++col) {
-     f32 temp = 0.0f;
-     status = MatGet(target, row, col, &temp);
-     if (status != ML_OK) return status;
-     if (temp > maxv) maxv = temp;
-   }
-
-   *val = maxv;
-
-   return status;
+   return ML_OK;
  }
 
  ML_Status Mat_exp_inplace(Matf32 *target) {
    if (!target || !target->data) return ML_INVALID_ARGUMENT;
-   ML_Status status = ML_OK;
 
-   for (u64 r = 0; r < target->rows; ++r) {  
-    for (u64 c = 0; c < target->cols; ++c) {
-      f32 val = 0.0f;
-      status = MatGet(*target,r,c,&val);
-      if (status != ML_OK) return status;
-      f32 exp_val = expf(val);
-      status = MatSet(target,r,c,exp_val);
-      if (status != ML_OK) return status;
-    }
-   }
-   return status;
+   ml_kernel_exp(target->data, Mat_ld(*target), target->rows, target->cols);
+
+   return ML_OK;
  }
 
  ML_Status Mat_Sub_Scalar(Matf32 *lhs, f32 scalar) {
    if(!lhs) return ML_INVALID_ARGUMENT;
-   ML_Status status = ML_OK;
+   if(!lhs->data) return ML_INVALID_ARGUMENT;
+
+   ml_kernel_add_scalar(lhs->data, Mat_ld(*lhs), lhs->rows, lhs->cols, -scalar);
 
-   for (u64 r = 0;r < lhs->rows; ++r) {
-    for (u64 c = 0;c < lhs->cols; ++c) {
-      f32 val = 0.0f;
-      status = MatGet(*lhs,r,c,&val);
-      if (status != ML_OK) return status;
-      f32 new_val = val - scalar;
-      status = MatSet(lhs,r,c,new_val);
-      if (status != ML_OK) return status;
-    }
-   }
-   
-   return status;
+   return ML_OK;
  }
 
  ML_Status Mat_Scale_inplace(Matf32* A, f32 s) {
   if (!A || !A->data) return ML_INVALID_ARGUMENT;
 
-  ML_Status status = ML_OK;
-
-  for (u64 r = 0; r < A->rows; ++r) {
-    for (u64 c = 0; c < A->cols; ++c) {
-      f32 v = 0.0f;
-      status = MatGet(*A, r, c, &v);
-      if (status != ML_OK) return status;
-
-      status = MatSet(A, r, c, v * s);
-      if (status != ML_OK) return status;
-    }
-  }
+  ml_kernel_scale(A->data, Mat_ld(*A), A->rows, A->cols, s);
 
   return ML_OK;
  }
@@ -442,21 +358,7 @@ ML_Status Mat_Mul_Mat_into(Matf32 *out, const Matf32 lhs, const Matf32 rhs) {
   if (out->rows != 1) return ML_INVALID_ARGUMENT;
   if (out->cols != A.cols) return ML_INVALID_ARGUMENT;
 
-  ML_Status status = ML_OK;
-
-  for (u64 c = 0; c < A.cols; ++c) {
-    f32 sum = 0.0f;
-
-    for (u64 r = 0; r < A.rows; ++r) {
-      f32 v = 0.0f;
-      status = MatGet(A, r, c, &v);
-      if (status != ML_OK) return status;
-      sum += v;
-    }
-
-    status = MatSet(out, 0, c, sum);
-    if (status != ML_OK) return status;
-  }
+  ml_kernel_colsum(out->data, A.data, Mat_ld(A), A.rows, A.cols);
 
   return ML_OK;
 }
@@ -468,22 +370,8 @@ ML_Status Mat_Mul_Mat_into(Matf32 *out, const Matf32 lhs, const Matf32 rhs) {
   if (param->rows != grad.rows) return ML_INVALID_ARGUMENT;
   if (param->cols != grad.cols) return ML_INVALID_ARGUMENT;
 
-  ML_Status status = ML_OK;
-
-  for (u64 r = 0; r < param->rows; ++r) {
-    for (u64 c = 0; c < param->cols; ++c) {
-      f32 p = 0.0f;
-      status = MatGet(*param, r, c, &p);
-      if (status != ML_OK) return status;
-
-      f32 g = 0.0f;
-      status = MatGet(grad, r, c, &g);
-      if (status != ML_OK) return status;
-
-      status = MatSet(param, r, c, p - lr * g);
-      if (status != ML_OK) return status;
-    }
-  }
+  ml_kernel_axpy(param->data, Mat_ld(*param), grad.data, Mat_ld(grad),
+                 param->rows, param->cols, -lr);
 
   return ML_OK;
 }
@@ -494,21 +382,7 @@ ML_Status Mat_Mul_Mat_into(Matf32 *out, const Matf32 lhs, const Matf32 rhs) {
   ML_Status status = create_Mat(arena, out, target.rows, 1);
   if (status != ML_OK) return status;
 
-  for (u64 r = 0; r < target.rows; ++r) {
-    f32 sum = 0.0f;
-
-    for (u64 c = 0; c < target.cols; ++c) {
-      f32 v = 0.0f;
-      status = MatGet(target, r, c, &v);
-      if (status != ML_OK) return status;
-      sum += v;
-    }
-
-    status = MatSet(out, r, 0, sum);
-    if (status != ML_OK) return status;
-  }
-
-  return ML_OK;
+  return Mat_rowsum_into(out, target);
  }
 
  ML_Status Mat_rowwise_div_ColVec_inplace(Matf32 *lhs, Matf32 rhs) {
@@ -517,25 +391,43 @@ ML_Status Mat_Mul_Mat_into(Matf32 *out, const Matf32 lhs, const Matf32 rhs) {
   if (lhs->rows != rhs.rows) return ML_INVALID_ARGUMENT;
   if (rhs.cols != 1) return ML_INVALID_ARGUMENT;
 
-  ML_Status status = ML_OK;
+  const u64 ld = Mat_ld(*lhs);
+  const u64 ld_v = Mat_ld(rhs);
 
   for (u64 r = 0; r < lhs->rows; ++r) {
-    f32 denom = 0.0f;
-    status = MatGet(rhs, r, 0, &denom);
-    if (status != ML_OK) return status;
+    f32 denom = rhs.data[r * ld_v];
 
     // denom should be > 0
     if (denom == 0.0f) return ML_INVALID_ARGUMENT;
 
-    for (u64 c = 0; c < lhs->cols; ++c) {
-      f32 v = 0.0f;
-      status = MatGet(*lhs, r, c, &v);
-      if (status != ML_OK) return status;
-
-      status = MatSet(lhs, r, c, v / denom);
-      if (status != ML_OK) return status;
-    }
+    ml_kernel_scale(lhs->data + r * ld, ld, 1, lhs->cols, 1.0f / denom);
   }
 
   return ML_OK;
 }
+
+ML_Status Mat_act_into(Matf32* out, const Matf32 in, ML_Activation act, f32 alpha) {
+  if (!out || !out->data || !in.data) return ML_INVALID_ARGUMENT;
+  if (out->rows != in.rows || out->cols != in.cols) return ML_INVALID_ARGUMENT;
+  if ((u32)act > (u32)ML_ACT_GELU) return ML_INVALID_ARGUMENT;
+  if (!mat_same_or_disjoint(*out, in)) return ML_INVALID_ARGUMENT;
+
+  ml_kernel_act(out->data, Mat_ld(*out), in.data, Mat_ld(in), in.rows, in.cols, act, alpha);
+
+  return ML_OK;
+}
+
+ML_Status Mat_act_grad_into(Matf32* dx, const Matf32 dy, const Matf32 v,
+                            ML_Activation act, f32 alpha) {
+  if (!dx || !dx->data || !dy.data || !v.data) return ML_INVALID_ARGUMENT;
+  if (dx->rows != dy.rows || dx->cols != dy.cols) return ML_INVALID_ARGUMENT;
+  if (v.rows != dy.rows || v.cols != dy.cols) return ML_INVALID_ARGUMENT;
+  if ((u32)act > (u32)ML_ACT_GELU) return ML_INVALID_ARGUMENT;
+  if (act == ML_ACT_LEAKY_RELU && !(alpha >= 0.0f)) return ML_INVALID_ARGUMENT;
+  if (!mat_same_or_disjoint(*dx, dy) || !mat_same_or_disjoint(*dx, v)) return ML_INVALID_ARGUMENT;
+
+  ml_kernel_act_grad(dx->data, Mat_ld(*dx), dy.data, Mat_ld(dy), v.data, Mat_ld(v),
+                     dy.rows, dy.cols, act, alpha);
+
+  return ML_OK;
+}
@@ -0,0 +1,179 @@
+#include "ml_quant.h"
+#include "ml_alloc.h"
+#include "ml_error.h"
+#include "ml_primitives.h"
+#include "ml_simd.h"
+
+#include <stddef.h>
+
+#define ML_QUANT_MAX 127.0f
+
+// Bytes of rhs_t rows kept hot in cache while every lhs row streams past
+#define ML_GEMM_I8_BLOCK_BYTES (32u * 1024u)
+
+static inline u64 mati8_ld(const Mati8 m) {
+  return m.stride ? m.stride : m.cols;
+}
+
+// Round half away from zero and saturate to [-127, 127]. NaN slips past
+// both clamps and converting it is undefined, so it maps to 0.
+static inline i8 quant_round(f32 v) {
+  if (!(v == v)) return 0;
+  if (v > ML_QUANT_MAX) v = ML_QUANT_MAX;
+  if (v < -ML_QUANT_MAX) v = -ML_QUANT_MAX;
+  return (i8)(v + (v >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline f32 quant_scale_for(f32 absmax) {
+  // An all-zero block quantizes to zeros with any scale
+  return absmax > 0.0f ? absmax / ML_QUANT_MAX : 1.0f;
+}
+
+static void quant_row(i8* dst, const f32* src, u64 cs, u64 n, f32 scale) {
+  const f32 inv = 1.0f / scale;
+  for (u64 i = 0; i < n; ++i) dst[i] = quant_round(src[i * cs] * inv);
+}
+
+static f32 absmax_row(const f32* src, u64 cs, u64 n) {
+  f32 m = 0.0f;
+  for (u64 i = 0; i < n; ++i) {
+    f32 v = src[i * cs];
+    if (v < 0.0f) v = -v;
+    if (v > m) m = v;
+  }
+  return m;
+}
+
+ML_Status create_Mati8(ml_arena* arena, Mati8* dest, u64 rows, u64 cols,
+                       ML_QuantGranularity granularity) {
+  if (!arena || !dest) return ML_INVALID_ARGUMENT;
+  if (granularity != ML_QUANT_PER_TENSOR && granularity != ML_QUANT_PER_ROW)
+    return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+  void* data_ptr = NULL;
+  void* scales_ptr = NULL;
+  u64 n_scales = granularity == ML_QUANT_PER_ROW ? rows : 1;
+
+  status = push_ml_arena(&scales_ptr, arena, n_scales * sizeof(f32));
+  if (status != ML_OK) return status;
+
+  status = push_ml_arena(&data_ptr, arena, rows * cols * sizeof(i8));
+  if (status != ML_OK) return status;
+
+  dest->rows = rows;
+  dest->cols = cols;
+  dest->data = data_ptr;
+  dest->stride = cols;
+  dest->scales = scales_ptr;
+  dest->granularity = granularity;
+
+  return ML_OK;
+}
+
+ML_Status Mat_quantize_i8(Mati8* dest, const Matf32 src, ML_Transpose src_t) {
+  if (!dest) return ML_INVALID_ARGUMENT;
+  if (!dest->data || !dest->scales || !src.data) return ML_INVALID_ARGUMENT;
+  if (src_t != ML_NO_TRANS && src_t != ML_TRANS) return ML_INVALID_ARGUMENT;
+
+  // Logical source op(src) is (rows x cols) with strides (rs, cs)
+  const u64 rows = src_t == ML_TRANS ? src.cols : src.rows;
+  const u64 cols = src_t == ML_TRANS ? src.rows : src.cols;
+  const u64 rs = src_t == ML_TRANS ? 1 : Mat_ld(src);
+  const u64 cs = src_t == ML_TRANS ? Mat_ld(src) : 1;
+
+  if (dest->rows != rows || dest->cols != cols) return ML_INVALID_ARGUMENT;
+
+  const u64 ld = mati8_ld(*dest);
+
+  if (dest->granularity == ML_QUANT_PER_ROW) {
+    for (u64 r = 0; r < rows; ++r) {
+      f32 scale = quant_scale_for(absmax_row(src.data + r * rs, cs, cols));
+      dest->scales[r] = scale;
+      quant_row(dest->data + r * ld, src.data + r * rs, cs, cols, scale);
+    }
+    return ML_OK;
+  }
+
+  f32 absmax = 0.0f;
+  for (u64 r = 0; r < rows; ++r) {
+    f32 m = absmax_row(src.data + r * rs, cs, cols);
+    if (m > absmax) absmax = m;
+  }
+
+  f32 scale = quant_scale_for(absmax);
+  dest->scales[0] = scale;
+  for (u64 r = 0; r < rows; ++r)
+    quant_row(dest->data + r * ld, src.data + r * rs, cs, cols, scale);
+
+  return ML_OK;
+}
+
+ML_Status Mat_quantize_i8_scaled(Mati8* dest, const Matf32 src, f32 scale) {
+  if (!dest) return ML_INVALID_ARGUMENT;
+  if (!dest->data || !dest->scales || !src.data) return ML_INVALID_ARGUMENT;
+  if (dest->granularity != ML_QUANT_PER_TENSOR) return ML_INVALID_ARGUMENT;
+  if (!(scale > 0.0f)) return ML_INVALID_ARGUMENT;
+  if (dest->rows != src.rows || dest->cols != src.cols) return ML_INVALID_ARGUMENT;
+
+  const u64 ld = mati8_ld(*dest);
+
+  dest->scales[0] = scale;
+  for (u64 r = 0; r < src.rows; ++r)
+    quant_row(dest->data + r * ld, Mat_row_ptr(src, r), 1, src.cols, scale);
+
+  return ML_OK;
+}
+
+ML_Status Mat_dequantize_i8(Matf32* dest, const Mati8 src) {
+  if (!dest) return ML_INVALID_ARGUMENT;
+  if (!dest->data || !src.data || !src.scales) return ML_INVALID_ARGUMENT;
+  if (dest->rows != src.rows || dest->cols != src.cols) return ML_INVALID_ARGUMENT;
+
+  const u64 ld = mati8_ld(src);
+
+  for (u64 r = 0; r < src.rows; ++r) {
+    const i8* q = src.data + r * ld;
+    f32* out = Mat_row_ptr(*dest, r);
+    const f32 scale = Mati8_scale(src, r);
+    for (u64 c = 0; c < src.cols; ++c) out[c] = (f32)q[c] * scale;
+  }
+
+  return ML_OK;
+}
+
+ML_Status Mat_Mul_Mati8_into(Matf32* out, const Mati8 lhs, const Mati8 rhs_t) {
+  if (!out) return ML_INVALID_ARGUMENT;
+  if (!out->data || !lhs.data || !rhs_t.data) return ML_INVALID_ARGUMENT;
+  if (!lhs.scales || !rhs_t.scales) return ML_INVALID_ARGUMENT;
+
+  if (lhs.cols != rhs_t.cols) return ML_INVALID_ARGUMENT;
+  if (out->rows != lhs.rows || out->cols != rhs_t.rows) return ML_INVALID_ARGUMENT;
+
+  const ML_SimdKernels* K = ml_simd();
+  const u64 k = lhs.cols;
+  const u64 ld_a = mati8_ld(lhs);
+  const u64 ld_b = mati8_ld(rhs_t);
+  const u64 ld_c = Mat_ld(*out);
+
+  // Keep a block of rhs_t rows resident while all of lhs streams over it
+  u64 nb = k ? ML_GEMM_I8_BLOCK_BYTES / k : rhs_t.rows;
+  if (nb == 0) nb = 1;
+
+  for (u64 j0 = 0; j0 < rhs_t.rows; j0 += nb) {
+    const u64 j1 = j0 + nb < rhs_t.rows ? j0 + nb : rhs_t.rows;
+
+    for (u64 i = 0; i < lhs.rows; ++i) {
+      const i8* a = lhs.data + i * ld_a;
+      const f32 sa = Mati8_scale(lhs, i);
+      f32* c = out->data + i * ld_c;
+
+      for (u64 j = j0; j < j1; ++j) {
+        const i32 acc = K->dot_i8(a, rhs_t.data + j * ld_b, k);
+        c[j] = (f32)acc * (sa * Mati8_scale(rhs_t, j));
+      }
+    }
+  }
+
+  return ML_OK;
+}
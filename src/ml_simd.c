@@ -0,0 +1,115 @@
+#include "ml_simd.h"
+#include "ml_backend.h"
+#include "ml_error.h"
+#include "ml_math.h"
+
+#include <stddef.h>
+
+_Atomic(const ML_SimdKernels*) ml_simd_active = NULL;
+ML_MathAccuracy ml_math_accuracy = ML_MATH_DEFAULT_ACCURACY;
+
+static const ML_SimdKernels* simd_table(ML_Backend backend) {
+  switch (backend) {
+   case ML_BACKEND_SCALAR:
+     return &ml_simd_scalar_kernels;
+#if defined(ML_SIMD_X86)
+   case ML_BACKEND_SSE2:
+     return __builtin_cpu_supports("sse2") ? &ml_simd_sse2_kernels : NULL;
+   case ML_BACKEND_AVX2:
+     return (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+             __builtin_cpu_supports("f16c"))
+       ? &ml_simd_avx2_kernels : NULL;
+   case ML_BACKEND_AVX512:
+     return __builtin_cpu_supports("avx512f") ? &ml_simd_avx512_kernels : NULL;
+#endif
+#if defined(ML_SIMD_NEON)
+   case ML_BACKEND_NEON:
+     return &ml_simd_neon_kernels;
+#endif
+   default:
+     return NULL;
+  }
+}
+
+static const ML_SimdKernels* simd_detect(void) {
+  // Widest first
+  static const ML_Backend order[] = {
+    ML_BACKEND_AVX512,
+    ML_BACKEND_AVX2,
+    ML_BACKEND_NEON,
+    ML_BACKEND_SSE2,
+  };
+
+#if defined(ML_SIMD_X86)
+  __builtin_cpu_init();
+#endif
+
+  for (u64 i = 0; i < sizeof(order) / sizeof(order[0]); ++i) {
+    const ML_SimdKernels* k = simd_table(order[i]);
+    if (k) return k;
+  }
+  return &ml_simd_scalar_kernels;
+}
+
+const ML_SimdKernels* ml_simd_init(void) {
+  // Detection is idempotent, so a concurrent first call stores the same table
+  const ML_SimdKernels* k = simd_detect();
+  atomic_store_explicit(&ml_simd_active, k, memory_order_relaxed);
+  return k;
+}
+
+ML_Backend get_ml_backend(void) {
+  return ml_simd()->id;
+}
+
+ML_Status set_ml_backend(ML_Backend backend) {
+  if (backend == ML_BACKEND_AUTO) {
+    ml_simd_init();
+    return ML_OK;
+  }
+  if (backend < ML_BACKEND_SCALAR || backend > ML_BACKEND_NEON)
+    return ML_INVALID_ARGUMENT;
+
+#if defined(ML_SIMD_X86)
+  __builtin_cpu_init();
+#endif
+
+  const ML_SimdKernels* k = simd_table(backend);
+  if (!k) return ML_UNIMPLEMENTED;
+
+  atomic_store_explicit(&ml_simd_active, k, memory_order_relaxed);
+  return ML_OK;
+}
+
+int has_ml_backend(ML_Backend backend) {
+  if (backend == ML_BACKEND_AUTO) return 1;
+
+#if defined(ML_SIMD_X86)
+  __builtin_cpu_init();
+#endif
+
+  return simd_table(backend) != NULL;
+}
+
+const char* get_name_ml_backend(ML_Backend backend) {
+  switch (backend) {
+   case ML_BACKEND_AUTO:   return "auto";
+   case ML_BACKEND_SCALAR: return "scalar";
+   case ML_BACKEND_SSE2:   return "sse2";
+   case ML_BACKEND_AVX2:   return "avx2";
+   case ML_BACKEND_AVX512: return "avx512";
+   case ML_BACKEND_NEON:   return "neon";
+   default:                return "unknown";
+  }
+}
+
+ML_MathAccuracy get_ml_math_accuracy(void) {
+  return ml_math_accuracy;
+}
+
+ML_Status set_ml_math_accuracy(ML_MathAccuracy acc) {
+  if (acc < ML_MATH_EXACT || acc > ML_MATH_FASTEST) return ML_INVALID_ARGUMENT;
+
+  ml_math_accuracy = acc;
+  return ML_OK;
+}
@@ -0,0 +1,126 @@
+#ifndef ML_SIMD_H
+#define ML_SIMD_H
+
+#include "ml_defs.h"
+#include "ml_backend.h"
+#include "ml_primitives.h"
+
+#include <stdatomic.h>
+
+/**
+ * @file ml_simd.h
+ * @brief Internal kernel table shared by the SIMD backends.
+ *
+ * Kernels work on raw contiguous runs of @p n floats and do no argument
+ * checking; the primitives validate shapes once and then call into the
+ * active table row by row (or over the whole buffer when contiguous).
+ *
+ * Define ML_SIMD_DISABLE to build only the scalar backend.
+ */
+
+#if !defined(ML_SIMD_DISABLE) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define ML_SIMD_X86 1
+#endif
+
+#if !defined(ML_SIMD_DISABLE) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define ML_SIMD_NEON 1
+#endif
+
+/** @brief Largest micro-kernel tile any backend may declare. */
+#define ML_SIMD_GEMM_MR_MAX 16
+#define ML_SIMD_GEMM_NR_MAX 32
+
+/**
+ * @brief GEMM micro-kernel: C(mr x nr) = (accumulate ? C : 0) + A * B.
+ *
+ * @p a is a packed MR-row micro-panel (MR values per k step) and @p b a
+ * packed NR-column micro-panel (NR values per k step), both kc deep.
+ */
+typedef void (*ML_GemmKernelFn)(u64 kc, const f32* a, const f32* b,
+                                f32* c, u64 ldc, int accumulate);
+
+typedef struct {
+  ML_Backend id;
+
+  /** dst[i] = v */
+  void (*fill)(f32* dst, u64 n, f32 v);
+  /** dst[i] = src[i] */
+  void (*copy)(f32* dst, const f32* src, u64 n);
+  /** x[i] *= s */
+  void (*scale)(f32* x, u64 n, f32 s);
+  /** x[i] += s */
+  void (*add_scalar)(f32* x, u64 n, f32 s);
+  /** y[i] += x[i] */
+  void (*add)(f32* y, const f32* x, u64 n);
+  /** y[i] += a * x[i] */
+  void (*axpy)(f32* y, const f32* x, u64 n, f32 a);
+  /** max_i x[i], n >= 1 */
+  f32 (*max)(const f32* x, u64 n);
+  /** sum_i x[i] */
+  f32 (*sum)(const f32* x, u64 n);
+  /** sum_i x[i] * y[i] */
+  f32 (*dot)(const f32* x, const f32* y, u64 n);
+  /** sum_i x[i] * y[i] over int8, accumulated in int32 */
+  i32 (*dot_i8)(const i8* x, const i8* y, u64 n);
+  /** x[i] = exp(x[i]), at the accuracy selected by ml_math_accuracy */
+  void (*exp)(f32* x, u64 n);
+  /** x[i] = log(x[i]), at the accuracy selected by ml_math_accuracy */
+  void (*log)(f32* x, u64 n);
+  /**
+   * y[i] = act(x[i]), y may equal x. Sigmoid, tanh and GELU follow
+   * ml_math_accuracy; ML_ACT_NONE copies.
+   */
+  void (*act)(f32* y, const f32* x, u64 n, ML_Activation act, f32 alpha);
+  /**
+   * dx[i] = dy[i] * act'(x[i]), dx may equal dy. v is the forward output
+   * y = act(x) for every activation but GELU, which takes the input x.
+   * The ReLU forms read the sign of y, so leaky alpha must be >= 0.
+   */
+  void (*act_grad)(f32* dx, const f32* dy, const f32* v, u64 n,
+                   ML_Activation act, f32 alpha);
+
+  /** dst[i] = (f32)src[i], IEEE binary16 source */
+  void (*f16_to_f32)(f32* dst, const u16* src, u64 n);
+  /** dst[i] = (f16)src[i], round to nearest even */
+  void (*f32_to_f16)(u16* dst, const f32* src, u64 n);
+  /** dst[i] = (f32)src[i], bfloat16 source */
+  void (*bf16_to_f32)(f32* dst, const u16* src, u64 n);
+  /** dst[i] = (bf16)src[i], round to nearest even */
+  void (*f32_to_bf16)(u16* dst, const f32* src, u64 n);
+
+  /** GEMM micro-kernel and its register tile. */
+  ML_GemmKernelFn gemm_kernel;
+  u64 gemm_mr;
+  u64 gemm_nr;
+} ML_SimdKernels;
+
+/* Backend tables. Only the ones compiled for this target are defined. */
+extern const ML_SimdKernels ml_simd_scalar_kernels;
+#if defined(ML_SIMD_X86)
+extern const ML_SimdKernels ml_simd_sse2_kernels;
+extern const ML_SimdKernels ml_simd_avx2_kernels;
+extern const ML_SimdKernels ml_simd_avx512_kernels;
+#endif
+#if defined(ML_SIMD_NEON)
+extern const ML_SimdKernels ml_simd_neon_kernels;
+#endif
+
+/**
+ * @brief Active table, NULL until the first call to ml_simd().
+ *
+ * Pool workers may make the first call concurrently, so the pointer is
+ * atomic. The tables are constants, so relaxed ordering is enough.
+ */
+extern _Atomic(const ML_SimdKernels*) ml_simd_active;
+
+/** @brief Detect the CPU and install the best table. */
+const ML_SimdKernels* ml_simd_init(void);
+
+/** @brief Get the active kernel table (detecting the CPU on first use). */
+static inline const ML_SimdKernels* ml_simd(void) {
+  const ML_SimdKernels* k = atomic_load_explicit(&ml_simd_active, memory_order_relaxed);
+  return k ? k : ml_simd_init();
+}
+
+#endif // ML_SIMD_H
@@ -0,0 +1,503 @@
+#include "ml_simd.h"
+#include "ml_math.h"
+#include "ml_half_conv.h"
+
+#if defined(ML_SIMD_NEON)
+
+#include <arm_neon.h>
+#include <math.h>
+
+/*
+ * ARM NEON backend. NEON is part of the AArch64 baseline, so this table is
+ * selected at compile time and needs no runtime probe.
+ */
+
+#define NEON_MR 8
+#define NEON_NR 8
+
+static inline f32 neon_hsum(float32x4_t v) {
+#if defined(__aarch64__)
+  return vaddvq_f32(v);
+#else
+  float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+  return vget_lane_f32(vpadd_f32(s, s), 0);
+#endif
+}
+
+static inline f32 neon_hmax(float32x4_t v) {
+#if defined(__aarch64__)
+  return vmaxvq_f32(v);
+#else
+  float32x2_t m = vmax_f32(vget_low_f32(v), vget_high_f32(v));
+  return vget_lane_f32(vpmax_f32(m, m), 0);
+#endif
+}
+
+static inline float32x4_t neon_fma(float32x4_t acc, float32x4_t a, float32x4_t b) {
+#if defined(__aarch64__)
+  return vfmaq_f32(acc, a, b);
+#else
+  return vmlaq_f32(acc, a, b);
+#endif
+}
+
+static void neon_fill(f32* dst, u64 n, f32 v) {
+  const float32x4_t vv = vdupq_n_f32(v);
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4) vst1q_f32(dst + i, vv);
+  for (; i < n; ++i) dst[i] = v;
+}
+
+static void neon_copy(f32* dst, const f32* src, u64 n) {
+  if (dst == src) return;
+  if (dst > src && dst < src + n) {
+    for (u64 i = n; i-- > 0;) dst[i] = src[i];
+    return;
+  }
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4) vst1q_f32(dst + i, vld1q_f32(src + i));
+  for (; i < n; ++i) dst[i] = src[i];
+}
+
+static void neon_scale(f32* x, u64 n, f32 s) {
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4) vst1q_f32(x + i, vmulq_n_f32(vld1q_f32(x + i), s));
+  for (; i < n; ++i) x[i] *= s;
+}
+
+static void neon_add_scalar(f32* x, u64 n, f32 s) {
+  const float32x4_t vs = vdupq_n_f32(s);
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4) vst1q_f32(x + i, vaddq_f32(vld1q_f32(x + i), vs));
+  for (; i < n; ++i) x[i] += s;
+}
+
+static void neon_add(f32* y, const f32* x, u64 n) {
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32(y + i, vaddq_f32(vld1q_f32(y + i), vld1q_f32(x + i)));
+  for (; i < n; ++i) y[i] += x[i];
+}
+
+static void neon_axpy(f32* y, const f32* x, u64 n, f32 a) {
+  const float32x4_t va = vdupq_n_f32(a);
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32(y + i, neon_fma(vld1q_f32(y + i), va, vld1q_f32(x + i)));
+  for (; i < n; ++i) y[i] += a * x[i];
+}
+
+static f32 neon_max(const f32* x, u64 n) {
+  f32 m = x[0];
+  u64 i = 0;
+  if (n >= 4) {
+    float32x4_t vm = vld1q_f32(x);
+    for (i = 4; i + 4 <= n; i += 4) vm = vmaxq_f32(vm, vld1q_f32(x + i));
+    m = neon_hmax(vm);
+  }
+  for (; i < n; ++i)
+    if (x[i] > m) m = x[i];
+  return m;
+}
+
+static f32 neon_sum(const f32* x, u64 n) {
+  float32x4_t s0 = vdupq_n_f32(0.0f), s1 = vdupq_n_f32(0.0f);
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    s0 = vaddq_f32(s0, vld1q_f32(x + i));
+    s1 = vaddq_f32(s1, vld1q_f32(x + i + 4));
+  }
+  for (; i + 4 <= n; i += 4) s0 = vaddq_f32(s0, vld1q_f32(x + i));
+  f32 s = neon_hsum(vaddq_f32(s0, s1));
+  for (; i < n; ++i) s += x[i];
+  return s;
+}
+
+static f32 neon_dot(const f32* x, const f32* y, u64 n) {
+  float32x4_t s0 = vdupq_n_f32(0.0f), s1 = vdupq_n_f32(0.0f);
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    s0 = neon_fma(s0, vld1q_f32(x + i), vld1q_f32(y + i));
+    s1 = neon_fma(s1, vld1q_f32(x + i + 4), vld1q_f32(y + i + 4));
+  }
+  for (; i + 4 <= n; i += 4) s0 = neon_fma(s0, vld1q_f32(x + i), vld1q_f32(y + i));
+  f32 s = neon_hsum(vaddq_f32(s0, s1));
+  for (; i < n; ++i) s += x[i] * y[i];
+  return s;
+}
+
+// Widening int8 multiply into int16, pairwise-accumulated into int32
+static i32 neon_dot_i8(const i8* x, const i8* y, u64 n) {
+  int32x4_t acc = vdupq_n_s32(0);
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const int8x16_t vx = vld1q_s8(x + i);
+    const int8x16_t vy = vld1q_s8(y + i);
+    acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(vx), vget_low_s8(vy)));
+    acc = vpadalq_s16(acc, vmull_s8(vget_high_s8(vx), vget_high_s8(vy)));
+  }
+#if defined(__aarch64__)
+  i32 s = vaddvq_s32(acc);
+#else
+  int32x2_t s2 = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+  i32 s = vget_lane_s32(vpadd_s32(s2, s2), 0);
+#endif
+  for (; i < n; ++i) s += (i32)x[i] * (i32)y[i];
+  return s;
+}
+
+// See ml_math.h for the algorithm
+static inline float32x4_t neon_exp_ps(float32x4_t x, int fastest) {
+  const float32x4_t hi = vdupq_n_f32(ML_EXP_HI);
+  const float32x4_t lo = vdupq_n_f32(ML_EXP_LO);
+  const float32x4_t xc = vminq_f32(vmaxq_f32(x, lo), hi);
+
+  const float32x4_t magic = vdupq_n_f32(ML_ROUND_MAGIC);
+  const float32x4_t n = vsubq_f32(neon_fma(magic, xc, vdupq_n_f32(ML_LOG2E)), magic);
+  float32x4_t r = vmlsq_n_f32(xc, n, ML_LN2_HI);
+  r = vmlsq_n_f32(r, n, ML_LN2_LO);
+
+  float32x4_t q;
+  if (fastest) {
+    q = vdupq_n_f32(ML_EXP_X_Q2);
+    q = neon_fma(vdupq_n_f32(ML_EXP_X_Q1), q, r);
+    q = neon_fma(vdupq_n_f32(ML_EXP_X_Q0), q, r);
+  } else {
+    q = vdupq_n_f32(ML_EXP_F_Q5);
+    q = neon_fma(vdupq_n_f32(ML_EXP_F_Q4), q, r);
+    q = neon_fma(vdupq_n_f32(ML_EXP_F_Q3), q, r);
+    q = neon_fma(vdupq_n_f32(ML_EXP_F_Q2), q, r);
+    q = neon_fma(vdupq_n_f32(ML_EXP_F_Q1), q, r);
+    q = neon_fma(vdupq_n_f32(ML_EXP_F_Q0), q, r);
+  }
+  float32x4_t p = neon_fma(r, q, vmulq_f32(r, r));
+  p = vaddq_f32(p, vdupq_n_f32(1.0f));
+
+  const int32x4_t bias = vdupq_n_s32(127);
+  const int32x4_t ni = vcvtq_s32_f32(n);
+  const int32x4_t n1 = vshrq_n_s32(ni, 1);
+  const int32x4_t n2 = vsubq_s32(ni, n1);
+  p = vmulq_f32(p, vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(n1, bias), 23)));
+  p = vmulq_f32(p, vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(n2, bias), 23)));
+
+  p = vbslq_f32(vcgtq_f32(x, hi), vdupq_n_f32(INFINITY), p);
+  p = vbslq_f32(vcltq_f32(x, lo), vdupq_n_f32(0.0f), p);
+  return vbslq_f32(vceqq_f32(x, x), p, vaddq_f32(x, x));
+}
+
+static inline float32x4_t neon_log_ps(float32x4_t x, int fastest) {
+  const uint32x4_t sub = vcltq_f32(x, vdupq_n_f32(1.17549435e-38f));
+  const float32x4_t xs = vbslq_f32(sub, vmulq_n_f32(x, 8388608.0f), x);
+  const uint32x4_t bits = vreinterpretq_u32_f32(xs);
+
+  int32x4_t e = vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(126));
+  e = vsubq_s32(e, vreinterpretq_s32_u32(vandq_u32(sub, vdupq_n_u32(23))));
+  float32x4_t m = vreinterpretq_f32_u32(
+      vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007fffff)), vdupq_n_u32(0x3f000000)));
+  const uint32x4_t small = vcltq_f32(m, vdupq_n_f32(ML_SQRTHF));
+  m = vbslq_f32(small, vaddq_f32(m, m), m);
+  e = vaddq_s32(e, vreinterpretq_s32_u32(small));
+
+  const float32x4_t f = vsubq_f32(m, vdupq_n_f32(1.0f));
+  const float32x4_t z = vmulq_f32(f, f);
+
+  float32x4_t rr;
+  if (fastest) {
+    rr = vdupq_n_f32(ML_LOG_X_R3);
+    rr = neon_fma(vdupq_n_f32(ML_LOG_X_R2), rr, f);
+    rr = neon_fma(vdupq_n_f32(ML_LOG_X_R1), rr, f);
+    rr = neon_fma(vdupq_n_f32(ML_LOG_X_R0), rr, f);
+  } else {
+    rr = vdupq_n_f32(ML_LOG_F_R8);
+    rr = neon_fma(vdupq_n_f32(ML_LOG_F_R7), rr, f);
+    rr = neon_fma(vdupq_n_f32(ML_LOG_F_R6), rr, f);
+    rr = neon_fma(vdupq_n_f32(ML_LOG_F_R5), rr, f);
+    rr = neon_fma(vdupq_n_f32(ML_LOG_F_R4), rr, f);
+    rr = neon_fma(vdupq_n_f32(ML_LOG_F_R3), rr, f);
+    rr = neon_fma(vdupq_n_f32(ML_LOG_F_R2), rr, f);
+    rr = neon_fma(vdupq_n_f32(ML_LOG_F_R1), rr, f);
+    rr = neon_fma(vdupq_n_f32(ML_LOG_F_R0), rr, f);
+  }
+
+  const float32x4_t fe = vcvtq_f32_s32(e);
+  float32x4_t y = vmulq_f32(vmulq_f32(rr, f), z);
+  y = neon_fma(y, fe, vdupq_n_f32(ML_LN2_LO));
+  y = vmlsq_n_f32(y, z, 0.5f);
+  y = neon_fma(vaddq_f32(f, y), fe, vdupq_n_f32(ML_LN2_HI));
+
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  y = vbslq_f32(vceqq_f32(x, zero), vdupq_n_f32(-INFINITY), y);
+  y = vbslq_f32(vceqq_f32(x, vdupq_n_f32(INFINITY)), x, y);
+  y = vbslq_f32(vcltq_f32(x, zero), vdupq_n_f32(NAN), y);
+  return vbslq_f32(vceqq_f32(x, x), y, vaddq_f32(x, x));
+}
+
+static inline void neon_exp_run(f32* x, u64 n, int fastest) {
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4) vst1q_f32(x + i, neon_exp_ps(vld1q_f32(x + i), fastest));
+  for (; i < n; ++i) x[i] = ml_expf_approx(x[i], fastest);
+}
+
+static inline void neon_log_run(f32* x, u64 n, int fastest) {
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4) vst1q_f32(x + i, neon_log_ps(vld1q_f32(x + i), fastest));
+  for (; i < n; ++i) x[i] = ml_logf_approx(x[i], fastest);
+}
+
+static void neon_exp(f32* x, u64 n) {
+  switch (ml_math_accuracy) {
+   case ML_MATH_FAST:    neon_exp_run(x, n, 0); break;
+   case ML_MATH_FASTEST: neon_exp_run(x, n, 1); break;
+   default:              ml_exp_libm(x, n); break;
+  }
+}
+
+static void neon_log(f32* x, u64 n) {
+  switch (ml_math_accuracy) {
+   case ML_MATH_FAST:    neon_log_run(x, n, 0); break;
+   case ML_MATH_FASTEST: neon_log_run(x, n, 1); break;
+   default:              ml_log_libm(x, n); break;
+  }
+}
+
+// a / b; ARMv7 NEON has no divide, so refine the reciprocal estimate
+static inline float32x4_t neon_div(float32x4_t a, float32x4_t b) {
+#if defined(__aarch64__)
+  return vdivq_f32(a, b);
+#else
+  float32x4_t r = vrecpeq_f32(b);
+  r = vmulq_f32(r, vrecpsq_f32(b, r));
+  r = vmulq_f32(r, vrecpsq_f32(b, r));
+  return vmulq_f32(a, r);
+#endif
+}
+
+static inline float32x4_t neon_sigmoid_ps(float32x4_t x, int fastest) {
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  return neon_div(one, vaddq_f32(one, neon_exp_ps(vnegq_f32(x), fastest)));
+}
+
+// See ml_tanhf_approx; vmin/vmax propagate NaN
+static inline float32x4_t neon_tanh_ps(float32x4_t x, int fastest) {
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  const float32x4_t v = vminq_f32(vmaxq_f32(x, vdupq_n_f32(-ML_TANH_CLAMP)),
+                                  vdupq_n_f32(ML_TANH_CLAMP));
+  const float32x4_t e = neon_exp_ps(vmulq_n_f32(v, -2.0f), fastest);
+  return neon_div(vsubq_f32(one, e), vaddq_f32(one, e));
+}
+
+// tanh(K x (1 + C x^2)), the inner term of GELU and its derivative
+static inline float32x4_t neon_gelu_t_ps(float32x4_t x, float32x4_t x2, int fastest) {
+  const float32x4_t p = neon_fma(vdupq_n_f32(1.0f), x2, vdupq_n_f32(ML_GELU_C));
+  return neon_tanh_ps(vmulq_f32(vmulq_n_f32(x, ML_GELU_K), p), fastest);
+}
+
+static inline float32x4_t neon_gelu_ps(float32x4_t x, int fastest) {
+  const float32x4_t t = neon_gelu_t_ps(x, vmulq_f32(x, x), fastest);
+  return vmulq_f32(vmulq_n_f32(x, 0.5f), vaddq_f32(vdupq_n_f32(1.0f), t));
+}
+
+static inline float32x4_t neon_gelu_grad_ps(float32x4_t x, int fastest) {
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  const float32x4_t x2 = vmulq_f32(x, x);
+  const float32x4_t t = neon_gelu_t_ps(x, x2, fastest);
+  const float32x4_t du = vmulq_n_f32(neon_fma(one, x2, vdupq_n_f32(3.0f * ML_GELU_C)), ML_GELU_K);
+  const float32x4_t s = vmulq_f32(vmulq_n_f32(x, 0.5f), vmlsq_f32(one, t, t));
+  return neon_fma(vmulq_n_f32(vaddq_f32(one, t), 0.5f), s, du);
+}
+
+// y[i] = VEC over xv = x[i..i+4), SCAL for the remainder
+#define NEON_ACT_LOOP(VEC, SCAL)                                       \
+  for (; i + 4 <= n; i += 4) {                                         \
+    const float32x4_t xv = vld1q_f32(x + i);                           \
+    vst1q_f32(y + i, VEC);                                             \
+  }                                                                    \
+  for (; i < n; ++i) y[i] = SCAL
+
+// dx[i] = VEC over gv = dy[i..i+4) and vv = v[i..i+4), SCAL for the remainder
+#define NEON_GRAD_LOOP(VEC, SCAL)                                      \
+  for (; i + 4 <= n; i += 4) {                                         \
+    const float32x4_t gv = vld1q_f32(dy + i);                          \
+    const float32x4_t vv = vld1q_f32(v + i);                           \
+    vst1q_f32(dx + i, VEC);                                            \
+  }                                                                    \
+  for (; i < n; ++i) dx[i] = SCAL
+
+static void neon_act(f32* y, const f32* x, u64 n, ML_Activation act, f32 alpha) {
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const int fastest = ml_math_accuracy == ML_MATH_FASTEST;
+  u64 i = 0;
+
+  if (ml_math_accuracy == ML_MATH_EXACT && act != ML_ACT_RELU && act != ML_ACT_LEAKY_RELU) {
+    ml_act_libm(y, x, n, act, alpha);
+    return;
+  }
+  switch (act) {
+   case ML_ACT_RELU:
+     // vmaxq would keep a NaN, where the other backends give 0
+     NEON_ACT_LOOP(vbslq_f32(vcgtq_f32(xv, zero), xv, zero), x[i] > 0.0f ? x[i] : 0.0f);
+     break;
+   case ML_ACT_LEAKY_RELU:
+     NEON_ACT_LOOP(vbslq_f32(vcgtq_f32(xv, zero), xv, vmulq_n_f32(xv, alpha)),
+                   x[i] > 0.0f ? x[i] : alpha * x[i]);
+     break;
+   case ML_ACT_SIGMOID:
+     NEON_ACT_LOOP(neon_sigmoid_ps(xv, fastest), ml_sigmoidf_approx(x[i], fastest));
+     break;
+   case ML_ACT_TANH:
+     NEON_ACT_LOOP(neon_tanh_ps(xv, fastest), ml_tanhf_approx(x[i], fastest));
+     break;
+   case ML_ACT_GELU:
+     NEON_ACT_LOOP(neon_gelu_ps(xv, fastest), ml_geluf_approx(x[i], fastest));
+     break;
+   default:
+     ml_act_libm(y, x, n, act, alpha);
+     break;
+  }
+}
+
+static void neon_act_grad(f32* dx, const f32* dy, const f32* v, u64 n,
+                          ML_Activation act, f32 alpha) {
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  const int fastest = ml_math_accuracy == ML_MATH_FASTEST;
+  u64 i = 0;
+
+  switch (act) {
+   case ML_ACT_RELU:
+     NEON_GRAD_LOOP(vbslq_f32(vcgtq_f32(vv, zero), gv, zero), v[i] > 0.0f ? dy[i] : 0.0f);
+     break;
+   case ML_ACT_LEAKY_RELU:
+     NEON_GRAD_LOOP(vbslq_f32(vcgtq_f32(vv, zero), gv, vmulq_n_f32(gv, alpha)),
+                    v[i] > 0.0f ? dy[i] : alpha * dy[i]);
+     break;
+   case ML_ACT_SIGMOID:
+     NEON_GRAD_LOOP(vmulq_f32(vmulq_f32(gv, vv), vsubq_f32(one, vv)),
+                    dy[i] * v[i] * (1.0f - v[i]));
+     break;
+   case ML_ACT_TANH:
+     NEON_GRAD_LOOP(vmulq_f32(gv, vmlsq_f32(one, vv, vv)), dy[i] * (1.0f - v[i] * v[i]));
+     break;
+   case ML_ACT_GELU:
+     if (ml_math_accuracy == ML_MATH_EXACT) {
+       ml_act_grad_libm(dx, dy, v, n, act, alpha);
+       break;
+     }
+     NEON_GRAD_LOOP(vmulq_f32(gv, neon_gelu_grad_ps(vv, fastest)),
+                    dy[i] * ml_gelu_gradf_approx(v[i], fastest));
+     break;
+   default:
+     ml_act_grad_libm(dx, dy, v, n, act, alpha);
+     break;
+  }
+}
+
+#undef NEON_ACT_LOOP
+#undef NEON_GRAD_LOOP
+
+#if defined(__aarch64__)
+// AArch64 always has the half <-> single conversion instructions
+static void neon_f16_to_f32(f32* dst, const u16* src, u64 n) {
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+  for (; i < n; ++i) dst[i] = ml_f16_to_f32(src[i]);
+}
+
+static void neon_f32_to_f16(u16* dst, const f32* src, u64 n) {
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4)
+    vst1_u16(dst + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+  for (; i < n; ++i) dst[i] = ml_f32_to_f16(src[i]);
+}
+#else
+#define neon_f16_to_f32 ml_f16_to_f32_ref
+#define neon_f32_to_f16 ml_f32_to_f16_ref
+#endif
+
+static void neon_bf16_to_f32(f32* dst, const u16* src, u64 n) {
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32(dst + i, vreinterpretq_f32_u32(vshll_n_u16(vld1_u16(src + i), 16)));
+  for (; i < n; ++i) dst[i] = ml_bf16_to_f32(src[i]);
+}
+
+static void neon_f32_to_bf16(u16* dst, const f32* src, u64 n) {
+  const uint32x4_t abs_mask = vdupq_n_u32(0x7fffffffu);
+  const uint32x4_t inf = vdupq_n_u32(0x7f800000u);
+  const uint32x4_t one = vdupq_n_u32(1);
+  const uint32x4_t bias = vdupq_n_u32(0x7fffu);
+  const uint32x4_t quiet = vdupq_n_u32(0x400000u);
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const uint32x4_t x = vreinterpretq_u32_f32(vld1q_f32(src + i));
+    const uint32x4_t nan = vcgtq_u32(vandq_u32(x, abs_mask), inf);
+    const uint32x4_t odd = vandq_u32(vshrq_n_u32(x, 16), one);
+    uint32x4_t r = vaddq_u32(x, vaddq_u32(odd, bias));
+    r = vbslq_u32(nan, vorrq_u32(x, quiet), r);
+    vst1_u16(dst + i, vshrn_n_u32(r, 16));
+  }
+  for (; i < n; ++i) dst[i] = ml_f32_to_bf16(src[i]);
+}
+
+static void neon_gemm_8x8(u64 kc, const f32* a, const f32* b,
+                          f32* c, u64 ldc, int accumulate) {
+  float32x4_t acc[NEON_MR][2];
+
+  for (int r = 0; r < NEON_MR; ++r) {
+    acc[r][0] = vdupq_n_f32(0.0f);
+    acc[r][1] = vdupq_n_f32(0.0f);
+  }
+
+  for (u64 p = 0; p < kc; ++p) {
+    const float32x4_t b0 = vld1q_f32(b);
+    const float32x4_t b1 = vld1q_f32(b + 4);
+
+    for (int r = 0; r < NEON_MR; ++r) {
+      const float32x4_t av = vdupq_n_f32(a[r]);
+      acc[r][0] = neon_fma(acc[r][0], av, b0);
+      acc[r][1] = neon_fma(acc[r][1], av, b1);
+    }
+
+    a += NEON_MR;
+    b += NEON_NR;
+  }
+
+  for (int r = 0; r < NEON_MR; ++r) {
+    f32* cr = c + (u64)r * ldc;
+    float32x4_t v0 = acc[r][0], v1 = acc[r][1];
+    if (accumulate) {
+      v0 = vaddq_f32(v0, vld1q_f32(cr));
+      v1 = vaddq_f32(v1, vld1q_f32(cr + 4));
+    }
+    vst1q_f32(cr, v0);
+    vst1q_f32(cr + 4, v1);
+  }
+}
+
+const ML_SimdKernels ml_simd_neon_kernels = {
+  .id = ML_BACKEND_NEON,
+  .fill = neon_fill,
+  .copy = neon_copy,
+  .scale = neon_scale,
+  .add_scalar = neon_add_scalar,
+  .add = neon_add,
+  .axpy = neon_axpy,
+  .max = neon_max,
+  .sum = neon_sum,
+  .dot = neon_dot,
+  .dot_i8 = neon_dot_i8,
+  .exp = neon_exp,
+  .log = neon_log,
+  .act = neon_act,
+  .act_grad = neon_act_grad,
+  .f16_to_f32 = neon_f16_to_f32,
+  .f32_to_f16 = neon_f32_to_f16,
+  .bf16_to_f32 = neon_bf16_to_f32,
+  .f32_to_bf16 = neon_f32_to_bf16,
+  .gemm_kernel = neon_gemm_8x8,
+  .gemm_mr = NEON_MR,
+  .gemm_nr = NEON_NR,
+};
+
+#endif // ML_SIMD_NEON
@@ -0,0 +1,262 @@
+// The fast exp/log in ml_math.h are written branch-free, but with
+// -ftrapping-math GCC will not if-convert their selects and so never
+// vectorises the loops below. Nothing here reads the FP exception flags.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize("no-trapping-math")
+#endif
+
+#include "ml_simd.h"
+#include "ml_math.h"
+#include "ml_half_conv.h"
+
+#include <math.h>
+#include <string.h>
+
+/*
+ * Portable reference backend. Plain loops the compiler is free to
+ * auto-vectorise; this is the only backend on ESP-IDF targets.
+ */
+
+#define SCALAR_MR 4
+#define SCALAR_NR 8
+
+static void scalar_fill(f32* dst, u64 n, f32 v) {
+  for (u64 i = 0; i < n; ++i) dst[i] = v;
+}
+
+static void scalar_copy(f32* dst, const f32* src, u64 n) {
+  if (dst != src) memmove(dst, src, (size_t)n * sizeof(f32));
+}
+
+static void scalar_scale(f32* x, u64 n, f32 s) {
+  for (u64 i = 0; i < n; ++i) x[i] *= s;
+}
+
+static void scalar_add_scalar(f32* x, u64 n, f32 s) {
+  for (u64 i = 0; i < n; ++i) x[i] += s;
+}
+
+static void scalar_add(f32* y, const f32* x, u64 n) {
+  for (u64 i = 0; i < n; ++i) y[i] += x[i];
+}
+
+static void scalar_axpy(f32* y, const f32* x, u64 n, f32 a) {
+  for (u64 i = 0; i < n; ++i) y[i] += a * x[i];
+}
+
+static f32 scalar_max(const f32* x, u64 n) {
+  f32 m = x[0];
+  for (u64 i = 1; i < n; ++i)
+    if (x[i] > m) m = x[i];
+  return m;
+}
+
+static f32 scalar_sum(const f32* x, u64 n) {
+  f32 s = 0.0f;
+  for (u64 i = 0; i < n; ++i) s += x[i];
+  return s;
+}
+
+static f32 scalar_dot(const f32* x, const f32* y, u64 n) {
+  f32 s = 0.0f;
+  for (u64 i = 0; i < n; ++i) s += x[i] * y[i];
+  return s;
+}
+
+void ml_exp_libm(f32* x, u64 n) {
+  for (u64 i = 0; i < n; ++i) x[i] = expf(x[i]);
+}
+
+void ml_log_libm(f32* x, u64 n) {
+  for (u64 i = 0; i < n; ++i) x[i] = logf(x[i]);
+}
+
+static i32 scalar_dot_i8(const i8* x, const i8* y, u64 n) {
+  i32 s = 0;
+  for (u64 i = 0; i < n; ++i) s += (i32)x[i] * (i32)y[i];
+  return s;
+}
+
+static void scalar_exp(f32* x, u64 n) {
+  switch (ml_math_accuracy) {
+   case ML_MATH_FAST:
+     for (u64 i = 0; i < n; ++i) x[i] = ml_expf_approx(x[i], 0);
+     break;
+   case ML_MATH_FASTEST:
+     for (u64 i = 0; i < n; ++i) x[i] = ml_expf_approx(x[i], 1);
+     break;
+   default:
+     ml_exp_libm(x, n);
+     break;
+  }
+}
+
+static void scalar_log(f32* x, u64 n) {
+  switch (ml_math_accuracy) {
+   case ML_MATH_FAST:
+     for (u64 i = 0; i < n; ++i) x[i] = ml_logf_approx(x[i], 0);
+     break;
+   case ML_MATH_FASTEST:
+     for (u64 i = 0; i < n; ++i) x[i] = ml_logf_approx(x[i], 1);
+     break;
+   default:
+     ml_log_libm(x, n);
+     break;
+  }
+}
+
+void ml_act_libm(f32* y, const f32* x, u64 n, ML_Activation act, f32 alpha) {
+  switch (act) {
+   case ML_ACT_RELU:
+     for (u64 i = 0; i < n; ++i) y[i] = x[i] > 0.0f ? x[i] : 0.0f;
+     break;
+   case ML_ACT_LEAKY_RELU:
+     for (u64 i = 0; i < n; ++i) y[i] = x[i] > 0.0f ? x[i] : alpha * x[i];
+     break;
+   case ML_ACT_SIGMOID:
+     for (u64 i = 0; i < n; ++i) y[i] = 1.0f / (1.0f + expf(-x[i]));
+     break;
+   case ML_ACT_TANH:
+     for (u64 i = 0; i < n; ++i) y[i] = tanhf(x[i]);
+     break;
+   case ML_ACT_GELU:
+     for (u64 i = 0; i < n; ++i) {
+       const f32 v = x[i];
+       y[i] = 0.5f * v * (1.0f + tanhf(ML_GELU_K * v * (1.0f + ML_GELU_C * v * v)));
+     }
+     break;
+   default:
+     if (y != x) memmove(y, x, (size_t)n * sizeof(f32));
+     break;
+  }
+}
+
+void ml_act_grad_libm(f32* dx, const f32* dy, const f32* v, u64 n,
+                      ML_Activation act, f32 alpha) {
+  switch (act) {
+   case ML_ACT_RELU:
+     for (u64 i = 0; i < n; ++i) dx[i] = v[i] > 0.0f ? dy[i] : 0.0f;
+     break;
+   case ML_ACT_LEAKY_RELU:
+     for (u64 i = 0; i < n; ++i) dx[i] = v[i] > 0.0f ? dy[i] : alpha * dy[i];
+     break;
+   case ML_ACT_SIGMOID:
+     for (u64 i = 0; i < n; ++i) dx[i] = dy[i] * v[i] * (1.0f - v[i]);
+     break;
+   case ML_ACT_TANH:
+     for (u64 i = 0; i < n; ++i) dx[i] = dy[i] * (1.0f - v[i] * v[i]);
+     break;
+   case ML_ACT_GELU:
+     for (u64 i = 0; i < n; ++i) {
+       const f32 x = v[i], x2 = x * x;
+       const f32 t = tanhf(ML_GELU_K * x * (1.0f + ML_GELU_C * x2));
+       const f32 du = ML_GELU_K * (1.0f + 3.0f * ML_GELU_C * x2);
+       dx[i] = dy[i] * (0.5f * (1.0f + t) + 0.5f * x * (1.0f - t * t) * du);
+     }
+     break;
+   default:
+     if (dx != dy) memmove(dx, dy, (size_t)n * sizeof(f32));
+     break;
+  }
+}
+
+static void scalar_act(f32* y, const f32* x, u64 n, ML_Activation act, f32 alpha) {
+  const int fastest = ml_math_accuracy == ML_MATH_FASTEST;
+
+  if (ml_math_accuracy == ML_MATH_EXACT) {
+    ml_act_libm(y, x, n, act, alpha);
+    return;
+  }
+  switch (act) {
+   case ML_ACT_SIGMOID:
+     for (u64 i = 0; i < n; ++i) y[i] = ml_sigmoidf_approx(x[i], fastest);
+     break;
+   case ML_ACT_TANH:
+     for (u64 i = 0; i < n; ++i) y[i] = ml_tanhf_approx(x[i], fastest);
+     break;
+   case ML_ACT_GELU:
+     for (u64 i = 0; i < n; ++i) y[i] = ml_geluf_approx(x[i], fastest);
+     break;
+   default:
+     // The piecewise-linear ones have nothing to approximate
+     ml_act_libm(y, x, n, act, alpha);
+     break;
+  }
+}
+
+static void scalar_act_grad(f32* dx, const f32* dy, const f32* v, u64 n,
+                            ML_Activation act, f32 alpha) {
+  // Only GELU evaluates a transcendental in its derivative
+  if (act != ML_ACT_GELU || ml_math_accuracy == ML_MATH_EXACT) {
+    ml_act_grad_libm(dx, dy, v, n, act, alpha);
+    return;
+  }
+  const int fastest = ml_math_accuracy == ML_MATH_FASTEST;
+  for (u64 i = 0; i < n; ++i) dx[i] = dy[i] * ml_gelu_gradf_approx(v[i], fastest);
+}
+
+void ml_f16_to_f32_ref(f32* dst, const u16* src, u64 n) {
+  for (u64 i = 0; i < n; ++i) dst[i] = ml_f16_to_f32(src[i]);
+}
+
+void ml_f32_to_f16_ref(u16* dst, const f32* src, u64 n) {
+  for (u64 i = 0; i < n; ++i) dst[i] = ml_f32_to_f16(src[i]);
+}
+
+static void scalar_bf16_to_f32(f32* dst, const u16* src, u64 n) {
+  for (u64 i = 0; i < n; ++i) dst[i] = ml_bf16_to_f32(src[i]);
+}
+
+static void scalar_f32_to_bf16(u16* dst, const f32* src, u64 n) {
+  for (u64 i = 0; i < n; ++i) dst[i] = ml_f32_to_bf16(src[i]);
+}
+
+// The accumulator tile is small enough to stay in registers and the
+// inner loop over NR is a straight vector multiply-add.
+static void scalar_gemm_4x8(u64 kc, const f32* restrict a,
+                            const f32* restrict b,
+                            f32* restrict c, u64 ldc, int accumulate) {
+  f32 ab[SCALAR_MR][SCALAR_NR] = {{0.0f}};
+
+  for (u64 p = 0; p < kc; ++p) {
+    for (u64 r = 0; r < SCALAR_MR; ++r) {
+      const f32 av = a[r];
+      for (u64 j = 0; j < SCALAR_NR; ++j) ab[r][j] += av * b[j];
+    }
+    a += SCALAR_MR;
+    b += SCALAR_NR;
+  }
+
+  if (accumulate) {
+    for (u64 r = 0; r < SCALAR_MR; ++r)
+      for (u64 j = 0; j < SCALAR_NR; ++j) c[r * ldc + j] += ab[r][j];
+  } else {
+    for (u64 r = 0; r < SCALAR_MR; ++r)
+      for (u64 j = 0; j < SCALAR_NR; ++j) c[r * ldc + j] = ab[r][j];
+  }
+}
+
+const ML_SimdKernels ml_simd_scalar_kernels = {
+  .id = ML_BACKEND_SCALAR,
+  .fill = scalar_fill,
+  .copy = scalar_copy,
+  .scale = scalar_scale,
+  .add_scalar = scalar_add_scalar,
+  .add = scalar_add,
+  .axpy = scalar_axpy,
+  .max = scalar_max,
+  .sum = scalar_sum,
+  .dot = scalar_dot,
+  .dot_i8 = scalar_dot_i8,
+  .exp = scalar_exp,
+  .log = scalar_log,
+  .act = scalar_act,
+  .act_grad = scalar_act_grad,
+  .f16_to_f32 = ml_f16_to_f32_ref,
+  .f32_to_f16 = ml_f32_to_f16_ref,
+  .bf16_to_f32 = scalar_bf16_to_f32,
+  .f32_to_bf16 = scalar_f32_to_bf16,
+  .gemm_kernel = scalar_gemm_4x8,
+  .gemm_mr = SCALAR_MR,
+  .gemm_nr = SCALAR_NR,
+};
@@ -0,0 +1,1495 @@
+#include "ml_simd.h"
+#include "ml_math.h"
+#include "ml_half_conv.h"
+
+#if defined(ML_SIMD_X86)
+
+#include <immintrin.h>
+#include <math.h>
+
+/*
+ * x86 backends. Each function is compiled for its own ISA through a
+ * target attribute, so the library itself builds for the baseline and
+ * ml_simd.c only installs a table after the CPU reported support.
+ */
+
+#define SSE2_FN   __attribute__((target("sse2")))
+#define AVX2_FN   __attribute__((target("avx2,fma,f16c")))
+#define AVX512_FN __attribute__((target("avx512f")))
+
+#define SSE2_MR 6
+#define SSE2_NR 8
+#define AVX2_MR 6
+#define AVX2_NR 16
+#define AVX512_MR 12
+#define AVX512_NR 32
+
+/* ========================================================================== */
+/* SSE2                                                                        */
+/* ========================================================================== */
+
+SSE2_FN static f32 sse2_hsum(__m128 v) {
+  __m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 0x55));
+  return _mm_cvtss_f32(s);
+}
+
+SSE2_FN static f32 sse2_hmax(__m128 v) {
+  __m128 m = _mm_max_ps(v, _mm_movehl_ps(v, v));
+  m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 0x55));
+  return _mm_cvtss_f32(m);
+}
+
+SSE2_FN static void sse2_fill(f32* dst, u64 n, f32 v) {
+  const __m128 vv = _mm_set1_ps(v);
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4) _mm_storeu_ps(dst + i, vv);
+  for (; i < n; ++i) dst[i] = v;
+}
+
+SSE2_FN static void sse2_copy(f32* dst, const f32* src, u64 n) {
+  if (dst == src) return;
+  if (dst > src && dst < src + n) {
+    // Overlapping forward copy: go backwards
+    for (u64 i = n; i-- > 0;) dst[i] = src[i];
+    return;
+  }
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4) _mm_storeu_ps(dst + i, _mm_loadu_ps(src + i));
+  for (; i < n; ++i) dst[i] = src[i];
+}
+
+SSE2_FN static void sse2_scale(f32* x, u64 n, f32 s) {
+  const __m128 vs = _mm_set1_ps(s);
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(x + i, _mm_mul_ps(_mm_loadu_ps(x + i), vs));
+  for (; i < n; ++i) x[i] *= s;
+}
+
+SSE2_FN static void sse2_add_scalar(f32* x, u64 n, f32 s) {
+  const __m128 vs = _mm_set1_ps(s);
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), vs));
+  for (; i < n; ++i) x[i] += s;
+}
+
+SSE2_FN static void sse2_add(f32* y, const f32* x, u64 n) {
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_loadu_ps(x + i)));
+  for (; i < n; ++i) y[i] += x[i];
+}
+
+SSE2_FN static void sse2_axpy(f32* y, const f32* x, u64 n, f32 a) {
+  const __m128 va = _mm_set1_ps(a);
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 p = _mm_mul_ps(va, _mm_loadu_ps(x + i));
+    _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), p));
+  }
+  for (; i < n; ++i) y[i] += a * x[i];
+}
+
+SSE2_FN static f32 sse2_max(const f32* x, u64 n) {
+  f32 m = x[0];
+  u64 i = 0;
+  if (n >= 4) {
+    __m128 vm = _mm_loadu_ps(x);
+    for (i = 4; i + 4 <= n; i += 4) vm = _mm_max_ps(vm, _mm_loadu_ps(x + i));
+    m = sse2_hmax(vm);
+  }
+  for (; i < n; ++i)
+    if (x[i] > m) m = x[i];
+  return m;
+}
+
+SSE2_FN static f32 sse2_sum(const f32* x, u64 n) {
+  __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    s0 = _mm_add_ps(s0, _mm_loadu_ps(x + i));
+    s1 = _mm_add_ps(s1, _mm_loadu_ps(x + i + 4));
+  }
+  for (; i + 4 <= n; i += 4) s0 = _mm_add_ps(s0, _mm_loadu_ps(x + i));
+  f32 s = sse2_hsum(_mm_add_ps(s0, s1));
+  for (; i < n; ++i) s += x[i];
+  return s;
+}
+
+SSE2_FN static f32 sse2_dot(const f32* x, const f32* y, u64 n) {
+  __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+    s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(y + i + 4)));
+  }
+  for (; i + 4 <= n; i += 4)
+    s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+  f32 s = sse2_hsum(_mm_add_ps(s0, s1));
+  for (; i < n; ++i) s += x[i] * y[i];
+  return s;
+}
+
+SSE2_FN static i32 sse2_hsum_epi32(__m128i v) {
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0x4e));
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0xb1));
+  return _mm_cvtsi128_si32(v);
+}
+
+// Sign-extend 16 int8 to two int16 halves and multiply-add pairs into int32
+SSE2_FN static i32 sse2_dot_i8(const i8* x, const i8* y, u64 n) {
+  __m128i acc = _mm_setzero_si128();
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i vx = _mm_loadu_si128((const __m128i*)(x + i));
+    const __m128i vy = _mm_loadu_si128((const __m128i*)(y + i));
+    const __m128i xl = _mm_srai_epi16(_mm_unpacklo_epi8(vx, vx), 8);
+    const __m128i xh = _mm_srai_epi16(_mm_unpackhi_epi8(vx, vx), 8);
+    const __m128i yl = _mm_srai_epi16(_mm_unpacklo_epi8(vy, vy), 8);
+    const __m128i yh = _mm_srai_epi16(_mm_unpackhi_epi8(vy, vy), 8);
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(xl, yl));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(xh, yh));
+  }
+  i32 s = sse2_hsum_epi32(acc);
+  for (; i < n; ++i) s += (i32)x[i] * (i32)y[i];
+  return s;
+}
+
+SSE2_FN static inline __m128 sse2_select(__m128 mask, __m128 a, __m128 b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// See ml_math.h for the algorithm; SSE2 has no FMA or blend
+SSE2_FN static inline __m128 sse2_exp_ps(__m128 x, int fastest) {
+  const __m128 hi = _mm_set1_ps(ML_EXP_HI);
+  const __m128 lo = _mm_set1_ps(ML_EXP_LO);
+  const __m128 xc = _mm_min_ps(_mm_max_ps(x, lo), hi);
+
+  const __m128i ni = _mm_cvtps_epi32(_mm_mul_ps(xc, _mm_set1_ps(ML_LOG2E)));
+  const __m128 n = _mm_cvtepi32_ps(ni);
+  __m128 r = _mm_sub_ps(xc, _mm_mul_ps(n, _mm_set1_ps(ML_LN2_HI)));
+  r = _mm_sub_ps(r, _mm_mul_ps(n, _mm_set1_ps(ML_LN2_LO)));
+
+  __m128 q;
+  if (fastest) {
+    q = _mm_set1_ps(ML_EXP_X_Q2);
+    q = _mm_add_ps(_mm_mul_ps(q, r), _mm_set1_ps(ML_EXP_X_Q1));
+    q = _mm_add_ps(_mm_mul_ps(q, r), _mm_set1_ps(ML_EXP_X_Q0));
+  } else {
+    q = _mm_set1_ps(ML_EXP_F_Q5);
+    q = _mm_add_ps(_mm_mul_ps(q, r), _mm_set1_ps(ML_EXP_F_Q4));
+    q = _mm_add_ps(_mm_mul_ps(q, r), _mm_set1_ps(ML_EXP_F_Q3));
+    q = _mm_add_ps(_mm_mul_ps(q, r), _mm_set1_ps(ML_EXP_F_Q2));
+    q = _mm_add_ps(_mm_mul_ps(q, r), _mm_set1_ps(ML_EXP_F_Q1));
+    q = _mm_add_ps(_mm_mul_ps(q, r), _mm_set1_ps(ML_EXP_F_Q0));
+  }
+  __m128 p = _mm_add_ps(_mm_mul_ps(q, _mm_mul_ps(r, r)), r);
+  p = _mm_add_ps(p, _mm_set1_ps(1.0f));
+
+  const __m128i bias = _mm_set1_epi32(127);
+  const __m128i n1 = _mm_srai_epi32(ni, 1);
+  const __m128i n2 = _mm_sub_epi32(ni, n1);
+  p = _mm_mul_ps(p, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n1, bias), 23)));
+  p = _mm_mul_ps(p, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n2, bias), 23)));
+
+  p = sse2_select(_mm_cmpgt_ps(x, hi), _mm_set1_ps(INFINITY), p);
+  p = _mm_andnot_ps(_mm_cmplt_ps(x, lo), p);
+  return sse2_select(_mm_cmpunord_ps(x, x), _mm_add_ps(x, x), p);
+}
+
+SSE2_FN static inline __m128 sse2_log_ps(__m128 x, int fastest) {
+  // Renormalise subnormals first
+  const __m128 sub = _mm_cmplt_ps(x, _mm_set1_ps(1.17549435e-38f));
+  const __m128 xs = sse2_select(sub, _mm_mul_ps(x, _mm_set1_ps(8388608.0f)), x);
+  const __m128i bits = _mm_castps_si128(xs);
+
+  __m128i e = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126));
+  e = _mm_sub_epi32(e, _mm_and_si128(_mm_castps_si128(sub), _mm_set1_epi32(23)));
+  __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)),
+                                           _mm_set1_epi32(0x3f000000)));
+  const __m128 small = _mm_cmplt_ps(m, _mm_set1_ps(ML_SQRTHF));
+  m = _mm_add_ps(m, _mm_and_ps(small, m));
+  e = _mm_add_epi32(e, _mm_castps_si128(small));
+
+  const __m128 f = _mm_sub_ps(m, _mm_set1_ps(1.0f));
+  const __m128 z = _mm_mul_ps(f, f);
+
+  __m128 rr;
+  if (fastest) {
+    rr = _mm_set1_ps(ML_LOG_X_R3);
+    rr = _mm_add_ps(_mm_mul_ps(rr, f), _mm_set1_ps(ML_LOG_X_R2));
+    rr = _mm_add_ps(_mm_mul_ps(rr, f), _mm_set1_ps(ML_LOG_X_R1));
+    rr = _mm_add_ps(_mm_mul_ps(rr, f), _mm_set1_ps(ML_LOG_X_R0));
+  } else {
+    rr = _mm_set1_ps(ML_LOG_F_R8);
+    rr = _mm_add_ps(_mm_mul_ps(rr, f), _mm_set1_ps(ML_LOG_F_R7));
+    rr = _mm_add_ps(_mm_mul_ps(rr, f), _mm_set1_ps(ML_LOG_F_R6));
+    rr = _mm_add_ps(_mm_mul_ps(rr, f), _mm_set1_ps(ML_LOG_F_R5));
+    rr = _mm_add_ps(_mm_mul_ps(rr, f), _mm_set1_ps(ML_LOG_F_R4));
+    rr = _mm_add_ps(_mm_mul_ps(rr, f), _mm_set1_ps(ML_LOG_F_R3));
+    rr = _mm_add_ps(_mm_mul_ps(rr, f), _mm_set1_ps(ML_LOG_F_R2));
+    rr = _mm_add_ps(_mm_mul_ps(rr, f), _mm_set1_ps(ML_LOG_F_R1));
+    rr = _mm_add_ps(_mm_mul_ps(rr, f), _mm_set1_ps(ML_LOG_F_R0));
+  }
+
+  const __m128 fe = _mm_cvtepi32_ps(e);
+  __m128 y = _mm_mul_ps(_mm_mul_ps(rr, f), z);
+  y = _mm_add_ps(y, _mm_mul_ps(fe, _mm_set1_ps(ML_LN2_LO)));
+  y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+  y = _mm_add_ps(_mm_add_ps(f, y), _mm_mul_ps(fe, _mm_set1_ps(ML_LN2_HI)));
+
+  // x < 0 or NaN -> NaN, 0 -> -inf, +inf -> +inf
+  const __m128 zero = _mm_setzero_ps();
+  y = sse2_select(_mm_cmpeq_ps(x, zero), _mm_set1_ps(-INFINITY), y);
+  y = sse2_select(_mm_cmpeq_ps(x, _mm_set1_ps(INFINITY)), x, y);
+  y = sse2_select(_mm_cmplt_ps(x, zero), _mm_set1_ps(NAN), y);
+  return sse2_select(_mm_cmpunord_ps(x, x), _mm_add_ps(x, x), y);
+}
+
+SSE2_FN static inline void sse2_exp_run(f32* x, u64 n, int fastest) {
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(x + i, sse2_exp_ps(_mm_loadu_ps(x + i), fastest));
+  for (; i < n; ++i) x[i] = ml_expf_approx(x[i], fastest);
+}
+
+SSE2_FN static inline void sse2_log_run(f32* x, u64 n, int fastest) {
+  u64 i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(x + i, sse2_log_ps(_mm_loadu_ps(x + i), fastest));
+  for (; i < n; ++i) x[i] = ml_logf_approx(x[i], fastest);
+}
+
+SSE2_FN static void sse2_exp(f32* x, u64 n) {
+  switch (ml_math_accuracy) {
+   case ML_MATH_FAST:    sse2_exp_run(x, n, 0); break;
+   case ML_MATH_FASTEST: sse2_exp_run(x, n, 1); break;
+   default:              ml_exp_libm(x, n); break;
+  }
+}
+
+SSE2_FN static void sse2_log(f32* x, u64 n) {
+  switch (ml_math_accuracy) {
+   case ML_MATH_FAST:    sse2_log_run(x, n, 0); break;
+   case ML_MATH_FASTEST: sse2_log_run(x, n, 1); break;
+   default:              ml_log_libm(x, n); break;
+  }
+}
+
+SSE2_FN static inline __m128 sse2_sigmoid_ps(__m128 x, int fastest) {
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 e = sse2_exp_ps(_mm_sub_ps(_mm_setzero_ps(), x), fastest);
+  return _mm_div_ps(one, _mm_add_ps(one, e));
+}
+
+// See ml_tanhf_approx. min/max return their second operand when either is
+// NaN, so with x last a NaN passes through the clamp
+SSE2_FN static inline __m128 sse2_tanh_ps(__m128 x, int fastest) {
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 c = _mm_set1_ps(ML_TANH_CLAMP);
+  const __m128 v = _mm_min_ps(c, _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), c), x));
+  const __m128 e = sse2_exp_ps(_mm_mul_ps(v, _mm_set1_ps(-2.0f)), fastest);
+  return _mm_div_ps(_mm_sub_ps(one, e), _mm_add_ps(one, e));
+}
+
+// tanh(K x (1 + C x^2)), the inner term of GELU and its derivative
+SSE2_FN static inline __m128 sse2_gelu_t_ps(__m128 x, __m128 x2, int fastest) {
+  const __m128 p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(ML_GELU_C), x2));
+  return sse2_tanh_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(ML_GELU_K), x), p), fastest);
+}
+
+SSE2_FN static inline __m128 sse2_gelu_ps(__m128 x, int fastest) {
+  const __m128 t = sse2_gelu_t_ps(x, _mm_mul_ps(x, x), fastest);
+  return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), _mm_add_ps(_mm_set1_ps(1.0f), t));
+}
+
+SSE2_FN static inline __m128 sse2_gelu_grad_ps(__m128 x, int fastest) {
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 x2 = _mm_mul_ps(x, x);
+  const __m128 t = sse2_gelu_t_ps(x, x2, fastest);
+  const __m128 du = _mm_mul_ps(_mm_set1_ps(ML_GELU_K),
+                               _mm_add_ps(one, _mm_mul_ps(_mm_set1_ps(3.0f * ML_GELU_C), x2)));
+  const __m128 s = _mm_mul_ps(_mm_mul_ps(half, x), _mm_sub_ps(one, _mm_mul_ps(t, t)));
+  return _mm_add_ps(_mm_mul_ps(half, _mm_add_ps(one, t)), _mm_mul_ps(s, du));
+}
+
+// y[i] = VEC over xv = x[i..i+4), SCAL for the remainder
+#define SSE2_ACT_LOOP(VEC, SCAL)                                       \
+  for (; i + 4 <= n; i += 4) {                                         \
+    const __m128 xv = _mm_loadu_ps(x + i);                             \
+    _mm_storeu_ps(y + i, VEC);                                         \
+  }                                                                    \
+  for (; i < n; ++i) y[i] = SCAL
+
+// dx[i] = VEC over gv = dy[i..i+4) and vv = v[i..i+4), SCAL for the remainder
+#define SSE2_GRAD_LOOP(VEC, SCAL)                                      \
+  for (; i + 4 <= n; i += 4) {                                         \
+    const __m128 gv = _mm_loadu_ps(dy + i);                            \
+    const __m128 vv = _mm_loadu_ps(v + i);                             \
+    _mm_storeu_ps(dx + i, VEC);                                        \
+  }                                                                    \
+  for (; i < n; ++i) dx[i] = SCAL
+
+SSE2_FN static void sse2_act(f32* y, const f32* x, u64 n, ML_Activation act, f32 alpha) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 a = _mm_set1_ps(alpha);
+  const int fastest = ml_math_accuracy == ML_MATH_FASTEST;
+  u64 i = 0;
+
+  if (ml_math_accuracy == ML_MATH_EXACT && act != ML_ACT_RELU && act != ML_ACT_LEAKY_RELU) {
+    ml_act_libm(y, x, n, act, alpha);
+    return;
+  }
+  switch (act) {
+   case ML_ACT_RELU:
+     SSE2_ACT_LOOP(_mm_max_ps(xv, zero), x[i] > 0.0f ? x[i] : 0.0f);
+     break;
+   case ML_ACT_LEAKY_RELU:
+     SSE2_ACT_LOOP(sse2_select(_mm_cmpgt_ps(xv, zero), xv, _mm_mul_ps(a, xv)),
+                   x[i] > 0.0f ? x[i] : alpha * x[i]);
+     break;
+   case ML_ACT_SIGMOID:
+     SSE2_ACT_LOOP(sse2_sigmoid_ps(xv, fastest), ml_sigmoidf_approx(x[i], fastest));
+     break;
+   case ML_ACT_TANH:
+     SSE2_ACT_LOOP(sse2_tanh_ps(xv, fastest), ml_tanhf_approx(x[i], fastest));
+     break;
+   case ML_ACT_GELU:
+     SSE2_ACT_LOOP(sse2_gelu_ps(xv, fastest), ml_geluf_approx(x[i], fastest));
+     break;
+   default:
+     ml_act_libm(y, x, n, act, alpha);
+     break;
+  }
+}
+
+SSE2_FN static void sse2_act_grad(f32* dx, const f32* dy, const f32* v, u64 n,
+                                  ML_Activation act, f32 alpha) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 a = _mm_set1_ps(alpha);
+  const int fastest = ml_math_accuracy == ML_MATH_FASTEST;
+  u64 i = 0;
+
+  switch (act) {
+   case ML_ACT_RELU:
+     SSE2_GRAD_LOOP(_mm_and_ps(_mm_cmpgt_ps(vv, zero), gv), v[i] > 0.0f ? dy[i] : 0.0f);
+     break;
+   case ML_ACT_LEAKY_RELU:
+     SSE2_GRAD_LOOP(sse2_select(_mm_cmpgt_ps(vv, zero), gv, _mm_mul_ps(a, gv)),
+                    v[i] > 0.0f ? dy[i] : alpha * dy[i]);
+     break;
+   case ML_ACT_SIGMOID:
+     SSE2_GRAD_LOOP(_mm_mul_ps(_mm_mul_ps(gv, vv), _mm_sub_ps(one, vv)),
+                    dy[i] * v[i] * (1.0f - v[i]));
+     break;
+   case ML_ACT_TANH:
+     SSE2_GRAD_LOOP(_mm_mul_ps(gv, _mm_sub_ps(one, _mm_mul_ps(vv, vv))),
+                    dy[i] * (1.0f - v[i] * v[i]));
+     break;
+   case ML_ACT_GELU:
+     if (ml_math_accuracy == ML_MATH_EXACT) {
+       ml_act_grad_libm(dx, dy, v, n, act, alpha);
+       break;
+     }
+     SSE2_GRAD_LOOP(_mm_mul_ps(gv, sse2_gelu_grad_ps(vv, fastest)),
+                    dy[i] * ml_gelu_gradf_approx(v[i], fastest));
+     break;
+   default:
+     ml_act_grad_libm(dx, dy, v, n, act, alpha);
+     break;
+  }
+}
+
+#undef SSE2_ACT_LOOP
+#undef SSE2_GRAD_LOOP
+
+SSE2_FN static void sse2_bf16_to_f32(f32* dst, const u16* src, u64 n) {
+  const __m128i zero = _mm_setzero_si128();
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i h = _mm_loadu_si128((const __m128i*)(src + i));
+    // bf16 is the top half of an f32: interleave zeros below it
+    _mm_storeu_ps(dst + i, _mm_castsi128_ps(_mm_unpacklo_epi16(zero, h)));
+    _mm_storeu_ps(dst + i + 4, _mm_castsi128_ps(_mm_unpackhi_epi16(zero, h)));
+  }
+  for (; i < n; ++i) dst[i] = ml_bf16_to_f32(src[i]);
+}
+
+// Round 4 floats to bf16 (nearest even, NaN kept quiet), returned
+// sign-extended in 32-bit lanes so packs_epi32 narrows them exactly
+SSE2_FN static __m128i sse2_round_bf16(__m128 v) {
+  const __m128i x = _mm_castps_si128(v);
+  const __m128i ax = _mm_and_si128(x, _mm_set1_epi32(0x7fffffff));
+  const __m128i nan = _mm_cmpgt_epi32(ax, _mm_set1_epi32(0x7f800000));
+
+  const __m128i odd = _mm_and_si128(_mm_srli_epi32(x, 16), _mm_set1_epi32(1));
+  __m128i r = _mm_add_epi32(x, _mm_add_epi32(odd, _mm_set1_epi32(0x7fff)));
+  __m128i q = _mm_or_si128(x, _mm_set1_epi32(0x400000));
+
+  r = _mm_or_si128(_mm_and_si128(nan, q), _mm_andnot_si128(nan, r));
+  return _mm_srai_epi32(r, 16);
+}
+
+SSE2_FN static void sse2_f32_to_bf16(u16* dst, const f32* src, u64 n) {
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i lo = sse2_round_bf16(_mm_loadu_ps(src + i));
+    const __m128i hi = sse2_round_bf16(_mm_loadu_ps(src + i + 4));
+    _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(lo, hi));
+  }
+  for (; i < n; ++i) dst[i] = ml_f32_to_bf16(src[i]);
+}
+
+SSE2_FN static void sse2_gemm_6x8(u64 kc, const f32* a, const f32* b,
+                                  f32* c, u64 ldc, int accumulate) {
+  __m128 c00 = _mm_setzero_ps(), c01 = _mm_setzero_ps();
+  __m128 c10 = _mm_setzero_ps(), c11 = _mm_setzero_ps();
+  __m128 c20 = _mm_setzero_ps(), c21 = _mm_setzero_ps();
+  __m128 c30 = _mm_setzero_ps(), c31 = _mm_setzero_ps();
+  __m128 c40 = _mm_setzero_ps(), c41 = _mm_setzero_ps();
+  __m128 c50 = _mm_setzero_ps(), c51 = _mm_setzero_ps();
+
+  for (u64 p = 0; p < kc; ++p) {
+    const __m128 b0 = _mm_load_ps(b);
+    const __m128 b1 = _mm_load_ps(b + 4);
+    __m128 av;
+
+    av = _mm_set1_ps(a[0]);
+    c00 = _mm_add_ps(c00, _mm_mul_ps(av, b0)); c01 = _mm_add_ps(c01, _mm_mul_ps(av, b1));
+    av = _mm_set1_ps(a[1]);
+    c10 = _mm_add_ps(c10, _mm_mul_ps(av, b0)); c11 = _mm_add_ps(c11, _mm_mul_ps(av, b1));
+    av = _mm_set1_ps(a[2]);
+    c20 = _mm_add_ps(c20, _mm_mul_ps(av, b0)); c21 = _mm_add_ps(c21, _mm_mul_ps(av, b1));
+    av = _mm_set1_ps(a[3]);
+    c30 = _mm_add_ps(c30, _mm_mul_ps(av, b0)); c31 = _mm_add_ps(c31, _mm_mul_ps(av, b1));
+    av = _mm_set1_ps(a[4]);
+    c40 = _mm_add_ps(c40, _mm_mul_ps(av, b0)); c41 = _mm_add_ps(c41, _mm_mul_ps(av, b1));
+    av = _mm_set1_ps(a[5]);
+    c50 = _mm_add_ps(c50, _mm_mul_ps(av, b0)); c51 = _mm_add_ps(c51, _mm_mul_ps(av, b1));
+
+    a += SSE2_MR;
+    b += SSE2_NR;
+  }
+
+#define SSE2_STORE_ROW(r, v0, v1)                                        \
+  do {                                                                   \
+    f32* cr = c + (r) * ldc;                                             \
+    if (accumulate) {                                                    \
+      v0 = _mm_add_ps(v0, _mm_loadu_ps(cr));                             \
+      v1 = _mm_add_ps(v1, _mm_loadu_ps(cr + 4));                         \
+    }                                                                    \
+    _mm_storeu_ps(cr, v0);                                               \
+    _mm_storeu_ps(cr + 4, v1);                                           \
+  } while (0)
+
+  SSE2_STORE_ROW(0, c00, c01);
+  SSE2_STORE_ROW(1, c10, c11);
+  SSE2_STORE_ROW(2, c20, c21);
+  SSE2_STORE_ROW(3, c30, c31);
+  SSE2_STORE_ROW(4, c40, c41);
+  SSE2_STORE_ROW(5, c50, c51);
+#undef SSE2_STORE_ROW
+}
+
+const ML_SimdKernels ml_simd_sse2_kernels = {
+  .id = ML_BACKEND_SSE2,
+  .fill = sse2_fill,
+  .copy = sse2_copy,
+  .scale = sse2_scale,
+  .add_scalar = sse2_add_scalar,
+  .add = sse2_add,
+  .axpy = sse2_axpy,
+  .max = sse2_max,
+  .sum = sse2_sum,
+  .dot = sse2_dot,
+  .dot_i8 = sse2_dot_i8,
+  .exp = sse2_exp,
+  .log = sse2_log,
+  .act = sse2_act,
+  .act_grad = sse2_act_grad,
+  // No half conversion instructions before F16C
+  .f16_to_f32 = ml_f16_to_f32_ref,
+  .f32_to_f16 = ml_f32_to_f16_ref,
+  .bf16_to_f32 = sse2_bf16_to_f32,
+  .f32_to_bf16 = sse2_f32_to_bf16,
+  .gemm_kernel = sse2_gemm_6x8,
+  .gemm_mr = SSE2_MR,
+  .gemm_nr = SSE2_NR,
+};
+
+/* ========================================================================== */
+/* AVX2 + FMA + F16C                                                           */
+/* ========================================================================== */
+
+AVX2_FN static f32 avx2_hsum(__m256 v) {
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 0x55));
+  return _mm_cvtss_f32(s);
+}
+
+AVX2_FN static f32 avx2_hmax(__m256 v) {
+  __m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+  m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 0x55));
+  return _mm_cvtss_f32(m);
+}
+
+AVX2_FN static void avx2_fill(f32* dst, u64 n, f32 v) {
+  const __m256 vv = _mm256_set1_ps(v);
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8) _mm256_storeu_ps(dst + i, vv);
+  for (; i < n; ++i) dst[i] = v;
+}
+
+AVX2_FN static void avx2_copy(f32* dst, const f32* src, u64 n) {
+  if (dst == src) return;
+  if (dst > src && dst < src + n) {
+    for (u64 i = n; i-- > 0;) dst[i] = src[i];
+    return;
+  }
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8) _mm256_storeu_ps(dst + i, _mm256_loadu_ps(src + i));
+  for (; i < n; ++i) dst[i] = src[i];
+}
+
+AVX2_FN static void avx2_scale(f32* x, u64 n, f32 s) {
+  const __m256 vs = _mm256_set1_ps(s);
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(x + i, _mm256_mul_ps(_mm256_loadu_ps(x + i), vs));
+  for (; i < n; ++i) x[i] *= s;
+}
+
+AVX2_FN static void avx2_add_scalar(f32* x, u64 n, f32 s) {
+  const __m256 vs = _mm256_set1_ps(s);
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), vs));
+  for (; i < n; ++i) x[i] += s;
+}
+
+AVX2_FN static void avx2_add(f32* y, const f32* x, u64 n) {
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i),
+                                          _mm256_loadu_ps(x + i)));
+  for (; i < n; ++i) y[i] += x[i];
+}
+
+AVX2_FN static void avx2_axpy(f32* y, const f32* x, u64 n, f32 a) {
+  const __m256 va = _mm256_set1_ps(a);
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i),
+                                            _mm256_loadu_ps(y + i)));
+  for (; i < n; ++i) y[i] += a * x[i];
+}
+
+AVX2_FN static f32 avx2_max(const f32* x, u64 n) {
+  f32 m = x[0];
+  u64 i = 0;
+  if (n >= 8) {
+    __m256 vm = _mm256_loadu_ps(x);
+    for (i = 8; i + 8 <= n; i += 8) vm = _mm256_max_ps(vm, _mm256_loadu_ps(x + i));
+    m = avx2_hmax(vm);
+  }
+  for (; i < n; ++i)
+    if (x[i] > m) m = x[i];
+  return m;
+}
+
+AVX2_FN static f32 avx2_sum(const f32* x, u64 n) {
+  __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16) {
+    s0 = _mm256_add_ps(s0, _mm256_loadu_ps(x + i));
+    s1 = _mm256_add_ps(s1, _mm256_loadu_ps(x + i + 8));
+  }
+  for (; i + 8 <= n; i += 8) s0 = _mm256_add_ps(s0, _mm256_loadu_ps(x + i));
+  f32 s = avx2_hsum(_mm256_add_ps(s0, s1));
+  for (; i < n; ++i) s += x[i];
+  return s;
+}
+
+AVX2_FN static f32 avx2_dot(const f32* x, const f32* y, u64 n) {
+  __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16) {
+    s0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), s0);
+    s1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8), s1);
+  }
+  for (; i + 8 <= n; i += 8)
+    s0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), s0);
+  f32 s = avx2_hsum(_mm256_add_ps(s0, s1));
+  for (; i < n; ++i) s += x[i] * y[i];
+  return s;
+}
+
+AVX2_FN static i32 avx2_dot_i8(const i8* x, const i8* y, u64 n) {
+  __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+  u64 i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i x0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(x + i)));
+    const __m256i y0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(y + i)));
+    const __m256i x1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(x + i + 16)));
+    const __m256i y1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(y + i + 16)));
+    acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(x0, y0));
+    acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(x1, y1));
+  }
+  for (; i + 16 <= n; i += 16) {
+    const __m256i x0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(x + i)));
+    const __m256i y0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(y + i)));
+    acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(x0, y0));
+  }
+  const __m256i acc = _mm256_add_epi32(acc0, acc1);
+  __m128i v = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0x4e));
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0xb1));
+  i32 s = _mm_cvtsi128_si32(v);
+  for (; i < n; ++i) s += (i32)x[i] * (i32)y[i];
+  return s;
+}
+
+// See ml_math.h for the algorithm
+AVX2_FN static inline __m256 avx2_exp_ps(__m256 x, int fastest) {
+  const __m256 hi = _mm256_set1_ps(ML_EXP_HI);
+  const __m256 lo = _mm256_set1_ps(ML_EXP_LO);
+  const __m256 xc = _mm256_min_ps(_mm256_max_ps(x, lo), hi);
+
+  const __m256 n = _mm256_round_ps(_mm256_mul_ps(xc, _mm256_set1_ps(ML_LOG2E)),
+                                   _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(ML_LN2_HI), xc);
+  r = _mm256_fnmadd_ps(n, _mm256_set1_ps(ML_LN2_LO), r);
+
+  __m256 q;
+  if (fastest) {
+    q = _mm256_set1_ps(ML_EXP_X_Q2);
+    q = _mm256_fmadd_ps(q, r, _mm256_set1_ps(ML_EXP_X_Q1));
+    q = _mm256_fmadd_ps(q, r, _mm256_set1_ps(ML_EXP_X_Q0));
+  } else {
+    q = _mm256_set1_ps(ML_EXP_F_Q5);
+    q = _mm256_fmadd_ps(q, r, _mm256_set1_ps(ML_EXP_F_Q4));
+    q = _mm256_fmadd_ps(q, r, _mm256_set1_ps(ML_EXP_F_Q3));
+    q = _mm256_fmadd_ps(q, r, _mm256_set1_ps(ML_EXP_F_Q2));
+    q = _mm256_fmadd_ps(q, r, _mm256_set1_ps(ML_EXP_F_Q1));
+    q = _mm256_fmadd_ps(q, r, _mm256_set1_ps(ML_EXP_F_Q0));
+  }
+  __m256 p = _mm256_fmadd_ps(q, _mm256_mul_ps(r, r), r);
+  p = _mm256_add_ps(p, _mm256_set1_ps(1.0f));
+
+  const __m256i bias = _mm256_set1_epi32(127);
+  const __m256i ni = _mm256_cvtps_epi32(n);
+  const __m256i n1 = _mm256_srai_epi32(ni, 1);
+  const __m256i n2 = _mm256_sub_epi32(ni, n1);
+  p = _mm256_mul_ps(p, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n1, bias), 23)));
+  p = _mm256_mul_ps(p, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n2, bias), 23)));
+
+  p = _mm256_blendv_ps(p, _mm256_set1_ps(INFINITY), _mm256_cmp_ps(x, hi, _CMP_GT_OQ));
+  p = _mm256_blendv_ps(p, _mm256_setzero_ps(), _mm256_cmp_ps(x, lo, _CMP_LT_OQ));
+  return _mm256_blendv_ps(p, _mm256_add_ps(x, x), _mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+}
+
+AVX2_FN static inline __m256 avx2_log_ps(__m256 x, int fastest) {
+  const __m256 sub = _mm256_cmp_ps(x, _mm256_set1_ps(1.17549435e-38f), _CMP_LT_OQ);
+  const __m256 xs = _mm256_blendv_ps(x, _mm256_mul_ps(x, _mm256_set1_ps(8388608.0f)), sub);
+  const __m256i bits = _mm256_castps_si256(xs);
+
+  __m256i e = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126));
+  e = _mm256_sub_epi32(e, _mm256_and_si256(_mm256_castps_si256(sub), _mm256_set1_epi32(23)));
+  __m256 m = _mm256_castsi256_ps(
+      _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+                      _mm256_set1_epi32(0x3f000000)));
+  const __m256 small = _mm256_cmp_ps(m, _mm256_set1_ps(ML_SQRTHF), _CMP_LT_OQ);
+  m = _mm256_add_ps(m, _mm256_and_ps(small, m));
+  e = _mm256_add_epi32(e, _mm256_castps_si256(small));
+
+  const __m256 f = _mm256_sub_ps(m, _mm256_set1_ps(1.0f));
+  const __m256 z = _mm256_mul_ps(f, f);
+
+  __m256 rr;
+  if (fastest) {
+    rr = _mm256_set1_ps(ML_LOG_X_R3);
+    rr = _mm256_fmadd_ps(rr, f, _mm256_set1_ps(ML_LOG_X_R2));
+    rr = _mm256_fmadd_ps(rr, f, _mm256_set1_ps(ML_LOG_X_R1));
+    rr = _mm256_fmadd_ps(rr, f, _mm256_set1_ps(ML_LOG_X_R0));
+  } else {
+    rr = _mm256_set1_ps(ML_LOG_F_R8);
+    rr = _mm256_fmadd_ps(rr, f, _mm256_set1_ps(ML_LOG_F_R7));
+    rr = _mm256_fmadd_ps(rr, f, _mm256_set1_ps(ML_LOG_F_R6));
+    rr = _mm256_fmadd_ps(rr, f, _mm256_set1_ps(ML_LOG_F_R5));
+    rr = _mm256_fmadd_ps(rr, f, _mm256_set1_ps(ML_LOG_F_R4));
+    rr = _mm256_fmadd_ps(rr, f, _mm256_set1_ps(ML_LOG_F_R3));
+    rr = _mm256_fmadd_ps(rr, f, _mm256_set1_ps(ML_LOG_F_R2));
+    rr = _mm256_fmadd_ps(rr, f, _mm256_set1_ps(ML_LOG_F_R1));
+    rr = _mm256_fmadd_ps(rr, f, _mm256_set1_ps(ML_LOG_F_R0));
+  }
+
+  const __m256 fe = _mm256_cvtepi32_ps(e);
+  __m256 y = _mm256_mul_ps(_mm256_mul_ps(rr, f), z);
+  y = _mm256_fmadd_ps(fe, _mm256_set1_ps(ML_LN2_LO), y);
+  y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+  y = _mm256_fmadd_ps(fe, _mm256_set1_ps(ML_LN2_HI), _mm256_add_ps(f, y));
+
+  const __m256 zero = _mm256_setzero_ps();
+  y = _mm256_blendv_ps(y, _mm256_set1_ps(-INFINITY), _mm256_cmp_ps(x, zero, _CMP_EQ_OQ));
+  y = _mm256_blendv_ps(y, x, _mm256_cmp_ps(x, _mm256_set1_ps(INFINITY), _CMP_EQ_OQ));
+  y = _mm256_blendv_ps(y, _mm256_set1_ps(NAN), _mm256_cmp_ps(x, zero, _CMP_LT_OQ));
+  return _mm256_blendv_ps(y, _mm256_add_ps(x, x), _mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+}
+
+AVX2_FN static inline void avx2_exp_run(f32* x, u64 n, int fastest) {
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(x + i, avx2_exp_ps(_mm256_loadu_ps(x + i), fastest));
+  for (; i < n; ++i) x[i] = ml_expf_approx(x[i], fastest);
+}
+
+AVX2_FN static inline void avx2_log_run(f32* x, u64 n, int fastest) {
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(x + i, avx2_log_ps(_mm256_loadu_ps(x + i), fastest));
+  for (; i < n; ++i) x[i] = ml_logf_approx(x[i], fastest);
+}
+
+AVX2_FN static void avx2_exp(f32* x, u64 n) {
+  switch (ml_math_accuracy) {
+   case ML_MATH_FAST:    avx2_exp_run(x, n, 0); break;
+   case ML_MATH_FASTEST: avx2_exp_run(x, n, 1); break;
+   default:              ml_exp_libm(x, n); break;
+  }
+}
+
+AVX2_FN static void avx2_log(f32* x, u64 n) {
+  switch (ml_math_accuracy) {
+   case ML_MATH_FAST:    avx2_log_run(x, n, 0); break;
+   case ML_MATH_FASTEST: avx2_log_run(x, n, 1); break;
+   default:              ml_log_libm(x, n); break;
+  }
+}
+
+AVX2_FN static inline __m256 avx2_sigmoid_ps(__m256 x, int fastest) {
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 e = avx2_exp_ps(_mm256_sub_ps(_mm256_setzero_ps(), x), fastest);
+  return _mm256_div_ps(one, _mm256_add_ps(one, e));
+}
+
+// See ml_tanhf_approx. min/max return their second operand when either is
+// NaN, so with x last a NaN passes through the clamp
+AVX2_FN static inline __m256 avx2_tanh_ps(__m256 x, int fastest) {
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 c = _mm256_set1_ps(ML_TANH_CLAMP);
+  const __m256 v = _mm256_min_ps(c, _mm256_max_ps(_mm256_sub_ps(_mm256_setzero_ps(), c), x));
+  const __m256 e = avx2_exp_ps(_mm256_mul_ps(v, _mm256_set1_ps(-2.0f)), fastest);
+  return _mm256_div_ps(_mm256_sub_ps(one, e), _mm256_add_ps(one, e));
+}
+
+// tanh(K x (1 + C x^2)), the inner term of GELU and its derivative
+AVX2_FN static inline __m256 avx2_gelu_t_ps(__m256 x, __m256 x2, int fastest) {
+  const __m256 p = _mm256_fmadd_ps(_mm256_set1_ps(ML_GELU_C), x2, _mm256_set1_ps(1.0f));
+  return avx2_tanh_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(ML_GELU_K), x), p), fastest);
+}
+
+AVX2_FN static inline __m256 avx2_gelu_ps(__m256 x, int fastest) {
+  const __m256 t = avx2_gelu_t_ps(x, _mm256_mul_ps(x, x), fastest);
+  return _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), x), _mm256_add_ps(_mm256_set1_ps(1.0f), t));
+}
+
+AVX2_FN static inline __m256 avx2_gelu_grad_ps(__m256 x, int fastest) {
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 x2 = _mm256_mul_ps(x, x);
+  const __m256 t = avx2_gelu_t_ps(x, x2, fastest);
+  const __m256 du = _mm256_mul_ps(_mm256_set1_ps(ML_GELU_K),
+                                  _mm256_fmadd_ps(_mm256_set1_ps(3.0f * ML_GELU_C), x2, one));
+  const __m256 s = _mm256_mul_ps(_mm256_mul_ps(half, x), _mm256_fnmadd_ps(t, t, one));
+  return _mm256_fmadd_ps(s, du, _mm256_mul_ps(half, _mm256_add_ps(one, t)));
+}
+
+// y[i] = VEC over xv = x[i..i+8), SCAL for the remainder
+#define AVX2_ACT_LOOP(VEC, SCAL)                                       \
+  for (; i + 8 <= n; i += 8) {                                         \
+    const __m256 xv = _mm256_loadu_ps(x + i);                             \
+    _mm256_storeu_ps(y + i, VEC);                                         \
+  }                                                                    \
+  for (; i < n; ++i) y[i] = SCAL
+
+// dx[i] = VEC over gv = dy[i..i+8) and vv = v[i..i+8), SCAL for the remainder
+#define AVX2_GRAD_LOOP(VEC, SCAL)                                      \
+  for (; i + 8 <= n; i += 8) {                                         \
+    const __m256 gv = _mm256_loadu_ps(dy + i);                            \
+    const __m256 vv = _mm256_loadu_ps(v + i);                             \
+    _mm256_storeu_ps(dx + i, VEC);                                        \
+  }                                                                    \
+  for (; i < n; ++i) dx[i] = SCAL
+
+AVX2_FN static void avx2_act(f32* y, const f32* x, u64 n, ML_Activation act, f32 alpha) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 a = _mm256_set1_ps(alpha);
+  const int fastest = ml_math_accuracy == ML_MATH_FASTEST;
+  u64 i = 0;
+
+  if (ml_math_accuracy == ML_MATH_EXACT && act != ML_ACT_RELU && act != ML_ACT_LEAKY_RELU) {
+    ml_act_libm(y, x, n, act, alpha);
+    return;
+  }
+  switch (act) {
+   case ML_ACT_RELU:
+     AVX2_ACT_LOOP(_mm256_max_ps(xv, zero), x[i] > 0.0f ? x[i] : 0.0f);
+     break;
+   case ML_ACT_LEAKY_RELU:
+     AVX2_ACT_LOOP(_mm256_blendv_ps(_mm256_mul_ps(a, xv), xv, _mm256_cmp_ps(xv, zero, _CMP_GT_OQ)),
+                   x[i] > 0.0f ? x[i] : alpha * x[i]);
+     break;
+   case ML_ACT_SIGMOID:
+     AVX2_ACT_LOOP(avx2_sigmoid_ps(xv, fastest), ml_sigmoidf_approx(x[i], fastest));
+     break;
+   case ML_ACT_TANH:
+     AVX2_ACT_LOOP(avx2_tanh_ps(xv, fastest), ml_tanhf_approx(x[i], fastest));
+     break;
+   case ML_ACT_GELU:
+     AVX2_ACT_LOOP(avx2_gelu_ps(xv, fastest), ml_geluf_approx(x[i], fastest));
+     break;
+   default:
+     ml_act_libm(y, x, n, act, alpha);
+     break;
+  }
+}
+
+AVX2_FN static void avx2_act_grad(f32* dx, const f32* dy, const f32* v, u64 n,
+                                  ML_Activation act, f32 alpha) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 a = _mm256_set1_ps(alpha);
+  const int fastest = ml_math_accuracy == ML_MATH_FASTEST;
+  u64 i = 0;
+
+  switch (act) {
+   case ML_ACT_RELU:
+     AVX2_GRAD_LOOP(_mm256_and_ps(_mm256_cmp_ps(vv, zero, _CMP_GT_OQ), gv), v[i] > 0.0f ? dy[i] : 0.0f);
+     break;
+   case ML_ACT_LEAKY_RELU:
+     AVX2_GRAD_LOOP(_mm256_blendv_ps(_mm256_mul_ps(a, gv), gv, _mm256_cmp_ps(vv, zero, _CMP_GT_OQ)),
+                    v[i] > 0.0f ? dy[i] : alpha * dy[i]);
+     break;
+   case ML_ACT_SIGMOID:
+     AVX2_GRAD_LOOP(_mm256_mul_ps(_mm256_mul_ps(gv, vv), _mm256_sub_ps(one, vv)),
+                    dy[i] * v[i] * (1.0f - v[i]));
+     break;
+   case ML_ACT_TANH:
+     AVX2_GRAD_LOOP(_mm256_mul_ps(gv, _mm256_fnmadd_ps(vv, vv, one)),
+                    dy[i] * (1.0f - v[i] * v[i]));
+     break;
+   case ML_ACT_GELU:
+     if (ml_math_accuracy == ML_MATH_EXACT) {
+       ml_act_grad_libm(dx, dy, v, n, act, alpha);
+       break;
+     }
+     AVX2_GRAD_LOOP(_mm256_mul_ps(gv, avx2_gelu_grad_ps(vv, fastest)),
+                    dy[i] * ml_gelu_gradf_approx(v[i], fastest));
+     break;
+   default:
+     ml_act_grad_libm(dx, dy, v, n, act, alpha);
+     break;
+  }
+}
+
+#undef AVX2_ACT_LOOP
+#undef AVX2_GRAD_LOOP
+
+AVX2_FN static void avx2_f16_to_f32(f32* dst, const u16* src, u64 n) {
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i))));
+  for (; i < n; ++i) dst[i] = ml_f16_to_f32(src[i]);
+}
+
+AVX2_FN static void avx2_f32_to_f16(u16* dst, const f32* src, u64 n) {
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm_storeu_si128((__m128i*)(dst + i),
+                     _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+  for (; i < n; ++i) dst[i] = ml_f32_to_f16(src[i]);
+}
+
+AVX2_FN static void avx2_bf16_to_f32(f32* dst, const u16* src, u64 n) {
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i h = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src + i)));
+    _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(_mm256_slli_epi32(h, 16)));
+  }
+  for (; i < n; ++i) dst[i] = ml_bf16_to_f32(src[i]);
+}
+
+AVX2_FN static void avx2_f32_to_bf16(u16* dst, const f32* src, u64 n) {
+  const __m256i abs_mask = _mm256_set1_epi32(0x7fffffff);
+  const __m256i inf = _mm256_set1_epi32(0x7f800000);
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i bias = _mm256_set1_epi32(0x7fff);
+  const __m256i quiet = _mm256_set1_epi32(0x400000);
+  u64 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i x = _mm256_castps_si256(_mm256_loadu_ps(src + i));
+    const __m256i nan = _mm256_cmpgt_epi32(_mm256_and_si256(x, abs_mask), inf);
+    const __m256i odd = _mm256_and_si256(_mm256_srli_epi32(x, 16), one);
+    __m256i r = _mm256_add_epi32(x, _mm256_add_epi32(odd, bias));
+    r = _mm256_blendv_epi8(r, _mm256_or_si256(x, quiet), nan);
+    r = _mm256_srai_epi32(r, 16);
+    // packs works per 128-bit lane; gather the two low quarters
+    r = _mm256_permute4x64_epi64(_mm256_packs_epi32(r, r), 0x08);
+    _mm_storeu_si128((__m128i*)(dst + i), _mm256_castsi256_si128(r));
+  }
+  for (; i < n; ++i) dst[i] = ml_f32_to_bf16(src[i]);
+}
+
+AVX2_FN static void avx2_gemm_6x16(u64 kc, const f32* a, const f32* b,
+                                   f32* c, u64 ldc, int accumulate) {
+  __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+  __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+  __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+  __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+  __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+  __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+
+  for (u64 p = 0; p < kc; ++p) {
+    const __m256 b0 = _mm256_load_ps(b);
+    const __m256 b1 = _mm256_load_ps(b + 8);
+    __m256 av;
+
+    av = _mm256_broadcast_ss(a + 0);
+    c00 = _mm256_fmadd_ps(av, b0, c00); c01 = _mm256_fmadd_ps(av, b1, c01);
+    av = _mm256_broadcast_ss(a + 1);
+    c10 = _mm256_fmadd_ps(av, b0, c10); c11 = _mm256_fmadd_ps(av, b1, c11);
+    av = _mm256_broadcast_ss(a + 2);
+    c20 = _mm256_fmadd_ps(av, b0, c20); c21 = _mm256_fmadd_ps(av, b1, c21);
+    av = _mm256_broadcast_ss(a + 3);
+    c30 = _mm256_fmadd_ps(av, b0, c30); c31 = _mm256_fmadd_ps(av, b1, c31);
+    av = _mm256_broadcast_ss(a + 4);
+    c40 = _mm256_fmadd_ps(av, b0, c40); c41 = _mm256_fmadd_ps(av, b1, c41);
+    av = _mm256_broadcast_ss(a + 5);
+    c50 = _mm256_fmadd_ps(av, b0, c50); c51 = _mm256_fmadd_ps(av, b1, c51);
+
+    a += AVX2_MR;
+    b += AVX2_NR;
+  }
+
+#define AVX2_STORE_ROW(r, v0, v1)                                        \
+  do {                                                                   \
+    f32* cr = c + (r) * ldc;                                             \
+    if (accumulate) {                                                    \
+      v0 = _mm256_add_ps(v0, _mm256_loadu_ps(cr));                       \
+      v1 = _mm256_add_ps(v1, _mm256_loadu_ps(cr + 8));                   \
+    }                                                                    \
+    _mm256_storeu_ps(cr, v0);                                            \
+    _mm256_storeu_ps(cr + 8, v1);                                        \
+  } while (0)
+
+  AVX2_STORE_ROW(0, c00, c01);
+  AVX2_STORE_ROW(1, c10, c11);
+  AVX2_STORE_ROW(2, c20, c21);
+  AVX2_STORE_ROW(3, c30, c31);
+  AVX2_STORE_ROW(4, c40, c41);
+  AVX2_STORE_ROW(5, c50, c51);
+#undef AVX2_STORE_ROW
+}
+
+const ML_SimdKernels ml_simd_avx2_kernels = {
+  .id = ML_BACKEND_AVX2,
+  .fill = avx2_fill,
+  .copy = avx2_copy,
+  .scale = avx2_scale,
+  .add_scalar = avx2_add_scalar,
+  .add = avx2_add,
+  .axpy = avx2_axpy,
+  .max = avx2_max,
+  .sum = avx2_sum,
+  .dot = avx2_dot,
+  .dot_i8 = avx2_dot_i8,
+  .exp = avx2_exp,
+  .log = avx2_log,
+  .act = avx2_act,
+  .act_grad = avx2_act_grad,
+  .f16_to_f32 = avx2_f16_to_f32,
+  .f32_to_f16 = avx2_f32_to_f16,
+  .bf16_to_f32 = avx2_bf16_to_f32,
+  .f32_to_bf16 = avx2_f32_to_bf16,
+  .gemm_kernel = avx2_gemm_6x16,
+  .gemm_mr = AVX2_MR,
+  .gemm_nr = AVX2_NR,
+};
+
+/* ========================================================================== */
+/* AVX-512F                                                                    */
+/* ========================================================================== */
+
+// Lanes [0, r) set, r < 16
+#define AVX512_TAIL(r) ((__mmask16)((1u << (r)) - 1u))
+
+AVX512_FN static void avx512_fill(f32* dst, u64 n, f32 v) {
+  const __m512 vv = _mm512_set1_ps(v);
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16) _mm512_storeu_ps(dst + i, vv);
+  if (i < n) _mm512_mask_storeu_ps(dst + i, AVX512_TAIL(n - i), vv);
+}
+
+AVX512_FN static void avx512_copy(f32* dst, const f32* src, u64 n) {
+  if (dst == src) return;
+  if (dst > src && dst < src + n) {
+    for (u64 i = n; i-- > 0;) dst[i] = src[i];
+    return;
+  }
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16) _mm512_storeu_ps(dst + i, _mm512_loadu_ps(src + i));
+  if (i < n) {
+    const __mmask16 m = AVX512_TAIL(n - i);
+    _mm512_mask_storeu_ps(dst + i, m, _mm512_maskz_loadu_ps(m, src + i));
+  }
+}
+
+AVX512_FN static void avx512_scale(f32* x, u64 n, f32 s) {
+  const __m512 vs = _mm512_set1_ps(s);
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(x + i, _mm512_mul_ps(_mm512_loadu_ps(x + i), vs));
+  if (i < n) {
+    const __mmask16 m = AVX512_TAIL(n - i);
+    _mm512_mask_storeu_ps(x + i, m, _mm512_mul_ps(_mm512_maskz_loadu_ps(m, x + i), vs));
+  }
+}
+
+AVX512_FN static void avx512_add_scalar(f32* x, u64 n, f32 s) {
+  const __m512 vs = _mm512_set1_ps(s);
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(x + i, _mm512_add_ps(_mm512_loadu_ps(x + i), vs));
+  if (i < n) {
+    const __mmask16 m = AVX512_TAIL(n - i);
+    _mm512_mask_storeu_ps(x + i, m, _mm512_add_ps(_mm512_maskz_loadu_ps(m, x + i), vs));
+  }
+}
+
+AVX512_FN static void avx512_add(f32* y, const f32* x, u64 n) {
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(y + i, _mm512_add_ps(_mm512_loadu_ps(y + i),
+                                          _mm512_loadu_ps(x + i)));
+  if (i < n) {
+    const __mmask16 m = AVX512_TAIL(n - i);
+    _mm512_mask_storeu_ps(y + i, m, _mm512_add_ps(_mm512_maskz_loadu_ps(m, y + i),
+                                                  _mm512_maskz_loadu_ps(m, x + i)));
+  }
+}
+
+AVX512_FN static void avx512_axpy(f32* y, const f32* x, u64 n, f32 a) {
+  const __m512 va = _mm512_set1_ps(a);
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(y + i, _mm512_fmadd_ps(va, _mm512_loadu_ps(x + i),
+                                            _mm512_loadu_ps(y + i)));
+  if (i < n) {
+    const __mmask16 m = AVX512_TAIL(n - i);
+    _mm512_mask_storeu_ps(y + i, m,
+                          _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(m, x + i),
+                                          _mm512_maskz_loadu_ps(m, y + i)));
+  }
+}
+
+AVX512_FN static f32 avx512_max(const f32* x, u64 n) {
+  if (n < 16) {
+    f32 m = x[0];
+    for (u64 i = 1; i < n; ++i)
+      if (x[i] > m) m = x[i];
+    return m;
+  }
+  __m512 vm = _mm512_loadu_ps(x);
+  u64 i = 16;
+  for (; i + 16 <= n; i += 16) vm = _mm512_max_ps(vm, _mm512_loadu_ps(x + i));
+  if (i < n)
+    vm = _mm512_mask_max_ps(vm, AVX512_TAIL(n - i), vm, _mm512_maskz_loadu_ps(AVX512_TAIL(n - i), x + i));
+  return _mm512_reduce_max_ps(vm);
+}
+
+AVX512_FN static f32 avx512_sum(const f32* x, u64 n) {
+  __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+  u64 i = 0;
+  for (; i + 32 <= n; i += 32) {
+    s0 = _mm512_add_ps(s0, _mm512_loadu_ps(x + i));
+    s1 = _mm512_add_ps(s1, _mm512_loadu_ps(x + i + 16));
+  }
+  for (; i + 16 <= n; i += 16) s0 = _mm512_add_ps(s0, _mm512_loadu_ps(x + i));
+  if (i < n) s1 = _mm512_add_ps(s1, _mm512_maskz_loadu_ps(AVX512_TAIL(n - i), x + i));
+  return _mm512_reduce_add_ps(_mm512_add_ps(s0, s1));
+}
+
+AVX512_FN static f32 avx512_dot(const f32* x, const f32* y, u64 n) {
+  __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+  u64 i = 0;
+  for (; i + 32 <= n; i += 32) {
+    s0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), s0);
+    s1 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 16), _mm512_loadu_ps(y + i + 16), s1);
+  }
+  for (; i + 16 <= n; i += 16)
+    s0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), s0);
+  if (i < n) {
+    const __mmask16 m = AVX512_TAIL(n - i);
+    s1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, x + i), _mm512_maskz_loadu_ps(m, y + i), s1);
+  }
+  return _mm512_reduce_add_ps(_mm512_add_ps(s0, s1));
+}
+
+// See ml_math.h for the algorithm; scalef applies 2^n without the split
+AVX512_FN static inline __m512 avx512_exp_ps(__m512 x, int fastest) {
+  const __m512 hi = _mm512_set1_ps(ML_EXP_HI);
+  const __m512 lo = _mm512_set1_ps(ML_EXP_LO);
+  const __m512 xc = _mm512_min_ps(_mm512_max_ps(x, lo), hi);
+
+  const __m512 n = _mm512_roundscale_ps(_mm512_mul_ps(xc, _mm512_set1_ps(ML_LOG2E)),
+                                        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(ML_LN2_HI), xc);
+  r = _mm512_fnmadd_ps(n, _mm512_set1_ps(ML_LN2_LO), r);
+
+  __m512 q;
+  if (fastest) {
+    q = _mm512_set1_ps(ML_EXP_X_Q2);
+    q = _mm512_fmadd_ps(q, r, _mm512_set1_ps(ML_EXP_X_Q1));
+    q = _mm512_fmadd_ps(q, r, _mm512_set1_ps(ML_EXP_X_Q0));
+  } else {
+    q = _mm512_set1_ps(ML_EXP_F_Q5);
+    q = _mm512_fmadd_ps(q, r, _mm512_set1_ps(ML_EXP_F_Q4));
+    q = _mm512_fmadd_ps(q, r, _mm512_set1_ps(ML_EXP_F_Q3));
+    q = _mm512_fmadd_ps(q, r, _mm512_set1_ps(ML_EXP_F_Q2));
+    q = _mm512_fmadd_ps(q, r, _mm512_set1_ps(ML_EXP_F_Q1));
+    q = _mm512_fmadd_ps(q, r, _mm512_set1_ps(ML_EXP_F_Q0));
+  }
+  __m512 p = _mm512_fmadd_ps(q, _mm512_mul_ps(r, r), r);
+  p = _mm512_add_ps(p, _mm512_set1_ps(1.0f));
+  p = _mm512_scalef_ps(p, n);
+
+  p = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, hi, _CMP_GT_OQ), p, _mm512_set1_ps(INFINITY));
+  p = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, lo, _CMP_LT_OQ), p, _mm512_setzero_ps());
+  return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q), p, _mm512_add_ps(x, x));
+}
+
+AVX512_FN static inline __m512 avx512_log_ps(__m512 x, int fastest) {
+  // getexp/getmant normalise subnormals directly: x = m * 2^e, m in [0.5, 1)
+  __m512 m = _mm512_getmant_ps(x, _MM_MANT_NORM_p5_1, _MM_MANT_SIGN_src);
+  __m512 fe = _mm512_add_ps(_mm512_getexp_ps(x), _mm512_set1_ps(1.0f));
+  const __mmask16 small = _mm512_cmp_ps_mask(m, _mm512_set1_ps(ML_SQRTHF), _CMP_LT_OQ);
+  m = _mm512_mask_add_ps(m, small, m, m);
+  fe = _mm512_mask_sub_ps(fe, small, fe, _mm512_set1_ps(1.0f));
+
+  const __m512 f = _mm512_sub_ps(m, _mm512_set1_ps(1.0f));
+  const __m512 z = _mm512_mul_ps(f, f);
+
+  __m512 rr;
+  if (fastest) {
+    rr = _mm512_set1_ps(ML_LOG_X_R3);
+    rr = _mm512_fmadd_ps(rr, f, _mm512_set1_ps(ML_LOG_X_R2));
+    rr = _mm512_fmadd_ps(rr, f, _mm512_set1_ps(ML_LOG_X_R1));
+    rr = _mm512_fmadd_ps(rr, f, _mm512_set1_ps(ML_LOG_X_R0));
+  } else {
+    rr = _mm512_set1_ps(ML_LOG_F_R8);
+    rr = _mm512_fmadd_ps(rr, f, _mm512_set1_ps(ML_LOG_F_R7));
+    rr = _mm512_fmadd_ps(rr, f, _mm512_set1_ps(ML_LOG_F_R6));
+    rr = _mm512_fmadd_ps(rr, f, _mm512_set1_ps(ML_LOG_F_R5));
+    rr = _mm512_fmadd_ps(rr, f, _mm512_set1_ps(ML_LOG_F_R4));
+    rr = _mm512_fmadd_ps(rr, f, _mm512_set1_ps(ML_LOG_F_R3));
+    rr = _mm512_fmadd_ps(rr, f, _mm512_set1_ps(ML_LOG_F_R2));
+    rr = _mm512_fmadd_ps(rr, f, _mm512_set1_ps(ML_LOG_F_R1));
+    rr = _mm512_fmadd_ps(rr, f, _mm512_set1_ps(ML_LOG_F_R0));
+  }
+
+  __m512 y = _mm512_mul_ps(_mm512_mul_ps(rr, f), z);
+  y = _mm512_fmadd_ps(fe, _mm512_set1_ps(ML_LN2_LO), y);
+  y = _mm512_fnmadd_ps(z, _mm512_set1_ps(0.5f), y);
+  y = _mm512_fmadd_ps(fe, _mm512_set1_ps(ML_LN2_HI), _mm512_add_ps(f, y));
+
+  const __m512 zero = _mm512_setzero_ps();
+  y = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, zero, _CMP_EQ_OQ), y, _mm512_set1_ps(-INFINITY));
+  y = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, _mm512_set1_ps(INFINITY), _CMP_EQ_OQ), y, x);
+  y = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, zero, _CMP_LT_OQ), y, _mm512_set1_ps(NAN));
+  return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q), y, _mm512_add_ps(x, x));
+}
+
+AVX512_FN static inline void avx512_exp_run(f32* x, u64 n, int fastest) {
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(x + i, avx512_exp_ps(_mm512_loadu_ps(x + i), fastest));
+  if (i < n) {
+    const __mmask16 m = AVX512_TAIL(n - i);
+    _mm512_mask_storeu_ps(x + i, m, avx512_exp_ps(_mm512_maskz_loadu_ps(m, x + i), fastest));
+  }
+}
+
+AVX512_FN static inline void avx512_log_run(f32* x, u64 n, int fastest) {
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(x + i, avx512_log_ps(_mm512_loadu_ps(x + i), fastest));
+  if (i < n) {
+    const __mmask16 m = AVX512_TAIL(n - i);
+    _mm512_mask_storeu_ps(x + i, m, avx512_log_ps(_mm512_maskz_loadu_ps(m, x + i), fastest));
+  }
+}
+
+AVX512_FN static void avx512_exp(f32* x, u64 n) {
+  switch (ml_math_accuracy) {
+   case ML_MATH_FAST:    avx512_exp_run(x, n, 0); break;
+   case ML_MATH_FASTEST: avx512_exp_run(x, n, 1); break;
+   default:              ml_exp_libm(x, n); break;
+  }
+}
+
+AVX512_FN static void avx512_log(f32* x, u64 n) {
+  switch (ml_math_accuracy) {
+   case ML_MATH_FAST:    avx512_log_run(x, n, 0); break;
+   case ML_MATH_FASTEST: avx512_log_run(x, n, 1); break;
+   default:              ml_log_libm(x, n); break;
+  }
+}
+
+AVX512_FN static inline __m512 avx512_sigmoid_ps(__m512 x, int fastest) {
+  const __m512 one = _mm512_set1_ps(1.0f);
+  const __m512 e = avx512_exp_ps(_mm512_sub_ps(_mm512_setzero_ps(), x), fastest);
+  return _mm512_div_ps(one, _mm512_add_ps(one, e));
+}
+
+// See ml_tanhf_approx. min/max return their second operand when either is
+// NaN, so with x last a NaN passes through the clamp
+AVX512_FN static inline __m512 avx512_tanh_ps(__m512 x, int fastest) {
+  const __m512 one = _mm512_set1_ps(1.0f);
+  const __m512 c = _mm512_set1_ps(ML_TANH_CLAMP);
+  const __m512 v = _mm512_min_ps(c, _mm512_max_ps(_mm512_sub_ps(_mm512_setzero_ps(), c), x));
+  const __m512 e = avx512_exp_ps(_mm512_mul_ps(v, _mm512_set1_ps(-2.0f)), fastest);
+  return _mm512_div_ps(_mm512_sub_ps(one, e), _mm512_add_ps(one, e));
+}
+
+// tanh(K x (1 + C x^2)), the inner term of GELU and its derivative
+AVX512_FN static inline __m512 avx512_gelu_t_ps(__m512 x, __m512 x2, int fastest) {
+  const __m512 p = _mm512_fmadd_ps(_mm512_set1_ps(ML_GELU_C), x2, _mm512_set1_ps(1.0f));
+  return avx512_tanh_ps(_mm512_mul_ps(_mm512_mul_ps(_mm512_set1_ps(ML_GELU_K), x), p), fastest);
+}
+
+AVX512_FN static inline __m512 avx512_gelu_ps(__m512 x, int fastest) {
+  const __m512 t = avx512_gelu_t_ps(x, _mm512_mul_ps(x, x), fastest);
+  return _mm512_mul_ps(_mm512_mul_ps(_mm512_set1_ps(0.5f), x), _mm512_add_ps(_mm512_set1_ps(1.0f), t));
+}
+
+AVX512_FN static inline __m512 avx512_gelu_grad_ps(__m512 x, int fastest) {
+  const __m512 half = _mm512_set1_ps(0.5f);
+  const __m512 one = _mm512_set1_ps(1.0f);
+  const __m512 x2 = _mm512_mul_ps(x, x);
+  const __m512 t = avx512_gelu_t_ps(x, x2, fastest);
+  const __m512 du = _mm512_mul_ps(_mm512_set1_ps(ML_GELU_K),
+                                  _mm512_fmadd_ps(_mm512_set1_ps(3.0f * ML_GELU_C), x2, one));
+  const __m512 s = _mm512_mul_ps(_mm512_mul_ps(half, x), _mm512_fnmadd_ps(t, t, one));
+  return _mm512_fmadd_ps(s, du, _mm512_mul_ps(half, _mm512_add_ps(one, t)));
+}
+
+// y[i] = VEC over xv = x[i..i+16), the remainder through a masked load
+// and store (the zeroed lanes are computed and dropped)
+#define AVX512_ACT_LOOP(VEC)                                     \
+  for (; i + 16 <= n; i += 16) {                                       \
+    const __m512 xv = _mm512_loadu_ps(x + i);                          \
+    _mm512_storeu_ps(y + i, VEC);                                      \
+  }                                                                    \
+  if (i < n) {                                                         \
+    const __mmask16 m = AVX512_TAIL(n - i);                            \
+    const __m512 xv = _mm512_maskz_loadu_ps(m, x + i);                 \
+    _mm512_mask_storeu_ps(y + i, m, VEC);                              \
+  }
+
+// dx[i] = VEC over gv = dy[i..i+16) and vv = v[i..i+16), masked remainder
+#define AVX512_GRAD_LOOP(VEC)                                    \
+  for (; i + 16 <= n; i += 16) {                                       \
+    const __m512 gv = _mm512_loadu_ps(dy + i);                         \
+    const __m512 vv = _mm512_loadu_ps(v + i);                          \
+    _mm512_storeu_ps(dx + i, VEC);                                     \
+  }                                                                    \
+  if (i < n) {                                                         \
+    const __mmask16 m = AVX512_TAIL(n - i);                            \
+    const __m512 gv = _mm512_maskz_loadu_ps(m, dy + i);                \
+    const __m512 vv = _mm512_maskz_loadu_ps(m, v + i);                 \
+    _mm512_mask_storeu_ps(dx + i, m, VEC);                             \
+  }
+
+AVX512_FN static void avx512_act(f32* y, const f32* x, u64 n, ML_Activation act, f32 alpha) {
+  const __m512 zero = _mm512_setzero_ps();
+  const __m512 a = _mm512_set1_ps(alpha);
+  const int fastest = ml_math_accuracy == ML_MATH_FASTEST;
+  u64 i = 0;
+
+  if (ml_math_accuracy == ML_MATH_EXACT && act != ML_ACT_RELU && act != ML_ACT_LEAKY_RELU) {
+    ml_act_libm(y, x, n, act, alpha);
+    return;
+  }
+  switch (act) {
+   case ML_ACT_RELU:
+     AVX512_ACT_LOOP(_mm512_max_ps(xv, zero));
+     break;
+   case ML_ACT_LEAKY_RELU:
+     AVX512_ACT_LOOP(_mm512_mask_blend_ps(_mm512_cmp_ps_mask(xv, zero, _CMP_GT_OQ),
+                                          _mm512_mul_ps(a, xv), xv));
+     break;
+   case ML_ACT_SIGMOID:
+     AVX512_ACT_LOOP(avx512_sigmoid_ps(xv, fastest));
+     break;
+   case ML_ACT_TANH:
+     AVX512_ACT_LOOP(avx512_tanh_ps(xv, fastest));
+     break;
+   case ML_ACT_GELU:
+     AVX512_ACT_LOOP(avx512_gelu_ps(xv, fastest));
+     break;
+   default:
+     ml_act_libm(y, x, n, act, alpha);
+     break;
+  }
+}
+
+AVX512_FN static void avx512_act_grad(f32* dx, const f32* dy, const f32* v, u64 n,
+                                      ML_Activation act, f32 alpha) {
+  const __m512 zero = _mm512_setzero_ps();
+  const __m512 one = _mm512_set1_ps(1.0f);
+  const __m512 a = _mm512_set1_ps(alpha);
+  const int fastest = ml_math_accuracy == ML_MATH_FASTEST;
+  u64 i = 0;
+
+  switch (act) {
+   case ML_ACT_RELU:
+     AVX512_GRAD_LOOP(_mm512_maskz_mov_ps(_mm512_cmp_ps_mask(vv, zero, _CMP_GT_OQ), gv));
+     break;
+   case ML_ACT_LEAKY_RELU:
+     AVX512_GRAD_LOOP(_mm512_mask_blend_ps(_mm512_cmp_ps_mask(vv, zero, _CMP_GT_OQ),
+                                           _mm512_mul_ps(a, gv), gv));
+     break;
+   case ML_ACT_SIGMOID:
+     AVX512_GRAD_LOOP(_mm512_mul_ps(_mm512_mul_ps(gv, vv), _mm512_sub_ps(one, vv)));
+     break;
+   case ML_ACT_TANH:
+     AVX512_GRAD_LOOP(_mm512_mul_ps(gv, _mm512_fnmadd_ps(vv, vv, one)));
+     break;
+   case ML_ACT_GELU:
+     if (ml_math_accuracy == ML_MATH_EXACT) {
+       ml_act_grad_libm(dx, dy, v, n, act, alpha);
+       break;
+     }
+     AVX512_GRAD_LOOP(_mm512_mul_ps(gv, avx512_gelu_grad_ps(vv, fastest)));
+     break;
+   default:
+     ml_act_grad_libm(dx, dy, v, n, act, alpha);
+     break;
+  }
+}
+
+#undef AVX512_ACT_LOOP
+#undef AVX512_GRAD_LOOP
+
+AVX512_FN static void avx512_f16_to_f32(f32* dst, const u16* src, u64 n) {
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(dst + i, _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(src + i))));
+  for (; i < n; ++i) dst[i] = ml_f16_to_f32(src[i]);
+}
+
+AVX512_FN static void avx512_f32_to_f16(u16* dst, const f32* src, u64 n) {
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm256_storeu_si256((__m256i*)(dst + i),
+                        _mm512_cvtps_ph(_mm512_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+  for (; i < n; ++i) dst[i] = ml_f32_to_f16(src[i]);
+}
+
+AVX512_FN static void avx512_bf16_to_f32(f32* dst, const u16* src, u64 n) {
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512i h = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)(src + i)));
+    _mm512_storeu_ps(dst + i, _mm512_castsi512_ps(_mm512_slli_epi32(h, 16)));
+  }
+  for (; i < n; ++i) dst[i] = ml_bf16_to_f32(src[i]);
+}
+
+AVX512_FN static void avx512_f32_to_bf16(u16* dst, const f32* src, u64 n) {
+  const __m512i abs_mask = _mm512_set1_epi32(0x7fffffff);
+  const __m512i inf = _mm512_set1_epi32(0x7f800000);
+  const __m512i one = _mm512_set1_epi32(1);
+  const __m512i bias = _mm512_set1_epi32(0x7fff);
+  const __m512i quiet = _mm512_set1_epi32(0x400000);
+  u64 i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512i x = _mm512_castps_si512(_mm512_loadu_ps(src + i));
+    const __mmask16 nan = _mm512_cmpgt_epi32_mask(_mm512_and_si512(x, abs_mask), inf);
+    const __m512i odd = _mm512_and_si512(_mm512_srli_epi32(x, 16), one);
+    __m512i r = _mm512_add_epi32(x, _mm512_add_epi32(odd, bias));
+    r = _mm512_mask_blend_epi32(nan, r, _mm512_or_si512(x, quiet));
+    _mm256_storeu_si256((__m256i*)(dst + i), _mm512_cvtepi32_epi16(_mm512_srli_epi32(r, 16)));
+  }
+  for (; i < n; ++i) dst[i] = ml_f32_to_bf16(src[i]);
+}
+
+AVX512_FN static void avx512_gemm_12x32(u64 kc, const f32* a, const f32* b,
+                                        f32* c, u64 ldc, int accumulate) {
+  __m512 acc[AVX512_MR][2];
+
+  for (int r = 0; r < AVX512_MR; ++r) {
+    acc[r][0] = _mm512_setzero_ps();
+    acc[r][1] = _mm512_setzero_ps();
+  }
+
+  for (u64 p = 0; p < kc; ++p) {
+    const __m512 b0 = _mm512_load_ps(b);
+    const __m512 b1 = _mm512_load_ps(b + 16);
+
+#pragma GCC unroll 12
+    for (int r = 0; r < AVX512_MR; ++r) {
+      const __m512 av = _mm512_set1_ps(a[r]);
+      acc[r][0] = _mm512_fmadd_ps(av, b0, acc[r][0]);
+      acc[r][1] = _mm512_fmadd_ps(av, b1, acc[r][1]);
+    }
+
+    a += AVX512_MR;
+    b += AVX512_NR;
+  }
+
+#pragma GCC unroll 12
+  for (int r = 0; r < AVX512_MR; ++r) {
+    f32* cr = c + (u64)r * ldc;
+    __m512 v0 = acc[r][0], v1 = acc[r][1];
+    if (accumulate) {
+      v0 = _mm512_add_ps(v0, _mm512_loadu_ps(cr));
+      v1 = _mm512_add_ps(v1, _mm512_loadu_ps(cr + 16));
+    }
+    _mm512_storeu_ps(cr, v0);
+    _mm512_storeu_ps(cr + 16, v1);
+  }
+}
+
+const ML_SimdKernels ml_simd_avx512_kernels = {
+  .id = ML_BACKEND_AVX512,
+  .fill = avx512_fill,
+  .copy = avx512_copy,
+  .scale = avx512_scale,
+  .add_scalar = avx512_add_scalar,
+  .add = avx512_add,
+  .axpy = avx512_axpy,
+  .max = avx512_max,
+  .sum = avx512_sum,
+  .dot = avx512_dot,
+  // 512-bit int16 multiply-add needs AVX512BW; every AVX-512 part has AVX2
+  .dot_i8 = avx2_dot_i8,
+  .exp = avx512_exp,
+  .log = avx512_log,
+  .act = avx512_act,
+  .act_grad = avx512_act_grad,
+  .f16_to_f32 = avx512_f16_to_f32,
+  .f32_to_f16 = avx512_f32_to_f16,
+  .bf16_to_f32 = avx512_bf16_to_f32,
+  .f32_to_bf16 = avx512_f32_to_bf16,
+  .gemm_kernel = avx512_gemm_12x32,
+  .gemm_mr = AVX512_MR,
+  .gemm_nr = AVX512_NR,
+};
+
+#endif // ML_SIMD_X86
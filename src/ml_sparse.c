@@ -0,0 +1,201 @@
+#include "ml_sparse.h"
+#include "ml_alloc.h"
+#include "ml_error.h"
+#include "ml_kernels.h"
+#include "ml_primitives.h"
+#include "ml_simd.h"
+
+#include <stddef.h>
+
+// Indices are stored as u32
+#define ML_SPARSE_MAX_INDEX 0xffffffffu
+
+ML_Status create_MatCOO(ml_arena* arena, MatCOO* dest, u64 rows, u64 cols, u64 cap) {
+  if (!arena || !dest) return ML_INVALID_ARGUMENT;
+  if (rows > ML_SPARSE_MAX_INDEX || cols > ML_SPARSE_MAX_INDEX || cap > ML_SPARSE_MAX_INDEX)
+    return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+  void* row_ptr = NULL;
+  void* col_ptr = NULL;
+  void* val_ptr = NULL;
+
+  status = push_ml_arena(&val_ptr, arena, cap * sizeof(f32));
+  if (status != ML_OK) return status;
+  status = push_ml_arena(&row_ptr, arena, cap * sizeof(u32));
+  if (status != ML_OK) return status;
+  status = push_ml_arena(&col_ptr, arena, cap * sizeof(u32));
+  if (status != ML_OK) return status;
+
+  dest->rows = rows;
+  dest->cols = cols;
+  dest->nnz = 0;
+  dest->cap = cap;
+  dest->row_idx = row_ptr;
+  dest->col_idx = col_ptr;
+  dest->values = val_ptr;
+
+  return ML_OK;
+}
+
+ML_Status create_MatCSR(ml_arena* arena, MatCSR* dest, u64 rows, u64 cols, u64 cap) {
+  if (!arena || !dest) return ML_INVALID_ARGUMENT;
+  if (rows > ML_SPARSE_MAX_INDEX || cols > ML_SPARSE_MAX_INDEX || cap > ML_SPARSE_MAX_INDEX)
+    return ML_INVALID_ARGUMENT;
+
+  ML_Status status = ML_OK;
+  void* row_ptr = NULL;
+  void* col_ptr = NULL;
+  void* val_ptr = NULL;
+
+  status = push_ml_arena(&val_ptr, arena, cap * sizeof(f32));
+  if (status != ML_OK) return status;
+  status = push_ml_arena(&row_ptr, arena, (rows + 1) * sizeof(u32));
+  if (status != ML_OK) return status;
+  status = push_ml_arena(&col_ptr, arena, cap * sizeof(u32));
+  if (status != ML_OK) return status;
+
+  dest->rows = rows;
+  dest->cols = cols;
+  dest->nnz = 0;
+  dest->cap = cap;
+  dest->row_ptr = row_ptr;
+  dest->col_idx = col_ptr;
+  dest->values = val_ptr;
+
+  for (u64 r = 0; r <= rows; ++r) dest->row_ptr[r] = 0;
+
+  return ML_OK;
+}
+
+ML_Status MatCOO_push(MatCOO* coo, u64 row, u64 col, f32 val) {
+  if (!coo) return ML_INVALID_ARGUMENT;
+  if (row >= coo->rows || col >= coo->cols) return ML_OUT_OF_BOUNDS;
+  if (coo->nnz >= coo->cap) return ML_OUT_OF_MEMORY;
+
+  coo->row_idx[coo->nnz] = (u32)row;
+  coo->col_idx[coo->nnz] = (u32)col;
+  coo->values[coo->nnz] = val;
+  ++coo->nnz;
+
+  return ML_OK;
+}
+
+ML_Status MatCSR_from_COO(MatCSR* dest, const MatCOO src) {
+  if (!dest) return ML_INVALID_ARGUMENT;
+  if (!dest->row_ptr || (src.nnz && (!src.row_idx || !src.col_idx || !src.values)))
+    return ML_INVALID_ARGUMENT;
+  if (dest->rows != src.rows || dest->cols != src.cols) return ML_INVALID_ARGUMENT;
+  if (src.nnz > dest->cap) return ML_OUT_OF_MEMORY;
+
+  const u64 rows = src.rows;
+  u32* ptr = dest->row_ptr;
+
+  // Counting sort by row: count, prefix sum, scatter
+  for (u64 r = 0; r <= rows; ++r) ptr[r] = 0;
+  for (u64 e = 0; e < src.nnz; ++e) ++ptr[src.row_idx[e] + 1];
+  for (u64 r = 0; r < rows; ++r) ptr[r + 1] += ptr[r];
+
+  // ptr[r] is used as the insertion cursor of row r, which leaves it at
+  // the start of row r + 1; shift back afterwards
+  for (u64 e = 0; e < src.nnz; ++e) {
+    const u32 at = ptr[src.row_idx[e]]++;
+    dest->col_idx[at] = src.col_idx[e];
+    dest->values[at] = src.values[e];
+  }
+  for (u64 r = rows; r > 0; --r) ptr[r] = ptr[r - 1];
+  ptr[0] = 0;
+
+  dest->nnz = src.nnz;
+
+  return ML_OK;
+}
+
+ML_Status MatCSR_from_dense(MatCSR* dest, const Matf32 src) {
+  if (!dest) return ML_INVALID_ARGUMENT;
+  if (!dest->row_ptr || !src.data) return ML_INVALID_ARGUMENT;
+  if (dest->rows != src.rows || dest->cols != src.cols) return ML_INVALID_ARGUMENT;
+
+  u64 nnz = 0;
+  dest->row_ptr[0] = 0;
+
+  for (u64 r = 0; r < src.rows; ++r) {
+    const f32* row = Mat_row_ptr(src, r);
+    for (u64 c = 0; c < src.cols; ++c) {
+      if (row[c] == 0.0f) continue;
+      if (nnz >= dest->cap) return ML_OUT_OF_MEMORY;
+      dest->col_idx[nnz] = (u32)c;
+      dest->values[nnz] = row[c];
+      ++nnz;
+    }
+    dest->row_ptr[r + 1] = (u32)nnz;
+  }
+
+  dest->nnz = nnz;
+
+  return ML_OK;
+}
+
+ML_Status MatCSR_to_dense(Matf32* dest, const MatCSR src) {
+  if (!dest) return ML_INVALID_ARGUMENT;
+  if (!dest->data || !src.row_ptr) return ML_INVALID_ARGUMENT;
+  if (dest->rows != src.rows || dest->cols != src.cols) return ML_INVALID_ARGUMENT;
+
+  const u64 ld = Mat_ld(*dest);
+  ml_kernel_fill(dest->data, ld, dest->rows, dest->cols, 0.0f);
+
+  for (u64 r = 0; r < src.rows; ++r) {
+    f32* out = dest->data + r * ld;
+    for (u32 e = src.row_ptr[r]; e < src.row_ptr[r + 1]; ++e)
+      out[src.col_idx[e]] += src.values[e];
+  }
+
+  return ML_OK;
+}
+
+ML_Status MatCSR_Mul_Mat_into(Matf32* out, const MatCSR lhs, const Matf32 rhs) {
+  if (!out) return ML_INVALID_ARGUMENT;
+  if (!out->data || !lhs.row_ptr || !rhs.data) return ML_INVALID_ARGUMENT;
+
+  if (lhs.cols != rhs.rows) return ML_INVALID_ARGUMENT;
+  if (out->rows != lhs.rows || out->cols != rhs.cols) return ML_INVALID_ARGUMENT;
+
+  const ML_SimdKernels* K = ml_simd();
+  const u64 n = rhs.cols;
+  const u64 ld_b = Mat_ld(rhs);
+  const u64 ld_c = Mat_ld(*out);
+
+  for (u64 i = 0; i < lhs.rows; ++i) {
+    f32* c = out->data + i * ld_c;
+
+    K->fill(c, n, 0.0f);
+    for (u32 e = lhs.row_ptr[i]; e < lhs.row_ptr[i + 1]; ++e)
+      K->axpy(c, rhs.data + (u64)lhs.col_idx[e] * ld_b, n, lhs.values[e]);
+  }
+
+  return ML_OK;
+}
+
+ML_Status MatCSR_trans_Mul_Mat_into(Matf32* out, const MatCSR lhs, const Matf32 rhs) {
+  if (!out) return ML_INVALID_ARGUMENT;
+  if (!out->data || !lhs.row_ptr || !rhs.data) return ML_INVALID_ARGUMENT;
+
+  if (lhs.rows != rhs.rows) return ML_INVALID_ARGUMENT;
+  if (out->rows != lhs.cols || out->cols != rhs.cols) return ML_INVALID_ARGUMENT;
+
+  const ML_SimdKernels* K = ml_simd();
+  const u64 n = rhs.cols;
+  const u64 ld_b = Mat_ld(rhs);
+  const u64 ld_c = Mat_ld(*out);
+
+  ml_kernel_fill(out->data, ld_c, out->rows, n, 0.0f);
+
+  // Scatter: row i of rhs goes to every output row p with lhs[i, p] != 0
+  for (u64 i = 0; i < lhs.rows; ++i) {
+    const f32* b = rhs.data + i * ld_b;
+    for (u32 e = lhs.row_ptr[i]; e < lhs.row_ptr[i + 1]; ++e)
+      K->axpy(out->data + (u64)lhs.col_idx[e] * ld_c, b, n, lhs.values[e]);
+  }
+
+  return ML_OK;
+}
@@ -0,0 +1,337 @@
+#include "ml_thread.h"
+#include "ml_error.h"
+#include "ml_gemm.h"
+#include "ml_pool.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(ESP_PLATFORM)
+#define ML_THREAD_FREERTOS 1
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#elif defined(__unix__) || defined(__APPLE__)
+#define ML_THREAD_PTHREAD 1
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/*
+ * One job at a time: the caller publishes it, wakes every worker and then
+ * works on it too. Chunks are claimed from an atomic counter, so threads
+ * that start late simply find less left to do.
+ */
+typedef struct {
+  ML_ParallelFn fn;
+  void* ctx;
+  u64 n;
+  u64 grain;
+  u64 chunks;
+  atomic_uint_fast64_t next;
+} ml_job;
+
+static u64 ml_threads = 1;
+static ml_job ml_pool_job;
+// Held for the duration of a parallel loop; nested or concurrent loops
+// that fail to take it run serially instead
+static atomic_flag ml_pool_busy = ATOMIC_FLAG_INIT;
+
+#if ML_GEMM_PACKED
+
+// Panels start on a cache line; the GEMM micro-kernels use aligned B loads
+#define ML_POOL_ALIGN 64
+
+// GEMM pack panels for ml_threads threads, sized for the largest block.
+// Only the holder of ml_pool_busy touches them; set_ml_threads() resizes
+// them while the library is idle.
+static ML_PoolScratch pool_scratch;
+static void* pool_scratch_mem = NULL;
+static u64 pool_scratch_threads = 0;
+
+static void pool_scratch_free(void) {
+  free(pool_scratch_mem);
+  pool_scratch_mem = NULL;
+  pool_scratch_threads = 0;
+  pool_scratch = (ML_PoolScratch){0};
+}
+
+// Leaves no panels if the allocation fails; GEMM then takes the direct path
+static void pool_scratch_alloc(u64 threads) {
+  pool_scratch_free();
+
+  const u64 align = ML_POOL_ALIGN / sizeof(f32);
+  const u64 a_len = (ML_GEMM_MC * ML_GEMM_KC + align - 1) / align * align;
+  const u64 b_len = (ML_GEMM_KC * ML_GEMM_NC + align - 1) / align * align;
+  void* mem = malloc((threads * a_len + b_len) * sizeof(f32) + ML_POOL_ALIGN - 1);
+  if (!mem) return;
+
+  f32* base = (f32*)(((uintptr_t)mem + ML_POOL_ALIGN - 1) & ~(uintptr_t)(ML_POOL_ALIGN - 1));
+  pool_scratch_mem = mem;
+  pool_scratch_threads = threads;
+  pool_scratch.packB = base;
+  pool_scratch.packA = base + b_len;
+  pool_scratch.packA_len = a_len;
+}
+
+#endif // ML_GEMM_PACKED
+
+static void job_run(ml_job* job, u64 tid) {
+  for (;;) {
+    const u64 c = atomic_fetch_add_explicit(&job->next, 1, memory_order_relaxed);
+    if (c >= job->chunks) return;
+
+    const u64 begin = c * job->grain;
+    const u64 end = begin + job->grain < job->n ? begin + job->grain : job->n;
+    job->fn(job->ctx, begin, end, tid);
+  }
+}
+
+#if defined(ML_THREAD_PTHREAD)
+
+static pthread_t pool_workers[ML_THREADS_MAX];
+static u64 pool_size = 0; // workers, not counting the caller
+static pthread_mutex_t pool_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t pool_done = PTHREAD_COND_INITIALIZER;
+static u64 pool_generation = 0;
+static u64 pool_start_generation = 0;
+static u64 pool_active = 0;
+static int pool_quit = 0;
+
+static void* pool_worker(void* arg) {
+  const u64 tid = (u64)(size_t)arg;
+  // Start from the generation the pool was created at: a worker scheduled
+  // late must still see the first job as new
+  u64 seen = pool_start_generation;
+
+  pthread_mutex_lock(&pool_mtx);
+  for (;;) {
+    while (pool_generation == seen && !pool_quit) pthread_cond_wait(&pool_wake, &pool_mtx);
+    if (pool_quit) break;
+    seen = pool_generation;
+    pthread_mutex_unlock(&pool_mtx);
+
+    job_run(&ml_pool_job, tid);
+
+    pthread_mutex_lock(&pool_mtx);
+    if (--pool_active == 0) pthread_cond_signal(&pool_done);
+  }
+  pthread_mutex_unlock(&pool_mtx);
+
+  return NULL;
+}
+
+static void pool_stop(void) {
+  pthread_mutex_lock(&pool_mtx);
+  pool_quit = 1;
+  pthread_cond_broadcast(&pool_wake);
+  pthread_mutex_unlock(&pool_mtx);
+
+  for (u64 i = 0; i < pool_size; ++i) pthread_join(pool_workers[i], NULL);
+
+  pool_size = 0;
+  pool_quit = 0;
+}
+
+static ML_Status pool_start(u64 workers) {
+  pool_start_generation = pool_generation;
+
+  for (u64 i = 0; i < workers; ++i) {
+    // Worker i runs as tid i + 1; the caller is tid 0
+    if (pthread_create(&pool_workers[i], NULL, pool_worker, (void*)(size_t)(i + 1)) != 0) {
+      pool_stop();
+      return ML_OUT_OF_MEMORY;
+    }
+    // Count each worker as it starts so a failure joins only live ones
+    pool_size = i + 1;
+  }
+  return ML_OK;
+}
+
+static void pool_run(void) {
+  pthread_mutex_lock(&pool_mtx);
+  pool_active = pool_size;
+  ++pool_generation;
+  pthread_cond_broadcast(&pool_wake);
+  pthread_mutex_unlock(&pool_mtx);
+
+  job_run(&ml_pool_job, 0);
+
+  pthread_mutex_lock(&pool_mtx);
+  while (pool_active != 0) pthread_cond_wait(&pool_done, &pool_mtx);
+  pthread_mutex_unlock(&pool_mtx);
+}
+
+static u64 pool_hw_threads(void) {
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (u64)n : 1;
+}
+
+#elif defined(ML_THREAD_FREERTOS)
+
+#ifndef ML_THREAD_STACK
+#define ML_THREAD_STACK 4096
+#endif
+
+static TaskHandle_t pool_workers[ML_THREADS_MAX];
+static u64 pool_size = 0;
+static SemaphoreHandle_t pool_done = NULL;
+static atomic_uint_fast64_t pool_active;
+static volatile int pool_quit = 0;
+
+static void pool_worker(void* arg) {
+  const u64 tid = (u64)(size_t)arg;
+
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    if (!pool_quit) job_run(&ml_pool_job, tid);
+
+    const int quit = pool_quit;
+    if (atomic_fetch_sub(&pool_active, 1) == 1) xSemaphoreGive(pool_done);
+    if (quit) vTaskDelete(NULL);
+  }
+}
+
+// Wake every worker and wait until each has checked in once
+static void pool_signal_all(void) {
+  atomic_store(&pool_active, pool_size);
+  for (u64 i = 0; i < pool_size; ++i) xTaskNotifyGive(pool_workers[i]);
+}
+
+static void pool_stop(void) {
+  if (pool_size != 0) {
+    pool_quit = 1;
+    pool_signal_all();
+    xSemaphoreTake(pool_done, portMAX_DELAY);
+  }
+  pool_size = 0;
+  pool_quit = 0;
+}
+
+static ML_Status pool_start(u64 workers) {
+  if (!pool_done) {
+    pool_done = xSemaphoreCreateBinary();
+    if (!pool_done) return ML_OUT_OF_MEMORY;
+  }
+
+  const UBaseType_t prio = uxTaskPriorityGet(NULL);
+  for (u64 i = 0; i < workers; ++i) {
+    if (xTaskCreate(pool_worker, "ml_worker", ML_THREAD_STACK, (void*)(size_t)(i + 1),
+                    prio, &pool_workers[i]) != pdPASS) {
+      pool_stop();
+      return ML_OUT_OF_MEMORY;
+    }
+    pool_size = i + 1;
+  }
+  return ML_OK;
+}
+
+static void pool_run(void) {
+  pool_signal_all();
+  job_run(&ml_pool_job, 0);
+  xSemaphoreTake(pool_done, portMAX_DELAY);
+}
+
+static u64 pool_hw_threads(void) {
+  return portNUM_PROCESSORS;
+}
+
+#endif
+
+ML_Status set_ml_threads(u64 n) {
+#if defined(ML_THREAD_PTHREAD) || defined(ML_THREAD_FREERTOS)
+  if (n == 0) n = pool_hw_threads();
+  if (n > ML_THREADS_MAX) n = ML_THREADS_MAX;
+
+  if (n == ml_threads) return ML_OK;
+
+  pool_stop();
+  ml_threads = 1;
+
+  ML_Status status = n == 1 ? ML_OK : pool_start(n - 1);
+  if (status == ML_OK) ml_threads = n;
+
+#if ML_GEMM_PACKED
+  pool_scratch_alloc(ml_threads);
+#endif
+  return status;
+#else
+  if (n > 1) return ML_UNIMPLEMENTED;
+  return ML_OK;
+#endif
+}
+
+u64 get_ml_threads(void) {
+  return ml_threads;
+}
+
+#if defined(ML_THREAD_PTHREAD) || defined(ML_THREAD_FREERTOS)
+// Run one loop on the workers; the caller holds ml_pool_busy
+static void pool_for(u64 n, u64 grain, ML_ParallelFn fn, void* ctx) {
+  ml_pool_job.fn = fn;
+  ml_pool_job.ctx = ctx;
+  ml_pool_job.n = n;
+  ml_pool_job.grain = grain;
+  ml_pool_job.chunks = (n + grain - 1) / grain;
+  atomic_store_explicit(&ml_pool_job.next, 0, memory_order_relaxed);
+
+  pool_run();
+}
+#endif
+
+void ml_parallel_for(u64 n, u64 grain, ML_ParallelFn fn, void* ctx) {
+  if (n == 0) return;
+  if (grain == 0) grain = 1;
+
+  if (ml_threads <= 1 || n <= grain) {
+    fn(ctx, 0, n, 0);
+    return;
+  }
+
+#if defined(ML_THREAD_PTHREAD) || defined(ML_THREAD_FREERTOS)
+  if (atomic_flag_test_and_set_explicit(&ml_pool_busy, memory_order_acquire)) {
+    fn(ctx, 0, n, 0);
+    return;
+  }
+
+  pool_for(n, grain, fn, ctx);
+
+  atomic_flag_clear_explicit(&ml_pool_busy, memory_order_release);
+#else
+  fn(ctx, 0, n, 0);
+#endif
+}
+
+void ml_parallel_for_held(u64 n, u64 grain, ML_ParallelFn fn, void* ctx) {
+  if (n == 0) return;
+  if (grain == 0) grain = 1;
+
+#if defined(ML_THREAD_PTHREAD) || defined(ML_THREAD_FREERTOS)
+  if (ml_threads > 1 && n > grain) {
+    pool_for(n, grain, fn, ctx);
+    return;
+  }
+#endif
+  fn(ctx, 0, n, 0);
+}
+
+const ML_PoolScratch* ml_pool_acquire(void) {
+#if ML_GEMM_PACKED
+  if (atomic_flag_test_and_set_explicit(&ml_pool_busy, memory_order_acquire)) return NULL;
+
+  // Without a set_ml_threads() call the serial panels are made on first use
+  if (pool_scratch_threads != ml_threads) pool_scratch_alloc(ml_threads);
+  if (pool_scratch_mem) return &pool_scratch;
+
+  atomic_flag_clear_explicit(&ml_pool_busy, memory_order_release);
+#endif
+  return NULL;
+}
+
+void ml_pool_release(void) {
+  atomic_flag_clear_explicit(&ml_pool_busy, memory_order_release);
+}